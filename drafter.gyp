@@ -2,6 +2,16 @@
   "includes": [
     "ext/snowcrash/common.gypi"
   ],
+
+  "target_defaults": {
+    "cflags_cc": [ "-std=c++11", "-pthread" ],
+    "ldflags": [ "-pthread" ],
+    "xcode_settings": {
+      "CLANG_CXX_LANGUAGE_STANDARD": "c++11",
+      "CLANG_CXX_LIBRARY": "libc++",
+      "MACOSX_DEPLOYMENT_TARGET": "10.7",
+    },
+  },
   
   "targets" : [
     {
@@ -38,6 +48,60 @@
         "src/SerializeSourcemap.cc",
         "src/SerializeResult.h",
         "src/SerializeResult.cc",
+        "src/Format.h",
+        "src/SerializeJSON.h",
+        "src/SerializeJSON.cc",
+        "src/SerializeYAML.h",
+        "src/SerializeYAML.cc",
+
+        "src/Hash.h",
+        "src/HashAST.h",
+        "src/HashAST.cc",
+        "src/DiffAST.h",
+        "src/DiffAST.cc",
+
+        "src/LRUCache.h",
+
+        "src/Routes.h",
+        "src/Routes.cc",
+        "src/RouteMatcher.h",
+        "src/RouteMatcher.cc",
+
+        "src/JSONReader.h",
+        "src/JSONReader.cc",
+        "src/JSONSchema.h",
+        "src/JSONSchema.cc",
+        "src/SchemaCache.h",
+        "src/SchemaCache.cc",
+        "src/ValidatePayloads.h",
+        "src/ValidatePayloads.cc",
+
+        "src/ResultCache.h",
+        "src/ResultCache.cc",
+
+        "src/Deadline.h",
+        "src/Deadline.cc",
+
+        "src/ParallelParse.h",
+        "src/ParallelParse.cc",
+        "src/BlueprintSegments.h",
+        "src/BlueprintSegments.cc",
+        "src/AssembleBlueprint.h",
+        "src/AssembleBlueprint.cc",
+
+        "src/PositionIndex.h",
+        "src/PositionIndex.cc",
+
+        "src/JSONPatch.h",
+        "src/JSONPatch.cc",
+
+        "src/SymbolIndex.h",
+        "src/SymbolIndex.cc",
+
+        "src/NormalizeSource.h",
+        "src/NormalizeSource.cc",
+        "src/ResolveMSON.h",
+        "src/ResolveMSON.cc",
       ],
 
       # FIXME: replace by direct dependecies
@@ -72,6 +136,54 @@
         "test/test-main.cc",
         "test/test-SerializeResult.cc",
         "test/test-cdrafter.cc",
+        "test/test-DiffAST.cc",
+        "test/test-Routes.cc",
+        "test/test-RouteMatcher.cc",
+        "test/test-ValidatePayloads.cc",
+        "test/test-ResultCache.cc",
+        "test/test-Format.cc",
+        "test/test-Deadline.cc",
+        "test/test-ParallelParse.cc",
+        "test/test-AssembleBlueprint.cc",
+        "test/test-PositionIndex.cc",
+        "test/test-JSONPatch.cc",
+        "test/test-SymbolIndex.cc",
+        "test/test-NormalizeSource.cc",
+        "test/test-ResolveMSON.cc",
+        "test/test-ThreadSafety.cc",
+        "test/test-MockServer.cc",
+        "test/test-Reporting.cc",
+
+        # parts of drafter executable under test
+        "src/MockServer.cc",
+        "src/reporting.cc",
+      ],
+      'dependencies': [
+        "libdrafter",
+        "libsos",
+        "ext/snowcrash/snowcrash.gyp:libsnowcrash",
+        "ext/snowcrash/snowcrash.gyp:libmarkdownparser",
+        "ext/snowcrash/snowcrash.gyp:libsundown",
+      ],
+      'conditions': [
+         [ 'OS=="win"', { 'defines' : [ 'WIN' ] } ]
+      ],
+    },
+
+    {
+      'target_name': 'benchmark-allocations',
+      'type': 'executable',
+      'include_dirs': [
+        'src',
+        'test',
+        'test/vendor/Catch/include',
+        "ext/snowcrash/src",
+        "ext/snowcrash/ext/markdown-parser/src",
+        "ext/snowcrash/ext/markdown-parser/ext/sundown/src",
+        "ext/sos/src",
+      ],
+      'sources': [
+        "test/benchmark-allocations.cc",
       ],
       'dependencies': [
         "libdrafter",
@@ -94,6 +206,12 @@
         "src/config.h",
         "src/reporting.cc",
         "src/reporting.h",
+        "src/MockServer.cc",
+        "src/MockServer.h",
+        "src/LanguageServer.cc",
+        "src/LanguageServer.h",
+        "src/FileWatcher.cc",
+        "src/FileWatcher.h",
       ],
 
       # FIXME: replace by direct dependecies
@@ -0,0 +1,476 @@
+//
+//  AssembleBlueprint.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "AssembleBlueprint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "drafter.h"
+#include "BlueprintSegments.h"
+#include "NormalizeSource.h"
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+using snowcrash::ParseResult;
+using snowcrash::Warnings;
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Blueprint;
+
+/**
+ *  \brief Parse result of one file, without data structures sections of other files
+ */
+struct BlueprintAssembler::Parsed {
+    mdp::ByteBuffer source;
+    Hash context;                       ///< hash of data structures sections of other files
+    unsigned int options;
+    bool main;                          ///< the first file
+
+    ParseResult<Blueprint> result;
+    size_t characters;                  ///< code points of source
+    bool merge;                         ///< result can be merged
+};
+
+namespace {
+
+    /**
+     *  \brief Data structures sections of one file
+     */
+    struct Context {
+        mdp::ByteBuffer sections;
+        size_t count;
+        Hash hash;
+    };
+
+    inline bool IsContinuation(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    size_t CountCharacters(const mdp::ByteBuffer& source)
+    {
+        size_t characters = 0;
+
+        for (mdp::ByteBuffer::const_iterator it = source.begin(); it != source.end(); ++it) {
+            if (!IsContinuation(*it)) {
+                ++characters;
+            }
+        }
+
+        return characters;
+    }
+
+    void CollectContext(const mdp::ByteBuffer& source, Context& context)
+    {
+        Segments segments;
+        size_t nameEnd = 0;
+
+        ScanSegments(source, segments, nameEnd);
+
+        context.count = 0;
+        Hasher hasher;
+
+        for (Segments::const_iterator it = segments.begin(); it != segments.end(); ++it) {
+
+            if (it->kind != DataStructuresSegment) {
+                continue;
+            }
+
+            context.sections.append(source, it->begin, it->end - it->begin);
+
+            // next section has to start on its own line
+            if (context.sections[context.sections.size() - 1] != '\n') {
+                context.sections += '\n';
+            }
+
+            ++context.count;
+        }
+
+        context.hash = hasher(context.sections)(context.count).value;
+    }
+
+    Hash ParsedKey(const mdp::ByteBuffer& source, Hash context, unsigned int options, bool main)
+    {
+        return Hasher()(source)(context)(options)(main ? 1 : 0).value;
+    }
+}
+
+void BlueprintAssembler::parse(Parsed& parsed, const mdp::ByteBuffer& context, size_t contextCount)
+{
+    mdp::ByteBuffer source = parsed.source;
+
+    if (!source.empty() && source[source.size() - 1] != '\n') {
+        source += '\n';
+    }
+
+    source += context;
+
+    snowcrash::BlueprintParserOptions options = parsed.options;
+
+    if (!parsed.main) {
+        options &= ~snowcrash::RequireBlueprintNameOption;
+    }
+
+    ParseBlueprint(source, options, parsed.result);
+
+    parsed.characters = CountCharacters(parsed.source);
+    parsed.merge = false;
+
+    if (parsed.result.report.error.code != snowcrash::Error::OK) {
+        return;
+    }
+
+    // data structures sections of other files must follow the file
+    Elements& elements = parsed.result.node.content.elements();
+
+    if (elements.size() < contextCount) {
+        return;
+    }
+
+    for (size_t i = elements.size() - contextCount; i < elements.size(); ++i) {
+        if (!IsDataStructuresElement(elements[i])) {
+            return;
+        }
+    }
+
+    elements.erase(elements.end() - contextCount, elements.end());
+
+    SourceMap<Elements>::collection_type& sourceMaps = parsed.result.sourceMap.content.elements().collection;
+
+    if (sourceMaps.size() >= contextCount) {
+        sourceMaps.erase(sourceMaps.end() - contextCount, sourceMaps.end());
+    }
+
+    // keep warnings of the file, API name is expected in the main file only
+    Warnings warnings;
+
+    for (Warnings::const_iterator it = parsed.result.report.warnings.begin();
+         it != parsed.result.report.warnings.end();
+         ++it) {
+
+        if (it->location.empty() ? !parsed.main : it->location.begin()->location >= parsed.characters) {
+            continue;
+        }
+
+        if (!parsed.main && it->code == snowcrash::APINameWarning) {
+            continue;
+        }
+
+        warnings.push_back(*it);
+    }
+
+    parsed.result.report.warnings.swap(warnings);
+    parsed.merge = true;
+}
+
+mdp::ByteBuffer drafter::ConcatenateSourceFiles(const SourceFiles& files)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        size += files[i].source.size() + SourceFileSeparator(files, i);
+    }
+
+    mdp::ByteBuffer source;
+    source.reserve(size);
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        source += files[i].source;
+
+        if (SourceFileSeparator(files, i)) {
+            source += '\n';
+        }
+    }
+
+    return source;
+}
+
+size_t drafter::SourceFileSeparator(const SourceFiles& files, size_t index)
+{
+    const mdp::ByteBuffer& source = files[index].source;
+
+    return (index + 1 < files.size() && !source.empty() && source[source.size() - 1] != '\n') ? 1 : 0;
+}
+
+size_t drafter::LocateSourceFile(const SourceFiles& files, size_t offset, size_t& local)
+{
+    local = offset;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+
+        size_t size = files[i].source.size() + SourceFileSeparator(files, i);
+
+        if (local < size || i + 1 == files.size()) {
+            local = std::min(local, files[i].source.size());
+            return i;
+        }
+
+        local -= size;
+    }
+
+    return 0;
+}
+
+namespace {
+
+    bool IsRange(const sos::Base& value)
+    {
+        return value.type == sos::Base::ArrayType &&
+               value.array.size() == 2 &&
+               value.array[0].type == sos::Base::NumberType &&
+               value.array[1].type == sos::Base::NumberType;
+    }
+
+    class FileConverter {
+    public:
+
+        FileConverter(const SourceFiles& files, PositionUnit unit)
+        : files_(files), unit_(unit), indexes_(files.size()) {}
+
+        void operator()(sos::Base& sourceMap)
+        {
+            if (IsRange(sourceMap)) {
+                convert(sourceMap);
+                return;
+            }
+
+            for (sos::Bases::iterator it = sourceMap.array.begin(); it != sourceMap.array.end(); ++it) {
+                (*this)(*it);
+            }
+
+            for (sos::KeyValues::iterator it = sourceMap.object.begin(); it != sourceMap.object.end(); ++it) {
+                (*this)(it->second);
+            }
+        }
+
+    private:
+        const SourceFiles& files_;
+        PositionUnit unit_;
+        std::vector<std::unique_ptr<PositionIndex> > indexes_;
+
+        void convert(sos::Base& range)
+        {
+            size_t begin = static_cast<size_t>(range.array[0].number);
+            size_t length = static_cast<size_t>(range.array[1].number);
+
+            size_t local = 0;
+            size_t file = LocateSourceFile(files_, begin, local);
+
+            // ranges never cross files, except a trailing line break
+            length = std::min(length, files_[file].source.size() - local);
+
+            range.array[0].number = local;
+            range.array[1].number = length;
+
+            if (unit_ != BytePositions) {
+
+                if (!indexes_[file]) {
+                    indexes_[file].reset(new PositionIndex(files_[file].source));
+                }
+
+                ConvertSourcemapPositions(range, *indexes_[file], unit_);
+            }
+
+            range.array.insert(range.array.begin(), sos::Number(file));
+        }
+    };
+}
+
+void drafter::ConvertSourcemapFiles(sos::Base& sourceMap, const SourceFiles& files, PositionUnit unit)
+{
+    if (files.empty()) {
+        return;
+    }
+
+    FileConverter converter(files, unit);
+    converter(sourceMap);
+}
+
+BlueprintAssembler::BlueprintAssembler(size_t capacity) : cache_(capacity)
+{
+    statistics_.parsed = 0;
+    statistics_.reused = 0;
+}
+
+const BlueprintAssembler::Statistics& BlueprintAssembler::statistics() const
+{
+    return statistics_;
+}
+
+int BlueprintAssembler::assemble(const SourceFiles& files,
+                                 snowcrash::BlueprintParserOptions options,
+                                 const snowcrash::ParseResultRef<Blueprint>& out,
+                                 unsigned int threads)
+{
+    statistics_.parsed = 0;
+    statistics_.reused = 0;
+
+    if (files.size() < 2) {
+        statistics_.parsed = files.size();
+        return ParseBlueprint(ConcatenateSourceFiles(files), options, out);
+    }
+
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    std::vector<Context> contexts(files.size());
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        CollectContext(files[i].source, contexts[i]);
+    }
+
+    // results of files, from cache or to be parsed
+    std::vector<LRUCache<Hash, Parsed>::value_ptr> results(files.size());
+    std::vector<std::shared_ptr<Parsed> > missing;
+    std::vector<size_t> missingFiles;
+
+    for (size_t i = 0; i < files.size(); ++i) {
+
+        Hasher context;
+
+        for (size_t j = 0; j < files.size(); ++j) {
+            if (j != i) {
+                context(contexts[j].hash);
+            }
+        }
+
+        Hash key = ParsedKey(files[i].source, context.value, options, i == 0);
+        LRUCache<Hash, Parsed>::value_ptr cached = cache_.get(key);
+
+        if (cached && cached->source == files[i].source && cached->context == context.value &&
+            cached->options == options && cached->main == (i == 0)) {
+
+            results[i] = cached;
+            ++statistics_.reused;
+            continue;
+        }
+
+        std::shared_ptr<Parsed> parsed(new Parsed);
+
+        parsed->source = files[i].source;
+        parsed->context = context.value;
+        parsed->options = options;
+        parsed->main = (i == 0);
+
+        missing.push_back(parsed);
+        missingFiles.push_back(i);
+    }
+
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+        for (size_t m = next++; m < missing.size(); m = next++) {
+
+            size_t i = missingFiles[m];
+
+            mdp::ByteBuffer context;
+            size_t count = 0;
+
+            for (size_t j = 0; j < files.size(); ++j) {
+                if (j != i) {
+                    context += contexts[j].sections;
+                    count += contexts[j].count;
+                }
+            }
+
+            parse(*missing[m], context, count);
+        }
+    };
+
+    std::vector<std::thread> workers;
+
+    for (unsigned int i = 1; i < std::min(threads, static_cast<unsigned int>(missing.size())); ++i) {
+        workers.push_back(std::thread(worker));
+    }
+
+    worker();
+
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+        it->join();
+    }
+
+    for (size_t m = 0; m < missing.size(); ++m) {
+
+        size_t i = missingFiles[m];
+        const Parsed& parsed = *missing[m];
+
+        cache_.put(ParsedKey(parsed.source, parsed.context, parsed.options, parsed.main),
+                   missing[m],
+                   sizeof(Parsed) + 4 * parsed.source.size());
+
+        results[i] = missing[m];
+        ++statistics_.parsed;
+    }
+
+    // merge, or parse the concatenation where it might differ
+    std::vector<ElementsRange> parts;
+
+    for (size_t i = 0; i < results.size(); ++i) {
+
+        if (!results[i]->merge) {
+            return ParseBlueprint(ConcatenateSourceFiles(files), options, out);
+        }
+
+        const Elements& elements = results[i]->result.node.content.elements();
+        ElementsRange part = { elements.begin(), elements.end() };
+        parts.push_back(part);
+    }
+
+    if (!HasUniqueResources(parts)) {
+        return ParseBlueprint(ConcatenateSourceFiles(files), options, out);
+    }
+
+    // name, description and metadata come from the main file
+    const ParseResult<Blueprint>& main = results.front()->result;
+
+    out.node = main.node;
+    out.sourceMap = main.sourceMap;
+    out.report = main.report;
+
+    size_t offset = files.front().source.size() + SourceFileSeparator(files, 0);
+    size_t characters = results.front()->characters + SourceFileSeparator(files, 0);
+
+    for (size_t i = 1; i < results.size(); ++i) {
+
+        const ParseResult<Blueprint>& result = results[i]->result;
+
+        Elements& elements = out.node.content.elements();
+        elements.insert(elements.end(), result.node.content.elements().begin(), result.node.content.elements().end());
+
+        SourceMap<Blueprint> sourceMap;
+        sourceMap.content.elements() = result.sourceMap.content.elements();
+
+        SourceRemap remap;
+        remap.shift(0, offset);
+        RemapSourceMap(sourceMap, remap);
+
+        SourceMap<Elements>::collection_type& sourceMaps = out.sourceMap.content.elements().collection;
+        sourceMaps.insert(sourceMaps.end(),
+                          sourceMap.content.elements().collection.begin(),
+                          sourceMap.content.elements().collection.end());
+
+        for (Warnings::const_iterator it = result.report.warnings.begin(); it != result.report.warnings.end(); ++it) {
+
+            out.report.warnings.push_back(*it);
+
+            mdp::CharactersRangeSet& location = out.report.warnings.back().location;
+
+            for (mdp::CharactersRangeSet::iterator range = location.begin(); range != location.end(); ++range) {
+                range->location += characters;
+            }
+        }
+
+        offset += files[i].source.size() + SourceFileSeparator(files, i);
+        characters += results[i]->characters + SourceFileSeparator(files, i);
+    }
+
+    return out.report.error.code;
+}
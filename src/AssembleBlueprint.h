@@ -0,0 +1,130 @@
+//
+//  AssembleBlueprint.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_ASSEMBLE_BLUEPRINT_H
+#define DRAFTER_ASSEMBLE_BLUEPRINT_H
+
+#include <string>
+#include <vector>
+
+#include "snowcrash.h"
+#include "Hash.h"
+#include "LRUCache.h"
+#include "PositionIndex.h"
+
+namespace drafter {
+
+    /**
+     *  \brief One file of blueprint split into more files
+     */
+    struct SourceFile {
+        std::string name;
+        mdp::ByteBuffer source;
+
+        SourceFile() {}
+        SourceFile(const std::string& name_, const mdp::ByteBuffer& source_) : name(name_), source(source_) {}
+    };
+
+    typedef std::vector<SourceFile> SourceFiles;
+
+    /**
+     *  \brief Concatenation of \param files, the source assembled result refers to
+     *
+     *  Files not ending by a line break are followed by one, so the next
+     *  file starts on its own line.
+     */
+    mdp::ByteBuffer ConcatenateSourceFiles(const SourceFiles& files);
+
+    /**
+     *  \brief Length (0 or 1) of line break ConcatenateSourceFiles() puts after file \param index
+     */
+    size_t SourceFileSeparator(const SourceFiles& files, size_t index);
+
+    /**
+     *  \brief Index of file containing byte \param offset of concatenated \param files
+     *
+     *  Line break added after a file belongs to the file.
+     *
+     *  \param local    Output - offset in the file, at most its size
+     */
+    size_t LocateSourceFile(const SourceFiles& files, size_t offset, size_t& local);
+
+    /**
+     *  \brief Prefix every range of wrapped source map by index of its file
+     *
+     *  Every `[location, length]` row of \param sourceMap in bytes of
+     *  concatenated \param files becomes `[file, location, length]` with
+     *  location in the file, converted to \param unit as by
+     *  ConvertSourcemapPositions().
+     */
+    void ConvertSourcemapFiles(sos::Base& sourceMap, const SourceFiles& files, PositionUnit unit);
+
+    /**
+     *  \brief Parses blueprint split into files, reparsing only files changed since the previous assembly
+     *
+     *  The first file is the main one - API name, metadata and description
+     *  come from it. Other files continue it by resource groups, resources
+     *  and data structures sections, their own API name and description,
+     *  if any, are dropped.
+     *
+     *  Every file is parsed alone, followed by `Data Structures` sections of
+     *  the other files, so named types are resolved across all files. Parse
+     *  results are cached by content hash of the file and of the data
+     *  structures sections around it - changed file is parsed again, the
+     *  rest is only merged. A change to a data structures section reparses
+     *  every file.
+     *
+     *  Merged result is the same as of ParseBlueprint() of concatenated
+     *  files - elements, source maps in bytes of the concatenation and
+     *  warnings in its characters. Whenever it might differ - any file
+     *  fails, the same resource URI template or name is in more files or a
+     *  file does not end its code block - the concatenation is parsed
+     *  instead and nothing is cached.
+     */
+    class BlueprintAssembler {
+    public:
+
+        struct Statistics {
+            size_t parsed;          ///< files parsed by the last assemble()
+            size_t reused;          ///< files of the last assemble() found in cache
+        };
+
+        static const size_t DefaultCapacity = 256 * 1024 * 1024;
+
+        /** \param capacity  Approximate limit of cached results in bytes */
+        explicit BlueprintAssembler(size_t capacity = DefaultCapacity);
+
+        /**
+         *  \brief Parse and merge \param files into \param out
+         *
+         *  \param threads  Maximal number of concurrent parses, 0 for number of cores.
+         *                  Concurrent parse is opt-in, see ParseBlueprintParallel().
+         *  \return Error status code. Zero represents success, non-zero a failure.
+         */
+        int assemble(const SourceFiles& files,
+                     snowcrash::BlueprintParserOptions options,
+                     const snowcrash::ParseResultRef<snowcrash::Blueprint>& out,
+                     unsigned int threads = 1);
+
+        const Statistics& statistics() const;
+
+    private:
+
+        struct Parsed;
+
+        LRUCache<Hash, Parsed> cache_;
+        Statistics statistics_;
+
+        /** Parse \param parsed source in front of \param context, keep only its own elements and warnings */
+        static void parse(Parsed& parsed, const mdp::ByteBuffer& context, size_t contextCount);
+
+        BlueprintAssembler(const BlueprintAssembler&);
+        BlueprintAssembler& operator=(const BlueprintAssembler&);
+    };
+}
+
+#endif // #ifndef DRAFTER_ASSEMBLE_BLUEPRINT_H
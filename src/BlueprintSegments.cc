@@ -0,0 +1,213 @@
+//
+//  BlueprintSegments.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "BlueprintSegments.h"
+
+#include <map>
+
+using namespace drafter;
+
+using snowcrash::Resource;
+using snowcrash::Element;
+using snowcrash::Elements;
+
+namespace {
+
+    bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    /**
+     *  \brief Check line [begin, end) opens or closes code fence
+     */
+    bool IsFence(const std::string& source, size_t begin, size_t end, char& fence)
+    {
+        size_t i = begin;
+
+        while (i < end && i - begin < 3 && source[i] == ' ') {
+            ++i;
+        }
+
+        if (end - i < 3 || (source[i] != '`' && source[i] != '~')) {
+            return false;
+        }
+
+        if (source[i + 1] != source[i] || source[i + 2] != source[i]) {
+            return false;
+        }
+
+        fence = source[i];
+        return true;
+    }
+
+    /**
+     *  \brief Text of level one ATX heading on line [begin, end)
+     *
+     *  \return False if line is not level one heading
+     */
+    bool HeadingText(const std::string& source, size_t begin, size_t end, std::string& text)
+    {
+        if (end - begin < 2 || source[begin] != '#' || (source[begin + 1] != ' ' && source[begin + 1] != '\t')) {
+            return false;
+        }
+
+        begin += 2;
+
+        while (begin < end && IsBlank(source[begin])) {
+            ++begin;
+        }
+
+        while (end > begin && (IsBlank(source[end - 1]) || source[end - 1] == '#')) {
+            --end;
+        }
+
+        text.assign(source, begin, end - begin);
+        return true;
+    }
+
+    bool IsGroupHeading(const std::string& text)
+    {
+        return text.size() > 6 &&
+               (text[0] == 'G' || text[0] == 'g') &&
+               text.compare(1, 4, "roup") == 0 &&
+               IsBlank(text[5]);
+    }
+
+    bool IsDataStructuresHeading(const std::string& text)
+    {
+        return text.size() == 15 &&
+               (text[0] == 'D' || text[0] == 'd') &&
+               text.compare(1, 4, "ata ") == 0 &&
+               (text[5] == 'S' || text[5] == 's') &&
+               text.compare(6, 9, "tructures") == 0;
+    }
+
+    /**
+     *  \brief Remember \param key of \param part in \param seen
+     *
+     *  \return False if \param key is already in other part
+     */
+    bool CheckUnique(const std::string& key, size_t part, std::map<std::string, size_t>& seen)
+    {
+        if (key.empty()) {
+            return true;
+        }
+
+        std::pair<std::map<std::string, size_t>::iterator, bool> inserted = seen.insert(std::make_pair(key, part));
+
+        return inserted.second || inserted.first->second == part;
+    }
+}
+
+bool drafter::ScanSegments(const std::string& source, Segments& segments, size_t& nameEnd)
+{
+    Segment current = { 0, 0, PreambleSegment };
+
+    bool first = true;
+    bool named = false;
+    bool inFence = false;
+    char fence = 0;
+    std::string text;
+
+    for (size_t begin = 0; begin < source.size();) {
+
+        size_t end = source.find('\n', begin);
+        size_t next = (end == std::string::npos) ? source.size() : end + 1;
+
+        if (end == std::string::npos) {
+            end = source.size();
+        }
+
+        char lineFence;
+
+        if (IsFence(source, begin, end, lineFence)) {
+
+            if (!inFence) {
+                inFence = true;
+                fence = lineFence;
+            }
+            else if (lineFence == fence) {
+                inFence = false;
+            }
+        }
+        else if (!inFence && source[begin] == '#') {
+
+            bool heading = HeadingText(source, begin, end, text);
+            bool split = heading && (IsGroupHeading(text) || IsDataStructuresHeading(text));
+
+            // API name must be the first heading
+            if (first && !split) {
+                named = heading;
+                nameEnd = next;
+            }
+            else if (split) {
+
+                current.end = begin;
+                segments.push_back(current);
+
+                current.begin = begin;
+                current.kind = IsGroupHeading(text) ? GroupSegment : DataStructuresSegment;
+            }
+
+            first = false;
+        }
+
+        begin = next;
+    }
+
+    current.end = source.size();
+    segments.push_back(current);
+
+    return named;
+}
+
+bool drafter::IsDataStructuresElement(const Element& element)
+{
+    return element.element == Element::CategoryElement && element.category == Element::DataStructureGroupCategory;
+}
+
+bool drafter::HasUniqueResources(const std::vector<ElementsRange>& parts)
+{
+    std::map<std::string, size_t> uriTemplates;
+    std::map<std::string, size_t> names;
+
+    for (size_t i = 0; i < parts.size(); ++i) {
+
+        for (Elements::const_iterator it = parts[i].begin; it != parts[i].end; ++it) {
+
+            std::vector<const Resource*> resources;
+
+            if (it->element == Element::ResourceElement) {
+                resources.push_back(&it->content.resource);
+            }
+            else if (it->element == Element::CategoryElement) {
+
+                for (Elements::const_iterator child = it->content.elements().begin();
+                     child != it->content.elements().end();
+                     ++child) {
+
+                    if (child->element == Element::ResourceElement) {
+                        resources.push_back(&child->content.resource);
+                    }
+                }
+            }
+
+            for (std::vector<const Resource*>::const_iterator resource = resources.begin();
+                 resource != resources.end();
+                 ++resource) {
+
+                if (!CheckUnique((*resource)->uriTemplate, i, uriTemplates) ||
+                    !CheckUnique((*resource)->name, i, names)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
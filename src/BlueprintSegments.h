@@ -0,0 +1,63 @@
+//
+//  BlueprintSegments.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_BLUEPRINT_SEGMENTS_H
+#define DRAFTER_BLUEPRINT_SEGMENTS_H
+
+#include <string>
+#include <vector>
+
+#include "snowcrash.h"
+
+namespace drafter {
+
+    enum SegmentKind {
+        PreambleSegment,            ///< API name, description and anything else before the first split
+        GroupSegment,
+        DataStructuresSegment
+    };
+
+    /**
+     *  \brief Part of source starting by top-level heading
+     */
+    struct Segment {
+        size_t begin, end;          ///< byte range in source
+        SegmentKind kind;
+    };
+
+    typedef std::vector<Segment> Segments;
+
+    /**
+     *  \brief Split \param source before every top-level group and data structures heading
+     *
+     *  Headings in code fences are skipped. The first segment is always
+     *  preamble, empty if source starts by a split.
+     *
+     *  \param nameEnd  Output - end of API name heading line
+     *  \return False if source does not start by API name
+     */
+    bool ScanSegments(const std::string& source, Segments& segments, size_t& nameEnd);
+
+    bool IsDataStructuresElement(const snowcrash::Element& element);
+
+    /**
+     *  \brief Top-level elements of one part of blueprint
+     */
+    struct ElementsRange {
+        snowcrash::Elements::const_iterator begin, end;
+    };
+
+    /**
+     *  \brief Check no resource URI template or name is in more parts
+     *
+     *  Snowcrash checks those across the whole document, parts parsed
+     *  separately would miss the duplicate warnings.
+     */
+    bool HasUniqueResources(const std::vector<ElementsRange>& parts);
+}
+
+#endif // #ifndef DRAFTER_BLUEPRINT_SEGMENTS_H
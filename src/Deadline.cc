@@ -0,0 +1,44 @@
+//
+//  Deadline.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "Deadline.h"
+
+using namespace drafter;
+
+Deadline::Deadline() : limited_(false), until_(), cancelled_(false)
+{
+}
+
+Deadline::Deadline(Clock::duration timeout) : limited_(true), until_(Clock::now() + timeout), cancelled_(false)
+{
+}
+
+void Deadline::cancel()
+{
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+bool Deadline::expired() const
+{
+    return cancelled_.load(std::memory_order_relaxed) || (limited_ && Clock::now() >= until_);
+}
+
+Deadline::Clock::time_point Deadline::until() const
+{
+    return limited_ ? until_ : Clock::time_point::max();
+}
+
+void Deadline::check() const
+{
+    if (cancelled_.load(std::memory_order_relaxed)) {
+        throw Cancelled("parsing cancelled");
+    }
+
+    if (limited_ && Clock::now() >= until_) {
+        throw Cancelled("parsing deadline exceeded");
+    }
+}
@@ -0,0 +1,120 @@
+//
+//  Deadline.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_DEADLINE_H
+#define DRAFTER_DEADLINE_H
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace drafter {
+
+    /**
+     *  Error codes of drafter's own failures. They start at 100 to stay clear
+     *  of snowcrash::ErrorCode.
+     */
+    enum ErrorCode {
+        CancelledError = 100    ///< deadline exceeded or cancelled before the result was complete
+    };
+
+    /**
+     *  \brief Thrown by Deadline::check() - wrapping or serialization was abandoned
+     */
+    class Cancelled : public std::runtime_error {
+    public:
+        explicit Cancelled(const std::string& message) : std::runtime_error(message) {}
+    };
+
+    /**
+     *  \brief Time limit and cancellation token of one parse
+     *
+     *  Deadline is checked between elements - resource groups, resources and
+     *  data structures while wrapping, every few values while serializing.
+     *  cancel() may be called from any thread, the work observes it at the
+     *  next check. Snowcrash parsing itself can not be interrupted,
+     *  ParseBlueprint() runs it on a worker thread and stops waiting for it
+     *  when the deadline expires - the abandoned parse finishes in background.
+     *  No more than MaxAbandonedParses are left so, see ParseBlueprint().
+     *
+     *  usage:
+     *
+     *  drafter::Deadline deadline(std::chrono::milliseconds(500));
+     *  drafter::ParseBlueprint(source, options, blueprint, &deadline);
+     */
+    class Deadline {
+    public:
+
+        typedef std::chrono::steady_clock Clock;
+
+        /** No time limit, expires only by cancel() */
+        Deadline();
+
+        /** Expires \param timeout from now or by cancel() */
+        explicit Deadline(Clock::duration timeout);
+
+        /** Expire now */
+        void cancel();
+
+        /** True if cancelled or past the time limit */
+        bool expired() const;
+
+        /** Time limit, Clock::time_point::max() if there is none */
+        Clock::time_point until() const;
+
+        /**
+         *  \brief Throw Cancelled if expired
+         */
+        void check() const;
+
+    private:
+        bool limited_;
+        Clock::time_point until_;
+        std::atomic<bool> cancelled_;
+
+        Deadline(const Deadline&);
+        Deadline& operator=(const Deadline&);
+    };
+
+    /**
+     *  \brief Checks deadline once in Interval calls of tick()
+     *
+     *  For loops with many cheap steps where reading the clock every time
+     *  would cost more than the step itself.
+     */
+    class DeadlineCounter {
+    public:
+
+        static const unsigned int Interval = 256;
+
+        explicit DeadlineCounter(const Deadline* deadline) : deadline_(deadline), count_(0) {}
+
+        /** \throw Cancelled when deadline expired */
+        void tick()
+        {
+            if (deadline_ && ++count_ % Interval == 0) {
+                deadline_->check();
+            }
+        }
+
+    private:
+        const Deadline* deadline_;
+        unsigned int count_;
+    };
+
+    /**
+     *  \brief Call \param deadline check() unless it is NULL
+     */
+    inline void CheckDeadline(const Deadline* deadline)
+    {
+        if (deadline) {
+            deadline->check();
+        }
+    }
+}
+
+#endif // #ifndef DRAFTER_DEADLINE_H
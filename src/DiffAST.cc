@@ -0,0 +1,159 @@
+//
+//  DiffAST.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "DiffAST.h"
+
+#include <map>
+#include <set>
+
+using namespace drafter;
+
+typedef std::vector<std::string> Path;
+typedef std::vector<HashNode> HashNodes;
+
+static void PushChange(Change::Type type, const HashNode& node, const Path& path, Changes& changes)
+{
+    Change change;
+
+    change.type = type;
+    change.element = node.element;
+    change.path = path;
+
+    changes.push_back(change);
+}
+
+/**
+ *  \brief Push changes from \param before to \param after, children are matched by element and key
+ *
+ *  Siblings with duplicate keys are numbered by their position, so removing
+ *  the first of them would renumber the others. They are matched by content
+ *  hash first, only the rest of them by position.
+ */
+static void DiffNode(const HashNode& before, const HashNode& after, Path& path, Changes& changes)
+{
+    if (before.hash == after.hash) {
+        return;
+    }
+
+    if (before.content != after.content) {
+        PushChange(Change::ModifiedChange, after, path, changes);
+    }
+
+    typedef std::pair<std::string, std::string> Identity;      // element and base key
+    typedef std::map<Identity, std::vector<const HashNode*> > NodeMap;
+
+    NodeMap previous;
+
+    for (HashNodes::const_iterator it = before.children.begin(); it != before.children.end(); ++it) {
+        previous[Identity(it->element, it->baseKey)].push_back(&(*it));
+    }
+
+    std::set<const HashNode*> unchanged;       // children of `after` with equal child in `before`
+
+    for (HashNodes::const_iterator it = after.children.begin(); it != after.children.end(); ++it) {
+
+        std::vector<const HashNode*>& candidates = previous[Identity(it->element, it->baseKey)];
+
+        for (std::vector<const HashNode*>::iterator candidate = candidates.begin(); candidate != candidates.end(); ++candidate) {
+            if ((*candidate)->hash == it->hash) {
+                candidates.erase(candidate);
+                unchanged.insert(&(*it));
+                break;
+            }
+        }
+    }
+
+    for (HashNodes::const_iterator it = after.children.begin(); it != after.children.end(); ++it) {
+
+        if (unchanged.count(&(*it))) {
+            continue;
+        }
+
+        std::vector<const HashNode*>& candidates = previous[Identity(it->element, it->baseKey)];
+
+        path.push_back(it->key);
+
+        if (candidates.empty()) {
+            PushChange(Change::AddedChange, *it, path, changes);
+        }
+        else {
+            DiffNode(*candidates.front(), *it, path, changes);
+            candidates.erase(candidates.begin());
+        }
+
+        path.pop_back();
+    }
+
+    // Whatever was not matched is gone
+    std::set<const HashNode*> removed;
+
+    for (NodeMap::const_iterator it = previous.begin(); it != previous.end(); ++it) {
+        removed.insert(it->second.begin(), it->second.end());
+    }
+
+    for (HashNodes::const_iterator it = before.children.begin(); it != before.children.end(); ++it) {
+
+        if (!removed.count(&(*it))) {
+            continue;
+        }
+
+        path.push_back(it->key);
+        PushChange(Change::RemovedChange, *it, path, changes);
+        path.pop_back();
+    }
+}
+
+void drafter::DiffBlueprint(const HashNode& before, const HashNode& after, Changes& changes)
+{
+    Path path;
+    DiffNode(before, after, path, changes);
+}
+
+static sos::String ChangeTypeToString(const Change::Type& type)
+{
+    switch (type) {
+        case Change::AddedChange:
+            return sos::String("added");
+
+        case Change::RemovedChange:
+            return sos::String("removed");
+
+        case Change::ModifiedChange:
+            return sos::String("modified");
+
+        default:
+            return sos::String();
+    }
+
+    return sos::String();
+}
+
+static sos::String WrapPathKey(const std::string& key)
+{
+    return sos::String(key);
+}
+
+static sos::Object WrapChange(const Change& change)
+{
+    sos::Object changeObject;
+
+    // Change
+    changeObject.set(SerializeKey::Change, ChangeTypeToString(change.type));
+
+    // Element
+    changeObject.set(SerializeKey::Element, sos::String(change.element));
+
+    // Path
+    changeObject.set(SerializeKey::Path, WrapCollection<std::string>()(change.path, WrapPathKey));
+
+    return changeObject;
+}
+
+sos::Array drafter::WrapChanges(const Changes& changes)
+{
+    return WrapCollection<Change>()(changes, WrapChange);
+}
@@ -0,0 +1,51 @@
+//
+//  DiffAST.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_DIFF_AST_H
+#define DRAFTER_DIFF_AST_H
+
+#include "HashAST.h"
+#include "Serialize.h"
+
+namespace drafter {
+
+    /**
+     *  \brief One difference between two blueprints
+     */
+    struct Change {
+
+        enum Type {
+            AddedChange,
+            RemovedChange,
+            ModifiedChange
+        };
+
+        Type type;
+        std::string element;            ///< kind of node \see HashNode::element
+        std::vector<std::string> path;  ///< keys of nodes from blueprint down to changed node
+    };
+
+    typedef std::vector<Change> Changes;
+
+    /**
+     *  \brief Structural diff of two blueprints
+     *
+     *  Subtrees with the same hash are skipped without descending, so cost is
+     *  proportional to the size of the change, not to the size of blueprints.
+     *  Added or removed node is reported once - its children are not listed.
+     *  Modified node is reported only if its own fields differ.
+     *
+     *  \param before   Hash tree of original blueprint
+     *  \param after    Hash tree of new blueprint
+     *  \param changes  Output - found differences
+     */
+    void DiffBlueprint(const HashNode& before, const HashNode& after, Changes& changes);
+
+    sos::Array WrapChanges(const Changes& changes);
+}
+
+#endif // #ifndef DRAFTER_DIFF_AST_H
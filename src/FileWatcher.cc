@@ -0,0 +1,287 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  FileWatcher.cc - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "FileWatcher.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+
+const int FileWatcher::DebounceInterval;
+
+namespace {
+
+    /**
+     *  \brief Split \param path into \param directory and file \param name
+     */
+    void SplitPath(const std::string& path, std::string& directory, std::string& name)
+    {
+        size_t slash = path.rfind('/');
+
+        if (slash == std::string::npos) {
+            directory = ".";
+            name = path;
+            return;
+        }
+
+        directory = (slash == 0) ? "/" : path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+
+    std::string PathKey(const std::string& directory, const std::string& name)
+    {
+        return directory + '/' + name;
+    }
+}
+
+FileWatcher::FileWatcher(const std::vector<std::string>& files) : fd_(-1), files_(files)
+{
+}
+
+#if defined(__linux__)
+
+namespace {
+
+    const uint32_t WatchedEvents = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+    const size_t EventBufferSize = 64 * 1024;
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool FileWatcher::start()
+{
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (fd_ < 0) {
+        return false;
+    }
+
+    for (size_t i = 0; i < files_.size(); ++i) {
+
+        std::string directory, name;
+        SplitPath(files_[i], directory, name);
+
+        int wd = inotify_add_watch(fd_, directory.c_str(), WatchedEvents);
+
+        if (wd < 0) {
+            return false;
+        }
+
+        // the same directory, however spelled, gets the same watch descriptor
+        paths_.insert(std::make_pair(std::make_pair(wd, name), i));
+    }
+
+    return true;
+}
+
+bool FileWatcher::read(std::set<size_t>& touched)
+{
+    std::vector<char> buffer(EventBufferSize);
+
+    for (;;) {
+
+        ssize_t count = ::read(fd_, &buffer[0], buffer.size());
+
+        if (count < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        for (ssize_t offset = 0; offset < count;) {
+
+            inotify_event event;
+            memcpy(&event, &buffer[offset], sizeof(event));
+
+            const char* name = &buffer[offset + sizeof(inotify_event)];
+            offset += sizeof(inotify_event) + event.len;
+
+            if (event.mask & IN_Q_OVERFLOW) {
+
+                // events were lost, any file may have changed
+                for (size_t i = 0; i < files_.size(); ++i) {
+                    touched.insert(i);
+                }
+
+                continue;
+            }
+
+            if (event.len == 0) {
+                continue;
+            }
+
+            typedef std::multimap<std::pair<int, std::string>, size_t>::const_iterator iterator;
+            std::pair<iterator, iterator> files = paths_.equal_range(std::make_pair(event.wd, std::string(name)));
+
+            for (iterator it = files.first; it != files.second; ++it) {
+                touched.insert(it->second);
+            }
+        }
+    }
+}
+
+bool FileWatcher::wait(std::set<size_t>& touched)
+{
+    touched.clear();
+
+    pollfd events;
+    events.fd = fd_;
+    events.events = POLLIN;
+
+    // sleep until an event of the files
+    while (touched.empty()) {
+
+        if (poll(&events, 1, -1) < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (!read(touched)) {
+            return false;
+        }
+    }
+
+    // and until the burst is over
+    for (;;) {
+
+        int ready = poll(&events, 1, DebounceInterval);
+
+        if (ready < 0) {
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (ready == 0) {
+            return true;
+        }
+
+        if (!read(touched)) {
+            return false;
+        }
+    }
+}
+
+#else
+
+FileWatcher::~FileWatcher()
+{
+}
+
+bool FileWatcher::start()
+{
+    errno = ENOSYS;
+    return false;
+}
+
+bool FileWatcher::read(std::set<size_t>& touched)
+{
+    errno = ENOSYS;
+    return false;
+}
+
+bool FileWatcher::wait(std::set<size_t>& touched)
+{
+    errno = ENOSYS;
+    return false;
+}
+
+#endif
+
+#if !defined(_WIN32)
+
+bool WriteFileAtomically(const std::string& name, const std::string& content)
+{
+    std::string directory, file;
+    SplitPath(name, directory, file);
+
+    std::string temporary = PathKey(directory, "." + file + ".XXXXXX");
+
+    int fd = mkstemp(&temporary[0]);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    // keep permissions of the replaced file, mkstemp() creates it private
+    struct stat status;
+    fchmod(fd, stat(name.c_str(), &status) == 0 ? (status.st_mode & 07777) : 0644);
+
+    for (size_t written = 0; written < content.size();) {
+
+        ssize_t count = write(fd, content.data() + written, content.size() - written);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0) {
+            int error = errno;
+
+            close(fd);
+            unlink(temporary.c_str());
+
+            errno = error;
+            return false;
+        }
+
+        written += count;
+    }
+
+    if (close(fd) < 0 || rename(temporary.c_str(), name.c_str()) < 0) {
+        int error = errno;
+
+        unlink(temporary.c_str());
+
+        errno = error;
+        return false;
+    }
+
+    return true;
+}
+
+#else
+
+bool WriteFileAtomically(const std::string& name, const std::string& content)
+{
+    std::ofstream out(name.c_str(), std::ios::binary | std::ios::trunc);
+    out << content;
+
+    return static_cast<bool>(out);
+}
+
+#endif
@@ -0,0 +1,80 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  FileWatcher.h - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_FILE_WATCHER_H
+#define DRAFTER_FILE_WATCHER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ *  \brief Waits for changes of files by inotify
+ *
+ *  Directories of the files are watched rather than the files themselves -
+ *  editors often save by writing a new file and renaming it over the old
+ *  one, which a watch of the file would not survive. Events of other files
+ *  in the directories are ignored.
+ *
+ *  A burst of events - an editor saving, a checkout touching many files -
+ *  is coalesced, wait() returns once no event came for DebounceInterval.
+ *  Between bursts the process sleeps in poll(), using no CPU.
+ *
+ *  Needs inotify, it is available on Linux only.
+ */
+class FileWatcher {
+public:
+
+    static const int DebounceInterval = 50;  // ms
+
+    explicit FileWatcher(const std::vector<std::string>& files);
+    ~FileWatcher();
+
+    /**
+     *  \brief Start watching directories of the files
+     *
+     *  \return False if the directories can not be watched, errno is set
+     */
+    bool start();
+
+    /**
+     *  \brief Block until some of the files may have changed
+     *
+     *  \param touched  Output - indexes of files written, created, moved or deleted
+     *  \return False on error, errno is set
+     */
+    bool wait(std::set<size_t>& touched);
+
+private:
+
+    int fd_;
+    std::vector<std::string> files_;
+
+    /** watch descriptor of directory and file name to file index */
+    std::multimap<std::pair<int, std::string>, size_t> paths_;
+
+    /** Read pending events, \return False on error */
+    bool read(std::set<size_t>& touched);
+
+    FileWatcher(const FileWatcher&);
+    FileWatcher& operator=(const FileWatcher&);
+};
+
+/**
+ *  \brief Replace content of file \param name by \param content atomically
+ *
+ *  Content is written into a temporary file next to \param name and renamed
+ *  over it, readers see either the old or the new content, never a part.
+ *
+ *  \return False on error, errno is set
+ */
+bool WriteFileAtomically(const std::string& name, const std::string& content);
+
+#endif /* end of include guard: DRAFTER_FILE_WATCHER_H */
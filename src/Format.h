@@ -0,0 +1,263 @@
+//
+//  Format.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_FORMAT_H
+#define DRAFTER_FORMAT_H
+
+#include <cmath>
+#include <ostream>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace drafter {
+
+    /** Buffer size sufficient for any integer written by FormatInteger() with sign */
+    const size_t NumberBufferSize = 32;
+
+    /**
+     *  \brief Write decimal digits of \param value backwards, ending at \param end
+     *
+     *  Two digits are produced per division using lookup table.
+     *
+     *  \return Pointer to the first digit
+     */
+    inline char* FormatInteger(uint64_t value, char* end)
+    {
+        static const char digitPairs[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        while (value >= 100) {
+            const char* pair = digitPairs + (value % 100) * 2;
+            value /= 100;
+
+            *--end = pair[1];
+            *--end = pair[0];
+        }
+
+        if (value >= 10) {
+            const char* pair = digitPairs + value * 2;
+
+            *--end = pair[1];
+            *--end = pair[0];
+        }
+        else {
+            *--end = static_cast<char>('0' + value);
+        }
+
+        return end;
+    }
+
+    /**
+     *  \brief Write \param number to \param os
+     *
+     *  sos keeps every number as double although nearly all of them - source
+     *  map ranges, annotation locations and codes - are integers. Integral
+     *  values (up to 2^53, exactly representable) take the FormatInteger() path
+     *  and are written in full; `os << double` would also switch to exponent
+     *  notation from 1e6 on. Other values are written as `os << double` does.
+     *
+     *  \param os  std::ostream or OutputBuffer
+     */
+    template<typename Output>
+    inline void WriteNumber(double number, Output& os)
+    {
+        static const double MaxExactInteger = 9007199254740992.0;   // 2^53
+
+        if (number > -MaxExactInteger && number < MaxExactInteger && std::floor(number) == number) {
+
+            char buffer[NumberBufferSize];
+            char* end = buffer + sizeof(buffer);
+            char* begin = FormatInteger(static_cast<uint64_t>(number < 0 ? -number : number), end);
+
+            if (number < 0) {
+                *--begin = '-';
+            }
+
+            os.write(begin, end - begin);
+            return;
+        }
+
+        std::ostringstream formatted;
+        formatted << number;
+
+        const std::string& str = formatted.str();
+        os.write(str.data(), str.size());
+    }
+
+    /**
+     *  \brief Write \param level levels of two space indentation
+     */
+    template<typename Output>
+    inline void WriteIndent(size_t level, Output& os)
+    {
+        static const char spaces[] = "                                                                ";
+        static const size_t chunk = sizeof(spaces) - 1;
+
+        size_t count = level * 2;
+
+        for (; count > chunk; count -= chunk) {
+            os.write(spaces, chunk);
+        }
+
+        os.write(spaces, count);
+    }
+
+    /**
+     *  \brief Offset of the first control character, `"` or `\` in [\param begin, \param end) of \param data or \param end
+     *
+     *  Scans 16 bytes at once where SSE2 is available.
+     */
+    inline size_t FindEscape(const char* data, size_t begin, size_t end)
+    {
+        size_t i = begin;
+
+#if defined(__SSE2__)
+        const __m128i control = _mm_set1_epi8(0x1F);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+
+        for (; i + 16 <= end; i += 16) {
+
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+            __m128i found = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(block, control), control),
+                                         _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)));
+
+            int mask = _mm_movemask_epi8(found);
+
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+#endif
+
+        for (; i < end; ++i) {
+
+            unsigned char c = static_cast<unsigned char>(data[i]);
+
+            if (c < 0x20 || c == '"' || c == '\\') {
+                return i;
+            }
+        }
+
+        return end;
+    }
+
+    /**
+     *  \brief Write \param str as double quoted string with JSON escapes
+     *
+     *  Runs of characters without escapes are found by FindEscape() and
+     *  written at once.
+     *
+     *  \param os  std::ostream or OutputBuffer
+     */
+    template<typename Output>
+    inline void WriteQuotedString(const std::string& str, Output& os)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        os.put('"');
+
+        const char* data = str.data();
+        size_t run = 0;
+
+        for (size_t i = FindEscape(data, 0, str.size()); i < str.size(); i = FindEscape(data, i + 1, str.size())) {
+
+            unsigned char c = static_cast<unsigned char>(data[i]);
+
+            os.write(data + run, i - run);
+            run = i + 1;
+
+            switch (c) {
+                case '"':  os.write("\\\"", 2); break;
+                case '\\': os.write("\\\\", 2); break;
+                case '\b': os.write("\\b", 2); break;
+                case '\f': os.write("\\f", 2); break;
+                case '\n': os.write("\\n", 2); break;
+                case '\r': os.write("\\r", 2); break;
+                case '\t': os.write("\\t", 2); break;
+
+                default:
+                {
+                    char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+                    os.write(escaped, sizeof(escaped));
+                    break;
+                }
+            }
+        }
+
+        os.write(data + run, str.size() - run);
+        os.put('"');
+    }
+
+    /**
+     *  \brief Output collected in a buffer and written to stream in large blocks
+     *
+     *  Serializers write many short tokens, each of them through std::ostream
+     *  is a virtual call with sentry. The buffer is owned by the caller so it
+     *  can be reused between serializations. Nothing is written to \param os
+     *  until flush().
+     */
+    class OutputBuffer {
+    public:
+        OutputBuffer(std::vector<char>& buffer, std::ostream& os)
+        : buffer_(buffer), os_(os), used_(0) {}
+
+        void write(const char* data, size_t length)
+        {
+            if (length > buffer_.size() - used_) {
+                flush();
+
+                if (length > buffer_.size()) {
+                    os_.write(data, length);
+                    return;
+                }
+            }
+
+            memcpy(&buffer_[used_], data, length);
+            used_ += length;
+        }
+
+        void put(char c)
+        {
+            if (used_ == buffer_.size()) {
+                flush();
+            }
+
+            buffer_[used_++] = c;
+        }
+
+        void flush()
+        {
+            os_.write(&buffer_[0], used_);
+            used_ = 0;
+        }
+
+    private:
+        std::vector<char>& buffer_;
+        std::ostream& os_;
+        size_t used_;
+    };
+}
+
+#endif // #ifndef DRAFTER_FORMAT_H
@@ -0,0 +1,72 @@
+//
+//  Hash.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_HASH_H
+#define DRAFTER_HASH_H
+
+#include <string>
+#include <stdint.h>
+
+namespace drafter {
+
+    /** Stable 64-bit content hash */
+    typedef uint64_t Hash;
+
+    /**
+     *  \brief Incremental FNV-1a hasher
+     *
+     *  Values are fed field by field. Strings are prefixed by their length so
+     *  ("ab", "c") and ("a", "bc") never produce the same hash. The result does
+     *  not depend on platform, process or pointer values - it is safe to persist
+     *  and to compare between runs.
+     *
+     *  usage:
+     *
+     *  Hash hash = Hasher()(resource.name)(resource.uriTemplate).value;
+     */
+    struct Hasher {
+
+        static const Hash OffsetBasis = 14695981039346656037ULL;
+        static const Hash Prime = 1099511628211ULL;
+
+        Hash value;
+
+        Hasher() : value(OffsetBasis) {}
+
+        Hasher& bytes(const char* data, size_t length) {
+            for (size_t i = 0; i < length; ++i) {
+                value ^= static_cast<unsigned char>(data[i]);
+                value *= Prime;
+            }
+
+            return *this;
+        }
+
+        Hasher& operator()(uint64_t number) {
+            for (size_t i = 0; i < sizeof(number); ++i) {
+                value ^= static_cast<unsigned char>(number >> (i * 8));
+                value *= Prime;
+            }
+
+            return *this;
+        }
+
+        Hasher& operator()(const std::string& str) {
+            (*this)(static_cast<uint64_t>(str.length()));
+            return bytes(str.data(), str.length());
+        }
+    };
+
+    /**
+     *  \brief Hash of the whole byte buffer
+     */
+    inline Hash HashBytes(const std::string& source) {
+        return Hasher().bytes(source.data(), source.length()).value;
+    }
+}
+
+#endif // #ifndef DRAFTER_HASH_H
@@ -0,0 +1,399 @@
+//
+//  HashAST.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "HashAST.h"
+
+#include <map>
+#include <sstream>
+
+using namespace drafter;
+
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::KeyValuePair;
+using snowcrash::Header;
+using snowcrash::Headers;
+using snowcrash::DataStructure;
+using snowcrash::Payload;
+using snowcrash::Parameter;
+using snowcrash::Parameters;
+using snowcrash::TransactionExample;
+using snowcrash::TransactionExamples;
+using snowcrash::Request;
+using snowcrash::Response;
+using snowcrash::Action;
+using snowcrash::Actions;
+using snowcrash::Resource;
+using snowcrash::Blueprint;
+
+// Forward declarations
+static void HashTypeSection(const mson::TypeSection& section, Hasher& hasher);
+static void HashMSONElement(const mson::Element& element, Hasher& hasher);
+
+static void HashTypeName(const mson::TypeName& typeName, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(typeName.base));
+    hasher(typeName.symbol.literal)(static_cast<uint64_t>(typeName.symbol.variable));
+}
+
+static void HashTypeDefinition(const mson::TypeDefinition& typeDefinition, Hasher& hasher)
+{
+    const mson::TypeSpecification& typeSpecification = typeDefinition.typeSpecification;
+
+    HashTypeName(typeSpecification.name, hasher);
+
+    hasher(static_cast<uint64_t>(typeSpecification.nestedTypes.size()));
+
+    for (mson::TypeNames::const_iterator it = typeSpecification.nestedTypes.begin();
+         it != typeSpecification.nestedTypes.end();
+         ++it) {
+
+        HashTypeName(*it, hasher);
+    }
+
+    hasher(static_cast<uint64_t>(typeDefinition.attributes));
+}
+
+static void HashValueDefinition(const mson::ValueDefinition& valueDefinition, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(valueDefinition.values.size()));
+
+    for (mson::Values::const_iterator it = valueDefinition.values.begin();
+         it != valueDefinition.values.end();
+         ++it) {
+
+        hasher(it->literal)(static_cast<uint64_t>(it->variable));
+    }
+
+    HashTypeDefinition(valueDefinition.typeDefinition, hasher);
+}
+
+static void HashTypeSections(const mson::TypeSections& sections, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(sections.size()));
+
+    for (mson::TypeSections::const_iterator it = sections.begin(); it != sections.end(); ++it) {
+        HashTypeSection(*it, hasher);
+    }
+}
+
+static void HashMSONElements(const mson::Elements& elements, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(elements.size()));
+
+    for (mson::Elements::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+        HashMSONElement(*it, hasher);
+    }
+}
+
+static void HashValueMember(const mson::ValueMember& valueMember, Hasher& hasher)
+{
+    hasher(valueMember.description);
+    HashValueDefinition(valueMember.valueDefinition, hasher);
+    HashTypeSections(valueMember.sections, hasher);
+}
+
+static void HashMSONElement(const mson::Element& element, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(element.klass));
+
+    switch (element.klass) {
+
+        case mson::Element::PropertyClass:
+        {
+            const mson::PropertyName& name = element.content.property.name;
+
+            hasher(name.literal);
+            HashValueDefinition(name.variable, hasher);
+            HashValueMember(element.content.property, hasher);
+            break;
+        }
+
+        case mson::Element::ValueClass:
+            HashValueMember(element.content.value, hasher);
+            break;
+
+        case mson::Element::MixinClass:
+            HashTypeDefinition(element.content.mixin, hasher);
+            break;
+
+        case mson::Element::OneOfClass:
+            HashMSONElements(element.content.oneOf(), hasher);
+            break;
+
+        case mson::Element::GroupClass:
+            HashMSONElements(element.content.elements(), hasher);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void HashTypeSection(const mson::TypeSection& section, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(section.klass));
+    hasher(section.content.description)(section.content.value);
+    HashMSONElements(section.content.elements(), hasher);
+}
+
+static void HashKeyValues(const std::vector<KeyValuePair>& keyValues, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(keyValues.size()));
+
+    for (std::vector<KeyValuePair>::const_iterator it = keyValues.begin(); it != keyValues.end(); ++it) {
+        hasher(it->first)(it->second);
+    }
+}
+
+static void HashParameters(const Parameters& parameters, Hasher& hasher)
+{
+    hasher(static_cast<uint64_t>(parameters.size()));
+
+    for (Parameters::const_iterator it = parameters.begin(); it != parameters.end(); ++it) {
+        hasher(it->name)(it->description)(it->type)(static_cast<uint64_t>(it->use));
+        hasher(it->defaultValue)(it->exampleValue);
+
+        hasher(static_cast<uint64_t>(it->values.size()));
+
+        for (snowcrash::Values::const_iterator value = it->values.begin(); value != it->values.end(); ++value) {
+            hasher(*value);
+        }
+    }
+}
+
+/**
+ *  \brief Compute `hash` of node from its `content` and its children
+ *
+ *  Keys of children are made unique as side effect - second sibling with
+ *  the same key gets suffix " #2" etc., the key without suffix is kept as
+ *  `baseKey`.
+ */
+static void SealNode(HashNode& node)
+{
+    std::map<std::string, size_t> seen;
+    Hasher hasher;
+
+    hasher(node.content);
+
+    for (std::vector<HashNode>::iterator it = node.children.begin(); it != node.children.end(); ++it) {
+
+        it->baseKey = it->key;
+
+        size_t count = ++seen[it->key];
+
+        if (count > 1) {
+            std::stringstream key;
+            key << it->key << " #" << count;
+            it->key = key.str();
+        }
+
+        hasher(it->element)(it->key)(it->hash);
+    }
+
+    node.hash = hasher.value;
+}
+
+static HashNode HashDataStructure(const DataStructure& dataStructure, const std::string& key)
+{
+    HashNode node;
+    Hasher hasher;
+
+    HashTypeName(dataStructure.name, hasher);
+    HashTypeDefinition(dataStructure.typeDefinition, hasher);
+    HashTypeSections(dataStructure.sections, hasher);
+
+    node.element = "dataStructure";
+    node.key = key;
+    node.content = hasher.value;
+
+    SealNode(node);
+
+    return node;
+}
+
+static HashNode HashPayload(const Payload& payload, const std::string& element)
+{
+    HashNode node;
+    Hasher hasher;
+
+    hasher(payload.reference.id);
+    hasher(payload.name)(payload.description);
+    HashKeyValues(payload.headers, hasher);
+    hasher(payload.body)(payload.schema);
+
+    node.element = element;
+    node.key = payload.name.empty() ? element : element + " " + payload.name;
+    node.content = hasher.value;
+
+    if (!payload.attributes.empty()) {
+        node.children.push_back(HashDataStructure(payload.attributes, "attributes"));
+    }
+
+    SealNode(node);
+
+    return node;
+}
+
+static HashNode HashAction(const Action& action)
+{
+    HashNode node;
+    Hasher hasher;
+
+    hasher(action.name)(action.description)(action.method);
+    HashParameters(action.parameters, hasher);
+    hasher(action.relation.str)(action.uriTemplate);
+
+    node.element = "action";
+    node.key = action.uriTemplate.empty() ? action.method : action.method + " " + action.uriTemplate;
+
+    if (!action.attributes.empty()) {
+        node.children.push_back(HashDataStructure(action.attributes, "attributes"));
+    }
+
+    hasher(static_cast<uint64_t>(action.examples.size()));
+
+    for (TransactionExamples::const_iterator example = action.examples.begin();
+         example != action.examples.end();
+         ++example) {
+
+        hasher(example->name)(example->description);
+        hasher(static_cast<uint64_t>(example->requests.size()))(static_cast<uint64_t>(example->responses.size()));
+
+        for (snowcrash::Requests::const_iterator it = example->requests.begin(); it != example->requests.end(); ++it) {
+            node.children.push_back(HashPayload(*it, "request"));
+        }
+
+        for (snowcrash::Responses::const_iterator it = example->responses.begin(); it != example->responses.end(); ++it) {
+            node.children.push_back(HashPayload(*it, "response"));
+        }
+    }
+
+    node.content = hasher.value;
+
+    SealNode(node);
+
+    return node;
+}
+
+static HashNode HashResource(const Resource& resource)
+{
+    HashNode node;
+    Hasher hasher;
+
+    hasher(resource.name)(resource.description)(resource.uriTemplate);
+    HashParameters(resource.parameters, hasher);
+    HashKeyValues(resource.headers, hasher);
+
+    node.element = "resource";
+    node.key = resource.uriTemplate;
+    node.content = hasher.value;
+
+    if (!resource.model.name.empty()) {
+        node.children.push_back(HashPayload(resource.model, "model"));
+    }
+
+    if (!resource.attributes.empty()) {
+        node.children.push_back(HashDataStructure(resource.attributes, "attributes"));
+    }
+
+    for (Actions::const_iterator it = resource.actions.begin(); it != resource.actions.end(); ++it) {
+        node.children.push_back(HashAction(*it));
+    }
+
+    SealNode(node);
+
+    return node;
+}
+
+static HashNode HashResourceGroup(const Element& resourceGroup)
+{
+    HashNode node;
+    Hasher hasher;
+
+    hasher(resourceGroup.attributes.name);
+
+    node.element = "resourceGroup";
+    node.key = resourceGroup.attributes.name;
+
+    for (Elements::const_iterator it = resourceGroup.content.elements().begin();
+         it != resourceGroup.content.elements().end();
+         ++it) {
+
+        if (it->element == Element::ResourceElement) {
+            node.children.push_back(HashResource(it->content.resource));
+        }
+        else if (it->element == Element::CopyElement) {
+            hasher(it->content.copy);
+        }
+    }
+
+    node.content = hasher.value;
+
+    SealNode(node);
+
+    return node;
+}
+
+static HashNode HashDataStructureGroup(const Element& dataStructureGroup)
+{
+    HashNode node;
+
+    node.element = "dataStructureGroup";
+    node.key = dataStructureGroup.attributes.name;
+    node.content = Hasher()(dataStructureGroup.attributes.name).value;
+
+    for (Elements::const_iterator it = dataStructureGroup.content.elements().begin();
+         it != dataStructureGroup.content.elements().end();
+         ++it) {
+
+        if (it->element == Element::DataStructureElement) {
+            const DataStructure& dataStructure = it->content.dataStructure;
+            node.children.push_back(HashDataStructure(dataStructure, dataStructure.name.symbol.literal));
+        }
+    }
+
+    SealNode(node);
+
+    return node;
+}
+
+HashNode drafter::HashBlueprint(const Blueprint& blueprint)
+{
+    HashNode node;
+    Hasher hasher;
+
+    HashKeyValues(blueprint.metadata, hasher);
+    hasher(blueprint.name)(blueprint.description);
+
+    node.element = "blueprint";
+    node.key = blueprint.name;
+
+    for (Elements::const_iterator it = blueprint.content.elements().begin();
+         it != blueprint.content.elements().end();
+         ++it) {
+
+        if (it->element == Element::CategoryElement) {
+
+            if (it->category == Element::ResourceGroupCategory) {
+                node.children.push_back(HashResourceGroup(*it));
+            }
+            else if (it->category == Element::DataStructureGroupCategory) {
+                node.children.push_back(HashDataStructureGroup(*it));
+            }
+        }
+        else if (it->element == Element::CopyElement) {
+            hasher(it->content.copy);
+        }
+    }
+
+    node.content = hasher.value;
+
+    SealNode(node);
+
+    return node;
+}
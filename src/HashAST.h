@@ -0,0 +1,45 @@
+//
+//  HashAST.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_HASH_AST_H
+#define DRAFTER_HASH_AST_H
+
+#include <vector>
+
+#include "Blueprint.h"
+#include "Hash.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Node of Merkle tree computed over blueprint AST
+     *
+     *  There is one node per resource group, resource, action, payload
+     *  (model, request, response) and MSON data structure.
+     *
+     *  `content` covers only node own fields (name, description, headers ...),
+     *  `hash` covers `content` and hashes of all its children. Two subtrees
+     *  with the same `hash` serialize into the same AST.
+     */
+    struct HashNode {
+        std::string element;            ///< kind of node e.g. "resource", "action"
+        std::string key;                ///< identity of node between siblings e.g. URI template, HTTP method
+        std::string baseKey;            ///< key before duplicates were numbered, the same for all of them
+        Hash content;                   ///< hash of own fields
+        Hash hash;                      ///< hash of own fields and children
+        std::vector<HashNode> children;
+
+        HashNode() : content(0), hash(0) {}
+    };
+
+    /**
+     *  \brief Compute Merkle tree of content hashes for blueprint
+     */
+    HashNode HashBlueprint(const snowcrash::Blueprint& blueprint);
+}
+
+#endif // #ifndef DRAFTER_HASH_AST_H
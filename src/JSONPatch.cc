@@ -0,0 +1,296 @@
+//
+//  JSONPatch.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "JSONPatch.h"
+
+#include <map>
+#include <sstream>
+#include <string.h>
+
+#include "Serialize.h"
+
+using namespace drafter;
+
+namespace {
+
+    const std::string AddOperation = "add";
+    const std::string RemoveOperation = "remove";
+    const std::string ReplaceOperation = "replace";
+
+    void PushOperation(const std::string& op, const std::string& path, const sos::Base* value, sos::Array& patch)
+    {
+        sos::Object operation;
+
+        operation.set(SerializeKey::Op, sos::String(op));
+        operation.set(SerializeKey::Path, sos::String(path));
+
+        if (value) {
+            operation.set(SerializeKey::Value, *value);
+        }
+
+        patch.push(operation);
+    }
+
+    /** Append JSON Pointer reference token, `~` and `/` are escaped */
+    void AppendToken(const std::string& token, std::string& path)
+    {
+        path += '/';
+
+        for (std::string::const_iterator it = token.begin(); it != token.end(); ++it) {
+            if (*it == '~') {
+                path += "~0";
+            }
+            else if (*it == '/') {
+                path += "~1";
+            }
+            else {
+                path += *it;
+            }
+        }
+    }
+
+    void AppendIndex(size_t index, std::string& path)
+    {
+        std::stringstream ss;
+        ss << index;
+
+        AppendToken(ss.str(), path);
+    }
+
+    void DiffNode(const sos::Base& before, const ValueHash& beforeHash,
+                  const sos::Base& after, const ValueHash& afterHash,
+                  std::string& path, sos::Array& patch);
+
+    void DiffObject(const sos::Base& before, const ValueHash& beforeHash,
+                    const sos::Base& after, const ValueHash& afterHash,
+                    std::string& path, sos::Array& patch)
+    {
+        typedef std::map<std::string, size_t> KeyIndexes;
+        KeyIndexes previous;
+
+        for (size_t i = 0; i < before.keys.size(); ++i) {
+            previous[before.keys[i]] = i;
+        }
+
+        size_t length = path.length();
+
+        for (size_t i = 0; i < after.keys.size(); ++i) {
+
+            const std::string& key = after.keys[i];
+            sos::KeyValues::const_iterator value = after.object.find(key);
+
+            if (value == after.object.end()) {
+                continue;
+            }
+
+            AppendToken(key, path);
+
+            KeyIndexes::iterator match = previous.find(key);
+
+            if (match == previous.end()) {
+                PushOperation(AddOperation, path, &value->second, patch);
+            }
+            else {
+                DiffNode(before.object.find(key)->second, beforeHash.children[match->second],
+                         value->second, afterHash.children[i],
+                         path, patch);
+
+                previous.erase(match);
+            }
+
+            path.resize(length);
+        }
+
+        // Whatever was not matched is gone
+        for (size_t i = 0; i < before.keys.size(); ++i) {
+
+            if (previous.find(before.keys[i]) == previous.end()) {
+                continue;
+            }
+
+            AppendToken(before.keys[i], path);
+            PushOperation(RemoveOperation, path, NULL, patch);
+            path.resize(length);
+        }
+    }
+
+    void DiffArray(const sos::Base& before, const ValueHash& beforeHash,
+                   const sos::Base& after, const ValueHash& afterHash,
+                   std::string& path, sos::Array& patch)
+    {
+        size_t beforeSize = before.array.size();
+        size_t afterSize = after.array.size();
+
+        // Common prefix and suffix need no operations
+        size_t prefix = 0;
+
+        while (prefix < beforeSize && prefix < afterSize &&
+               beforeHash.children[prefix].hash == afterHash.children[prefix].hash &&
+               IsEqual(before.array[prefix], after.array[prefix])) {
+            ++prefix;
+        }
+
+        size_t suffix = 0;
+
+        while (suffix < beforeSize - prefix && suffix < afterSize - prefix &&
+               beforeHash.children[beforeSize - suffix - 1].hash == afterHash.children[afterSize - suffix - 1].hash &&
+               IsEqual(before.array[beforeSize - suffix - 1], after.array[afterSize - suffix - 1])) {
+            ++suffix;
+        }
+
+        size_t beforeMiddle = beforeSize - prefix - suffix;
+        size_t afterMiddle = afterSize - prefix - suffix;
+        size_t length = path.length();
+
+        // Operations are applied in order - indexes are those of partially patched array
+        for (size_t i = 0; i < beforeMiddle && i < afterMiddle; ++i) {
+            AppendIndex(prefix + i, path);
+            DiffNode(before.array[prefix + i], beforeHash.children[prefix + i],
+                     after.array[prefix + i], afterHash.children[prefix + i],
+                     path, patch);
+            path.resize(length);
+        }
+
+        for (size_t i = beforeMiddle; i < afterMiddle; ++i) {
+            AppendIndex(prefix + i, path);
+            PushOperation(AddOperation, path, &after.array[prefix + i], patch);
+            path.resize(length);
+        }
+
+        for (size_t i = afterMiddle; i < beforeMiddle; ++i) {
+            AppendIndex(prefix + afterMiddle, path);
+            PushOperation(RemoveOperation, path, NULL, patch);
+            path.resize(length);
+        }
+    }
+
+    void DiffNode(const sos::Base& before, const ValueHash& beforeHash,
+                  const sos::Base& after, const ValueHash& afterHash,
+                  std::string& path, sos::Array& patch)
+    {
+        // equal hashes are confirmed, a collision must not hide a change
+        if (beforeHash.hash == afterHash.hash && IsEqual(before, after)) {
+            return;
+        }
+
+        if (before.type != after.type) {
+            PushOperation(ReplaceOperation, path, &after, patch);
+            return;
+        }
+
+        switch (after.type) {
+            case sos::Base::ObjectType:
+                DiffObject(before, beforeHash, after, afterHash, path, patch);
+                break;
+
+            case sos::Base::ArrayType:
+                DiffArray(before, beforeHash, after, afterHash, path, patch);
+                break;
+
+            default:
+                PushOperation(ReplaceOperation, path, &after, patch);
+                break;
+        }
+    }
+}
+
+void drafter::HashValue(const sos::Base& value, ValueHash& out)
+{
+    Hasher hasher;
+    hasher(static_cast<uint64_t>(value.type));
+
+    out.children.clear();
+
+    switch (value.type) {
+        case sos::Base::StringType:
+            hasher(value.str);
+            break;
+
+        case sos::Base::NumberType:
+        {
+            uint64_t bits;
+            memcpy(&bits, &value.number, sizeof(bits));
+            hasher(bits);
+            break;
+        }
+
+        case sos::Base::BooleanType:
+            hasher(static_cast<uint64_t>(value.boolean));
+            break;
+
+        case sos::Base::ArrayType:
+            out.children.resize(value.array.size());
+            hasher(static_cast<uint64_t>(value.array.size()));
+
+            for (size_t i = 0; i < value.array.size(); ++i) {
+                HashValue(value.array[i], out.children[i]);
+                hasher(out.children[i].hash);
+            }
+            break;
+
+        case sos::Base::ObjectType:
+            out.children.resize(value.keys.size());
+            hasher(static_cast<uint64_t>(value.keys.size()));
+
+            for (size_t i = 0; i < value.keys.size(); ++i) {
+                sos::KeyValues::const_iterator it = value.object.find(value.keys[i]);
+
+                if (it != value.object.end()) {
+                    HashValue(it->second, out.children[i]);
+                }
+
+                hasher(value.keys[i])(out.children[i].hash);
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    out.hash = hasher.value;
+}
+
+void drafter::DiffValue(const sos::Base& before, const ValueHash& beforeHash,
+                        const sos::Base& after, const ValueHash& afterHash,
+                        sos::Array& patch)
+{
+    std::string path;
+    DiffNode(before, beforeHash, after, afterHash, path, patch);
+}
+
+PatchSession::PatchSession() : hasPrevious_(false)
+{
+}
+
+sos::Array PatchSession::update(const sos::Base& result)
+{
+    sos::Array patch;
+
+    ValueHash hash;
+    HashValue(result, hash);
+
+    if (hasPrevious_) {
+        DiffValue(previous_, previousHash_, result, hash, patch);
+    }
+    else {
+        PushOperation(ReplaceOperation, std::string(), &result, patch);
+    }
+
+    previous_ = result;
+    previousHash_.children.swap(hash.children);
+    previousHash_.hash = hash.hash;
+    hasPrevious_ = true;
+
+    return patch;
+}
+
+void PatchSession::reset()
+{
+    hasPrevious_ = false;
+    previous_ = sos::Base();
+    previousHash_ = ValueHash();
+}
@@ -0,0 +1,88 @@
+//
+//  JSONPatch.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_JSON_PATCH_H
+#define DRAFTER_JSON_PATCH_H
+
+#include <vector>
+
+#include "sos.h"
+#include "Hash.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Content hashes of sos value and all its subtrees
+     *
+     *  `children` follow array items or object keys in `keys` order.
+     */
+    struct ValueHash {
+        Hash hash;
+        std::vector<ValueHash> children;
+
+        ValueHash() : hash(0) {}
+    };
+
+    /**
+     *  \brief Compute hash tree of \param value
+     */
+    void HashValue(const sos::Base& value, ValueHash& out);
+
+    /**
+     *  \brief RFC 6902 JSON Patch turning \param before into \param after
+     *
+     *  Subtrees with the same hash are skipped once IsEqual() confirms
+     *  them, so patch size follows the size of the change and a hash
+     *  collision can not drop an operation. Items
+     *  inserted to or removed from the middle of array are found as common
+     *  prefix and suffix, other array changes are patched item by item.
+     *
+     *  \param before       Original value and its hash tree
+     *  \param after        New value and its hash tree
+     *  \param patch        Output - `add`, `remove` and `replace` operations
+     */
+    void DiffValue(const sos::Base& before, const ValueHash& beforeHash,
+                   const sos::Base& after, const ValueHash& afterHash,
+                   sos::Array& patch);
+
+    /**
+     *  \brief Emits JSON Patch between consecutive results of one document
+     *
+     *  Keeps the previous result with its hash tree. The first update (and
+     *  the first one after reset()) replaces the whole document. Not safe
+     *  to share between threads.
+     *
+     *  usage:
+     *
+     *  drafter::PatchSession session;
+     *  ...
+     *  serializer.process(session.update(drafter::WrapResult(blueprint, options)), stream);
+     */
+    class PatchSession {
+    public:
+
+        PatchSession();
+
+        /**
+         *  \brief JSON Patch from the previous result to \param result
+         *
+         *  \param result is remembered for the next update.
+         */
+        sos::Array update(const sos::Base& result);
+
+        /** Forget previous result */
+        void reset();
+
+    private:
+
+        bool hasPrevious_;
+        sos::Base previous_;
+        ValueHash previousHash_;
+    };
+}
+
+#endif // #ifndef DRAFTER_JSON_PATCH_H
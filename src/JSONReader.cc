@@ -0,0 +1,441 @@
+//
+//  JSONReader.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "JSONReader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+using namespace drafter;
+
+namespace {
+
+    const size_t MaxDepth = 512;
+
+    class JSONParser {
+    public:
+
+        JSONParser(const std::string& source) : source_(source), position_(0), depth_(0) {}
+
+        bool parse(sos::Base& out)
+        {
+            skipWhitespace();
+
+            if (!parseValue(out)) {
+                return false;
+            }
+
+            skipWhitespace();
+
+            if (position_ != source_.size()) {
+                return fail("unexpected data after JSON value");
+            }
+
+            return true;
+        }
+
+        const std::string& error() const
+        {
+            return error_;
+        }
+
+    private:
+
+        const std::string& source_;
+        size_t position_;
+        size_t depth_;
+        std::string error_;
+
+        bool fail(const std::string& message)
+        {
+            std::stringstream ss;
+            ss << message << " at offset " << position_;
+            error_ = ss.str();
+
+            return false;
+        }
+
+        bool atEnd() const
+        {
+            return position_ >= source_.size();
+        }
+
+        char peek() const
+        {
+            return atEnd() ? '\0' : source_[position_];
+        }
+
+        void skipWhitespace()
+        {
+            while (!atEnd()) {
+                char c = source_[position_];
+
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+                    return;
+                }
+
+                ++position_;
+            }
+        }
+
+        bool consumeLiteral(const char* literal)
+        {
+            size_t length = strlen(literal);
+
+            if (source_.compare(position_, length, literal) != 0) {
+                return fail("invalid literal");
+            }
+
+            position_ += length;
+            return true;
+        }
+
+        bool parseValue(sos::Base& out)
+        {
+            switch (peek()) {
+                case '{':
+                    return parseObject(out);
+
+                case '[':
+                    return parseArray(out);
+
+                case '"':
+                    out = sos::String();
+                    return parseString(out.str);
+
+                case 't':
+                    out = sos::Boolean(true);
+                    return consumeLiteral("true");
+
+                case 'f':
+                    out = sos::Boolean(false);
+                    return consumeLiteral("false");
+
+                case 'n':
+                    out = sos::Null();
+                    return consumeLiteral("null");
+
+                default:
+                    return parseNumber(out);
+            }
+        }
+
+        bool enter()
+        {
+            if (++depth_ > MaxDepth) {
+                return fail("nesting too deep");
+            }
+
+            ++position_;
+            skipWhitespace();
+
+            return true;
+        }
+
+        bool parseObject(sos::Base& out)
+        {
+            if (!enter()) {
+                return false;
+            }
+
+            sos::Object object;
+
+            if (peek() == '}') {
+                ++position_;
+                --depth_;
+                out = object;
+                return true;
+            }
+
+            for (;;) {
+                std::string key;
+
+                if (peek() != '"') {
+                    return fail("expected object key");
+                }
+
+                if (!parseString(key)) {
+                    return false;
+                }
+
+                skipWhitespace();
+
+                if (peek() != ':') {
+                    return fail("expected ':'");
+                }
+
+                ++position_;
+                skipWhitespace();
+
+                sos::Base value;
+
+                if (!parseValue(value)) {
+                    return false;
+                }
+
+                object.set(key, value);
+                skipWhitespace();
+
+                if (peek() == ',') {
+                    ++position_;
+                    skipWhitespace();
+                    continue;
+                }
+
+                if (peek() == '}') {
+                    ++position_;
+                    break;
+                }
+
+                return fail("expected ',' or '}'");
+            }
+
+            --depth_;
+            out = object;
+
+            return true;
+        }
+
+        bool parseArray(sos::Base& out)
+        {
+            if (!enter()) {
+                return false;
+            }
+
+            sos::Array array;
+
+            if (peek() == ']') {
+                ++position_;
+                --depth_;
+                out = array;
+                return true;
+            }
+
+            for (;;) {
+                sos::Base value;
+
+                if (!parseValue(value)) {
+                    return false;
+                }
+
+                array.push(value);
+                skipWhitespace();
+
+                if (peek() == ',') {
+                    ++position_;
+                    skipWhitespace();
+                    continue;
+                }
+
+                if (peek() == ']') {
+                    ++position_;
+                    break;
+                }
+
+                return fail("expected ',' or ']'");
+            }
+
+            --depth_;
+            out = array;
+
+            return true;
+        }
+
+        bool skipDigits()
+        {
+            size_t start = position_;
+
+            while (!atEnd() && source_[position_] >= '0' && source_[position_] <= '9') {
+                ++position_;
+            }
+
+            return position_ > start;
+        }
+
+        bool parseNumber(sos::Base& out)
+        {
+            size_t start = position_;
+
+            if (peek() == '-') {
+                ++position_;
+            }
+
+            if (peek() == '0') {
+                ++position_;
+            }
+            else if (!skipDigits()) {
+                return fail("invalid value");
+            }
+
+            if (peek() == '.') {
+                ++position_;
+
+                if (!skipDigits()) {
+                    return fail("invalid number");
+                }
+            }
+
+            if (peek() == 'e' || peek() == 'E') {
+                ++position_;
+
+                if (peek() == '+' || peek() == '-') {
+                    ++position_;
+                }
+
+                if (!skipDigits()) {
+                    return fail("invalid number");
+                }
+            }
+
+            out = sos::Number(strtod(source_.substr(start, position_ - start).c_str(), NULL));
+
+            return true;
+        }
+
+        bool parseHex4(unsigned int& out)
+        {
+            if (position_ + 4 > source_.size()) {
+                return fail("invalid unicode escape");
+            }
+
+            out = 0;
+
+            for (size_t i = 0; i < 4; ++i) {
+                char c = source_[position_++];
+                out <<= 4;
+
+                if (c >= '0' && c <= '9') {
+                    out |= c - '0';
+                }
+                else if (c >= 'a' && c <= 'f') {
+                    out |= c - 'a' + 10;
+                }
+                else if (c >= 'A' && c <= 'F') {
+                    out |= c - 'A' + 10;
+                }
+                else {
+                    return fail("invalid unicode escape");
+                }
+            }
+
+            return true;
+        }
+
+        static void AppendUTF8(unsigned int codePoint, std::string& out)
+        {
+            if (codePoint < 0x80) {
+                out += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800) {
+                out += static_cast<char>(0xC0 | (codePoint >> 6));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000) {
+                out += static_cast<char>(0xE0 | (codePoint >> 12));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else {
+                out += static_cast<char>(0xF0 | (codePoint >> 18));
+                out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        bool parseEscape(std::string& out)
+        {
+            char c = peek();
+            ++position_;
+
+            switch (c) {
+                case '"':  out += '"';  return true;
+                case '\\': out += '\\'; return true;
+                case '/':  out += '/';  return true;
+                case 'b':  out += '\b'; return true;
+                case 'f':  out += '\f'; return true;
+                case 'n':  out += '\n'; return true;
+                case 'r':  out += '\r'; return true;
+                case 't':  out += '\t'; return true;
+                case 'u':  break;
+                default:   return fail("invalid escape");
+            }
+
+            unsigned int codePoint;
+
+            if (!parseHex4(codePoint)) {
+                return false;
+            }
+
+            // surrogate pair
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF &&
+                source_.compare(position_, 2, "\\u") == 0) {
+
+                size_t mark = position_;
+                unsigned int low;
+
+                position_ += 2;
+
+                if (parseHex4(low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else {
+                    position_ = mark;
+                }
+            }
+
+            AppendUTF8(codePoint, out);
+
+            return true;
+        }
+
+        bool parseString(std::string& out)
+        {
+            ++position_;    // opening quote
+
+            for (;;) {
+                size_t start = position_;
+
+                while (!atEnd() && source_[position_] != '"' && source_[position_] != '\\') {
+
+                    if (static_cast<unsigned char>(source_[position_]) < 0x20) {
+                        return fail("control character in string");
+                    }
+
+                    ++position_;
+                }
+
+                out.append(source_, start, position_ - start);
+
+                if (atEnd()) {
+                    return fail("unterminated string");
+                }
+
+                if (source_[position_++] == '"') {
+                    return true;
+                }
+
+                if (!parseEscape(out)) {
+                    return false;
+                }
+            }
+        }
+    };
+}
+
+bool drafter::ReadJSON(const std::string& source, sos::Base& out, std::string& error)
+{
+    JSONParser parser(source);
+
+    if (!parser.parse(out)) {
+        error = parser.error();
+        return false;
+    }
+
+    return true;
+}
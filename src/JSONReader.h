@@ -0,0 +1,31 @@
+//
+//  JSONReader.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_JSON_READER_H
+#define DRAFTER_JSON_READER_H
+
+#include <string>
+
+#include "sos.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Parse JSON text into serialization tree
+     *
+     *  Strict RFC 7159 parser - no comments, no trailing commas. Nesting is
+     *  limited to 512 levels. Duplicate object keys keep the last value.
+     *
+     *  \param source   JSON text
+     *  \param out      Output - parsed value
+     *  \param error    Output - description of the first syntax error
+     *  \return True if \param source is valid JSON
+     */
+    bool ReadJSON(const std::string& source, sos::Base& out, std::string& error);
+}
+
+#endif // #ifndef DRAFTER_JSON_READER_H
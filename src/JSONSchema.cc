@@ -0,0 +1,753 @@
+//
+//  JSONSchema.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "JSONSchema.h"
+
+#include <cmath>
+#include <sstream>
+
+using namespace drafter;
+
+namespace {
+
+    enum TypeFlag {
+        NullFlag    = 1 << 0,
+        BooleanFlag = 1 << 1,
+        IntegerFlag = 1 << 2,
+        NumberFlag  = 1 << 3,
+        StringFlag  = 1 << 4,
+        ArrayFlag   = 1 << 5,
+        ObjectFlag  = 1 << 6
+    };
+
+    /** Limit of `$ref` and combinator nesting without descending into instance */
+    const size_t MaxValidationDepth = 1024;
+
+    /**
+     *  Longest string matched against `pattern` and `patternProperties`.
+     *  std::regex of libstdc++ matches ECMAScript by recursion per character
+     *  of the subject - hundreds of bytes of stack per character, so longer
+     *  strings could overflow the stack of a worker thread.
+     */
+    const size_t MaxPatternSubject = 512;
+
+    unsigned int TypeFlagByName(const std::string& name)
+    {
+        if (name == "null")     return NullFlag;
+        if (name == "boolean")  return BooleanFlag;
+        if (name == "integer")  return IntegerFlag;
+        if (name == "number")   return NumberFlag;
+        if (name == "string")   return StringFlag;
+        if (name == "array")    return ArrayFlag;
+        if (name == "object")   return ObjectFlag;
+
+        return 0;
+    }
+
+    const char* TypeName(const sos::Base& value)
+    {
+        switch (value.type) {
+            case sos::Base::NullType:    return "null";
+            case sos::Base::BooleanType: return "boolean";
+            case sos::Base::NumberType:  return "number";
+            case sos::Base::StringType:  return "string";
+            case sos::Base::ArrayType:   return "array";
+            case sos::Base::ObjectType:  return "object";
+            default:                     return "undefined";
+        }
+    }
+
+    bool IsInteger(double number)
+    {
+        return std::floor(number) == number;
+    }
+
+    bool MatchesType(unsigned int types, const sos::Base& value)
+    {
+        if (types == 0) {
+            return true;
+        }
+
+        switch (value.type) {
+            case sos::Base::NullType:    return types & NullFlag;
+            case sos::Base::BooleanType: return types & BooleanFlag;
+            case sos::Base::StringType:  return types & StringFlag;
+            case sos::Base::ArrayType:   return types & ArrayFlag;
+            case sos::Base::ObjectType:  return types & ObjectFlag;
+
+            case sos::Base::NumberType:
+                return (types & NumberFlag) || ((types & IntegerFlag) && IsInteger(value.number));
+
+            default:
+                return false;
+        }
+    }
+
+    bool Equals(const sos::Base& a, const sos::Base& b)
+    {
+        if (a.type != b.type) {
+            return false;
+        }
+
+        switch (a.type) {
+            case sos::Base::BooleanType: return a.boolean == b.boolean;
+            case sos::Base::NumberType:  return a.number == b.number;
+            case sos::Base::StringType:  return a.str == b.str;
+
+            case sos::Base::ArrayType:
+                if (a.array.size() != b.array.size()) {
+                    return false;
+                }
+
+                for (size_t i = 0; i < a.array.size(); ++i) {
+                    if (!Equals(a.array[i], b.array[i])) {
+                        return false;
+                    }
+                }
+
+                return true;
+
+            case sos::Base::ObjectType:
+                if (a.object.size() != b.object.size()) {
+                    return false;
+                }
+
+                for (sos::KeyValues::const_iterator it = a.object.begin(); it != a.object.end(); ++it) {
+
+                    sos::KeyValues::const_iterator other = b.object.find(it->first);
+
+                    if (other == b.object.end() || !Equals(it->second, other->second)) {
+                        return false;
+                    }
+                }
+
+                return true;
+
+            default:
+                return true;
+        }
+    }
+
+    /** Number of code points in UTF-8 string */
+    size_t UTF8Length(const std::string& str)
+    {
+        size_t length = 0;
+
+        for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+            if ((static_cast<unsigned char>(*it) & 0xC0) != 0x80) {
+                ++length;
+            }
+        }
+
+        return length;
+    }
+
+    /** Escape \param token for use in JSON pointer */
+    std::string PointerToken(const std::string& token)
+    {
+        if (token.find_first_of("~/") == std::string::npos) {
+            return token;
+        }
+
+        std::string escaped;
+
+        for (std::string::const_iterator it = token.begin(); it != token.end(); ++it) {
+            if (*it == '~') {
+                escaped += "~0";
+            }
+            else if (*it == '/') {
+                escaped += "~1";
+            }
+            else {
+                escaped += *it;
+            }
+        }
+
+        return escaped;
+    }
+
+    std::string PointerIndex(size_t index)
+    {
+        std::stringstream ss;
+        ss << index;
+        return ss.str();
+    }
+
+    const sos::Base* Member(const sos::Base& object, const char* key)
+    {
+        sos::KeyValues::const_iterator it = object.object.find(key);
+        return it == object.object.end() ? NULL : &it->second;
+    }
+
+    bool ReadNumber(const sos::Base& schema, const char* key, double& out)
+    {
+        const sos::Base* value = Member(schema, key);
+
+        if (!value || value->type != sos::Base::NumberType) {
+            return false;
+        }
+
+        out = value->number;
+        return true;
+    }
+
+    void ReadSize(const sos::Base& schema, const char* key, size_t& out)
+    {
+        double number;
+
+        if (ReadNumber(schema, key, number) && number >= 0) {
+            out = static_cast<size_t>(number);
+        }
+    }
+
+    bool ReadBoolean(const sos::Base& schema, const char* key)
+    {
+        const sos::Base* value = Member(schema, key);
+        return value && value->type == sos::Base::BooleanType && value->boolean;
+    }
+
+    bool Fail(const std::string& path, const std::string& message, std::string& error)
+    {
+        error = (path.empty() ? std::string("/") : path) + ": " + message;
+        return false;
+    }
+}
+
+JSONSchema::Node::Node()
+: types(0), hasEnum(false),
+  hasMinimum(false), exclusiveMinimum(false), hasMaximum(false), exclusiveMaximum(false),
+  minimum(0), maximum(0), multipleOf(0),
+  minLength(0), maxLength(None), hasPattern(false),
+  items(None), additionalItems(true), additionalItemsSchema(None), minItems(0), maxItems(None), uniqueItems(false),
+  additionalProperties(true), additionalPropertiesSchema(None), minProperties(0), maxProperties(None),
+  notSchema(None), refSchema(None)
+{
+}
+
+JSONSchema::JSONSchema()
+{
+}
+
+bool JSONSchema::compile(const sos::Base& schema, std::string& error)
+{
+    nodes_.clear();
+    pointers_.clear();
+
+    size_t root;
+
+    bool result = compileNode(schema, "#", root, error) && resolveReferences(error);
+
+    pointers_.clear();
+
+    if (!result) {
+        nodes_.clear();
+    }
+
+    return result;
+}
+
+bool JSONSchema::compileNode(const sos::Base& schema, const std::string& pointer, size_t& index, std::string& error)
+{
+    if (schema.type != sos::Base::ObjectType) {
+        error = "schema at '" + pointer + "' is not an object";
+        return false;
+    }
+
+    index = nodes_.size();
+    nodes_.push_back(Node());
+    pointers_[pointer] = index;
+
+    // children are appended to nodes_ while this node is filled
+    Node node;
+
+    if (const sos::Base* ref = Member(schema, "$ref")) {
+
+        if (ref->type != sos::Base::StringType) {
+            error = "'$ref' at '" + pointer + "' is not a string";
+            return false;
+        }
+
+        node.ref = ref->str;
+    }
+
+    if (const sos::Base* type = Member(schema, "type")) {
+
+        if (type->type == sos::Base::StringType) {
+            node.types = TypeFlagByName(type->str);
+
+            if (!node.types) {
+                error = "unknown type '" + type->str + "' at '" + pointer + "'";
+                return false;
+            }
+        }
+        else if (type->type == sos::Base::ArrayType) {
+            for (sos::Bases::const_iterator it = type->array.begin(); it != type->array.end(); ++it) {
+
+                unsigned int flag = (it->type == sos::Base::StringType) ? TypeFlagByName(it->str) : 0;
+
+                if (!flag) {
+                    error = "unknown type '" + it->str + "' at '" + pointer + "'";
+                    return false;
+                }
+
+                node.types |= flag;
+            }
+        }
+        else {
+            error = "'type' at '" + pointer + "' is not a string or an array";
+            return false;
+        }
+    }
+
+    if (const sos::Base* values = Member(schema, "enum")) {
+
+        if (values->type == sos::Base::ArrayType) {
+            node.hasEnum = true;
+            node.enumValues = values->array;
+        }
+    }
+
+    node.hasMinimum = ReadNumber(schema, "minimum", node.minimum);
+    node.hasMaximum = ReadNumber(schema, "maximum", node.maximum);
+    node.exclusiveMinimum = ReadBoolean(schema, "exclusiveMinimum");
+    node.exclusiveMaximum = ReadBoolean(schema, "exclusiveMaximum");
+
+    if (ReadNumber(schema, "multipleOf", node.multipleOf) && node.multipleOf <= 0) {
+        error = "'multipleOf' at '" + pointer + "' is not positive";
+        return false;
+    }
+
+    ReadSize(schema, "minLength", node.minLength);
+    ReadSize(schema, "maxLength", node.maxLength);
+    ReadSize(schema, "minItems", node.minItems);
+    ReadSize(schema, "maxItems", node.maxItems);
+    ReadSize(schema, "minProperties", node.minProperties);
+    ReadSize(schema, "maxProperties", node.maxProperties);
+
+    node.uniqueItems = ReadBoolean(schema, "uniqueItems");
+
+    if (const sos::Base* pattern = Member(schema, "pattern")) {
+
+        try {
+            node.pattern = std::regex(pattern->str, std::regex::ECMAScript);
+            node.hasPattern = true;
+        }
+        catch (const std::regex_error&) {
+            error = "invalid 'pattern' at '" + pointer + "'";
+            return false;
+        }
+    }
+
+    if (const sos::Base* items = Member(schema, "items")) {
+
+        if (items->type == sos::Base::ArrayType) {
+            for (size_t i = 0; i < items->array.size(); ++i) {
+
+                size_t item;
+
+                if (!compileNode(items->array[i], pointer + "/items/" + PointerIndex(i), item, error)) {
+                    return false;
+                }
+
+                node.tupleItems.push_back(item);
+            }
+        }
+        else if (!compileNode(*items, pointer + "/items", node.items, error)) {
+            return false;
+        }
+    }
+
+    if (const sos::Base* additional = Member(schema, "additionalItems")) {
+
+        if (additional->type == sos::Base::BooleanType) {
+            node.additionalItems = additional->boolean;
+        }
+        else if (!compileNode(*additional, pointer + "/additionalItems", node.additionalItemsSchema, error)) {
+            return false;
+        }
+    }
+
+    if (const sos::Base* properties = Member(schema, "properties")) {
+
+        for (sos::Keys::const_iterator it = properties->keys.begin(); it != properties->keys.end(); ++it) {
+
+            size_t property;
+
+            if (!compileNode(properties->object.find(*it)->second,
+                               pointer + "/properties/" + PointerToken(*it),
+                               property,
+                               error)) {
+                return false;
+            }
+
+            node.properties.push_back(std::make_pair(*it, property));
+        }
+    }
+
+    if (const sos::Base* properties = Member(schema, "patternProperties")) {
+
+        for (sos::Keys::const_iterator it = properties->keys.begin(); it != properties->keys.end(); ++it) {
+
+            size_t property;
+
+            if (!compileNode(properties->object.find(*it)->second,
+                               pointer + "/patternProperties/" + PointerToken(*it),
+                               property,
+                               error)) {
+                return false;
+            }
+
+            try {
+                node.patternProperties.push_back(std::make_pair(std::regex(*it, std::regex::ECMAScript), property));
+            }
+            catch (const std::regex_error&) {
+                error = "invalid pattern property '" + *it + "' at '" + pointer + "'";
+                return false;
+            }
+        }
+    }
+
+    if (const sos::Base* additional = Member(schema, "additionalProperties")) {
+
+        if (additional->type == sos::Base::BooleanType) {
+            node.additionalProperties = additional->boolean;
+        }
+        else if (!compileNode(*additional, pointer + "/additionalProperties", node.additionalPropertiesSchema, error)) {
+            return false;
+        }
+    }
+
+    if (const sos::Base* required = Member(schema, "required")) {
+
+        for (sos::Bases::const_iterator it = required->array.begin(); it != required->array.end(); ++it) {
+            if (it->type == sos::Base::StringType) {
+                node.required.push_back(it->str);
+            }
+        }
+    }
+
+    static const char* combinators[] = { "allOf", "anyOf", "oneOf" };
+    Indexes* targets[] = { &node.allOf, &node.anyOf, &node.oneOf };
+
+    for (size_t c = 0; c < 3; ++c) {
+
+        const sos::Base* schemas = Member(schema, combinators[c]);
+
+        if (!schemas) {
+            continue;
+        }
+
+        for (size_t i = 0; i < schemas->array.size(); ++i) {
+
+            size_t member;
+            std::string memberPointer = pointer + "/" + combinators[c] + "/" + PointerIndex(i);
+
+            if (!compileNode(schemas->array[i], memberPointer, member, error)) {
+                return false;
+            }
+
+            targets[c]->push_back(member);
+        }
+    }
+
+    if (const sos::Base* notSchema = Member(schema, "not")) {
+        if (!compileNode(*notSchema, pointer + "/not", node.notSchema, error)) {
+            return false;
+        }
+    }
+
+    // compiled only to be reachable by `$ref`
+    if (const sos::Base* definitions = Member(schema, "definitions")) {
+
+        for (sos::Keys::const_iterator it = definitions->keys.begin(); it != definitions->keys.end(); ++it) {
+
+            size_t definition;
+
+            if (!compileNode(definitions->object.find(*it)->second,
+                               pointer + "/definitions/" + PointerToken(*it),
+                               definition,
+                               error)) {
+                return false;
+            }
+        }
+    }
+
+    nodes_[index] = node;
+
+    return true;
+}
+
+bool JSONSchema::resolveReferences(std::string& error)
+{
+    for (std::vector<Node>::iterator it = nodes_.begin(); it != nodes_.end(); ++it) {
+
+        if (it->ref.empty()) {
+            continue;
+        }
+
+        std::map<std::string, size_t>::const_iterator target = pointers_.find(it->ref);
+
+        if (target == pointers_.end()) {
+            error = "unresolvable '$ref' '" + it->ref + "', only references into the same schema are supported";
+            return false;
+        }
+
+        it->refSchema = target->second;
+    }
+
+    return true;
+}
+
+bool JSONSchema::validate(const sos::Base& instance, std::string& error) const
+{
+    if (nodes_.empty()) {
+        return true;
+    }
+
+    return validateNode(0, instance, std::string(), 0, error);
+}
+
+bool JSONSchema::validateNode(size_t index, const sos::Base& value, const std::string& path, size_t depth, std::string& error) const
+{
+    if (depth > MaxValidationDepth) {
+        return Fail(path, "schema recursion is too deep", error);
+    }
+
+    const Node& node = nodes_[index];
+
+    // siblings of `$ref` are ignored
+    if (node.refSchema != None) {
+        return validateNode(node.refSchema, value, path, depth + 1, error);
+    }
+
+    if (!MatchesType(node.types, value)) {
+        return Fail(path, std::string("unexpected type '") + TypeName(value) + "'", error);
+    }
+
+    if (node.hasEnum) {
+
+        bool found = false;
+
+        for (sos::Bases::const_iterator it = node.enumValues.begin(); it != node.enumValues.end() && !found; ++it) {
+            found = Equals(*it, value);
+        }
+
+        if (!found) {
+            return Fail(path, "value is not one of enumerated values", error);
+        }
+    }
+
+    switch (value.type) {
+
+        case sos::Base::NumberType:
+        {
+            double number = value.number;
+
+            if (node.hasMinimum && (number < node.minimum || (node.exclusiveMinimum && number == node.minimum))) {
+                return Fail(path, "number is less than minimum", error);
+            }
+
+            if (node.hasMaximum && (number > node.maximum || (node.exclusiveMaximum && number == node.maximum))) {
+                return Fail(path, "number is greater than maximum", error);
+            }
+
+            if (node.multipleOf > 0) {
+                double quotient = number / node.multipleOf;
+
+                if (std::fabs(quotient - std::floor(quotient + 0.5)) > 1e-9) {
+                    return Fail(path, "number is not multiple of 'multipleOf'", error);
+                }
+            }
+
+            break;
+        }
+
+        case sos::Base::StringType:
+        {
+            if (node.minLength > 0 || node.maxLength != None) {
+
+                size_t length = UTF8Length(value.str);
+
+                if (length < node.minLength) {
+                    return Fail(path, "string is shorter than minLength", error);
+                }
+
+                if (node.maxLength != None && length > node.maxLength) {
+                    return Fail(path, "string is longer than maxLength", error);
+                }
+            }
+
+            // too long string is not matched, see MaxPatternSubject
+            if (node.hasPattern && value.str.size() <= MaxPatternSubject && !std::regex_search(value.str, node.pattern)) {
+                return Fail(path, "string does not match pattern", error);
+            }
+
+            break;
+        }
+
+        case sos::Base::ArrayType:
+        {
+            const sos::Bases& items = value.array;
+
+            if (items.size() < node.minItems) {
+                return Fail(path, "array has fewer items than minItems", error);
+            }
+
+            if (node.maxItems != None && items.size() > node.maxItems) {
+                return Fail(path, "array has more items than maxItems", error);
+            }
+
+            for (size_t i = 0; i < items.size(); ++i) {
+
+                size_t schema = node.items;
+
+                if (!node.tupleItems.empty()) {
+
+                    if (i < node.tupleItems.size()) {
+                        schema = node.tupleItems[i];
+                    }
+                    else if (!node.additionalItems) {
+                        return Fail(path, "array has additional items", error);
+                    }
+                    else {
+                        schema = node.additionalItemsSchema;
+                    }
+                }
+
+                if (schema != None &&
+                    !validateNode(schema, items[i], path + "/" + PointerIndex(i), 0, error)) {
+                    return false;
+                }
+            }
+
+            if (node.uniqueItems) {
+                for (size_t i = 0; i < items.size(); ++i) {
+                    for (size_t j = i + 1; j < items.size(); ++j) {
+                        if (Equals(items[i], items[j])) {
+                            return Fail(path, "array items are not unique", error);
+                        }
+                    }
+                }
+            }
+
+            break;
+        }
+
+        case sos::Base::ObjectType:
+        {
+            if (value.object.size() < node.minProperties) {
+                return Fail(path, "object has fewer properties than minProperties", error);
+            }
+
+            if (node.maxProperties != None && value.object.size() > node.maxProperties) {
+                return Fail(path, "object has more properties than maxProperties", error);
+            }
+
+            for (std::vector<std::string>::const_iterator it = node.required.begin(); it != node.required.end(); ++it) {
+                if (value.object.find(*it) == value.object.end()) {
+                    return Fail(path, "missing required property '" + *it + "'", error);
+                }
+            }
+
+            for (sos::KeyValues::const_iterator it = value.object.begin(); it != value.object.end(); ++it) {
+
+                std::string propertyPath = path + "/" + PointerToken(it->first);
+                bool matched = false;
+
+                for (NamedIndexes::const_iterator property = node.properties.begin();
+                     property != node.properties.end();
+                     ++property) {
+
+                    if (property->first != it->first) {
+                        continue;
+                    }
+
+                    matched = true;
+
+                    if (!validateNode(property->second, it->second, propertyPath, 0, error)) {
+                        return false;
+                    }
+                }
+
+                for (PatternIndexes::const_iterator property = node.patternProperties.begin();
+                     property != node.patternProperties.end();
+                     ++property) {
+
+                    if (it->first.size() > MaxPatternSubject || !std::regex_search(it->first, property->first)) {
+                        continue;
+                    }
+
+                    matched = true;
+
+                    if (!validateNode(property->second, it->second, propertyPath, 0, error)) {
+                        return false;
+                    }
+                }
+
+                if (matched) {
+                    continue;
+                }
+
+                if (!node.additionalProperties) {
+                    return Fail(path, "additional property '" + it->first + "' is not allowed", error);
+                }
+
+                if (node.additionalPropertiesSchema != None &&
+                    !validateNode(node.additionalPropertiesSchema, it->second, propertyPath, 0, error)) {
+                    return false;
+                }
+            }
+
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    for (Indexes::const_iterator it = node.allOf.begin(); it != node.allOf.end(); ++it) {
+        if (!validateNode(*it, value, path, depth + 1, error)) {
+            return false;
+        }
+    }
+
+    std::string ignored;
+
+    if (!node.anyOf.empty()) {
+
+        bool matched = false;
+
+        for (Indexes::const_iterator it = node.anyOf.begin(); it != node.anyOf.end() && !matched; ++it) {
+            matched = validateNode(*it, value, path, depth + 1, ignored);
+        }
+
+        if (!matched) {
+            return Fail(path, "value does not match any schema of anyOf", error);
+        }
+    }
+
+    if (!node.oneOf.empty()) {
+
+        size_t matches = 0;
+
+        for (Indexes::const_iterator it = node.oneOf.begin(); it != node.oneOf.end(); ++it) {
+            if (validateNode(*it, value, path, depth + 1, ignored)) {
+                ++matches;
+            }
+        }
+
+        if (matches != 1) {
+            return Fail(path, "value does not match exactly one schema of oneOf", error);
+        }
+    }
+
+    if (node.notSchema != None && validateNode(node.notSchema, value, path, depth + 1, ignored)) {
+        return Fail(path, "value matches schema of not", error);
+    }
+
+    return true;
+}
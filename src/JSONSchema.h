@@ -0,0 +1,116 @@
+//
+//  JSONSchema.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_JSON_SCHEMA_H
+#define DRAFTER_JSON_SCHEMA_H
+
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "sos.h"
+
+namespace drafter {
+
+    /**
+     *  \brief JSON Schema (draft 4) compiled for repeated validation
+     *
+     *  Schema document is compiled once into flat list of nodes; keywords are
+     *  decoded, regular expressions built and `$ref`s resolved, so validate()
+     *  only walks the instance. Compiled schema is immutable and can be used
+     *  from more threads at once.
+     *
+     *  Supported keywords: type, enum, minimum, maximum, exclusiveMinimum,
+     *  exclusiveMaximum, multipleOf, minLength, maxLength, pattern, items,
+     *  additionalItems, minItems, maxItems, uniqueItems, properties,
+     *  patternProperties, additionalProperties, required, minProperties,
+     *  maxProperties, allOf, anyOf, oneOf, not, definitions and local `$ref`
+     *  (`#` or `#/json/pointer`). Other keywords (e.g. format) are ignored.
+     *
+     *  Strings longer than 512 bytes are not matched against `pattern` and
+     *  property names that long match no `patternProperties` - std::regex
+     *  recurses per character and could overflow the stack.
+     */
+    class JSONSchema {
+    public:
+
+        JSONSchema();
+
+        /**
+         *  \brief Compile schema document
+         *
+         *  \param schema   Parsed schema document
+         *  \param error    Output - reason why schema can not be used
+         *  \return False if schema is not valid
+         */
+        bool compile(const sos::Base& schema, std::string& error);
+
+        /**
+         *  \brief Check \param instance against schema
+         *
+         *  \param error    Output - first violation with JSON pointer into instance
+         *  \return True if instance is valid
+         */
+        bool validate(const sos::Base& instance, std::string& error) const;
+
+    private:
+
+        static const size_t None = static_cast<size_t>(-1);
+
+        typedef std::vector<size_t> Indexes;
+        typedef std::vector<std::pair<std::string, size_t> > NamedIndexes;
+        typedef std::vector<std::pair<std::regex, size_t> > PatternIndexes;
+
+        struct Node {
+            unsigned int types;             ///< allowed types bitmask, 0 for any
+
+            bool hasEnum;
+            sos::Bases enumValues;
+
+            bool hasMinimum, exclusiveMinimum;
+            bool hasMaximum, exclusiveMaximum;
+            double minimum, maximum, multipleOf;
+
+            size_t minLength, maxLength;
+            bool hasPattern;
+            std::regex pattern;
+
+            size_t items;                   ///< schema of all items
+            Indexes tupleItems;             ///< schemas of items by position
+            bool additionalItems;
+            size_t additionalItemsSchema;
+            size_t minItems, maxItems;
+            bool uniqueItems;
+
+            NamedIndexes properties;
+            PatternIndexes patternProperties;
+            bool additionalProperties;
+            size_t additionalPropertiesSchema;
+            std::vector<std::string> required;
+            size_t minProperties, maxProperties;
+
+            Indexes allOf, anyOf, oneOf;
+            size_t notSchema;
+
+            std::string ref;                ///< `$ref` before it is resolved
+            size_t refSchema;
+
+            Node();
+        };
+
+        std::vector<Node> nodes_;
+        std::map<std::string, size_t> pointers_;   ///< compile time only - JSON pointer of each node
+
+        bool compileNode(const sos::Base& schema, const std::string& pointer, size_t& index, std::string& error);
+        bool resolveReferences(std::string& error);
+
+        bool validateNode(size_t index, const sos::Base& value, const std::string& path, size_t depth, std::string& error) const;
+    };
+}
+
+#endif // #ifndef DRAFTER_JSON_SCHEMA_H
@@ -0,0 +1,137 @@
+//
+//  LRUCache.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_LRU_CACHE_H
+#define DRAFTER_LRU_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace drafter {
+
+    /**
+     *  \brief Thread-safe least recently used cache bounded by total weight
+     *
+     *  Values are stored as shared immutable objects, so a value returned by
+     *  `get()` stays valid even if it is evicted meanwhile by another thread.
+     *
+     *  Weight of an entry is supplied by caller, typically its approximate size
+     *  in bytes. Entry heavier than whole capacity is not stored at all.
+     */
+    template <typename Key, typename Value, typename KeyHash = std::hash<Key> >
+    class LRUCache {
+    public:
+
+        typedef std::shared_ptr<const Value> value_ptr;
+
+        explicit LRUCache(size_t capacity) : capacity_(capacity), weight_(0) {}
+
+        /**
+         *  \brief Return cached value for \param key or empty pointer
+         */
+        value_ptr get(const Key& key) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            typename Index::iterator it = index_.find(key);
+
+            if (it == index_.end()) {
+                return value_ptr();
+            }
+
+            // Move to front - the most recently used
+            entries_.splice(entries_.begin(), entries_, it->second);
+
+            return it->second->value;
+        }
+
+        /**
+         *  \brief Store \param value under \param key, evict least recently used entries to fit
+         *
+         *  \return Number of evicted entries
+         */
+        size_t put(const Key& key, const value_ptr& value, size_t weight) {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            typename Index::iterator it = index_.find(key);
+
+            if (it != index_.end()) {
+                weight_ -= it->second->weight;
+                entries_.erase(it->second);
+                index_.erase(it);
+            }
+
+            if (weight > capacity_) {
+                return 0;
+            }
+
+            size_t evicted = 0;
+
+            while (weight_ + weight > capacity_ && !entries_.empty()) {
+                weight_ -= entries_.back().weight;
+                index_.erase(entries_.back().key);
+                entries_.pop_back();
+                ++evicted;
+            }
+
+            Entry entry = { key, value, weight };
+
+            entries_.push_front(entry);
+            index_[key] = entries_.begin();
+            weight_ += weight;
+
+            return evicted;
+        }
+
+        void clear() {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            entries_.clear();
+            index_.clear();
+            weight_ = 0;
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+
+        size_t weight() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return weight_;
+        }
+
+        size_t capacity() const {
+            return capacity_;
+        }
+
+    private:
+
+        struct Entry {
+            Key key;
+            value_ptr value;
+            size_t weight;
+        };
+
+        typedef std::list<Entry> Entries;
+        typedef std::unordered_map<Key, typename Entries::iterator, KeyHash> Index;
+
+        mutable std::mutex mutex_;
+
+        Entries entries_;
+        Index index_;
+
+        const size_t capacity_;
+        size_t weight_;
+
+        LRUCache(const LRUCache&);
+        LRUCache& operator=(const LRUCache&);
+    };
+}
+
+#endif // #ifndef DRAFTER_LRU_CACHE_H
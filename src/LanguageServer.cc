@@ -0,0 +1,749 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  LanguageServer.cc - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "LanguageServer.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <poll.h>
+#include <strings.h>
+#include <unistd.h>
+#endif
+
+#include "JSONReader.h"
+#include "ParallelParse.h"
+#include "SerializeJSON.h"
+#include "Version.h"
+
+namespace sc = snowcrash;
+
+const int LanguageServer::DebounceInterval;
+const int LanguageServer::SlowParseInterval;
+
+namespace {
+
+    // JSON-RPC error codes
+    const int ParseError = -32700;
+    const int InvalidRequest = -32600;
+    const int MethodNotFound = -32601;
+
+    // LSP constants
+    const int IncrementalSync = 2;
+    const int ErrorSeverity = 1;
+    const int WarningSeverity = 2;
+
+    const int NamespaceSymbolKind = 3;
+    const int ClassSymbolKind = 5;
+    const int MethodSymbolKind = 6;
+    const int StructSymbolKind = 23;
+
+    const size_t ReadChunkSize = 64 * 1024;
+
+    /** Member \param key of \param value or undefined value */
+    const sos::Base& Member(const sos::Base& value, const std::string& key)
+    {
+        static const sos::Base undefined;
+
+        sos::KeyValues::const_iterator it = value.object.find(key);
+        return it != value.object.end() ? it->second : undefined;
+    }
+
+    size_t Index(const sos::Base& value)
+    {
+        return value.type == sos::Base::NumberType && value.number > 0 ? static_cast<size_t>(value.number) : 0;
+    }
+
+    std::string DocumentURI(const sos::Base& params)
+    {
+        return Member(Member(params, "textDocument"), "uri").str;
+    }
+
+    /**
+     *  \brief Offset of 0-based \param line and UTF-16 \param character in \param text
+     *
+     *  Used for edits, where text changes between positions and no index is kept.
+     */
+    size_t OffsetOf(const std::string& text, size_t line, size_t character)
+    {
+        size_t position = 0;
+
+        for (; line > 0; --line) {
+            const void* newLine = memchr(text.data() + position, '\n', text.size() - position);
+
+            if (!newLine) {
+                return text.size();
+            }
+
+            position = static_cast<const char*>(newLine) - text.data() + 1;
+        }
+
+        while (position < text.size() && text[position] != '\n' && character > 0) {
+
+            unsigned char c = static_cast<unsigned char>(text[position]);
+            character -= (c >= 0xF0 && character > 1) ? 2 : 1;
+
+            for (++position; position < text.size() && (static_cast<unsigned char>(text[position]) & 0xC0) == 0x80; ++position);
+        }
+
+        return position;
+    }
+
+    sos::Object WrapPosition(const drafter::PositionIndex& index, size_t byte)
+    {
+        size_t line, column;
+        index.lineUTF16ColumnAt(byte, line, column);
+
+        sos::Object position;
+        position.set("line", sos::Number(line - 1));
+        position.set("character", sos::Number(column - 1));
+
+        return position;
+    }
+
+    sos::Object WrapRange(const drafter::PositionIndex& index, size_t begin, size_t end)
+    {
+        sos::Object range;
+        range.set("start", WrapPosition(index, begin));
+        range.set("end", WrapPosition(index, end));
+
+        return range;
+    }
+
+    /** Byte of LSP `position` in parsed text */
+    size_t ByteOf(const drafter::PositionIndex& index, const sos::Base& position)
+    {
+        return index.byteOfLineUTF16Column(Index(Member(position, "line")) + 1,
+                                           Index(Member(position, "character")) + 1);
+    }
+
+    sos::Object WrapDiagnostic(const sc::SourceAnnotation& annotation,
+                               int severity,
+                               const drafter::PositionIndex& index)
+    {
+        size_t begin = 0;
+        size_t end = 0;
+
+        // annotation locations are in characters
+        if (!annotation.location.empty()) {
+            const mdp::CharactersRange& first = annotation.location.front();
+            const mdp::CharactersRange& last = annotation.location.back();
+
+            begin = index.byteOfCodePoint(first.location);
+            end = index.byteOfCodePoint(last.location + last.length);
+        }
+
+        sos::Object diagnostic;
+
+        diagnostic.set("range", WrapRange(index, begin, end));
+        diagnostic.set("severity", sos::Number(severity));
+        diagnostic.set("code", sos::Number(annotation.code));
+        diagnostic.set("source", sos::String("drafter"));
+        diagnostic.set("message", sos::String(annotation.message));
+
+        return diagnostic;
+    }
+
+    int SymbolKind(drafter::Symbol::Kind kind)
+    {
+        switch (kind) {
+            case drafter::Symbol::GroupSymbol:
+                return NamespaceSymbolKind;
+
+            case drafter::Symbol::ResourceSymbol:
+                return ClassSymbolKind;
+
+            case drafter::Symbol::ActionSymbol:
+                return MethodSymbolKind;
+
+            default:
+                return StructSymbolKind;
+        }
+    }
+
+    sos::Object WrapSymbol(const drafter::Symbols& symbols,
+                           const std::vector<std::vector<size_t> >& children,
+                           size_t index,
+                           const drafter::PositionIndex& positions)
+    {
+        const drafter::Symbol& symbol = symbols[index];
+        sos::Object wrapped;
+
+        wrapped.set("name", sos::String(symbol.name.empty() ? "(anonymous)" : symbol.name));
+
+        if (!symbol.detail.empty()) {
+            wrapped.set("detail", sos::String(symbol.detail));
+        }
+
+        wrapped.set("kind", sos::Number(SymbolKind(symbol.kind)));
+        wrapped.set("range", WrapRange(positions, symbol.begin, symbol.end));
+        wrapped.set("selectionRange", WrapRange(positions, symbol.begin, symbol.signatureEnd));
+
+        sos::Array nested;
+
+        for (std::vector<size_t>::const_iterator it = children[index].begin(); it != children[index].end(); ++it) {
+            nested.push(WrapSymbol(symbols, children, *it, positions));
+        }
+
+        wrapped.set("children", nested);
+
+        return wrapped;
+    }
+
+    std::string HoverText(const drafter::Symbol& symbol)
+    {
+        std::stringstream text;
+
+        switch (symbol.kind) {
+            case drafter::Symbol::GroupSymbol:
+                text << "**Group** " << symbol.name;
+                break;
+
+            case drafter::Symbol::ResourceSymbol:
+                text << "**Resource** `" << symbol.detail << "`";
+
+                if (symbol.name != symbol.detail) {
+                    text << " " << symbol.name;
+                }
+                break;
+
+            case drafter::Symbol::ActionSymbol:
+                text << "**" << symbol.name << "**";
+
+                if (!symbol.detail.empty()) {
+                    text << " " << symbol.detail;
+                }
+                break;
+
+            case drafter::Symbol::DataStructureSymbol:
+                text << "**Data Structure** `" << symbol.name << "`";
+                break;
+        }
+
+        if (!symbol.description.empty()) {
+            text << "\n\n" << symbol.description;
+        }
+
+        return text.str();
+    }
+}
+
+LanguageServer::LanguageServer(unsigned int threads) : threads_(threads), shutdown_(false), exit_(false)
+{
+}
+
+void LanguageServer::reply(const sos::Base& id, const sos::Base& result)
+{
+    sos::Object message;
+
+    message.set("jsonrpc", sos::String("2.0"));
+    message.set("id", id);
+    message.set("result", result);
+
+    notify(std::string(), message);
+}
+
+void LanguageServer::replyError(const sos::Base& id, int code, const std::string& text)
+{
+    sos::Object error;
+    error.set("code", sos::Number(code));
+    error.set("message", sos::String(text));
+
+    sos::Object message;
+
+    message.set("jsonrpc", sos::String("2.0"));
+    message.set("id", id.type == sos::Base::UndefinedType ? sos::Base(sos::Base::NullType) : id);
+    message.set("error", error);
+
+    notify(std::string(), message);
+}
+
+/**
+ *  \brief Queue notification \param method, or a prepared message if \param method is empty
+ */
+void LanguageServer::notify(const std::string& method, const sos::Base& params)
+{
+    std::stringstream body;
+    drafter::SerializeJSON serializer;
+
+    if (method.empty()) {
+        serializer.process(params, body);
+    }
+    else {
+        sos::Object message;
+
+        message.set("jsonrpc", sos::String("2.0"));
+        message.set("method", sos::String(method));
+        message.set("params", params);
+
+        serializer.process(message, body);
+    }
+
+    std::string content = body.str();
+    std::stringstream header;
+
+    header << "Content-Length: " << content.size() << "\r\n\r\n";
+
+    output_ += header.str();
+    output_ += content;
+}
+
+void LanguageServer::handle(const sos::Base& message)
+{
+    const std::string& method = Member(message, "method").str;
+    const sos::Base& id = Member(message, "id");
+    const sos::Base& params = Member(message, "params");
+
+    bool isRequest = id.type != sos::Base::UndefinedType;
+
+    if (method == "exit") {
+        exit_ = true;
+        return;
+    }
+
+    if (shutdown_ && isRequest) {
+        replyError(id, InvalidRequest, "server is shutting down");
+        return;
+    }
+
+    if (method == "initialize") {
+
+        sos::Object sync;
+        sync.set("openClose", sos::Boolean(true));
+        sync.set("change", sos::Number(IncrementalSync));
+
+        sos::Object capabilities;
+        capabilities.set("textDocumentSync", sync);
+        capabilities.set("documentSymbolProvider", sos::Boolean(true));
+        capabilities.set("hoverProvider", sos::Boolean(true));
+        capabilities.set("definitionProvider", sos::Boolean(true));
+
+        sos::Object info;
+        info.set("name", sos::String("drafter"));
+        info.set("version", sos::String(DRAFTER_VERSION_STRING));
+
+        sos::Object result;
+        result.set("capabilities", capabilities);
+        result.set("serverInfo", info);
+
+        reply(id, result);
+    }
+    else if (method == "shutdown") {
+        shutdown_ = true;
+        reply(id, sos::Null());
+    }
+    else if (method == "textDocument/didOpen") {
+        didOpen(params);
+    }
+    else if (method == "textDocument/didChange") {
+        didChange(params);
+    }
+    else if (method == "textDocument/didClose") {
+        didClose(params);
+    }
+    else if (method == "textDocument/documentSymbol") {
+        reply(id, documentSymbol(params));
+    }
+    else if (method == "textDocument/hover") {
+        reply(id, hover(params));
+    }
+    else if (method == "textDocument/definition") {
+        reply(id, definition(params));
+    }
+    else if (isRequest) {
+        replyError(id, MethodNotFound, "unsupported method '" + method + "'");
+    }
+}
+
+void LanguageServer::didOpen(const sos::Base& params)
+{
+    const sos::Base& textDocument = Member(params, "textDocument");
+    const std::string& uri = Member(textDocument, "uri").str;
+
+    Document& document = documents_[uri];
+
+    document.text = Member(textDocument, "text").str;
+    document.version = Member(textDocument, "version");
+
+    reparse(uri, document);
+}
+
+void LanguageServer::didChange(const sos::Base& params)
+{
+    Documents::iterator it = documents_.find(DocumentURI(params));
+
+    if (it == documents_.end()) {
+        return;
+    }
+
+    Document& document = it->second;
+    const sos::Base& changes = Member(params, "contentChanges");
+
+    for (sos::Bases::const_iterator change = changes.array.begin(); change != changes.array.end(); ++change) {
+
+        const sos::Base& range = Member(*change, "range");
+        const std::string& text = Member(*change, "text").str;
+
+        if (range.type != sos::Base::ObjectType) {
+            document.text = text;
+            continue;
+        }
+
+        const sos::Base& start = Member(range, "start");
+        const sos::Base& end = Member(range, "end");
+
+        size_t begin = OffsetOf(document.text, Index(Member(start, "line")), Index(Member(start, "character")));
+        size_t finish = OffsetOf(document.text, Index(Member(end, "line")), Index(Member(end, "character")));
+
+        if (finish < begin) {
+            std::swap(begin, finish);
+        }
+
+        document.text.replace(begin, finish - begin, text);
+    }
+
+    document.version = Member(Member(params, "textDocument"), "version");
+    document.dirty = true;
+    document.due = Clock::now() + std::chrono::milliseconds(DebounceInterval);
+}
+
+void LanguageServer::didClose(const sos::Base& params)
+{
+    std::string uri = DocumentURI(params);
+
+    if (documents_.erase(uri) == 0) {
+        return;
+    }
+
+    sos::Object diagnostics;
+    diagnostics.set("uri", sos::String(uri));
+    diagnostics.set("diagnostics", sos::Array());
+
+    notify("textDocument/publishDiagnostics", diagnostics);
+}
+
+LanguageServer::Document* LanguageServer::ready(const sos::Base& params)
+{
+    std::string uri = DocumentURI(params);
+    Documents::iterator it = documents_.find(uri);
+
+    if (it == documents_.end()) {
+        return NULL;
+    }
+
+    if (it->second.dirty) {
+        reparse(uri, it->second);
+    }
+
+    return &it->second;
+}
+
+sos::Base LanguageServer::documentSymbol(const sos::Base& params)
+{
+    Document* document = ready(params);
+
+    if (!document) {
+        return sos::Null();
+    }
+
+    const drafter::Symbols& symbols = document->symbols->symbols();
+
+    std::vector<std::vector<size_t> > children(symbols.size());
+    sos::Array result;
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (symbols[i].parent != drafter::Symbol::NoParent) {
+            children[symbols[i].parent].push_back(i);
+        }
+    }
+
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (symbols[i].parent == drafter::Symbol::NoParent) {
+            result.push(WrapSymbol(symbols, children, i, *document->positions));
+        }
+    }
+
+    return result;
+}
+
+sos::Base LanguageServer::hover(const sos::Base& params)
+{
+    Document* document = ready(params);
+
+    if (!document) {
+        return sos::Null();
+    }
+
+    size_t byte = ByteOf(*document->positions, Member(params, "position"));
+
+    const drafter::Symbol* symbol = document->symbols->definitionOf(drafter::TypeReferenceAt(document->parsed, byte));
+
+    if (!symbol) {
+        symbol = document->symbols->symbolAt(byte);
+    }
+
+    if (!symbol) {
+        return sos::Null();
+    }
+
+    sos::Object contents;
+    contents.set("kind", sos::String("markdown"));
+    contents.set("value", sos::String(HoverText(*symbol)));
+
+    sos::Object result;
+    result.set("contents", contents);
+
+    return result;
+}
+
+sos::Base LanguageServer::definition(const sos::Base& params)
+{
+    Document* document = ready(params);
+
+    if (!document) {
+        return sos::Null();
+    }
+
+    size_t byte = ByteOf(*document->positions, Member(params, "position"));
+    const drafter::Symbol* symbol = document->symbols->definitionOf(drafter::TypeReferenceAt(document->parsed, byte));
+
+    if (!symbol) {
+        return sos::Null();
+    }
+
+    sos::Object location;
+    location.set("uri", sos::String(DocumentURI(params)));
+    location.set("range", WrapRange(*document->positions, symbol->begin, symbol->signatureEnd));
+
+    return location;
+}
+
+void LanguageServer::reparse(const std::string& uri, Document& document)
+{
+    document.dirty = false;
+    document.parsed = document.text;
+
+    Clock::time_point started = Clock::now();
+
+    std::unique_ptr<sc::ParseResult<sc::Blueprint> > result(new sc::ParseResult<sc::Blueprint>);
+    drafter::ParseBlueprintParallel(document.parsed, sc::ExportSourcemapOption, *result, threads_);
+
+    long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started).count();
+
+    if (elapsed >= SlowParseInterval) {
+        std::cerr << "drafter: parsing " << uri << " took " << elapsed << " ms, messages waited meanwhile\n";
+    }
+
+    document.result.swap(result);
+    document.positions.reset(new drafter::PositionIndex(document.parsed));
+    document.symbols.reset(new drafter::SymbolIndex(document.result->node, document.result->sourceMap, document.parsed.size()));
+
+    const sc::Report& report = document.result->report;
+    sos::Array diagnostics;
+
+    if (report.error.code != sc::Error::OK) {
+        diagnostics.push(WrapDiagnostic(report.error, ErrorSeverity, *document.positions));
+    }
+
+    for (sc::Warnings::const_iterator it = report.warnings.begin(); it != report.warnings.end(); ++it) {
+        diagnostics.push(WrapDiagnostic(*it, WarningSeverity, *document.positions));
+    }
+
+    sos::Object params;
+    params.set("uri", sos::String(uri));
+
+    if (document.version.type == sos::Base::NumberType) {
+        params.set("version", document.version);
+    }
+
+    params.set("diagnostics", diagnostics);
+
+    notify("textDocument/publishDiagnostics", params);
+}
+
+void LanguageServer::reparseDue()
+{
+    Clock::time_point now = Clock::now();
+
+    for (Documents::iterator it = documents_.begin(); it != documents_.end(); ++it) {
+        if (it->second.dirty && it->second.due <= now) {
+            reparse(it->first, it->second);
+        }
+    }
+}
+
+int LanguageServer::timeout() const
+{
+    int timeout = -1;
+    Clock::time_point now = Clock::now();
+
+    for (Documents::const_iterator it = documents_.begin(); it != documents_.end(); ++it) {
+
+        if (!it->second.dirty) {
+            continue;
+        }
+
+        long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(it->second.due - now).count();
+        int wait = remaining > 0 ? static_cast<int>(remaining) : 0;
+
+        if (timeout < 0 || wait < timeout) {
+            timeout = wait;
+        }
+    }
+
+    return timeout;
+}
+
+#if !defined(_WIN32)
+
+/**
+ *  \brief Write queued messages to stdout
+ *
+ *  \return False if stdout is closed
+ */
+bool LanguageServer::flush()
+{
+    size_t written = 0;
+
+    while (written < output_.size()) {
+
+        ssize_t count = write(STDOUT_FILENO, output_.data() + written, output_.size() - written);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            return false;
+        }
+
+        written += count;
+    }
+
+    output_.clear();
+    return true;
+}
+
+int LanguageServer::run()
+{
+    std::string input;
+    size_t consumed = 0;
+    char chunk[ReadChunkSize];
+
+    while (!exit_) {
+
+        // Handle all complete messages before reparsing - changes of a burst are coalesced
+        for (;;) {
+
+            size_t headerEnd = input.find("\r\n\r\n", consumed);
+
+            if (headerEnd == std::string::npos) {
+                break;
+            }
+
+            size_t length = std::string::npos;
+
+            for (size_t line = consumed; line < headerEnd; line = input.find("\r\n", line) + 2) {
+                if (strncasecmp(input.c_str() + line, "Content-Length:", 15) == 0) {
+                    length = strtoul(input.c_str() + line + 15, NULL, 10);
+                }
+            }
+
+            if (length == std::string::npos) {
+                std::cerr << "drafter: message without Content-Length header skipped\n";
+                consumed = headerEnd + 4;
+                continue;
+            }
+
+            if (input.size() < headerEnd + 4 + length) {
+                break;
+            }
+
+            sos::Base message;
+            std::string error;
+
+            if (drafter::ReadJSON(input.substr(headerEnd + 4, length), message, error)) {
+                handle(message);
+            }
+            else {
+                replyError(sos::Base(), ParseError, error);
+            }
+
+            consumed = headerEnd + 4 + length;
+        }
+
+        input.erase(0, consumed);
+        consumed = 0;
+
+        // Due documents are parsed even while messages keep coming
+        reparseDue();
+
+        if (!flush()) {
+            break;
+        }
+
+        if (exit_) {
+            break;
+        }
+
+        pollfd fd;
+        fd.fd = STDIN_FILENO;
+        fd.events = POLLIN;
+        fd.revents = 0;
+
+        int ready = poll(&fd, 1, timeout());
+
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << "fatal: poll failed: " << strerror(errno) << "\n";
+            return EXIT_FAILURE;
+        }
+
+        if (ready == 0) {
+            continue;
+        }
+
+        ssize_t count = read(STDIN_FILENO, chunk, sizeof(chunk));
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            break;
+        }
+
+        input.append(chunk, count);
+    }
+
+    flush();
+
+    return shutdown_ ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#else
+
+bool LanguageServer::flush()
+{
+    return false;
+}
+
+int LanguageServer::run()
+{
+    std::cerr << "fatal: language server is not available on Windows\n";
+    return EXIT_FAILURE;
+}
+
+#endif
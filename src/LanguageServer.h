@@ -0,0 +1,117 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  LanguageServer.h - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_LANGUAGE_SERVER_H
+#define DRAFTER_LANGUAGE_SERVER_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+
+#include "snowcrash.h"
+#include "sos.h"
+
+#include "PositionIndex.h"
+#include "SymbolIndex.h"
+
+/**
+ *  \brief Language Server Protocol over stdin and stdout
+ *
+ *  Keeps opened documents in memory. Changes (full or incremental) are
+ *  applied immediately, the document is reparsed once no change came for
+ *  DebounceInterval - a burst of keystrokes costs one parse. Documents are
+ *  parsed serially unless more threads are given, ParseBlueprintParallel()
+ *  is opt-in as elsewhere.
+ *
+ *  Parsing runs on the server thread, between reading messages. Messages
+ *  arriving meanwhile wait, so a request is answered at most one parse of
+ *  each due document late. Parses taking SlowParseInterval or longer are
+ *  logged to stderr.
+ *
+ *  Every parse publishes diagnostics from snowcrash::Report and rebuilds a
+ *  PositionIndex and SymbolIndex, so document symbols, hover and definition
+ *  requests are answered from memory without walking the source. Requests
+ *  for a document with pending changes reparse it first.
+ *
+ *  Needs poll(), it is not available on Windows.
+ */
+class LanguageServer {
+public:
+
+    typedef std::chrono::steady_clock Clock;
+
+    /** Quiet time after the last change before document is reparsed */
+    static const int DebounceInterval = 20;  // ms
+
+    /** Parses at least this long are logged, editor was not answered meanwhile */
+    static const int SlowParseInterval = 100;  // ms
+
+    /** \param threads  Threads of ParseBlueprintParallel(), 0 for number of cores */
+    explicit LanguageServer(unsigned int threads = 1);
+
+    /**
+     *  \brief Serve until `exit` notification or end of input
+     *
+     *  \return EXIT_SUCCESS if `shutdown` was requested before exit
+     */
+    int run();
+
+private:
+
+    struct Document {
+        std::string text;
+        sos::Base version;
+        bool dirty;
+        Clock::time_point due;                              ///< when to reparse dirty document
+
+        std::string parsed;                                 ///< text of the last parse, indexes point into it
+        std::unique_ptr<snowcrash::ParseResult<snowcrash::Blueprint> > result;
+        std::unique_ptr<drafter::PositionIndex> positions;
+        std::unique_ptr<drafter::SymbolIndex> symbols;
+
+        Document() : dirty(false) {}
+    };
+
+    typedef std::map<std::string, Document> Documents;
+
+    Documents documents_;
+    unsigned int threads_;
+    std::string output_;                                    ///< framed messages waiting to be written
+    bool shutdown_;
+    bool exit_;
+
+    void handle(const sos::Base& message);
+
+    void reply(const sos::Base& id, const sos::Base& result);
+    void replyError(const sos::Base& id, int code, const std::string& message);
+    void notify(const std::string& method, const sos::Base& params);
+
+    void didOpen(const sos::Base& params);
+    void didChange(const sos::Base& params);
+    void didClose(const sos::Base& params);
+
+    sos::Base documentSymbol(const sos::Base& params);
+    sos::Base hover(const sos::Base& params);
+    sos::Base definition(const sos::Base& params);
+
+    /** Document of `params.textDocument.uri` reparsed if dirty, NULL if not opened */
+    Document* ready(const sos::Base& params);
+
+    void reparse(const std::string& uri, Document& document);
+    void reparseDue();
+
+    /** Milliseconds until the first dirty document is due, -1 if none */
+    int timeout() const;
+
+    bool flush();
+
+    LanguageServer(const LanguageServer&);
+    LanguageServer& operator=(const LanguageServer&);
+};
+
+#endif /* end of include guard: DRAFTER_LANGUAGE_SERVER_H */
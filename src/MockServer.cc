@@ -0,0 +1,564 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  MockServer.cc - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "MockServer.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace sc = snowcrash;
+
+static const char* ReasonPhrase(int status)
+{
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default:  return "Unknown";
+    }
+}
+
+static bool IEquals(const std::string& a, const char* b)
+{
+    size_t i = 0;
+
+    for (; i < a.size() && b[i] != '\0'; ++i) {
+        if (tolower(static_cast<unsigned char>(a[i])) != tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+
+    return i == a.size() && b[i] == '\0';
+}
+
+/**
+ *  \brief Render complete HTTP response - status line, headers and body
+ *
+ *  \param withBody    False to render answer to HEAD request - headers
+ *                      describing \param body, but not the body itself
+ *  \param keepAlive   False if connection is closed after the response
+ */
+static std::string RenderResponse(int status, const sc::Headers& headers, const std::string& body, bool withBody = true, bool keepAlive = true)
+{
+    std::stringstream response;
+
+    response << "HTTP/1.1 " << status << " " << ReasonPhrase(status) << "\r\n";
+
+    for (sc::Headers::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+
+        // computed below
+        if (IEquals(it->first, "Content-Length") || IEquals(it->first, "Connection")) {
+            continue;
+        }
+
+        response << it->first << ": " << it->second << "\r\n";
+    }
+
+    response << "Content-Length: " << body.size() << "\r\n";
+    response << (keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    response << "\r\n";
+
+    if (withBody) {
+        response << body;
+    }
+
+    return response.str();
+}
+
+static std::string RenderActionResponse(const sc::Action* action, bool withBody)
+{
+    if (action) {
+        for (sc::TransactionExamples::const_iterator it = action->examples.begin();
+             it != action->examples.end();
+             ++it) {
+
+            if (it->responses.empty()) {
+                continue;
+            }
+
+            const sc::Response& response = it->responses.front();
+            int status = atoi(response.name.c_str());
+
+            if (status < 100 || status > 999) {
+                status = 200;
+            }
+
+            return RenderResponse(status, response.headers, response.body, withBody);
+        }
+    }
+
+    sc::Headers headers;
+    headers.push_back(sc::Header("Content-Type", "text/plain"));
+
+    return RenderResponse(501, headers, "No example response in blueprint\n", withBody);
+}
+
+MockServer::MockServer(const sc::Blueprint& blueprint)
+{
+    drafter::CollectRoutes(blueprint, sc::SourceMap<sc::Blueprint>(), routes_);
+
+    responses_.reserve(routes_.size());
+    headResponses_.reserve(routes_.size());
+
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        matcher_.add(routes_[i], i);
+        responses_.push_back(RenderActionResponse(routes_[i].action, true));
+        headResponses_.push_back(RenderActionResponse(routes_[i].action, false));
+    }
+
+    sc::Headers headers;
+    headers.push_back(sc::Header("Content-Type", "text/plain"));
+
+    notFound_ = RenderResponse(404, headers, "No matching action in blueprint\n");
+    headNotFound_ = RenderResponse(404, headers, "No matching action in blueprint\n", false);
+}
+
+const std::string& MockServer::respond(const std::string& method, const std::string& uri) const
+{
+    drafter::RouteMatch match;
+
+    if (method != "HEAD") {
+        return matcher_.match(method, uri, match) ? responses_[match.index] : notFound_;
+    }
+
+    // HEAD is answered by GET action unless blueprint describes it explicitly
+    if (matcher_.match(method, uri, match) || matcher_.match("GET", uri, match)) {
+        return headResponses_[match.index];
+    }
+
+    return headNotFound_;
+}
+
+bool MockServer::ParseContentLength(const std::string& value, size_t& length)
+{
+    static const size_t MaxLength = static_cast<size_t>(-1);
+
+    size_t i = 0;
+    length = 0;
+
+    for (; i < value.size() && isdigit(static_cast<unsigned char>(value[i])); ++i) {
+
+        size_t digit = value[i] - '0';
+
+        if (length > (MaxLength - digit) / 10) {
+            return false;
+        }
+
+        length = length * 10 + digit;
+    }
+
+    if (i == 0 && !value.empty()) {
+        return false;
+    }
+
+    for (; i < value.size(); ++i) {
+        if (value[i] != ' ' && value[i] != '\t') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+    const int MaxEvents = 256;
+    const size_t ReadChunkSize = 16 * 1024;
+    const size_t MaxRequestSize = 1024 * 1024;
+
+    struct Connection {
+        std::string input;
+        std::string output;
+        size_t written;
+        bool close;
+
+        Connection() : written(0), close(false) {}
+    };
+
+    typedef std::unordered_map<int, Connection> Connections;
+
+    /**
+     *  \brief Value of header \param name in header block or empty string
+     */
+    std::string HeaderValue(const std::string& headers, const char* name)
+    {
+        size_t nameLength = strlen(name);
+        size_t line = headers.find("\r\n");
+
+        while (line != std::string::npos && line < headers.size()) {
+
+            line += 2;
+
+            if (headers.size() > line + nameLength &&
+                headers[line + nameLength] == ':' &&
+                strncasecmp(headers.c_str() + line, name, nameLength) == 0) {
+
+                size_t begin = headers.find_first_not_of(' ', line + nameLength + 1);
+                size_t end = headers.find("\r\n", line);
+
+                if (begin == std::string::npos || begin >= end) {
+                    return std::string();
+                }
+
+                return headers.substr(begin, end - begin);
+            }
+
+            line = headers.find("\r\n", line);
+        }
+
+        return std::string();
+    }
+
+    /**
+     *  \brief Answer all complete requests buffered in connection
+     *
+     *  \return False if request is malformed and connection must be closed
+     */
+    bool HandleRequests(const MockServer& server, Connection& connection)
+    {
+        size_t consumed = 0;
+
+        for (;;) {
+
+            size_t headersEnd = connection.input.find("\r\n\r\n", consumed);
+
+            if (headersEnd == std::string::npos) {
+                break;
+            }
+
+            std::string headers = connection.input.substr(consumed, headersEnd + 2 - consumed);
+
+            size_t methodEnd = headers.find(' ');
+            size_t uriEnd = (methodEnd == std::string::npos) ? methodEnd : headers.find(' ', methodEnd + 1);
+            size_t lineEnd = headers.find("\r\n");
+
+            if (uriEnd == std::string::npos || uriEnd > lineEnd) {
+                return false;
+            }
+
+            std::string method = headers.substr(0, methodEnd);
+            std::string uri = headers.substr(methodEnd + 1, uriEnd - methodEnd - 1);
+            std::string version = headers.substr(uriEnd + 1, lineEnd - uriEnd - 1);
+
+            size_t bodyLength = 0;
+
+            // body which would not fit into input buffer is refused before it is read
+            if (!MockServer::ParseContentLength(HeaderValue(headers, "Content-Length"), bodyLength) ||
+                bodyLength > MaxRequestSize) {
+
+                int status = (bodyLength > MaxRequestSize) ? 413 : 400;
+
+                connection.output += RenderResponse(status, sc::Headers(), std::string(), true, false);
+                connection.close = true;
+                consumed = connection.input.size();
+                break;
+            }
+
+            size_t requestEnd = headersEnd + 4 + bodyLength;
+
+            if (requestEnd > connection.input.size()) {
+                break;  // wait for rest of body
+            }
+
+            std::string connectionHeader = HeaderValue(headers, "Connection");
+
+            if (IEquals(connectionHeader, "close") ||
+                (version == "HTTP/1.0" && !IEquals(connectionHeader, "keep-alive"))) {
+                connection.close = true;
+            }
+
+            connection.output += server.respond(method, uri);
+            consumed = requestEnd;
+
+            if (connection.close) {
+                break;
+            }
+        }
+
+        connection.input.erase(0, consumed);
+
+        return connection.input.size() <= MaxRequestSize;
+    }
+
+    /**
+     *  \brief Read everything available on socket and answer complete requests
+     *
+     *  \return False if connection must be closed
+     */
+    bool ReadConnection(int fd, const MockServer& server, Connection& connection)
+    {
+        char buffer[ReadChunkSize];
+        bool peerClosed = false;
+
+        for (;;) {
+            ssize_t count = recv(fd, buffer, sizeof(buffer), 0);
+
+            if (count > 0) {
+                connection.input.append(buffer, count);
+                continue;
+            }
+
+            if (count == 0) {
+                peerClosed = true;
+                break;
+            }
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            return false;
+        }
+
+        bool valid = HandleRequests(server, connection);
+
+        // peer closed its side - answer what it sent, then close
+        if (peerClosed) {
+            connection.close = true;
+        }
+
+        return valid;
+    }
+
+    /**
+     *  \brief Write as much of pending output as socket accepts
+     *
+     *  \return False if connection must be closed
+     */
+    bool FlushConnection(int fd, Connection& connection)
+    {
+        while (connection.written < connection.output.size()) {
+
+            ssize_t count = send(fd,
+                                 connection.output.data() + connection.written,
+                                 connection.output.size() - connection.written,
+                                 MSG_NOSIGNAL);
+
+            if (count > 0) {
+                connection.written += count;
+                continue;
+            }
+
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return true;
+            }
+
+            return false;
+        }
+
+        connection.output.clear();
+        connection.written = 0;
+
+        return true;
+    }
+
+    /**
+     *  \brief Watch \param fd for input, unless \param readable is false, and for free space in send buffer
+     */
+    void WatchConnection(int epoll, int fd, int operation, bool writable, bool readable = true)
+    {
+        epoll_event event;
+
+        memset(&event, 0, sizeof(event));
+        event.events = (readable ? EPOLLIN | EPOLLRDHUP : 0) | (writable ? EPOLLOUT : 0);
+        event.data.fd = fd;
+
+        epoll_ctl(epoll, operation, fd, &event);
+    }
+
+    int OpenListener(unsigned short port)
+    {
+        int listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+        if (listener < 0) {
+            return -1;
+        }
+
+        int enable = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in address;
+
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+            listen(listener, SOMAXCONN) < 0) {
+
+            close(listener);
+            return -1;
+        }
+
+        return listener;
+    }
+
+    void AcceptConnections(int epoll, int listener, Connections& connections)
+    {
+        for (;;) {
+            int fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+            if (fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                return;  // EAGAIN - no more pending connections, or error
+            }
+
+            int enable = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+            connections[fd] = Connection();
+            WatchConnection(epoll, fd, EPOLL_CTL_ADD, false);
+        }
+    }
+}
+
+int MockServer::run(unsigned short port)
+{
+    int listener = OpenListener(port);
+
+    if (listener < 0) {
+        std::cerr << "fatal: unable to listen on 127.0.0.1:" << port << ": " << strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+
+    if (epoll < 0) {
+        std::cerr << "fatal: unable to create epoll: " << strerror(errno) << "\n";
+        close(listener);
+        return EXIT_FAILURE;
+    }
+
+    WatchConnection(epoll, listener, EPOLL_CTL_ADD, false);
+
+    std::cerr << "mock server with " << routes_.size() << " actions listening on http://127.0.0.1:" << port << "\n";
+
+    Connections connections;
+    epoll_event events[MaxEvents];
+
+    for (;;) {
+
+        int count = epoll_wait(epoll, events, MaxEvents, -1);
+
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << "fatal: epoll_wait failed: " << strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+
+            int fd = events[i].data.fd;
+
+            if (fd == listener) {
+                AcceptConnections(epoll, listener, connections);
+                continue;
+            }
+
+            Connections::iterator it = connections.find(fd);
+
+            if (it == connections.end()) {
+                continue;
+            }
+
+            Connection& connection = it->second;
+            bool hadOutput = !connection.output.empty();
+            bool alive = !(events[i].events & EPOLLERR);
+
+            if (alive && (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP))) {
+                alive = ReadConnection(fd, *this, connection);
+            }
+
+            if (!connection.output.empty() && FlushConnection(fd, connection)) {
+
+                bool pending = !connection.output.empty();
+
+                // closing connection waits for its output only, half-closed peer would wake us up forever
+                if (pending != hadOutput || (pending && connection.close)) {
+                    WatchConnection(epoll, fd, EPOLL_CTL_MOD, pending, !connection.close);
+                }
+            }
+            else if (!connection.output.empty()) {
+                alive = false;
+            }
+
+            if (!alive || (connection.close && connection.output.empty())) {
+                epoll_ctl(epoll, EPOLL_CTL_DEL, fd, NULL);
+                close(fd);
+                connections.erase(it);
+            }
+        }
+    }
+
+    for (Connections::iterator it = connections.begin(); it != connections.end(); ++it) {
+        close(it->first);
+    }
+
+    close(epoll);
+    close(listener);
+
+    return EXIT_FAILURE;
+}
+
+#else
+
+int MockServer::run(unsigned short /* port */)
+{
+    std::cerr << "fatal: mock server is available on Linux only\n";
+    return EXIT_FAILURE;
+}
+
+#endif
@@ -0,0 +1,75 @@
+//
+// vi:cin:et:sw=4 ts=4
+//
+//  MockServer.h - part of drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_MOCK_SERVER_H
+#define DRAFTER_MOCK_SERVER_H
+
+#include "Blueprint.h"
+
+#include "Routes.h"
+#include "RouteMatcher.h"
+
+/**
+ *  \brief HTTP server answering requests with example responses of blueprint
+ *
+ *  Every action is answered by the first response of its first transaction
+ *  example. Responses (status line, headers and body) are rendered into byte
+ *  buffers once, in the constructor, the event loop only matches request to
+ *  route and copies prepared bytes to the socket.
+ *
+ *  Server listens on loopback only. It needs epoll, so it is available on
+ *  Linux only.
+ */
+class MockServer {
+public:
+
+    explicit MockServer(const snowcrash::Blueprint& blueprint);
+
+    /**
+     *  \brief Serve requests on 127.0.0.1:\param port, blocks until fatal error
+     *
+     *  \return EXIT_FAILURE if server can not be started or fails
+     */
+    int run(unsigned short port);
+
+    /**
+     *  \brief Return prepared response for request
+     *
+     *  HEAD request is answered by headers of GET response of the same
+     *  resource, if blueprint does not describe HEAD action itself.
+     *
+     *  \param method   HTTP method of request
+     *  \param uri      Request URI
+     */
+    const std::string& respond(const std::string& method, const std::string& uri) const;
+
+    /**
+     *  \brief Read body length from value of Content-Length header into \param length
+     *
+     *  Empty value means no body. Otherwise the value must be decimal digits,
+     *  optionally followed by spaces or tabs.
+     *
+     *  \return False if \param value is malformed or does not fit into size_t
+     */
+    static bool ParseContentLength(const std::string& value, size_t& length);
+
+private:
+
+    drafter::Routes routes_;
+    drafter::RouteMatcher matcher_;
+
+    std::vector<std::string> responses_;        ///< prepared response for each route
+    std::vector<std::string> headResponses_;    ///< responses_ without body, for HEAD requests
+    std::string notFound_;
+    std::string headNotFound_;
+
+    MockServer(const MockServer&);
+    MockServer& operator=(const MockServer&);
+};
+
+#endif /* end of include guard: DRAFTER_MOCK_SERVER_H */
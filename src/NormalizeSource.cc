@@ -0,0 +1,392 @@
+//
+//  NormalizeSource.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "NormalizeSource.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "PositionIndex.h"
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+using snowcrash::SourceMapBase;
+
+namespace {
+
+    const size_t TabStop = 4;
+
+    inline bool IsContinuation(unsigned char c)
+    {
+        return (c & 0xC0) == 0x80;
+    }
+
+    inline bool HasBOM(const mdp::ByteBuffer& source)
+    {
+        return source.size() >= 3 && source.compare(0, 3, "\xEF\xBB\xBF") == 0;
+    }
+
+    /**
+     *  \brief Offset of the first CR or tab in [\param begin, \param end) of \param data or \param end
+     */
+    size_t FindSpecial(const char* data, size_t begin, size_t end)
+    {
+        size_t i = begin;
+
+#if defined(__SSE2__)
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i tab = _mm_set1_epi8('\t');
+
+        for (; i + 16 <= end; i += 16) {
+
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, cr), _mm_cmpeq_epi8(block, tab)));
+
+            if (mask != 0) {
+                return i + __builtin_ctz(mask);
+            }
+        }
+#endif
+
+        for (; i < end; ++i) {
+            if (data[i] == '\r' || data[i] == '\t') {
+                return i;
+            }
+        }
+
+        return end;
+    }
+
+    /** Number of code points in [\param begin, \param end) of \param data */
+    size_t CountCodePoints(const char* data, size_t begin, size_t end)
+    {
+        size_t count = 0;
+
+        for (size_t i = begin; i < end; ++i) {
+            if (!IsContinuation(data[i])) {
+                ++count;
+            }
+        }
+
+        return count;
+    }
+
+    class Remapper {
+    public:
+
+        explicit Remapper(const SourceRemap& remap) : remap_(remap) {}
+
+        void operator()(mdp::BytesRangeSet& ranges) const
+        {
+            for (mdp::BytesRangeSet::iterator it = ranges.begin(); it != ranges.end(); ++it) {
+
+                size_t begin = remap_.originalOffset(it->location);
+                size_t end = remap_.originalOffset(it->location + it->length);
+
+                it->location = begin;
+                it->length = end - begin;
+            }
+        }
+
+    private:
+        const SourceRemap& remap_;
+    };
+
+    // Walk of source map tree, mirrors WrapBlueprintSourcemap()
+
+    void Remap(SourceMapBase& sourceMap, const Remapper& remapper)
+    {
+        remapper(sourceMap.sourceMap);
+    }
+
+    template<typename T>
+    void Remap(SourceMap<std::vector<T> >& collection, const Remapper& remapper)
+    {
+        remapper(collection.sourceMap);
+
+        for (typename SourceMap<std::vector<T> >::collection_type::iterator it = collection.collection.begin();
+             it != collection.collection.end();
+             ++it) {
+            Remap(*it, remapper);
+        }
+    }
+
+    void Remap(SourceMap<mson::Element>& element, const Remapper& remapper);
+
+    void Remap(SourceMap<mson::TypeSection>& section, const Remapper& remapper)
+    {
+        remapper(section.sourceMap);
+        Remap(section.description, remapper);
+        Remap(section.value, remapper);
+        Remap(section.elements(), remapper);
+    }
+
+    void Remap(SourceMap<mson::ValueMember>& value, const Remapper& remapper)
+    {
+        remapper(value.sourceMap);
+        Remap(value.description, remapper);
+        Remap(value.valueDefinition, remapper);
+        Remap(value.sections, remapper);
+    }
+
+    void Remap(SourceMap<mson::PropertyMember>& property, const Remapper& remapper)
+    {
+        Remap(static_cast<SourceMap<mson::ValueMember>&>(property), remapper);
+        Remap(property.name, remapper);
+    }
+
+    void Remap(SourceMap<mson::Element>& element, const Remapper& remapper)
+    {
+        remapper(element.sourceMap);
+        Remap(element.property, remapper);
+        Remap(element.value, remapper);
+        Remap(element.mixin, remapper);
+        Remap(element.elements(), remapper);
+    }
+
+    void Remap(SourceMap<mson::NamedType>& namedType, const Remapper& remapper)
+    {
+        remapper(namedType.sourceMap);
+        Remap(namedType.name, remapper);
+        Remap(namedType.typeDefinition, remapper);
+        Remap(namedType.sections, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Parameter>& parameter, const Remapper& remapper)
+    {
+        remapper(parameter.sourceMap);
+        Remap(parameter.name, remapper);
+        Remap(parameter.description, remapper);
+        Remap(parameter.type, remapper);
+        Remap(parameter.use, remapper);
+        Remap(parameter.defaultValue, remapper);
+        Remap(parameter.exampleValue, remapper);
+        Remap(parameter.values, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Payload>& payload, const Remapper& remapper)
+    {
+        remapper(payload.sourceMap);
+        Remap(payload.name, remapper);
+        Remap(payload.description, remapper);
+        Remap(payload.parameters, remapper);
+        Remap(payload.headers, remapper);
+        Remap(payload.body, remapper);
+        Remap(payload.schema, remapper);
+        Remap(payload.reference, remapper);
+        Remap(payload.attributes, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::TransactionExample>& example, const Remapper& remapper)
+    {
+        remapper(example.sourceMap);
+        Remap(example.name, remapper);
+        Remap(example.description, remapper);
+        Remap(example.requests, remapper);
+        Remap(example.responses, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Action>& action, const Remapper& remapper)
+    {
+        remapper(action.sourceMap);
+        Remap(action.method, remapper);
+        Remap(action.name, remapper);
+        Remap(action.description, remapper);
+        Remap(action.parameters, remapper);
+        Remap(action.headers, remapper);
+        Remap(action.examples, remapper);
+        Remap(action.relation, remapper);
+        Remap(action.uriTemplate, remapper);
+        Remap(action.attributes, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Resource>& resource, const Remapper& remapper)
+    {
+        remapper(resource.sourceMap);
+        Remap(resource.uriTemplate, remapper);
+        Remap(resource.name, remapper);
+        Remap(resource.description, remapper);
+        Remap(resource.model, remapper);
+        Remap(resource.parameters, remapper);
+        Remap(resource.headers, remapper);
+        Remap(resource.actions, remapper);
+        Remap(resource.attributes, remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Element>& element, const Remapper& remapper)
+    {
+        remapper(element.sourceMap);
+        Remap(element.attributes.name, remapper);
+        Remap(element.content.copy, remapper);
+        Remap(element.content.resource, remapper);
+        Remap(element.content.dataStructure, remapper);
+        Remap(element.content.elements(), remapper);
+    }
+
+    void Remap(SourceMap<snowcrash::Blueprint>& blueprint, const Remapper& remapper)
+    {
+        Remap(static_cast<SourceMap<snowcrash::Element>&>(blueprint), remapper);
+        Remap(blueprint.metadata, remapper);
+        Remap(blueprint.name, remapper);
+        Remap(blueprint.description, remapper);
+    }
+
+    /** Translate character ranges of normalized source to characters of original source */
+    void RemapLocation(mdp::CharactersRangeSet& location,
+                       const PositionIndex& sourceIndex,
+                       const PositionIndex& normalizedIndex,
+                       const SourceRemap& remap)
+    {
+        for (mdp::CharactersRangeSet::iterator it = location.begin(); it != location.end(); ++it) {
+
+            size_t begin = sourceIndex.codePointAt(remap.originalOffset(normalizedIndex.byteOfCodePoint(it->location)));
+            size_t end = sourceIndex.codePointAt(remap.originalOffset(normalizedIndex.byteOfCodePoint(it->location + it->length)));
+
+            it->location = begin;
+            it->length = end - begin;
+        }
+    }
+}
+
+bool SourceRemap::normalizedLess(size_t normalized, const Entry& entry)
+{
+    return normalized < entry.first;
+}
+
+size_t SourceRemap::originalOffset(size_t normalized) const
+{
+    std::vector<Entry>::const_iterator next = std::upper_bound(entries_.begin(), entries_.end(), normalized, normalizedLess);
+
+    size_t original = normalized;
+
+    if (next != entries_.begin()) {
+        std::vector<Entry>::const_iterator previous = next - 1;
+        original = previous->second + (normalized - previous->first);
+    }
+
+    if (next != entries_.end()) {
+        original = std::min(original, next->second - 1);
+    }
+
+    return original;
+}
+
+bool SourceRemap::empty() const
+{
+    return entries_.empty();
+}
+
+void SourceRemap::shift(size_t normalized, size_t original)
+{
+    entries_.push_back(Entry(normalized, original));
+}
+
+bool drafter::NormalizeSource(const mdp::ByteBuffer& source, mdp::ByteBuffer& normalized, SourceRemap& remap)
+{
+    const char* data = source.data();
+    const size_t size = source.size();
+
+    size_t i = HasBOM(source) ? 3 : 0;
+    size_t special = FindSpecial(data, i, size);
+
+    if (i == 0 && special == size) {
+        return false;
+    }
+
+    normalized.clear();
+    normalized.reserve(size + size / 16);
+
+    if (i != 0) {
+        remap.shift(0, i);
+    }
+
+    // Column of a tab is counted from the last offset with known column
+    size_t columnOffset = 0;
+    size_t column = 0;
+
+    while (true) {
+
+        if (special > i) {
+
+            normalized.append(data + i, special - i);
+
+            for (size_t j = special; j > i; --j) {
+                if (data[j - 1] == '\n') {
+                    columnOffset = normalized.size() - (special - j);
+                    column = 0;
+                    break;
+                }
+            }
+
+            i = special;
+        }
+
+        if (i == size) {
+            break;
+        }
+
+        if (data[i] == '\r') {
+
+            normalized += '\n';
+
+            i += (i + 1 < size && data[i + 1] == '\n') ? 2 : 1;
+
+            if (data[i - 1] == '\n') {
+                remap.shift(normalized.size(), i);
+            }
+
+            columnOffset = normalized.size();
+            column = 0;
+        }
+        else {  // tab
+
+            column += CountCodePoints(normalized.data(), columnOffset, normalized.size());
+
+            size_t spaces = TabStop - column % TabStop;
+
+            normalized.append(spaces, ' ');
+            ++i;
+
+            if (spaces > 1) {
+                remap.shift(normalized.size(), i);
+            }
+
+            columnOffset = normalized.size();
+            column += spaces;
+        }
+
+        special = FindSpecial(data, i, size);
+    }
+
+    return true;
+}
+
+void drafter::RemapSourceMap(SourceMap<snowcrash::Blueprint>& sourceMap, const SourceRemap& remap)
+{
+    Remap(sourceMap, Remapper(remap));
+}
+
+void drafter::RemapParseResult(const mdp::ByteBuffer& source,
+                               const mdp::ByteBuffer& normalized,
+                               const SourceRemap& remap,
+                               const snowcrash::ParseResultRef<snowcrash::Blueprint>& result)
+{
+    RemapSourceMap(result.sourceMap, remap);
+
+    PositionIndex sourceIndex(source);
+    PositionIndex normalizedIndex(normalized);
+
+    RemapLocation(result.report.error.location, sourceIndex, normalizedIndex, remap);
+
+    for (snowcrash::Warnings::iterator it = result.report.warnings.begin(); it != result.report.warnings.end(); ++it) {
+        RemapLocation(it->location, sourceIndex, normalizedIndex, remap);
+    }
+}
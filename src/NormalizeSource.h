@@ -0,0 +1,78 @@
+//
+//  NormalizeSource.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_NORMALIZE_SOURCE_H
+#define DRAFTER_NORMALIZE_SOURCE_H
+
+#include <utility>
+#include <vector>
+
+#include "snowcrash.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Translates byte offsets of normalized source back to the original source
+     *
+     *  Only offsets after a removed BOM or CR and after an expanded tab are
+     *  kept, as pairs of normalized and original offset. Offsets between
+     *  them are shifted by the previous pair, but never reach the original
+     *  offset of the next one - spaces of a tab all map to the tab.
+     */
+    class SourceRemap {
+    public:
+
+        /** Offset in original source of \param normalized offset */
+        size_t originalOffset(size_t normalized) const;
+
+        bool empty() const;
+
+        /** From \param normalized on offsets are shifted to \param original */
+        void shift(size_t normalized, size_t original);
+
+    private:
+
+        typedef std::pair<size_t, size_t> Entry;   // normalized, original
+
+        std::vector<Entry> entries_;
+
+        static bool normalizedLess(size_t normalized, const Entry& entry);
+    };
+
+    /**
+     *  \brief Normalize line endings, byte order mark and tabs in one pass
+     *
+     *  UTF-8 BOM is dropped, CR LF and lone CR become LF and tabs are
+     *  expanded to 4-column tab stops - the same the Markdown parser does
+     *  line by line. Input is scanned 16 bytes at once where SSE2 is
+     *  available, runs without CR or tab are copied as they are.
+     *
+     *  \param source       Source to normalize
+     *  \param normalized   Output - normalized source, untouched if nothing to normalize
+     *  \param remap        Output - offsets of \param normalized in \param source
+     *  \return False if \param source is already normalized
+     */
+    bool NormalizeSource(const mdp::ByteBuffer& source, mdp::ByteBuffer& normalized, SourceRemap& remap);
+
+    /**
+     *  \brief Translate byte ranges of \param sourceMap by \param remap
+     */
+    void RemapSourceMap(snowcrash::SourceMap<snowcrash::Blueprint>& sourceMap, const SourceRemap& remap);
+
+    /**
+     *  \brief Translate source maps and annotation locations of result parsed from normalized source
+     *
+     *  Byte ranges of source maps and character ranges of the error and
+     *  warnings are translated to \param source.
+     */
+    void RemapParseResult(const mdp::ByteBuffer& source,
+                          const mdp::ByteBuffer& normalized,
+                          const SourceRemap& remap,
+                          const snowcrash::ParseResultRef<snowcrash::Blueprint>& result);
+}
+
+#endif // #ifndef DRAFTER_NORMALIZE_SOURCE_H
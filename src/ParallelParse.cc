@@ -0,0 +1,395 @@
+//
+//  ParallelParse.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "ParallelParse.h"
+#include "NormalizeSource.h"
+#include "BlueprintSegments.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+using snowcrash::ParseResult;
+using snowcrash::Report;
+using snowcrash::Warnings;
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Blueprint;
+
+namespace {
+
+    /**
+     *  \brief Neighbouring segments parsed together
+     */
+    struct Chunk {
+        size_t begin, end;                  ///< byte range in source
+        bool dataStructures;                ///< chunk is data structures segment
+        size_t dataStructuresBefore;        ///< data structures sections of other chunks before chunk
+        size_t dataStructuresAfter;         ///< and after it
+
+        ParseResult<Blueprint> result;      ///< output - with warnings of chunk only
+        bool merge;                         ///< output - result can be merged
+
+        Chunk(size_t begin_, size_t end_, bool dataStructures_)
+        : begin(begin_), end(end_), dataStructures(dataStructures_),
+          dataStructuresBefore(0), dataStructuresAfter(0), merge(false) {}
+    };
+
+    typedef std::vector<Chunk> Chunks;
+
+    inline bool IsContinuation(char c)
+    {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    /**
+     *  \brief Translates byte offsets of UTF-8 buffer to character indexes and back
+     *
+     *  Number of characters is kept at every Stride bytes, so a translation
+     *  scans at most Stride bytes.
+     */
+    class CharacterIndex {
+    public:
+
+        static const size_t Stride = 4096;
+
+        explicit CharacterIndex(const std::string& buffer) : buffer_(buffer)
+        {
+            size_t characters = 0;
+
+            checkpoints_.reserve(buffer.size() / Stride + 1);
+
+            for (size_t begin = 0; begin <= buffer.size(); begin += Stride) {
+
+                checkpoints_.push_back(characters);
+
+                size_t end = std::min(begin + Stride, buffer.size());
+
+                for (size_t i = begin; i < end; ++i) {
+                    if (!IsContinuation(buffer[i])) {
+                        ++characters;
+                    }
+                }
+            }
+        }
+
+        /** Index of character at \param byte */
+        size_t characterAt(size_t byte) const
+        {
+            byte = std::min(byte, buffer_.size());
+
+            size_t position = byte - byte % Stride;
+            size_t characters = checkpoints_[position / Stride];
+
+            for (; position < byte; ++position) {
+                if (!IsContinuation(buffer_[position])) {
+                    ++characters;
+                }
+            }
+
+            return characters;
+        }
+
+        /** Offset of the first byte of \param character */
+        size_t byteAt(size_t character) const
+        {
+            size_t checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), character) - checkpoints_.begin() - 1;
+
+            size_t position = checkpoint * Stride;
+            size_t characters = checkpoints_[checkpoint];
+
+            while (position < buffer_.size() && (characters < character || IsContinuation(buffer_[position]))) {
+
+                if (!IsContinuation(buffer_[position])) {
+                    ++characters;
+                }
+
+                ++position;
+            }
+
+            return position;
+        }
+
+    private:
+        const std::string& buffer_;
+        std::vector<size_t> checkpoints_;
+    };
+
+    /**
+     *  \brief Join neighbouring segments into chunks of about \param chunkSize
+     *
+     *  Data structures segments stay alone, they are part of every chunk.
+     */
+    void MakeChunks(const Segments& segments, size_t chunkSize, Chunks& chunks)
+    {
+        size_t dataStructures = 0;
+
+        for (Segments::const_iterator it = segments.begin(); it != segments.end(); ++it) {
+
+            bool isDataStructures = (it->kind == DataStructuresSegment);
+
+            if (!isDataStructures && !chunks.empty() && !chunks.back().dataStructures &&
+                chunks.back().end - chunks.back().begin < chunkSize) {
+
+                chunks.back().end = it->end;
+                continue;
+            }
+
+            chunks.push_back(Chunk(it->begin, it->end, isDataStructures));
+            chunks.back().dataStructuresBefore = dataStructures;
+
+            if (isDataStructures) {
+                ++dataStructures;
+            }
+        }
+
+        for (Chunks::iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            it->dataStructuresAfter = dataStructures - it->dataStructuresBefore - (it->dataStructures ? 1 : 0);
+        }
+    }
+
+    /**
+     *  \brief Parse \param chunk with API name and all data structures sections around it
+     */
+    void ParseChunk(Chunk& chunk,
+                    const Chunks& chunks,
+                    const std::string& source,
+                    const CharacterIndex& sourceIndex,
+                    size_t nameEnd,
+                    snowcrash::BlueprintParserOptions options)
+    {
+        // same length as source so source maps are valid in source
+        std::string padded(source.size(), '\n');
+
+        padded.replace(0, nameEnd, source, 0, nameEnd);
+
+        for (Chunks::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            if (it->dataStructures || &*it == &chunk) {
+                padded.replace(it->begin, it->end - it->begin, source, it->begin, it->end - it->begin);
+            }
+        }
+
+        snowcrash::parse(padded, options, chunk.result);
+
+        if (chunk.result.report.error.code != snowcrash::Error::OK) {
+            return;
+        }
+
+        // data structures sections of other chunks must be on their places
+        const Elements& elements = chunk.result.node.content.elements();
+
+        if (elements.size() < chunk.dataStructuresBefore + chunk.dataStructuresAfter) {
+            return;
+        }
+
+        for (size_t i = 0; i < elements.size(); ++i) {
+
+            bool context = (i < chunk.dataStructuresBefore || i >= elements.size() - chunk.dataStructuresAfter);
+
+            if (context && !IsDataStructuresElement(elements[i])) {
+                return;
+            }
+        }
+
+        // keep warnings of chunk, locations as in source
+        CharacterIndex paddedIndex(padded);
+        Warnings warnings;
+
+        for (Warnings::const_iterator it = chunk.result.report.warnings.begin();
+             it != chunk.result.report.warnings.end();
+             ++it) {
+
+            if (it->location.empty()) {
+
+                if (chunk.begin == 0) {
+                    warnings.push_back(*it);
+                }
+
+                continue;
+            }
+
+            size_t first = paddedIndex.byteAt(it->location.begin()->location);
+
+            if (first < chunk.begin || first >= chunk.end) {
+                continue;
+            }
+
+            warnings.push_back(*it);
+
+            for (mdp::CharactersRangeSet::iterator range = warnings.back().location.begin();
+                 range != warnings.back().location.end();
+                 ++range) {
+
+                size_t begin = sourceIndex.characterAt(paddedIndex.byteAt(range->location));
+                size_t end = sourceIndex.characterAt(paddedIndex.byteAt(range->location + range->length));
+
+                range->location = begin;
+                range->length = end - begin;
+            }
+        }
+
+        chunk.result.report.warnings.swap(warnings);
+        chunk.merge = true;
+    }
+
+    void ParseChunks(Chunks& chunks,
+                     const std::string& source,
+                     size_t nameEnd,
+                     snowcrash::BlueprintParserOptions options,
+                     unsigned int threads)
+    {
+        CharacterIndex sourceIndex(source);
+        std::atomic<size_t> next(0);
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < chunks.size(); i = next++) {
+                ParseChunk(chunks[i], chunks, source, sourceIndex, nameEnd, options);
+            }
+        };
+
+        std::vector<std::thread> workers;
+
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.push_back(std::thread(worker));
+        }
+
+        worker();
+
+        for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+            it->join();
+        }
+    }
+
+    /**
+     *  \brief Check no resource URI template or name is in more chunks
+     */
+    bool HasUniqueResources(const Chunks& chunks)
+    {
+        std::vector<ElementsRange> parts;
+
+        for (Chunks::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+
+            const Elements& elements = it->result.node.content.elements();
+
+            // data structures sections of other chunks are not part of chunk
+            ElementsRange part = { elements.begin() + it->dataStructuresBefore, elements.end() - it->dataStructuresAfter };
+            parts.push_back(part);
+        }
+
+        return drafter::HasUniqueResources(parts);
+    }
+
+    /**
+     *  \brief Append elements of chunk without data structures sections of other chunks
+     */
+    template<typename T>
+    void AppendOwn(const std::vector<T>& from, const Chunk& chunk, std::vector<T>& to)
+    {
+        if (from.size() < chunk.dataStructuresBefore + chunk.dataStructuresAfter) {
+            return;
+        }
+
+        to.insert(to.end(), from.begin() + chunk.dataStructuresBefore, from.end() - chunk.dataStructuresAfter);
+    }
+}
+
+/**
+ *  \brief Parse normalized \param source in chunks
+ *
+ *  \param merged  Number of merged chunks as output, left unchanged if parsed serially
+ */
+static int ParseChunked(const mdp::ByteBuffer& source,
+                        snowcrash::BlueprintParserOptions options,
+                        const snowcrash::ParseResultRef<Blueprint>& out,
+                        unsigned int threads,
+                        size_t& merged)
+{
+    Segments segments;
+    size_t nameEnd = 0;
+
+    if (threads <= 1 || !ScanSegments(source, segments, nameEnd) || segments.size() < 2) {
+        return snowcrash::parse(source, options, out);
+    }
+
+    Chunks chunks;
+    MakeChunks(segments, (source.size() + threads - 1) / threads, chunks);
+
+    if (chunks.size() < 2) {
+        return snowcrash::parse(source, options, out);
+    }
+
+    ParseChunks(chunks, source, nameEnd, options, std::min(threads, static_cast<unsigned int>(chunks.size())));
+
+    for (Chunks::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+        if (!it->merge) {
+            return snowcrash::parse(source, options, out);
+        }
+    }
+
+    if (!HasUniqueResources(chunks)) {
+        return snowcrash::parse(source, options, out);
+    }
+
+    // name, description and metadata come from the first chunk
+    const Chunk& first = chunks.front();
+
+    out.node = first.result.node;
+    out.node.content.elements().clear();
+
+    out.sourceMap = first.result.sourceMap;
+    out.sourceMap.content.elements().collection.clear();
+
+    out.report.error = first.result.report.error;
+    out.report.warnings.clear();
+
+    for (Chunks::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+
+        AppendOwn(it->result.node.content.elements(), *it, out.node.content.elements());
+        AppendOwn(it->result.sourceMap.content.elements().collection, *it, out.sourceMap.content.elements().collection);
+
+        out.report.warnings.insert(out.report.warnings.end(),
+                                   it->result.report.warnings.begin(),
+                                   it->result.report.warnings.end());
+    }
+
+    merged = chunks.size();
+
+    return out.report.error.code;
+}
+
+int drafter::ParseBlueprintParallel(const mdp::ByteBuffer& source,
+                                    snowcrash::BlueprintParserOptions options,
+                                    const snowcrash::ParseResultRef<Blueprint>& out,
+                                    unsigned int threads,
+                                    ParallelParseStatistics* statistics)
+{
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+
+    size_t merged = 0;
+
+    mdp::ByteBuffer normalized;
+    SourceRemap remap;
+
+    if (!NormalizeSource(source, normalized, remap)) {
+        ParseChunked(source, options, out, threads, merged);
+    }
+    else {
+        ParseChunked(normalized, options, out, threads, merged);
+        RemapParseResult(source, normalized, remap, out);
+    }
+
+    if (statistics) {
+        statistics->chunks = merged;
+    }
+
+    return out.report.error.code;
+}
@@ -0,0 +1,56 @@
+//
+//  ParallelParse.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_PARALLEL_PARSE_H
+#define DRAFTER_PARALLEL_PARSE_H
+
+#include "snowcrash.h"
+
+namespace drafter {
+
+    struct ParallelParseStatistics {
+        size_t chunks;          ///< chunks parsed concurrently and merged, 0 if parsed serially
+    };
+
+    /**
+     *  \brief Parse huge blueprint on more cores, split at top-level headings
+     *
+     *  Source is split before every `# Group ...` and `# Data Structures`
+     *  heading outside code fences. Neighbouring groups are joined into
+     *  chunks of similar size and chunks are parsed concurrently. Each
+     *  chunk is parsed in a copy of source of the same length where
+     *  everything else is blanked, except API name (with metadata) and data
+     *  structures sections - named types are resolved across the whole
+     *  blueprint and source maps need no rebasing. Warnings of other parts
+     *  are dropped and annotation locations are translated back to
+     *  characters of \param source.
+     *
+     *  Merged result is the same as of ParseBlueprint() - elements, source
+     *  maps and warnings in document order. Whenever it might differ -
+     *  any chunk fails, the same resource URI template or resource name
+     *  is in more chunks (snowcrash checks those across the document) or
+     *  source has no API name or splitting headings - \param source is
+     *  parsed serially instead. Source is normalized by NormalizeSource()
+     *  first, as in ParseBlueprint().
+     *
+     *  \param source       A textual source data to be parsed.
+     *  \param options      Parser options. Use 0 for no additional options.
+     *  \param out          Output buffer to store parsing result into.
+     *  \param threads      Maximal number of concurrent parses, 0 for number of cores.
+     *                      1 parses serially - concurrent parse is opt-in until
+     *                      snowcrash passes `make test-tsan`.
+     *  \param statistics   Optional output, tells whether the result was merged from chunks
+     *  \return Error status code. Zero represents success, non-zero a failure.
+     */
+    int ParseBlueprintParallel(const mdp::ByteBuffer& source,
+                               snowcrash::BlueprintParserOptions options,
+                               const snowcrash::ParseResultRef<snowcrash::Blueprint>& out,
+                               unsigned int threads = 1,
+                               ParallelParseStatistics* statistics = NULL);
+}
+
+#endif // #ifndef DRAFTER_PARALLEL_PARSE_H
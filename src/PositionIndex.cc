@@ -0,0 +1,343 @@
+//
+//  PositionIndex.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "PositionIndex.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Serialize.h"
+
+using namespace drafter;
+
+namespace {
+
+    inline bool IsContinuation(unsigned char c)
+    {
+        return (c & 0xC0) == 0x80;
+    }
+
+    /**
+     *  \brief Add code points and UTF-16 units of \param length bytes at \param data
+     *
+     *  If \param lineStarts is given offsets (from \param base) after every
+     *  new line are appended to it.
+     */
+    template<typename Counts>
+    void CountRange(const char* data, size_t length, Counts& counts, std::vector<size_t>* lineStarts, size_t base)
+    {
+        size_t i = 0;
+
+        while (i < length) {
+
+#if defined(__SSE2__)
+            if (i + 16 <= length) {
+
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+                // all ASCII - one code point and one UTF-16 unit per byte
+                if (_mm_movemask_epi8(block) == 0) {
+
+                    counts.codePoints += 16;
+                    counts.utf16 += 16;
+
+                    if (lineStarts) {
+                        unsigned int newLines = _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+
+                        for (; newLines; newLines &= newLines - 1) {
+                            lineStarts->push_back(base + i + __builtin_ctz(newLines) + 1);
+                        }
+                    }
+
+                    i += 16;
+                    continue;
+                }
+            }
+#endif
+
+            unsigned char c = static_cast<unsigned char>(data[i]);
+
+            if (!IsContinuation(c)) {
+                ++counts.codePoints;
+                ++counts.utf16;
+
+                // four byte sequence is a surrogate pair in UTF-16
+                if (c >= 0xF0) {
+                    ++counts.utf16;
+                }
+            }
+
+            if (c == '\n' && lineStarts) {
+                lineStarts->push_back(base + i + 1);
+            }
+
+            ++i;
+        }
+    }
+
+    bool IsRange(const sos::Base& value)
+    {
+        return value.type == sos::Base::ArrayType &&
+               value.array.size() == 2 &&
+               value.array[0].type == sos::Base::NumberType &&
+               value.array[1].type == sos::Base::NumberType;
+    }
+
+    /**
+     *  \brief Convert byte range [begin, end) to \param unit, as `[location, length]` or `[line, column, end line, end column]`
+     */
+    void ConvertRange(size_t begin, size_t end, const PositionIndex& index, PositionUnit unit, sos::Bases& out)
+    {
+        out.clear();
+
+        switch (unit) {
+            case CodePointPositions:
+            {
+                size_t location = index.codePointAt(begin);
+
+                out.push_back(sos::Number(location));
+                out.push_back(sos::Number(index.codePointAt(end) - location));
+                break;
+            }
+
+            case UTF16Positions:
+            {
+                size_t location = index.utf16At(begin);
+
+                out.push_back(sos::Number(location));
+                out.push_back(sos::Number(index.utf16At(end) - location));
+                break;
+            }
+
+            case LineColumnPositions:
+            {
+                size_t line, column;
+
+                index.lineColumnAt(begin, line, column);
+                out.push_back(sos::Number(line));
+                out.push_back(sos::Number(column));
+
+                index.lineColumnAt(end, line, column);
+                out.push_back(sos::Number(line));
+                out.push_back(sos::Number(column));
+                break;
+            }
+
+            default:
+                out.push_back(sos::Number(begin));
+                out.push_back(sos::Number(end - begin));
+                break;
+        }
+    }
+
+    void ConvertAnnotation(sos::Base& annotation, const PositionIndex& index, PositionUnit unit)
+    {
+        static const std::string Line = "line";
+        static const std::string Column = "column";
+        static const std::string EndLine = "endLine";
+        static const std::string EndColumn = "endColumn";
+
+        sos::KeyValues::iterator location = annotation.object.find(SerializeKey::AnnotationLocation);
+
+        if (location == annotation.object.end()) {
+            return;
+        }
+
+        sos::Bases converted;
+
+        for (sos::Bases::iterator it = location->second.array.begin(); it != location->second.array.end(); ++it) {
+
+            sos::KeyValues::const_iterator indexValue = it->object.find(SerializeKey::AnnotationLocationIndex);
+            sos::KeyValues::const_iterator lengthValue = it->object.find(SerializeKey::AnnotationLocationLength);
+
+            if (indexValue == it->object.end() || lengthValue == it->object.end()) {
+                continue;
+            }
+
+            // annotations are in characters
+            size_t character = static_cast<size_t>(indexValue->second.number);
+            size_t begin = index.byteOfCodePoint(character);
+            size_t end = index.byteOfCodePoint(character + static_cast<size_t>(lengthValue->second.number));
+
+            ConvertRange(begin, end, index, unit, converted);
+
+            sos::Object range;
+
+            if (unit == LineColumnPositions) {
+                range.set(Line, converted[0]);
+                range.set(Column, converted[1]);
+                range.set(EndLine, converted[2]);
+                range.set(EndColumn, converted[3]);
+            }
+            else {
+                range.set(SerializeKey::AnnotationLocationIndex, converted[0]);
+                range.set(SerializeKey::AnnotationLocationLength, converted[1]);
+            }
+
+            *it = range;
+        }
+    }
+}
+
+const size_t PositionIndex::Stride;
+
+PositionIndex::PositionIndex(const mdp::ByteBuffer& source) : source_(source)
+{
+    Counts counts = { 0, 0 };
+
+    checkpoints_.reserve(source.size() / Stride + 1);
+    lineStarts_.push_back(0);
+
+    for (size_t begin = 0; begin <= source.size(); begin += Stride) {
+
+        checkpoints_.push_back(counts);
+
+        size_t length = std::min(Stride, source.size() - begin);
+        CountRange(source.data() + begin, length, counts, &lineStarts_, begin);
+    }
+}
+
+PositionIndex::Counts PositionIndex::countsAt(size_t byte) const
+{
+    byte = std::min(byte, source_.size());
+
+    size_t checkpoint = byte / Stride;
+    Counts counts = checkpoints_[checkpoint];
+
+    CountRange(source_.data() + checkpoint * Stride, byte - checkpoint * Stride, counts, NULL, 0);
+
+    return counts;
+}
+
+size_t PositionIndex::codePointAt(size_t byte) const
+{
+    return countsAt(byte).codePoints;
+}
+
+size_t PositionIndex::utf16At(size_t byte) const
+{
+    return countsAt(byte).utf16;
+}
+
+void PositionIndex::lineColumnAt(size_t byte, size_t& line, size_t& column) const
+{
+    byte = std::min(byte, source_.size());
+
+    line = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), byte) - lineStarts_.begin();
+    column = codePointAt(byte) - codePointAt(lineStarts_[line - 1]) + 1;
+}
+
+void PositionIndex::lineUTF16ColumnAt(size_t byte, size_t& line, size_t& column) const
+{
+    byte = std::min(byte, source_.size());
+
+    line = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), byte) - lineStarts_.begin();
+    column = utf16At(byte) - utf16At(lineStarts_[line - 1]) + 1;
+}
+
+size_t PositionIndex::byteOfLineUTF16Column(size_t line, size_t column) const
+{
+    if (line == 0) {
+        return 0;
+    }
+
+    if (line > lineStarts_.size()) {
+        return source_.size();
+    }
+
+    size_t position = lineStarts_[line - 1];
+    size_t units = 1;
+
+    while (position < source_.size() && source_[position] != '\n' && units < column) {
+
+        unsigned char c = static_cast<unsigned char>(source_[position]);
+        units += c >= 0xF0 ? 2 : 1;
+
+        // skip continuation bytes of the code point
+        for (++position; position < source_.size() && IsContinuation(static_cast<unsigned char>(source_[position])); ++position);
+    }
+
+    return position;
+}
+
+bool PositionIndex::codePointsLess(size_t codePoint, const Counts& counts)
+{
+    return codePoint < counts.codePoints;
+}
+
+size_t PositionIndex::byteOfCodePoint(size_t codePoint) const
+{
+    size_t checkpoint = std::upper_bound(checkpoints_.begin(), checkpoints_.end(), codePoint, codePointsLess) - checkpoints_.begin() - 1;
+
+    size_t position = checkpoint * Stride;
+    size_t codePoints = checkpoints_[checkpoint].codePoints;
+
+    while (position < source_.size() &&
+           (codePoints < codePoint || IsContinuation(static_cast<unsigned char>(source_[position])))) {
+
+        if (!IsContinuation(static_cast<unsigned char>(source_[position]))) {
+            ++codePoints;
+        }
+
+        ++position;
+    }
+
+    return position;
+}
+
+void drafter::ConvertSourcemapPositions(sos::Base& sourceMap, const PositionIndex& index, PositionUnit unit)
+{
+    if (unit == BytePositions) {
+        return;
+    }
+
+    if (IsRange(sourceMap)) {
+        size_t begin = static_cast<size_t>(sourceMap.array[0].number);
+        size_t end = begin + static_cast<size_t>(sourceMap.array[1].number);
+
+        ConvertRange(begin, end, index, unit, sourceMap.array);
+        return;
+    }
+
+    for (sos::Bases::iterator it = sourceMap.array.begin(); it != sourceMap.array.end(); ++it) {
+        ConvertSourcemapPositions(*it, index, unit);
+    }
+
+    for (sos::KeyValues::iterator it = sourceMap.object.begin(); it != sourceMap.object.end(); ++it) {
+        ConvertSourcemapPositions(it->second, index, unit);
+    }
+}
+
+void drafter::ConvertResultPositions(sos::Object& result, const PositionIndex& index, PositionUnit unit)
+{
+    if (unit == BytePositions) {
+        return;
+    }
+
+    sos::KeyValues::iterator sourceMap = result.object.find(SerializeKey::SourceMap);
+
+    if (sourceMap != result.object.end()) {
+        ConvertSourcemapPositions(sourceMap->second, index, unit);
+    }
+
+    sos::KeyValues::iterator error = result.object.find(SerializeKey::Error);
+
+    if (error != result.object.end()) {
+        ConvertAnnotation(error->second, index, unit);
+    }
+
+    sos::KeyValues::iterator warnings = result.object.find(SerializeKey::Warnings);
+
+    if (warnings != result.object.end()) {
+        for (sos::Bases::iterator it = warnings->second.array.begin(); it != warnings->second.array.end(); ++it) {
+            ConvertAnnotation(*it, index, unit);
+        }
+    }
+}
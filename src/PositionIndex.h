@@ -0,0 +1,96 @@
+//
+//  PositionIndex.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_POSITION_INDEX_H
+#define DRAFTER_POSITION_INDEX_H
+
+#include <vector>
+
+#include "ByteBuffer.h"
+#include "sos.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Units of positions in serialized source maps and annotations
+     */
+    enum PositionUnit {
+        BytePositions = 0,          ///< as parsed - source maps in bytes, annotations in characters
+        CodePointPositions,         ///< Unicode code points
+        UTF16Positions,             ///< UTF-16 code units, as JavaScript strings count
+        LineColumnPositions         ///< 1-based line and column (code points) of start and end
+    };
+
+    /**
+     *  \brief Translates byte offsets in UTF-8 source into other units
+     *
+     *  Built once per document. Number of code points and UTF-16 units is
+     *  kept at every Stride bytes and offset of every line start is kept, so
+     *  a translation looks at most Stride bytes. Runs of ASCII are counted
+     *  16 bytes at once where SSE2 is available.
+     */
+    class PositionIndex {
+    public:
+
+        static const size_t Stride = 1024;
+
+        explicit PositionIndex(const mdp::ByteBuffer& source);
+
+        /** Number of code points before \param byte */
+        size_t codePointAt(size_t byte) const;
+
+        /** Number of UTF-16 code units before \param byte */
+        size_t utf16At(size_t byte) const;
+
+        /** 1-based line and column (in code points) of \param byte */
+        void lineColumnAt(size_t byte, size_t& line, size_t& column) const;
+
+        /** Offset of the first byte of code point \param codePoint */
+        size_t byteOfCodePoint(size_t codePoint) const;
+
+        /** 1-based line and column (in UTF-16 code units) of \param byte, as editors count */
+        void lineUTF16ColumnAt(size_t byte, size_t& line, size_t& column) const;
+
+        /** Offset of 1-based \param line and \param column in UTF-16 code units, clamped to the line */
+        size_t byteOfLineUTF16Column(size_t line, size_t column) const;
+
+    private:
+
+        struct Counts {
+            size_t codePoints;
+            size_t utf16;
+        };
+
+        const mdp::ByteBuffer& source_;
+        std::vector<Counts> checkpoints_;           ///< counts before every Stride bytes
+        std::vector<size_t> lineStarts_;
+
+        Counts countsAt(size_t byte) const;
+
+        static bool codePointsLess(size_t codePoint, const Counts& counts);
+    };
+
+    /**
+     *  \brief Convert byte ranges of wrapped source map to \param unit
+     *
+     *  Every `[location, length]` row of \param sourceMap (as produced by
+     *  WrapBlueprintSourcemap()) is replaced by `[location, length]` in
+     *  \param unit, or by `[line, column, end line, end column]` for
+     *  LineColumnPositions - end is the position just after the range.
+     */
+    void ConvertSourcemapPositions(sos::Base& sourceMap, const PositionIndex& index, PositionUnit unit);
+
+    /**
+     *  \brief Convert source map and annotation locations of wrapped parse result to \param unit
+     *
+     *  Annotation `{index, length}` locations are in characters as parsed,
+     *  for LineColumnPositions they become `{line, column, endLine, endColumn}`.
+     */
+    void ConvertResultPositions(sos::Object& result, const PositionIndex& index, PositionUnit unit);
+}
+
+#endif // #ifndef DRAFTER_POSITION_INDEX_H
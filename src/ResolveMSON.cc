@@ -0,0 +1,271 @@
+//
+//  ResolveMSON.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "ResolveMSON.h"
+
+using namespace drafter;
+
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Payload;
+using snowcrash::TransactionExample;
+using snowcrash::TransactionExamples;
+using snowcrash::Action;
+using snowcrash::Actions;
+using snowcrash::Resource;
+using snowcrash::Blueprint;
+
+/** Members of all member sections of \param type */
+static mson::Elements Members(const mson::NamedType& type)
+{
+    mson::Elements members;
+
+    for (mson::TypeSections::const_iterator it = type.sections.begin(); it != type.sections.end(); ++it) {
+        if (it->klass == mson::TypeSection::MemberTypeClass) {
+            const mson::Elements& elements = it->content.elements();
+            members.insert(members.end(), elements.begin(), elements.end());
+        }
+    }
+
+    return members;
+}
+
+MSONResolver::MSONResolver(const Blueprint& blueprint)
+{
+    collect(blueprint.content.elements());
+}
+
+void MSONResolver::collect(const Elements& elements)
+{
+    for (Elements::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+
+        const mson::NamedType* type = NULL;
+
+        if (it->element == Element::DataStructureElement) {
+            type = &it->content.dataStructure;
+        }
+        else if (it->element == Element::ResourceElement) {
+            type = &it->content.resource.attributes;
+        }
+        else if (it->element == Element::CategoryElement) {
+            collect(it->content.elements());
+        }
+
+        if (type && !type->name.symbol.literal.empty()) {
+
+            Entry& entry = entries_[type->name.symbol.literal];
+
+            if (!entry.definition) {
+                entry.definition = type;
+            }
+        }
+    }
+}
+
+const mson::NamedType* MSONResolver::resolved(const std::string& name)
+{
+    Entries::iterator it = entries_.find(name);
+
+    if (it == entries_.end()) {
+        return NULL;
+    }
+
+    Entry& entry = it->second;
+
+    if (entry.state == ResolvingState) {
+        recursive_.insert(name);
+        return NULL;
+    }
+
+    if (entry.state == UnresolvedState) {
+
+        entry.state = ResolvingState;
+
+        mson::NamedType type = *entry.definition;
+        resolve(type.typeDefinition, type.sections);
+
+        entry.resolved = type;
+        entry.state = ResolvedState;
+    }
+
+    return &entry.resolved;
+}
+
+void MSONResolver::resolve(mson::NamedType& dataStructure)
+{
+    Entries::iterator it = entries_.find(dataStructure.name.symbol.literal);
+
+    if (it != entries_.end() && it->second.definition == &dataStructure) {
+
+        const mson::NamedType* type = resolved(it->first);
+
+        if (type) {
+            dataStructure = *type;
+            return;
+        }
+    }
+
+    resolve(dataStructure.typeDefinition, dataStructure.sections);
+}
+
+const std::set<std::string>& MSONResolver::recursive() const
+{
+    return recursive_;
+}
+
+const mson::NamedType* MSONResolver::inherited(const mson::TypeName& typeName)
+{
+    if (typeName.base != mson::UndefinedTypeName || typeName.symbol.variable || typeName.symbol.literal.empty()) {
+        return NULL;
+    }
+
+    return resolved(typeName.symbol.literal);
+}
+
+void MSONResolver::resolve(mson::TypeDefinition& typeDefinition, mson::TypeSections& sections)
+{
+    for (mson::TypeSections::iterator it = sections.begin(); it != sections.end(); ++it) {
+        if (it->klass == mson::TypeSection::MemberTypeClass) {
+            resolve(it->content.elements());
+        }
+    }
+
+    const mson::NamedType* ancestor = inherited(typeDefinition.typeSpecification.name);
+
+    if (!ancestor) {
+        return;
+    }
+
+    typeDefinition.typeSpecification = ancestor->typeDefinition.typeSpecification;
+
+    mson::Elements members = Members(*ancestor);
+
+    if (members.empty()) {
+        return;
+    }
+
+    mson::TypeSections::iterator own = sections.begin();
+
+    while (own != sections.end() && own->klass != mson::TypeSection::MemberTypeClass) {
+        ++own;
+    }
+
+    if (own == sections.end()) {
+        own = sections.insert(own, mson::TypeSection(mson::TypeSection::MemberTypeClass));
+    }
+
+    mson::Elements& elements = own->content.elements();
+    elements.insert(elements.begin(), members.begin(), members.end());
+}
+
+void MSONResolver::resolve(mson::Elements& elements)
+{
+    for (size_t i = 0; i < elements.size();) {
+
+        mson::Element& element = elements[i];
+
+        switch (element.klass) {
+            case mson::Element::MixinClass:
+            {
+                const mson::NamedType* mixed = inherited(element.content.mixin.typeSpecification.name);
+
+                if (mixed) {
+                    mson::Elements members = Members(*mixed);
+
+                    elements.erase(elements.begin() + i);
+                    elements.insert(elements.begin() + i, members.begin(), members.end());
+
+                    i += members.size();
+                    continue;
+                }
+
+                break;
+            }
+
+            case mson::Element::PropertyClass:
+                resolve(element.content.property.valueDefinition.typeDefinition, element.content.property.sections);
+                break;
+
+            case mson::Element::ValueClass:
+                resolve(element.content.value.valueDefinition.typeDefinition, element.content.value.sections);
+                break;
+
+            case mson::Element::OneOfClass:
+                resolve(element.content.oneOf());
+                break;
+
+            case mson::Element::GroupClass:
+                resolve(element.content.elements());
+                break;
+
+            default:
+                break;
+        }
+
+        ++i;
+    }
+}
+
+static void ResolvePayload(Payload& payload, MSONResolver& resolver)
+{
+    resolver.resolve(payload.attributes);
+}
+
+static void ResolveAction(Action& action, MSONResolver& resolver)
+{
+    resolver.resolve(action.attributes);
+
+    for (TransactionExamples::iterator example = action.examples.begin(); example != action.examples.end(); ++example) {
+
+        for (snowcrash::Requests::iterator it = example->requests.begin(); it != example->requests.end(); ++it) {
+            ResolvePayload(*it, resolver);
+        }
+
+        for (snowcrash::Responses::iterator it = example->responses.begin(); it != example->responses.end(); ++it) {
+            ResolvePayload(*it, resolver);
+        }
+    }
+}
+
+static void ResolveResource(Resource& resource, MSONResolver& resolver)
+{
+    resolver.resolve(resource.attributes);
+    ResolvePayload(resource.model, resolver);
+
+    for (Actions::iterator it = resource.actions.begin(); it != resource.actions.end(); ++it) {
+        ResolveAction(*it, resolver);
+    }
+}
+
+static void ResolveElements(Elements& elements, MSONResolver& resolver)
+{
+    for (Elements::iterator it = elements.begin(); it != elements.end(); ++it) {
+
+        switch (it->element) {
+            case Element::DataStructureElement:
+                resolver.resolve(it->content.dataStructure);
+                break;
+
+            case Element::ResourceElement:
+                ResolveResource(it->content.resource, resolver);
+                break;
+
+            case Element::CategoryElement:
+                ResolveElements(it->content.elements(), resolver);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+void drafter::ResolveBlueprintMSON(Blueprint& blueprint)
+{
+    MSONResolver resolver(blueprint);
+    ResolveElements(blueprint.content.elements(), resolver);
+}
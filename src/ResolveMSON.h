@@ -0,0 +1,97 @@
+//
+//  ResolveMSON.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_RESOLVE_MSON_H
+#define DRAFTER_RESOLVE_MSON_H
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "Blueprint.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Named MSON types of blueprint with inheritance and mixins expanded
+     *
+     *  Named types are data structures of `Data Structures` sections and
+     *  attributes of named resources. Each of them is expanded at most once,
+     *  on first use, after the types it depends on - the expansion is kept
+     *  and copied wherever the type is inherited from, mixed in or used as
+     *  type of a member.
+     *
+     *  Expanded type has base type of its ancestor and members of its
+     *  ancestors followed by its own. `Include` mixins are replaced by
+     *  members of the mixed in type. Nested types of arrays and enums
+     *  (`array[Note]`) are left as references.
+     *
+     *  A reference closing a cycle - type inheriting from or containing
+     *  itself - is left as it is and the type is reported by recursive().
+     */
+    class MSONResolver {
+    public:
+
+        explicit MSONResolver(const snowcrash::Blueprint& blueprint);
+
+        /**
+         *  \brief Expanded named type \param name
+         *
+         *  \return NULL for type not defined in blueprint or being expanded
+         */
+        const mson::NamedType* resolved(const std::string& name);
+
+        /**
+         *  \brief Expand inheritance and mixins of \param dataStructure in place
+         *
+         *  Named type of the blueprint itself is replaced by its kept expansion.
+         */
+        void resolve(mson::NamedType& dataStructure);
+
+        /** Names of types referencing themselves, directly or through other types */
+        const std::set<std::string>& recursive() const;
+
+    private:
+
+        enum State {
+            UnresolvedState = 0,
+            ResolvingState,
+            ResolvedState
+        };
+
+        struct Entry {
+            const mson::NamedType* definition;
+            mson::NamedType resolved;
+            State state;
+
+            Entry() : definition(NULL), state(UnresolvedState) {}
+        };
+
+        typedef std::map<std::string, Entry> Entries;
+
+        Entries entries_;
+        std::set<std::string> recursive_;
+
+        void collect(const snowcrash::Elements& elements);
+
+        const mson::NamedType* inherited(const mson::TypeName& typeName);
+
+        void resolve(mson::TypeDefinition& typeDefinition, mson::TypeSections& sections);
+        void resolve(mson::Elements& elements);
+    };
+
+    /**
+     *  \brief Expand inheritance and mixins of all MSON in \param blueprint
+     *
+     *  Data structures, resource, action and payload attributes are
+     *  replaced by their expansion. Source maps of the blueprint no longer
+     *  match expanded members.
+     */
+    void ResolveBlueprintMSON(snowcrash::Blueprint& blueprint);
+}
+
+#endif // #ifndef DRAFTER_RESOLVE_MSON_H
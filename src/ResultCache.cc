@@ -0,0 +1,97 @@
+//
+//  ResultCache.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "ResultCache.h"
+
+using namespace drafter;
+
+static Hash ResultKey(const std::string& source, unsigned int options)
+{
+    return Hasher()(source)(options).value;
+}
+
+ResultCache::ResultCache(size_t capacity, size_t shards) : hits_(0), misses_(0), evictions_(0)
+{
+    // results up to MinShardCapacity fit into shard even if capacity is small
+    if (shards > capacity / MinShardCapacity) {
+        shards = capacity / MinShardCapacity;
+    }
+
+    if (shards == 0) {
+        shards = 1;
+    }
+
+    for (size_t i = 0; i < shards; ++i) {
+        shards_.push_back(std::unique_ptr<Shard>(new Shard(capacity / shards)));
+    }
+}
+
+ResultCache::Shard& ResultCache::shard(Hash key)
+{
+    // low bits select bucket inside of shard
+    return *shards_[(key >> 32) % shards_.size()];
+}
+
+ResultCache::result_ptr ResultCache::get(const std::string& source, unsigned int options)
+{
+    Hash key = ResultKey(source, options);
+    result_ptr result = shard(key).get(key);
+
+    if (!result || result->options != options || result->source != source) {
+        ++misses_;
+        return result_ptr();
+    }
+
+    ++hits_;
+    return result;
+}
+
+ResultCache::result_ptr ResultCache::put(const std::string& source, unsigned int options, int code, std::string& data)
+{
+    Hash key = ResultKey(source, options);
+
+    std::shared_ptr<Result> result(new Result);
+
+    result->source = source;
+    result->options = options;
+    result->code = code;
+    result->data.swap(data);
+
+    evictions_ += shard(key).put(key, result, sizeof(Result) + source.size() + result->data.size());
+
+    return result;
+}
+
+ResultCache::Statistics ResultCache::statistics() const
+{
+    Statistics statistics;
+
+    statistics.hits = hits_;
+    statistics.misses = misses_;
+    statistics.evictions = evictions_;
+    statistics.entries = 0;
+    statistics.weight = 0;
+
+    for (std::vector<std::unique_ptr<Shard> >::const_iterator it = shards_.begin(); it != shards_.end(); ++it) {
+        statistics.entries += (*it)->size();
+        statistics.weight += (*it)->weight();
+    }
+
+    return statistics;
+}
+
+size_t ResultCache::maxEntryWeight() const
+{
+    return shards_.front()->capacity();
+}
+
+void ResultCache::clear()
+{
+    for (std::vector<std::unique_ptr<Shard> >::iterator it = shards_.begin(); it != shards_.end(); ++it) {
+        (*it)->clear();
+    }
+}
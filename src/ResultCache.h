@@ -0,0 +1,101 @@
+//
+//  ResultCache.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_RESULT_CACHE_H
+#define DRAFTER_RESULT_CACHE_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Hash.h"
+#include "LRUCache.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Cache of serialized parse results keyed by source and parser options
+     *
+     *  Entries are spread over independently locked shards by key hash, so
+     *  concurrent callers rarely wait for each other. Every shard is LRU
+     *  bounded by its part of capacity; entry weight is size of its source
+     *  and serialized result. An entry heavier than one shard, see
+     *  maxEntryWeight(), is not stored. Shards are never smaller than
+     *  MinShardCapacity, a small cache has fewer of them or just one.
+     *
+     *  Entries are immutable and shared - a result returned by get() or put()
+     *  stays valid while caller holds it, even if it is evicted meanwhile.
+     *  Key is 64 bit content hash, source is compared on lookup so colliding
+     *  sources are never confused.
+     */
+    class ResultCache {
+    public:
+
+        struct Result {
+            std::string source;
+            unsigned int options;
+            int code;               ///< return code of parser
+            std::string data;       ///< serialized result
+        };
+
+        typedef LRUCache<Hash, Result>::value_ptr result_ptr;
+
+        struct Statistics {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            size_t entries;
+            size_t weight;          ///< approximate size of entries in bytes
+        };
+
+        static const size_t DefaultShards = 16;
+
+        /** Capacity below which the cache is split into fewer shards */
+        static const size_t MinShardCapacity = 4 * 1024 * 1024;
+
+        /**
+         *  \param shards   Upper bound of shard count, actual count is limited
+         *                  by MinShardCapacity
+         */
+        explicit ResultCache(size_t capacity, size_t shards = DefaultShards);
+
+        /**
+         *  \brief Return result for \param source parsed with \param options or empty pointer
+         */
+        result_ptr get(const std::string& source, unsigned int options);
+
+        /**
+         *  \brief Store result of parsing \param source, \param data are moved into the cache
+         */
+        result_ptr put(const std::string& source, unsigned int options, int code, std::string& data);
+
+        Statistics statistics() const;
+
+        /** Weight of the heaviest entry the cache stores - capacity of one shard */
+        size_t maxEntryWeight() const;
+
+        void clear();
+
+    private:
+
+        typedef LRUCache<Hash, Result> Shard;
+
+        std::vector<std::unique_ptr<Shard> > shards_;
+
+        std::atomic<uint64_t> hits_;
+        std::atomic<uint64_t> misses_;
+        std::atomic<uint64_t> evictions_;
+
+        Shard& shard(Hash key);
+
+        ResultCache(const ResultCache&);
+        ResultCache& operator=(const ResultCache&);
+    };
+}
+
+#endif // #ifndef DRAFTER_RESULT_CACHE_H
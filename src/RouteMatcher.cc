@@ -0,0 +1,493 @@
+//
+//  RouteMatcher.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "RouteMatcher.h"
+
+using namespace drafter;
+
+typedef std::vector<std::string> Strings;
+
+/**
+ *  \brief Split \param str by \param delimiter
+ */
+static void Split(const std::string& str, char delimiter, Strings& out)
+{
+    size_t begin = 0;
+
+    for (;;) {
+        size_t end = str.find(delimiter, begin);
+
+        if (end == std::string::npos) {
+            out.push_back(str.substr(begin));
+            return;
+        }
+
+        out.push_back(str.substr(begin, end - begin));
+        begin = end + 1;
+    }
+}
+
+/**
+ *  \brief Strip explode `*` and prefix `:n` modifiers from variable name
+ */
+static std::string VariableName(const std::string& variable)
+{
+    size_t end = variable.find_first_of("*:");
+    return variable.substr(0, end);
+}
+
+static int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+static std::string PercentDecode(const std::string& value)
+{
+    if (value.find('%') == std::string::npos) {
+        return value;
+    }
+
+    std::string decoded;
+    decoded.reserve(value.size());
+
+    for (size_t i = 0; i < value.size(); ++i) {
+
+        if (value[i] == '%' && i + 2 < value.size()) {
+
+            int high = HexValue(value[i + 1]);
+            int low = HexValue(value[i + 2]);
+
+            if (high >= 0 && low >= 0) {
+                decoded += static_cast<char>(high * 16 + low);
+                i += 2;
+                continue;
+            }
+        }
+
+        decoded += value[i];
+    }
+
+    return decoded;
+}
+
+/**
+ *  \brief Rewrite URI template into plain path template and list of query variables
+ *
+ *  `/notes{/id}{?page,limit}` gives path `/notes/{id}` and query variables `page`, `limit`.
+ *  Literal query and fragment of template are dropped.
+ */
+static void NormalizeTemplate(const std::string& uriTemplate, std::string& path, Strings& queryVariables)
+{
+    bool inQuery = false;
+
+    for (size_t i = 0; i < uriTemplate.size(); ++i) {
+
+        char c = uriTemplate[i];
+
+        if (c != '{') {
+
+            if (c == '#') {
+                return;
+            }
+
+            if (c == '?') {
+                inQuery = true;
+            }
+
+            if (!inQuery) {
+                path += c;
+            }
+
+            continue;
+        }
+
+        size_t end = uriTemplate.find('}', i);
+
+        if (end == std::string::npos) {
+            if (!inQuery) {
+                path += uriTemplate.substr(i);
+            }
+
+            return;
+        }
+
+        std::string expression = uriTemplate.substr(i + 1, end - i - 1);
+        i = end;
+
+        if (expression.empty()) {
+            continue;
+        }
+
+        char op = expression[0];
+
+        if (std::string("+#./;?&").find(op) != std::string::npos) {
+            expression.erase(0, 1);
+        }
+        else {
+            op = 0;
+        }
+
+        Strings variables;
+        Split(expression, ',', variables);
+
+        for (Strings::iterator it = variables.begin(); it != variables.end(); ++it) {
+
+            std::string name = VariableName(*it);
+
+            if (name.empty()) {
+                continue;
+            }
+
+            switch (op) {
+
+                case '?':
+                case '&':
+                    queryVariables.push_back(name);
+                    break;
+
+                case '/':
+                    if (!inQuery) {
+                        path += "/{" + name + "}";
+                    }
+                    break;
+
+                case '.':
+                    if (!inQuery) {
+                        path += ".{" + name + "}";
+                    }
+                    break;
+
+                case '+':
+                    if (!inQuery) {
+                        path += (it == variables.begin() ? "{+" : ",{") + name + "}";
+                    }
+                    break;
+
+                case 0:
+                    if (!inQuery) {
+                        path += (it == variables.begin() ? "{" : ",{") + name + "}";
+                    }
+                    break;
+
+                default:
+                    // fragment and path-style parameters are not matched
+                    break;
+            }
+        }
+    }
+}
+
+RouteMatcher::RouteMatcher() : nodes_(1), size_(0)
+{
+}
+
+RouteMatcher::RouteMatcher(const Routes& routes) : nodes_(1), size_(0)
+{
+    for (size_t i = 0; i < routes.size(); ++i) {
+        add(routes[i], i);
+    }
+}
+
+size_t RouteMatcher::size() const
+{
+    return size_;
+}
+
+size_t RouteMatcher::addSegment(size_t node, const std::string& segment, Strings& variables)
+{
+    if (segment.find('{') == std::string::npos) {
+
+        std::unordered_map<std::string, size_t>::const_iterator it = nodes_[node].literals.find(segment);
+
+        if (it != nodes_[node].literals.end()) {
+            return it->second;
+        }
+
+        nodes_.push_back(Node());
+        nodes_[node].literals[segment] = nodes_.size() - 1;
+
+        return nodes_.size() - 1;
+    }
+
+    Pattern pattern;
+
+    for (size_t i = 0; i < segment.size();) {
+
+        Part part;
+
+        size_t end = segment.find('}', i);
+
+        if (segment[i] == '{' && end != std::string::npos) {
+            std::string name = segment.substr(i + 1, end - i - 1);
+
+            if (!name.empty() && name[0] == '+') {
+                name.erase(0, 1);
+            }
+
+            variables.push_back(name);
+
+            part.variable = true;
+            pattern.shape += "{}";
+
+            i = end + 1;
+        }
+        else {
+            end = segment.find('{', i + 1);
+
+            if (end == std::string::npos) {
+                end = segment.size();
+            }
+
+            part.variable = false;
+            part.literal = segment.substr(i, end - i);
+            pattern.shape += part.literal;
+
+            i = end;
+        }
+
+        pattern.parts.push_back(part);
+    }
+
+    std::vector<Pattern>& patterns = nodes_[node].patterns;
+
+    for (std::vector<Pattern>::const_iterator it = patterns.begin(); it != patterns.end(); ++it) {
+        if (it->shape == pattern.shape) {
+            return it->node;
+        }
+    }
+
+    nodes_.push_back(Node());
+
+    pattern.node = nodes_.size() - 1;
+    nodes_[node].patterns.push_back(pattern);
+
+    return pattern.node;
+}
+
+void RouteMatcher::add(const Route& route, size_t index)
+{
+    const std::string& uriTemplate = route.effectiveUriTemplate();
+
+    if (uriTemplate.empty()) {
+        return;
+    }
+
+    Target target;
+    std::string path;
+
+    target.index = index;
+    target.method = route.method;
+
+    NormalizeTemplate(uriTemplate, path, target.queryVariables);
+
+    Strings segments;
+    Split(path, '/', segments);
+
+    size_t node = 0;
+
+    for (Strings::const_iterator it = segments.begin(); it != segments.end(); ++it) {
+
+        bool isLast = (it + 1 == segments.end());
+
+        // `{+var}` as the last segment matches the rest of path
+        if (isLast && it->size() > 3 && it->compare(0, 2, "{+") == 0 && it->find('}') == it->size() - 1) {
+
+            target.pathVariables.push_back(it->substr(2, it->size() - 3));
+
+            if (!nodes_[node].tail) {
+                nodes_.push_back(Node());
+                nodes_[node].tail = nodes_.size() - 1;
+            }
+
+            node = nodes_[node].tail;
+            break;
+        }
+
+        node = addSegment(node, *it, target.pathVariables);
+    }
+
+    nodes_[node].targets.push_back(target);
+    ++size_;
+}
+
+bool RouteMatcher::matchParts(const Parts& parts, const std::string& segment, Segments& values)
+{
+    size_t position = 0;
+
+    for (size_t i = 0; i < parts.size(); ++i) {
+
+        const Part& part = parts[i];
+
+        if (!part.variable) {
+
+            if (segment.compare(position, part.literal.size(), part.literal) != 0) {
+                return false;
+            }
+
+            position += part.literal.size();
+            continue;
+        }
+
+        size_t end = segment.size();
+
+        if (i + 1 < parts.size()) {
+
+            if (parts[i + 1].variable) {
+                return false;
+            }
+
+            end = segment.find(parts[i + 1].literal, position + 1);
+
+            if (end == std::string::npos) {
+                return false;
+            }
+        }
+
+        if (end == position) {
+            return false;
+        }
+
+        values.push_back(segment.substr(position, end - position));
+        position = end;
+    }
+
+    return position == segment.size();
+}
+
+bool RouteMatcher::matchNode(size_t node,
+                             const Segments& segments,
+                             size_t segment,
+                             const std::string& method,
+                             Segments& values,
+                             const Target*& target) const
+{
+    const Node& current = nodes_[node];
+
+    if (segment == segments.size()) {
+
+        for (std::vector<Target>::const_iterator it = current.targets.begin(); it != current.targets.end(); ++it) {
+            if (it->method == method) {
+                target = &(*it);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Literal segments first
+    std::unordered_map<std::string, size_t>::const_iterator literal = current.literals.find(segments[segment]);
+
+    if (literal != current.literals.end() &&
+        matchNode(literal->second, segments, segment + 1, method, values, target)) {
+        return true;
+    }
+
+    // Segments with variables
+    for (std::vector<Pattern>::const_iterator it = current.patterns.begin(); it != current.patterns.end(); ++it) {
+
+        size_t mark = values.size();
+
+        if (matchParts(it->parts, segments[segment], values) &&
+            matchNode(it->node, segments, segment + 1, method, values, target)) {
+            return true;
+        }
+
+        values.resize(mark);
+    }
+
+    // `{+var}` - the rest of path
+    if (current.tail) {
+
+        std::string rest = segments[segment];
+
+        for (size_t i = segment + 1; i < segments.size(); ++i) {
+            rest += "/" + segments[i];
+        }
+
+        if (!rest.empty()) {
+
+            values.push_back(rest);
+
+            if (matchNode(current.tail, segments, segments.size(), method, values, target)) {
+                return true;
+            }
+
+            values.pop_back();
+        }
+    }
+
+    return false;
+}
+
+bool RouteMatcher::match(const std::string& method, const std::string& uri, RouteMatch& out) const
+{
+    std::string path = uri.substr(0, uri.find('#'));
+    std::string query;
+
+    size_t queryStart = path.find('?');
+
+    if (queryStart != std::string::npos) {
+        query = path.substr(queryStart + 1);
+        path.erase(queryStart);
+    }
+
+    Segments segments;
+    Split(path, '/', segments);
+
+    Segments values;
+    const Target* target = NULL;
+
+    if (!matchNode(0, segments, 0, method, values, target)) {
+        return false;
+    }
+
+    out.index = target->index;
+    out.parameters.clear();
+
+    for (size_t i = 0; i < values.size() && i < target->pathVariables.size(); ++i) {
+        out.parameters.push_back(URIParameter(target->pathVariables[i], PercentDecode(values[i])));
+    }
+
+    if (target->queryVariables.empty() || query.empty()) {
+        return true;
+    }
+
+    Strings pairs;
+    Split(query, '&', pairs);
+
+    for (Strings::const_iterator variable = target->queryVariables.begin();
+         variable != target->queryVariables.end();
+         ++variable) {
+
+        for (Strings::const_iterator it = pairs.begin(); it != pairs.end(); ++it) {
+
+            size_t equals = it->find('=');
+            std::string name = PercentDecode(it->substr(0, equals));
+
+            if (name == *variable) {
+                std::string value = (equals == std::string::npos) ? std::string() : it->substr(equals + 1);
+                out.parameters.push_back(URIParameter(name, PercentDecode(value)));
+                break;
+            }
+        }
+    }
+
+    return true;
+}
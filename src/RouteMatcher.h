@@ -0,0 +1,137 @@
+//
+//  RouteMatcher.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_ROUTE_MATCHER_H
+#define DRAFTER_ROUTE_MATCHER_H
+
+#include <unordered_map>
+#include <utility>
+
+#include "Routes.h"
+
+namespace drafter {
+
+    /** Variable name and its value extracted from matched URI */
+    typedef std::pair<std::string, std::string> URIParameter;
+    typedef std::vector<URIParameter> URIParameters;
+
+    /**
+     *  \brief Result of RouteMatcher::match()
+     */
+    struct RouteMatch {
+        size_t index;               ///< index of matched route in routes given to RouteMatcher
+        URIParameters parameters;   ///< values of path and query variables, percent-decoded
+
+        RouteMatch() : index(0) {}
+    };
+
+    /**
+     *  \brief Matches request URIs against URI templates of all routes at once
+     *
+     *  URI templates of routes (action URI template if defined, resource URI
+     *  template otherwise) are compiled into single trie of path segments.
+     *  Cost of match() depends on the number of segments of the URI, not on
+     *  the number of routes.
+     *
+     *  Supported expressions: `{var}`, `{+var}` (as last segment it matches
+     *  rest of the path including slashes), `{/var}`, `{?var}` and `{&var}`
+     *  (query variables, optional), `{#var}` (ignored). Variable can be mixed
+     *  with literal text inside of segment e.g. `/files/{name}.{ext}`.
+     *
+     *  Literal segments take precedence over variables. If more routes share
+     *  the same method and equal template shape the first one wins.
+     *
+     *  usage:
+     *
+     *  drafter::Routes routes;
+     *  drafter::CollectRoutes(blueprint.node, blueprint.sourceMap, routes);
+     *
+     *  drafter::RouteMatcher matcher(routes);
+     *  drafter::RouteMatch match;
+     *
+     *  if (matcher.match("GET", "/notes/42?page=2", match)) {
+     *      const drafter::Route& route = routes[match.index];
+     *      ...
+     *  }
+     */
+    class RouteMatcher {
+    public:
+
+        RouteMatcher();
+        explicit RouteMatcher(const Routes& routes);
+
+        /**
+         *  \brief Compile URI template of \param route, it is identified by \param index in match results
+         */
+        void add(const Route& route, size_t index);
+
+        /**
+         *  \brief Find route for request
+         *
+         *  \param method   HTTP method of request
+         *  \param uri      Request URI - path with optional query and fragment
+         *  \param out      Output - matched route and extracted parameters
+         *  \return True if a route was found
+         */
+        bool match(const std::string& method, const std::string& uri, RouteMatch& out) const;
+
+        /** Number of compiled routes */
+        size_t size() const;
+
+    private:
+
+        /** Part of path segment - literal text or variable */
+        struct Part {
+            bool variable;
+            std::string literal;
+        };
+
+        typedef std::vector<Part> Parts;
+
+        /** Path segment with at least one variable */
+        struct Pattern {
+            std::string shape;      ///< segment with variable names removed e.g. `{}.json`
+            Parts parts;
+            size_t node;
+        };
+
+        /** Route ending in trie node */
+        struct Target {
+            size_t index;
+            std::string method;
+            std::vector<std::string> pathVariables;
+            std::vector<std::string> queryVariables;
+        };
+
+        struct Node {
+            std::unordered_map<std::string, size_t> literals;
+            std::vector<Pattern> patterns;
+            size_t tail;            ///< node for `{+var}` matching rest of path, 0 if none
+            std::vector<Target> targets;
+
+            Node() : tail(0) {}
+        };
+
+        typedef std::vector<std::string> Segments;
+
+        std::vector<Node> nodes_;
+        size_t size_;
+
+        size_t addSegment(size_t node, const std::string& segment, std::vector<std::string>& variables);
+
+        bool matchNode(size_t node,
+                       const Segments& segments,
+                       size_t segment,
+                       const std::string& method,
+                       Segments& values,
+                       const Target*& target) const;
+
+        static bool matchParts(const Parts& parts, const std::string& segment, Segments& values);
+    };
+}
+
+#endif // #ifndef DRAFTER_ROUTE_MATCHER_H
@@ -0,0 +1,147 @@
+//
+//  Routes.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "Routes.h"
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+using snowcrash::Collection;
+
+using snowcrash::Action;
+using snowcrash::Actions;
+using snowcrash::Resource;
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Blueprint;
+
+typedef Collection<SourceMap<Element> >::type ElementSourceMaps;
+typedef Collection<SourceMap<Action> >::type ActionSourceMaps;
+
+/**
+ *  \brief Return source map of \param index-th member of \param collection or empty source map
+ *
+ *  Source map collections are empty if blueprint was parsed without source maps.
+ */
+template<typename T>
+static const T& SourceMapAt(const std::vector<T>& collection, size_t index)
+{
+    static const T empty = T();
+    return index < collection.size() ? collection[index] : empty;
+}
+
+static void CollectResourceRoutes(const std::string& group,
+                                  const Resource& resource,
+                                  const SourceMap<Resource>& sourceMap,
+                                  Routes& routes)
+{
+    const ActionSourceMaps& actionSourceMaps = sourceMap.actions.collection;
+
+    for (size_t i = 0; i < resource.actions.size(); ++i) {
+
+        const Action& action = resource.actions[i];
+        const SourceMap<Action>& actionSourceMap = SourceMapAt(actionSourceMaps, i);
+
+        routes.push_back(Route());
+        Route& route = routes.back();
+
+        route.group = group;
+        route.uriTemplate = resource.uriTemplate;
+        route.actionUriTemplate = action.uriTemplate;
+        route.method = action.method;
+        route.name = action.name;
+        route.relation = action.relation.str;
+        route.action = &action;
+
+        route.uriTemplateSourceMap = sourceMap.uriTemplate.sourceMap;
+        route.methodSourceMap = actionSourceMap.method.sourceMap;
+    }
+}
+
+static void CollectElementRoutes(const std::string& group,
+                                 const Elements& elements,
+                                 const ElementSourceMaps& sourceMaps,
+                                 Routes& routes)
+{
+    for (size_t i = 0; i < elements.size(); ++i) {
+
+        const Element& element = elements[i];
+        const SourceMap<Element>& sourceMap = SourceMapAt(sourceMaps, i);
+
+        if (element.element == Element::ResourceElement) {
+            CollectResourceRoutes(group, element.content.resource, sourceMap.content.resource, routes);
+        }
+        else if (element.element == Element::CategoryElement &&
+                 element.category == Element::ResourceGroupCategory) {
+
+            CollectElementRoutes(element.attributes.name,
+                                 element.content.elements(),
+                                 sourceMap.content.elements().collection,
+                                 routes);
+        }
+    }
+}
+
+void drafter::CollectRoutes(const Blueprint& blueprint,
+                            const SourceMap<Blueprint>& sourceMap,
+                            Routes& routes)
+{
+    CollectElementRoutes(std::string(),
+                         blueprint.content.elements(),
+                         sourceMap.content.elements().collection,
+                         routes);
+}
+
+/**
+ *  \brief Write value so it can not break tab separated table
+ */
+static void WriteField(const std::string& value, std::ostream& os)
+{
+    if (value.find_first_of("\t\r\n") == std::string::npos) {
+        os.write(value.data(), value.size());
+        return;
+    }
+
+    for (std::string::const_iterator it = value.begin(); it != value.end(); ++it) {
+        os.put((*it == '\t' || *it == '\n' || *it == '\r') ? ' ' : *it);
+    }
+}
+
+static void WriteSourceMap(const mdp::BytesRangeSet& sourceMap, std::ostream& os)
+{
+    for (mdp::BytesRangeSet::const_iterator it = sourceMap.begin(); it != sourceMap.end(); ++it) {
+
+        if (it != sourceMap.begin()) {
+            os << ';';
+        }
+
+        os << it->location << ':' << it->length;
+    }
+}
+
+void drafter::WriteRoutes(const Routes& routes, std::ostream& os)
+{
+    for (Routes::const_iterator it = routes.begin(); it != routes.end(); ++it) {
+
+        WriteField(it->group, os);
+        os << '\t';
+        WriteField(it->uriTemplate, os);
+        os << '\t';
+        WriteField(it->actionUriTemplate, os);
+        os << '\t';
+        WriteField(it->method, os);
+        os << '\t';
+        WriteField(it->name, os);
+        os << '\t';
+        WriteField(it->relation, os);
+        os << '\t';
+        WriteSourceMap(it->uriTemplateSourceMap, os);
+        os << '\t';
+        WriteSourceMap(it->methodSourceMap, os);
+        os << '\n';
+    }
+}
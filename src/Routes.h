@@ -0,0 +1,66 @@
+//
+//  Routes.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_ROUTES_H
+#define DRAFTER_ROUTES_H
+
+#include <ostream>
+#include <vector>
+
+#include "BlueprintSourcemap.h"
+
+namespace drafter {
+
+    /**
+     *  \brief One action of blueprint with its place in resource tree
+     */
+    struct Route {
+        std::string group;                  ///< name of resource group
+        std::string uriTemplate;            ///< resource URI template
+        std::string actionUriTemplate;      ///< action URI template, empty if not defined
+        std::string method;                 ///< HTTP method
+        std::string name;                   ///< action name
+        std::string relation;               ///< action relation
+
+        mdp::BytesRangeSet uriTemplateSourceMap;    ///< source map of resource URI template
+        mdp::BytesRangeSet methodSourceMap;         ///< source map of HTTP method
+
+        const snowcrash::Action* action;            ///< action of route, valid while blueprint exists
+
+        Route() : action(NULL) {}
+
+        /** Action URI template if defined, resource URI template otherwise */
+        const std::string& effectiveUriTemplate() const {
+            return actionUriTemplate.empty() ? uriTemplate : actionUriTemplate;
+        }
+    };
+
+    typedef std::vector<Route> Routes;
+
+    /**
+     *  \brief Collect all actions of blueprint without wrapping the whole AST
+     *
+     *  \param blueprint    Parsed blueprint
+     *  \param sourceMap    Blueprint source map, source map columns stay empty
+     *                      if blueprint was parsed without ExportSourcemapOption
+     *  \param routes       Output - one route per action, in order of appearance
+     */
+    void CollectRoutes(const snowcrash::Blueprint& blueprint,
+                       const snowcrash::SourceMap<snowcrash::Blueprint>& sourceMap,
+                       Routes& routes);
+
+    /**
+     *  \brief Write route table as tab separated values, one route per line
+     *
+     *  Columns: group, resource URI template, action URI template, method,
+     *  name, relation, URI template source map, method source map.
+     *  Source map is written as `location:length` ranges separated by `;`.
+     */
+    void WriteRoutes(const Routes& routes, std::ostream& os);
+}
+
+#endif // #ifndef DRAFTER_ROUTES_H
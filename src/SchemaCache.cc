@@ -0,0 +1,54 @@
+//
+//  SchemaCache.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "SchemaCache.h"
+#include "JSONReader.h"
+
+using namespace drafter;
+
+SchemaCache::SchemaCache(size_t capacity) : cache_(capacity)
+{
+}
+
+SchemaCache::schema_ptr SchemaCache::get(const std::string& source)
+{
+    Hash key = HashBytes(source);
+    schema_ptr compiled = cache_.get(key);
+
+    if (compiled && compiled->source == source) {
+        return compiled;
+    }
+
+    std::shared_ptr<CompiledSchema> schema(new CompiledSchema);
+    schema->source = source;
+    sos::Base document;
+
+    if (!ReadJSON(source, document, schema->error)) {
+        schema->error = "body schema is not valid JSON: " + schema->error;
+    }
+    else if (!schema->schema.compile(document, schema->error)) {
+        schema->error = "body schema is not valid: " + schema->error;
+    }
+    else {
+        schema->valid = true;
+    }
+
+    // source is kept, compiled form is roughly proportional to it
+    cache_.put(key, schema, 5 * source.size() + sizeof(CompiledSchema));
+
+    return schema;
+}
+
+size_t SchemaCache::size() const
+{
+    return cache_.size();
+}
+
+void SchemaCache::clear()
+{
+    cache_.clear();
+}
@@ -0,0 +1,67 @@
+//
+//  SchemaCache.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_SCHEMA_CACHE_H
+#define DRAFTER_SCHEMA_CACHE_H
+
+#include "JSONSchema.h"
+
+#include "Hash.h"
+#include "LRUCache.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Result of compiling body schema source
+     */
+    struct CompiledSchema {
+        std::string source;     ///< schema source, compared on hit to tell hash collision
+        bool valid;             ///< false if source is not valid JSON or not valid schema
+        std::string error;      ///< reason why schema is not valid
+        JSONSchema schema;
+
+        CompiledSchema() : valid(false) {}
+    };
+
+    /**
+     *  \brief Cache of compiled body schemas keyed by content hash of schema source
+     *
+     *  Hit is confirmed by comparing the source, schema colliding with
+     *  a cached one is compiled again and replaces it.
+     *
+     *  Payloads of one blueprint often share the same schema; every distinct
+     *  schema is compiled just once. Invalid schemas are cached too, so their
+     *  compile error is not computed again. Share one instance between parses
+     *  to keep compiled schemas of unchanged payloads. The cache is safe to
+     *  share between threads.
+     */
+    class SchemaCache {
+    public:
+
+        typedef LRUCache<Hash, CompiledSchema>::value_ptr schema_ptr;
+
+        /** Default capacity - approximate size of schema sources in bytes */
+        static const size_t DefaultCapacity = 16 * 1024 * 1024;
+
+        explicit SchemaCache(size_t capacity = DefaultCapacity);
+
+        /**
+         *  \brief Return compiled \param source, compile and store it if not cached yet
+         */
+        schema_ptr get(const std::string& source);
+
+        /** Number of stored schemas */
+        size_t size() const;
+
+        void clear();
+
+    private:
+        LRUCache<Hash, CompiledSchema> cache_;
+    };
+}
+
+#endif // #ifndef DRAFTER_SCHEMA_CACHE_H
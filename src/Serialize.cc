@@ -67,3 +67,62 @@ const std::string SerializeKey::AnnotationMessage = "message";
 const std::string SerializeKey::AnnotationLocation = "location";
 const std::string SerializeKey::AnnotationLocationIndex = "index";
 const std::string SerializeKey::AnnotationLocationLength = "length";
+
+const std::string SerializeKey::Change = "change";
+const std::string SerializeKey::Path = "path";
+
+const std::string SerializeKey::Op = "op";
+
+bool drafter::IsEqual(const sos::Base& left, const sos::Base& right)
+{
+    if (left.type != right.type) {
+        return false;
+    }
+
+    switch (left.type) {
+        case sos::Base::StringType:
+            return left.str == right.str;
+
+        case sos::Base::NumberType:
+            return left.number == right.number;
+
+        case sos::Base::BooleanType:
+            return left.boolean == right.boolean;
+
+        case sos::Base::ArrayType:
+            if (left.array.size() != right.array.size()) {
+                return false;
+            }
+
+            for (size_t i = 0; i < left.array.size(); ++i) {
+                if (!IsEqual(left.array[i], right.array[i])) {
+                    return false;
+                }
+            }
+
+            return true;
+
+        case sos::Base::ObjectType:
+            if (left.keys != right.keys) {
+                return false;
+            }
+
+            for (sos::Keys::const_iterator it = left.keys.begin(); it != left.keys.end(); ++it) {
+                sos::KeyValues::const_iterator leftMember = left.object.find(*it);
+                sos::KeyValues::const_iterator rightMember = right.object.find(*it);
+
+                if ((leftMember == left.object.end()) != (rightMember == right.object.end())) {
+                    return false;
+                }
+
+                if (leftMember != left.object.end() && !IsEqual(leftMember->second, rightMember->second)) {
+                    return false;
+                }
+            }
+
+            return true;
+
+        default:
+            return true;
+    }
+}
@@ -10,6 +10,7 @@
 #define DRAFTER_SERIALIZE_H
 
 #include <string>
+#include <utility>
 #include "BlueprintSourcemap.h"
 #include "sos.h"
 
@@ -21,6 +22,9 @@ namespace drafter {
 
     /**
      *  AST entities serialization keys
+     *
+     *  Constant once static initialization of libdrafter is done, read by
+     *  any number of threads without locking.
      */
     struct SerializeKey {
         static const std::string Metadata;
@@ -80,12 +84,145 @@ namespace drafter {
         static const std::string AnnotationLocation;
         static const std::string AnnotationLocationIndex;
         static const std::string AnnotationLocationLength;
+
+        static const std::string Change;
+        static const std::string Path;
+
+        static const std::string Op;
+    };
+
+    /** Options of wrapping, may be combined with snowcrash::BlueprintParserOptions */
+    enum WrapOption {
+        SparseWrapOption = (1 << 8),        ///< Leave out empty strings, empty arrays and default values
+        ResolveMSONWrapOption = (1 << 9)    ///< Expand MSON inheritance and mixins of named types, see MSONResolver
+    };
+
+    typedef unsigned int WrapOptions;
+
+    /**
+     *  \brief Options of one WrapBlueprint() or WrapBlueprintSourcemap() call
+     *
+     *  Passed down to every wrapper, bound to wrappers composed by
+     *  WrapCollection by ContextWrapper.
+     */
+    struct WrapContext {
+        bool sparse;                        ///< leave out empty strings, empty arrays and default values
+
+        explicit WrapContext(WrapOptions options = 0) : sparse((options & SparseWrapOption) != 0) {}
+    };
+
+    /**
+     *  \brief Binds wrap context to wrapper so it can be used with WrapCollection
+     */
+    template<typename T, typename R>
+    struct ContextWrapper {
+
+        typedef R (*Wrapper)(const T&, const WrapContext&);
+
+        Wrapper wrapper;
+        const WrapContext& context;
+
+        ContextWrapper(Wrapper wrapper_, const WrapContext& context_) : wrapper(wrapper_), context(context_) {}
+
+        R operator()(const T& value) const {
+            return wrapper(value, context);
+        }
     };
 
+    template<typename T, typename R>
+    ContextWrapper<T, R> BindContext(R (*wrapper)(const T&, const WrapContext&), const WrapContext& context)
+    {
+        return ContextWrapper<T, R>(wrapper, context);
+    }
+
+    /**
+     *  \brief Move \param value to \param key of \param object
+     *
+     *  sos::Object::set() takes the value by reference and copies it, with
+     *  wrappers nested in each other every level of the tree would be deep
+     *  copied again by its parent. Key order is kept the same way as set()
+     *  does, existing key is overwritten.
+     */
+    inline void SetMember(sos::Object& object, const std::string& key, sos::Base&& value)
+    {
+        std::pair<sos::KeyValues::iterator, bool> member = object.object.insert(sos::KeyValues::value_type(key, sos::Base()));
+
+        if (member.second) {
+            object.keys.push_back(key);
+        }
+
+        member.first->second = std::move(value);
+    }
+
+    /** Move \param value to the end of \param array, sos::Array::push() copies it */
+    inline void PushItem(sos::Array& array, sos::Base&& value)
+    {
+        array.array.push_back(std::move(value));
+    }
+
+    /** True for null, empty string, empty array and empty object */
+    inline bool IsEmptyValue(const sos::Base& value)
+    {
+        switch (value.type) {
+            case sos::Base::UndefinedType:
+            case sos::Base::NullType:
+                return true;
+
+            case sos::Base::StringType:
+                return value.str.empty();
+
+            case sos::Base::ArrayType:
+                return value.array.empty();
+
+            case sos::Base::ObjectType:
+                return value.keys.empty();
+
+            default:
+                return false;
+        }
+    }
+
+    /** Deep comparison of values, object keys must be in the same order */
+    bool IsEqual(const sos::Base& left, const sos::Base& right);
+
+    /** Set \param key to \param value unless it is empty and wrapping is sparse */
+    inline void SetValue(sos::Object& object, const std::string& key, const sos::Base& value, const WrapContext& context)
+    {
+        if (!context.sparse || !IsEmptyValue(value)) {
+            object.set(key, value);
+        }
+    }
+
+    /** Move \param value to \param key unless it is empty and wrapping is sparse */
+    inline void SetValue(sos::Object& object, const std::string& key, sos::Base&& value, const WrapContext& context)
+    {
+        if (!context.sparse || !IsEmptyValue(value)) {
+            SetMember(object, key, std::move(value));
+        }
+    }
+
+    /** Set \param key to \param value unless it is empty and wrapping is sparse, string is not copied if left out */
+    inline void SetString(sos::Object& object, const std::string& key, const std::string& value, const WrapContext& context)
+    {
+        if (!context.sparse || !value.empty()) {
+            SetMember(object, key, sos::String(value));
+        }
+    }
+
+    /** Set \param key to \param value unless it equals \param defaultValue and wrapping is sparse */
+    inline void SetBoolean(sos::Object& object, const std::string& key, bool value, bool defaultValue, const WrapContext& context)
+    {
+        if (!context.sparse || value != defaultValue) {
+            SetMember(object, key, sos::Boolean(value));
+        }
+    }
+
 
     /**
      * \brief functor pattern to translate _collection_ into sos::Array on serialization 
-     * \requests for collection - must define typedef member ::const_iterator
+     * \requests for collection - must define typedef member ::const_iterator and size()
+     *
+     * Wrapped items are moved into the array, reserved for the whole collection.
      *
      * usage:
      *
@@ -103,25 +240,27 @@ namespace drafter {
         typedef T value_type;
 
         template<typename Collection, typename Functor>
-        R operator()(const Collection& collection, Functor &wrapper) const {
+        R operator()(const Collection& collection, const Functor& wrapper) const {
             typedef typename Collection::const_iterator iterator_type;
             R array;
+            array.array.reserve(collection.size());
 
             for (iterator_type it = collection.begin(); it != collection.end(); ++it) {
-                array.push(wrapper(*it));
+                PushItem(array, wrapper(*it));
             }
 
             return array;
         }
 
         template<typename Collection, typename Functor, typename Predicate>
-        R operator()(const Collection& collection, Functor &wrapper, Predicate &predicate) const {
+        R operator()(const Collection& collection, const Functor& wrapper, const Predicate& predicate) const {
             typedef typename Collection::const_iterator iterator_type;
             R array;
+            array.array.reserve(collection.size());
 
             for (iterator_type it = collection.begin(); it != collection.end(); ++it) {
                 if (predicate(*it)) {
-                    array.push(wrapper(*it));
+                    PushItem(array, wrapper(*it));
                 }
             }
 
@@ -130,6 +269,19 @@ namespace drafter {
 
     };
 
+    /**
+     *  \brief Set \param key to wrapped \param collection unless it is empty and wrapping is sparse
+     *
+     *  Empty collection left out is not wrapped at all.
+     */
+    template<typename T, typename Collection, typename Functor>
+    void SetCollection(sos::Object& object, const std::string& key, const Collection& collection, const Functor& wrapper, const WrapContext& context)
+    {
+        if (!context.sparse || !collection.empty()) {
+            SetMember(object, key, WrapCollection<T>()(collection, wrapper));
+        }
+    }
+
 }
 
 #endif
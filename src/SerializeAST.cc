@@ -8,6 +8,7 @@
 
 #include "StringUtility.h"
 #include "SerializeAST.h"
+#include "ResolveMSON.h"
 
 using namespace drafter;
 
@@ -33,33 +34,33 @@ using snowcrash::Action;
 using snowcrash::Resource;
 using snowcrash::Blueprint;
 
-sos::Object WrapValue(const mson::Value& value)
+sos::Object WrapValue(const mson::Value& value, const WrapContext& context)
 {
     sos::Object valueObject;
 
     // Literal
-    valueObject.set(SerializeKey::Literal, sos::String(value.literal));
+    SetString(valueObject, SerializeKey::Literal, value.literal, context);
 
     // Variable
-    valueObject.set(SerializeKey::Variable, sos::Boolean(value.variable));
+    SetBoolean(valueObject, SerializeKey::Variable, value.variable, false, context);
 
     return valueObject;
 }
 
-sos::Object WrapSymbol(const mson::Symbol& symbol)
+sos::Object WrapSymbol(const mson::Symbol& symbol, const WrapContext& context)
 {
     sos::Object symbolObject;
 
     // Literal
-    symbolObject.set(SerializeKey::Literal, sos::String(symbol.literal));
+    SetString(symbolObject, SerializeKey::Literal, symbol.literal, context);
 
     // Variable
-    symbolObject.set(SerializeKey::Variable, sos::Boolean(symbol.variable));
+    SetBoolean(symbolObject, SerializeKey::Variable, symbol.variable, false, context);
 
     return symbolObject;
 }
 
-sos::Base WrapTypeName(const mson::TypeName& typeName)
+sos::Base WrapTypeName(const mson::TypeName& typeName, const WrapContext& context)
 {
     if (typeName.empty()) {
         return sos::Null();
@@ -102,20 +103,20 @@ sos::Base WrapTypeName(const mson::TypeName& typeName)
         return sos::String(baseTypeName);
     }
 
-    return WrapSymbol(typeName.symbol);
+    return WrapSymbol(typeName.symbol, context);
 }
 
 
-sos::Object WrapTypeSpecification(const mson::TypeSpecification& typeSpecification)
+sos::Object WrapTypeSpecification(const mson::TypeSpecification& typeSpecification, const WrapContext& context)
 {
     sos::Object typeSpecificationObject;
 
     // Name
-    typeSpecificationObject.set(SerializeKey::Name, WrapTypeName(typeSpecification.name));
+    SetValue(typeSpecificationObject, SerializeKey::Name, WrapTypeName(typeSpecification.name, context), context);
 
     // Nested Types
-    typeSpecificationObject.set(SerializeKey::NestedTypes, 
-                                WrapCollection<mson::TypeName>()(typeSpecification.nestedTypes, WrapTypeName));
+    SetCollection<mson::TypeName>(typeSpecificationObject, SerializeKey::NestedTypes,
+                                  typeSpecification.nestedTypes, BindContext(WrapTypeName, context), context);
 
     return typeSpecificationObject;
 }
@@ -125,69 +126,69 @@ sos::Array WrapTypeAttributes(const mson::TypeAttributes& typeAttributes)
     sos::Array typeAttributesArray;
 
     if (typeAttributes & mson::RequiredTypeAttribute) {
-        typeAttributesArray.push(sos::String("required"));
+        PushItem(typeAttributesArray, sos::String("required"));
     }
     else if (typeAttributes & mson::OptionalTypeAttribute) {
-        typeAttributesArray.push(sos::String("optional"));
+        PushItem(typeAttributesArray, sos::String("optional"));
     }
     else if (typeAttributes & mson::DefaultTypeAttribute) {
-        typeAttributesArray.push(sos::String("default"));
+        PushItem(typeAttributesArray, sos::String("default"));
     }
     else if (typeAttributes & mson::SampleTypeAttribute) {
-        typeAttributesArray.push(sos::String("sample"));
+        PushItem(typeAttributesArray, sos::String("sample"));
     }
     else if (typeAttributes & mson::FixedTypeAttribute) {
-        typeAttributesArray.push(sos::String("fixed"));
+        PushItem(typeAttributesArray, sos::String("fixed"));
     }
 
     return typeAttributesArray;
 }
 
-sos::Object WrapTypeDefinition(const mson::TypeDefinition& typeDefinition)
+sos::Object WrapTypeDefinition(const mson::TypeDefinition& typeDefinition, const WrapContext& context)
 {
     sos::Object typeDefinitionObject;
 
     // Type Specification
-    typeDefinitionObject.set(SerializeKey::TypeSpecification, WrapTypeSpecification(typeDefinition.typeSpecification));
+    SetValue(typeDefinitionObject, SerializeKey::TypeSpecification, WrapTypeSpecification(typeDefinition.typeSpecification, context), context);
 
     // Type Attributes
-    typeDefinitionObject.set(SerializeKey::Attributes, WrapTypeAttributes(typeDefinition.attributes));
+    SetValue(typeDefinitionObject, SerializeKey::Attributes, WrapTypeAttributes(typeDefinition.attributes), context);
 
     return typeDefinitionObject;
 }
 
-sos::Object WrapValueDefinition(const mson::ValueDefinition& valueDefinition)
+sos::Object WrapValueDefinition(const mson::ValueDefinition& valueDefinition, const WrapContext& context)
 {
     sos::Object valueDefinitionObject;
 
     // Values
-    valueDefinitionObject.set(SerializeKey::Values,
-                              WrapCollection<mson::Value>()(valueDefinition.values, WrapValue));
+    SetCollection<mson::Value>(valueDefinitionObject, SerializeKey::Values,
+                               valueDefinition.values, BindContext(WrapValue, context), context);
 
     // Type Definition
-    valueDefinitionObject.set(SerializeKey::TypeDefinition, WrapTypeDefinition(valueDefinition.typeDefinition));
+    SetValue(valueDefinitionObject, SerializeKey::TypeDefinition, WrapTypeDefinition(valueDefinition.typeDefinition, context), context);
 
     return valueDefinitionObject;
 }
 
-sos::Object WrapPropertyName(const mson::PropertyName& propertyName)
+sos::Object WrapPropertyName(const mson::PropertyName& propertyName, const WrapContext& context)
 {
     sos::Object propertyNameObject;
 
     if (!propertyName.literal.empty()) {
-        propertyNameObject.set(SerializeKey::Literal, sos::String(propertyName.literal));
+        SetMember(propertyNameObject, SerializeKey::Literal, sos::String(propertyName.literal));
     }
     else if (!propertyName.variable.empty()) {
-        propertyNameObject.set(SerializeKey::Variable, WrapValueDefinition(propertyName.variable));
+        SetMember(propertyNameObject, SerializeKey::Variable, WrapValueDefinition(propertyName.variable, context));
     }
 
     return propertyNameObject;
 }
 
 // Forward declarations
-sos::Object WrapTypeSection(const mson::TypeSection& typeSection);
+sos::Object WrapTypeSection(const mson::TypeSection& typeSection, const WrapContext& context);
 
-const sos::String TypeSectionClassToString(const mson::TypeSection::Class& klass)
+sos::String TypeSectionClassToString(const mson::TypeSection::Class& klass)
 {
     switch (klass) {
         case mson::TypeSection::BlockDescriptionClass:
@@ -261,44 +262,44 @@ sos::String ElementClassToString(const Element::Class& element)
     return sos::String(str);
 }
 
-sos::Object WrapNamedType(const mson::NamedType& namedType)
+sos::Object WrapNamedType(const mson::NamedType& namedType, const WrapContext& context)
 {
     sos::Object namedTypeObject;
 
     // Name
-    namedTypeObject.set(SerializeKey::Name, WrapTypeName(namedType.name));
+    SetValue(namedTypeObject, SerializeKey::Name, WrapTypeName(namedType.name, context), context);
 
     // Type Definition
-    namedTypeObject.set(SerializeKey::TypeDefinition, WrapTypeDefinition(namedType.typeDefinition));
+    SetValue(namedTypeObject, SerializeKey::TypeDefinition, WrapTypeDefinition(namedType.typeDefinition, context), context);
 
     // Type Sections
-    namedTypeObject.set(SerializeKey::Sections, 
-                        WrapCollection<mson::TypeSection>()(namedType.sections, WrapTypeSection));
+    SetCollection<mson::TypeSection>(namedTypeObject, SerializeKey::Sections,
+                                     namedType.sections, BindContext(WrapTypeSection, context), context);
 
     return namedTypeObject;
 }
 
-sos::Object WrapKeyValue(const KeyValuePair& keyValue)
+sos::Object WrapKeyValue(const KeyValuePair& keyValue, const WrapContext& context)
 {
     sos::Object keyValueObject;
 
     // Name
-    keyValueObject.set(SerializeKey::Name, sos::String(keyValue.first));
+    SetMember(keyValueObject, SerializeKey::Name, sos::String(keyValue.first));
 
     // Value
-    keyValueObject.set(SerializeKey::Value, sos::String(keyValue.second));
+    SetString(keyValueObject, SerializeKey::Value, keyValue.second, context);
 
     return keyValueObject;
 }
 
-sos::Object WrapMetadata(const Metadata& metadata)
+sos::Object WrapMetadata(const Metadata& metadata, const WrapContext& context)
 {
-    return WrapKeyValue(metadata);
+    return WrapKeyValue(metadata, context);
 }
 
-sos::Object WrapHeader(const Header& header)
+sos::Object WrapHeader(const Header& header, const WrapContext& context)
 {
-    return WrapKeyValue(header);
+    return WrapKeyValue(header, context);
 }
 
 sos::Object WrapReference(const Reference& reference)
@@ -306,54 +307,54 @@ sos::Object WrapReference(const Reference& reference)
     sos::Object referenceObject;
 
     // Id
-    referenceObject.set(SerializeKey::Id, sos::String(reference.id));
+    SetMember(referenceObject, SerializeKey::Id, sos::String(reference.id));
 
     return referenceObject;
 }
 
-sos::Object WrapPropertyMember(const mson::PropertyMember& propertyMember)
+sos::Object WrapPropertyMember(const mson::PropertyMember& propertyMember, const WrapContext& context)
 {
     sos::Object propertyMemberObject;
 
     // Name
-    propertyMemberObject.set(SerializeKey::Name, WrapPropertyName(propertyMember.name));
+    SetMember(propertyMemberObject, SerializeKey::Name, WrapPropertyName(propertyMember.name, context));
 
     // Description
-    propertyMemberObject.set(SerializeKey::Description, sos::String(propertyMember.description));
+    SetString(propertyMemberObject, SerializeKey::Description, propertyMember.description, context);
 
     // Value Definition
-    propertyMemberObject.set(SerializeKey::ValueDefinition, WrapValueDefinition(propertyMember.valueDefinition));
+    SetValue(propertyMemberObject, SerializeKey::ValueDefinition, WrapValueDefinition(propertyMember.valueDefinition, context), context);
 
     // Type Sections
-    propertyMemberObject.set(SerializeKey::Sections,
-                             WrapCollection<mson::TypeSection>()(propertyMember.sections, WrapTypeSection));
+    SetCollection<mson::TypeSection>(propertyMemberObject, SerializeKey::Sections,
+                                     propertyMember.sections, BindContext(WrapTypeSection, context), context);
 
     return propertyMemberObject;
 }
 
-sos::Object WrapValueMember(const mson::ValueMember& valueMember)
+sos::Object WrapValueMember(const mson::ValueMember& valueMember, const WrapContext& context)
 {
     sos::Object valueMemberObject;
 
     // Description
-    valueMemberObject.set(SerializeKey::Description, sos::String(valueMember.description));
+    SetString(valueMemberObject, SerializeKey::Description, valueMember.description, context);
 
     // Value Definition
-    valueMemberObject.set(SerializeKey::ValueDefinition, WrapValueDefinition(valueMember.valueDefinition));
+    SetValue(valueMemberObject, SerializeKey::ValueDefinition, WrapValueDefinition(valueMember.valueDefinition, context), context);
 
     // Type Sections
-    valueMemberObject.set(SerializeKey::Sections,
-                          WrapCollection<mson::TypeSection>()(valueMember.sections, WrapTypeSection));
+    SetCollection<mson::TypeSection>(valueMemberObject, SerializeKey::Sections,
+                                     valueMember.sections, BindContext(WrapTypeSection, context), context);
 
     return valueMemberObject;
 }
 
-sos::Object WrapMixin(const mson::Mixin& mixin)
+sos::Object WrapMixin(const mson::Mixin& mixin, const WrapContext& context)
 {
-    return WrapTypeDefinition(mixin);
+    return WrapTypeDefinition(mixin, context);
 }
 
-sos::Object WrapMSONElement(const mson::Element& element)
+sos::Object WrapMSONElement(const mson::Element& element, const WrapContext& context)
 {
     sos::Object elementObject;
     std::string klass;
@@ -363,37 +364,37 @@ sos::Object WrapMSONElement(const mson::Element& element)
         case mson::Element::PropertyClass:
         {
             klass = "property";
-            elementObject.set(SerializeKey::Content, WrapPropertyMember(element.content.property));
+            SetMember(elementObject, SerializeKey::Content, WrapPropertyMember(element.content.property, context));
             break;
         }
 
         case mson::Element::ValueClass:
         {
             klass = "value";
-            elementObject.set(SerializeKey::Content, WrapValueMember(element.content.value));
+            SetMember(elementObject, SerializeKey::Content, WrapValueMember(element.content.value, context));
             break;
         }
 
         case mson::Element::MixinClass:
         {
             klass = "mixin";
-            elementObject.set(SerializeKey::Content, WrapMixin(element.content.mixin));
+            SetMember(elementObject, SerializeKey::Content, WrapMixin(element.content.mixin, context));
             break;
         }
 
         case mson::Element::OneOfClass:
         {
             klass = "oneOf";
-            elementObject.set(SerializeKey::Content, 
-                              WrapCollection<mson::Element>()(element.content.oneOf(), WrapMSONElement));
+            SetMember(elementObject, SerializeKey::Content, 
+                              WrapCollection<mson::Element>()(element.content.oneOf(), BindContext(WrapMSONElement, context)));
             break;
         }
 
         case mson::Element::GroupClass:
         {
             klass = "group";
-            elementObject.set(SerializeKey::Content, 
-                              WrapCollection<mson::Element>()(element.content.elements(), WrapMSONElement));
+            SetMember(elementObject, SerializeKey::Content, 
+                              WrapCollection<mson::Element>()(element.content.elements(), BindContext(WrapMSONElement, context)));
             break;
         }
 
@@ -401,49 +402,49 @@ sos::Object WrapMSONElement(const mson::Element& element)
             break;
     }
 
-    elementObject.set(SerializeKey::Class, sos::String(klass));
+    SetMember(elementObject, SerializeKey::Class, sos::String(klass));
 
     return elementObject;
 }
 
-sos::Object WrapTypeSection(const mson::TypeSection& section)
+sos::Object WrapTypeSection(const mson::TypeSection& section, const WrapContext& context)
 {
     sos::Object object;
 
     // Class
-    object.set(SerializeKey::Class, TypeSectionClassToString(section.klass));
+    SetMember(object, SerializeKey::Class, TypeSectionClassToString(section.klass));
 
     // Content
     if (!section.content.description.empty()) {
-        object.set(SerializeKey::Content, sos::String(section.content.description));
+        SetMember(object, SerializeKey::Content, sos::String(section.content.description));
     }
     else if (!section.content.value.empty()) {
-        object.set(SerializeKey::Content, sos::String(section.content.value));
+        SetMember(object, SerializeKey::Content, sos::String(section.content.value));
     }
     else if (!section.content.elements().empty()) {
-        object.set(SerializeKey::Content, 
-                   WrapCollection<mson::Element>()(section.content.elements(), WrapMSONElement));
+        SetMember(object, SerializeKey::Content, 
+                   WrapCollection<mson::Element>()(section.content.elements(), BindContext(WrapMSONElement, context)));
     }
 
     return object;
 }
 
-sos::Object WrapDataStructure(const DataStructure& dataStructure)
+sos::Object WrapDataStructure(const DataStructure& dataStructure, const WrapContext& context)
 {
     sos::Object dataStructureObject;
 
     // Element
-    dataStructureObject.set(SerializeKey::Element, ElementClassToString(Element::DataStructureElement));
+    SetMember(dataStructureObject, SerializeKey::Element, ElementClassToString(Element::DataStructureElement));
 
     // Name
-    dataStructureObject.set(SerializeKey::Name, WrapTypeName(dataStructure.name));
+    SetValue(dataStructureObject, SerializeKey::Name, WrapTypeName(dataStructure.name, context), context);
 
     // Type Definition
-    dataStructureObject.set(SerializeKey::TypeDefinition, WrapTypeDefinition(dataStructure.typeDefinition));
+    SetValue(dataStructureObject, SerializeKey::TypeDefinition, WrapTypeDefinition(dataStructure.typeDefinition, context), context);
 
     // Type Sections
-    dataStructureObject.set(SerializeKey::Sections,
-                            WrapCollection<mson::TypeSection>()(dataStructure.sections, WrapTypeSection));
+    SetCollection<mson::TypeSection>(dataStructureObject, SerializeKey::Sections,
+                                    dataStructure.sections, BindContext(WrapTypeSection, context), context);
 
     return dataStructureObject;
 }
@@ -453,66 +454,65 @@ sos::Object WrapAsset(const Asset& asset, const AssetRole& role)
     sos::Object assetObject;
 
     // Element
-    assetObject.set(SerializeKey::Element, ElementClassToString(Element::AssetElement));
+    SetMember(assetObject, SerializeKey::Element, ElementClassToString(Element::AssetElement));
 
     // Attributes
     sos::Object attributes;
 
     /// Role
-    attributes.set(SerializeKey::Role, AssetRoleToString(role));
+    SetMember(attributes, SerializeKey::Role, AssetRoleToString(role));
 
-    assetObject.set(SerializeKey::Attributes, attributes);
+    SetMember(assetObject, SerializeKey::Attributes, std::move(attributes));
 
     // Content
-    assetObject.set(SerializeKey::Content, sos::String(asset));
+    SetMember(assetObject, SerializeKey::Content, sos::String(asset));
 
     return assetObject;
 }
 
-sos::Object WrapPayload(const Payload& payload)
+sos::Object WrapPayload(const Payload& payload, const WrapContext& context)
 {
     sos::Object payloadObject;
 
     // Reference
     if (!payload.reference.id.empty()) {
-        payloadObject.set(SerializeKey::Reference, WrapReference(payload.reference));
+        SetMember(payloadObject, SerializeKey::Reference, WrapReference(payload.reference));
     }
 
     // Name
-    payloadObject.set(SerializeKey::Name, sos::String(payload.name));
+    SetString(payloadObject, SerializeKey::Name, payload.name, context);
 
     // Description
-    payloadObject.set(SerializeKey::Description, sos::String(payload.description));
+    SetString(payloadObject, SerializeKey::Description, payload.description, context);
 
     // Headers
-    payloadObject.set(SerializeKey::Headers,
-                      WrapCollection<Header>()(payload.headers, WrapHeader));
+    SetCollection<Header>(payloadObject, SerializeKey::Headers, payload.headers, BindContext(WrapHeader, context), context);
 
     // Body
-    payloadObject.set(SerializeKey::Body, sos::String(payload.body));
+    SetString(payloadObject, SerializeKey::Body, payload.body, context);
 
     // Schema
-    payloadObject.set(SerializeKey::Schema, sos::String(payload.schema));
+    SetString(payloadObject, SerializeKey::Schema, payload.schema, context);
 
     // Content
     sos::Array content;
 
     /// Attributes
     if (!payload.attributes.empty()) {
-        content.push(WrapDataStructure(payload.attributes));
+        PushItem(content, WrapDataStructure(payload.attributes, context));
     }
 
     /// Asset 'bodyExample'
     if (!payload.body.empty()) {
-        content.push(WrapAsset(payload.body, BodyExampleAssetRole));
+        PushItem(content, WrapAsset(payload.body, BodyExampleAssetRole));
     }
 
     /// Asset 'bodySchema'
     if (!payload.schema.empty()) {
-        content.push(WrapAsset(payload.schema, BodySchemaAssetRole));
+        PushItem(content, WrapAsset(payload.schema, BodySchemaAssetRole));
     }
 
-    payloadObject.set(SerializeKey::Content, content);
+    SetValue(payloadObject, SerializeKey::Content, std::move(content), context);
 
     return payloadObject;
 }
@@ -520,151 +520,169 @@ sos::Object WrapPayload(const Payload& payload)
 sos::Object WrapParameterValue(const Value& value)
 {
     sos::Object object;
-    object.set(SerializeKey::Value, sos::String(value.c_str()));
+    SetMember(object, SerializeKey::Value, sos::String(value.c_str()));
 
     return object;
 }
 
-sos::Object WrapParameter(const Parameter& parameter)
+sos::Object WrapParameter(const Parameter& parameter, const WrapContext& context)
 {
     sos::Object parameterObject;
 
     // Name
-    parameterObject.set(SerializeKey::Name, sos::String(parameter.name));
+    SetMember(parameterObject, SerializeKey::Name, sos::String(parameter.name));
 
     // Description
-    parameterObject.set(SerializeKey::Description, sos::String(parameter.description));
+    SetString(parameterObject, SerializeKey::Description, parameter.description, context);
 
     // Type
-    parameterObject.set(SerializeKey::Type, sos::String(parameter.type));
+    SetString(parameterObject, SerializeKey::Type, parameter.type, context);
 
     // Use
-    parameterObject.set(SerializeKey::Required, sos::Boolean(parameter.use != snowcrash::OptionalParameterUse));
+    SetBoolean(parameterObject, SerializeKey::Required, parameter.use != snowcrash::OptionalParameterUse, true, context);
 
     // Default Value
-    parameterObject.set(SerializeKey::Default, sos::String(parameter.defaultValue));
+    SetString(parameterObject, SerializeKey::Default, parameter.defaultValue, context);
 
     // Example Value
-    parameterObject.set(SerializeKey::Example, sos::String(parameter.exampleValue));
+    SetString(parameterObject, SerializeKey::Example, parameter.exampleValue, context);
 
     // Values
-    parameterObject.set(SerializeKey::Values, 
-                        WrapCollection<Value>()(parameter.values, WrapParameterValue));
+    SetCollection<Value>(parameterObject, SerializeKey::Values, parameter.values, WrapParameterValue, context);
 
     return parameterObject;
 }
 
-sos::Object WrapTransactionExample(const TransactionExample& example)
+sos::Object WrapTransactionExample(const TransactionExample& example, const WrapContext& context)
 {
     sos::Object exampleObject;
 
     // Name
-    exampleObject.set(SerializeKey::Name, sos::String(example.name));
+    SetString(exampleObject, SerializeKey::Name, example.name, context);
 
     // Description
-    exampleObject.set(SerializeKey::Description, sos::String(example.description));
+    SetString(exampleObject, SerializeKey::Description, example.description, context);
 
     // Requests
-    exampleObject.set(SerializeKey::Requests,
-                      WrapCollection<Request>()(example.requests, WrapPayload));
+    SetCollection<Request>(exampleObject, SerializeKey::Requests, example.requests, BindContext(WrapPayload, context), context);
 
     // Responses
-    exampleObject.set(SerializeKey::Responses,
-                      WrapCollection<Response>()(example.responses, WrapPayload));
+    SetCollection<Response>(exampleObject, SerializeKey::Responses, example.responses, BindContext(WrapPayload, context), context);
 
     return exampleObject;
 }
 
-sos::Object WrapAction(const Action& action)
+sos::Object WrapAction(const Action& action, const WrapContext& context)
 {
     sos::Object actionObject;
 
     // Name
-    actionObject.set(SerializeKey::Name, sos::String(action.name));
+    SetString(actionObject, SerializeKey::Name, action.name, context);
 
     // Description
-    actionObject.set(SerializeKey::Description, sos::String(action.description));
+    SetString(actionObject, SerializeKey::Description, action.description, context);
 
     // HTTP Method
-    actionObject.set(SerializeKey::Method, sos::String(action.method));
+    SetMember(actionObject, SerializeKey::Method, sos::String(action.method));
 
     // Parameters
-    actionObject.set(SerializeKey::Parameters,
-                     WrapCollection<Parameter>()(action.parameters, WrapParameter));
+    SetCollection<Parameter>(actionObject, SerializeKey::Parameters, action.parameters, BindContext(WrapParameter, context), context);
 
     // Attributes
     sos::Object attributes;
 
     /// Relation
-    attributes.set(SerializeKey::Relation, sos::String(action.relation.str));
+    SetString(attributes, SerializeKey::Relation, action.relation.str, context);
 
     /// URI Template
-    attributes.set(SerializeKey::URITemplate, sos::String(action.uriTemplate));
+    SetString(attributes, SerializeKey::URITemplate, action.uriTemplate, context);
 
-    actionObject.set(SerializeKey::Attributes, attributes);
+    SetValue(actionObject, SerializeKey::Attributes, std::move(attributes), context);
 
     // Content
     sos::Array content;
 
     if (!action.attributes.empty()) {
-        content.push(WrapDataStructure(action.attributes));
+        PushItem(content, WrapDataStructure(action.attributes, context));
     }
 
-    actionObject.set(SerializeKey::Content, content);
+    SetValue(actionObject, SerializeKey::Content, std::move(content), context);
 
     // Transaction Examples
-    actionObject.set(SerializeKey::Examples,
-                     WrapCollection<TransactionExample>()(action.examples, WrapTransactionExample));
+    SetCollection<TransactionExample>(actionObject, SerializeKey::Examples,
+                                      action.examples, BindContext(WrapTransactionExample, context), context);
 
     return actionObject;
 }
 
-sos::Object WrapResource(const Resource& resource)
+sos::Object WrapResource(const Resource& resource, const WrapContext& context)
 {
     sos::Object resourceObject;
 
     // Element
-    resourceObject.set(SerializeKey::Element, ElementClassToString(Element::ResourceElement));
+    SetMember(resourceObject, SerializeKey::Element, ElementClassToString(Element::ResourceElement));
 
     // Name
-    resourceObject.set(SerializeKey::Name, sos::String(resource.name));
+    SetString(resourceObject, SerializeKey::Name, resource.name, context);
 
     // Description
-    resourceObject.set(SerializeKey::Description, sos::String(resource.description));
+    SetString(resourceObject, SerializeKey::Description, resource.description, context);
 
     // URI Template
-    resourceObject.set(SerializeKey::URITemplate, sos::String(resource.uriTemplate));
+    SetMember(resourceObject, SerializeKey::URITemplate, sos::String(resource.uriTemplate));
 
     // Model
-    sos::Object model = (resource.model.name.empty() ? sos::Object() : WrapPayload(resource.model));
-    resourceObject.set(SerializeKey::Model, model);
+    if (!resource.model.name.empty()) {
+        SetMember(resourceObject, SerializeKey::Model, WrapPayload(resource.model, context));
+    }
+    else if (!context.sparse) {
+        SetMember(resourceObject, SerializeKey::Model, sos::Object());
+    }
 
     // Parameters
-    resourceObject.set(SerializeKey::Parameters,
-                       WrapCollection<Parameter>()(resource.parameters, WrapParameter));
+    SetCollection<Parameter>(resourceObject, SerializeKey::Parameters, resource.parameters, BindContext(WrapParameter, context), context);
 
     // Actions
-    resourceObject.set(SerializeKey::Actions,
-                       WrapCollection<Action>()(resource.actions, WrapAction));
+    SetCollection<Action>(resourceObject, SerializeKey::Actions, resource.actions, BindContext(WrapAction, context), context);
 
     // Content
     sos::Array content;
 
     if (!resource.attributes.empty()) {
-        content.push(WrapDataStructure(resource.attributes));
+        PushItem(content, WrapDataStructure(resource.attributes, context));
     }
 
-    resourceObject.set(SerializeKey::Content, content);
+    SetValue(resourceObject, SerializeKey::Content, std::move(content), context);
 
     return resourceObject;
 }
 
-sos::Object WrapResourceGroup(const Element& resourceGroup)
+/**
+ *  \brief Binds deadline and wrap context to wrapper so it can be used with WrapCollection
+ */
+template<typename T>
+struct DeadlineWrapper {
+
+    typedef sos::Object (*Wrapper)(const T&, const Deadline*, const WrapContext&);
+
+    Wrapper wrapper;
+    const Deadline* deadline;
+    const WrapContext& context;
+
+    DeadlineWrapper(Wrapper wrapper_, const Deadline* deadline_, const WrapContext& context_)
+    : wrapper(wrapper_), deadline(deadline_), context(context_) {}
+
+    sos::Object operator()(const T& value) const {
+        return wrapper(value, deadline, context);
+    }
+};
+
+sos::Object WrapResourceGroup(const Element& resourceGroup, const Deadline* deadline, const WrapContext& context)
 {
     sos::Object resourceGroupObject;
 
     // Name
-    resourceGroupObject.set(SerializeKey::Name, sos::String(resourceGroup.attributes.name));
+    SetString(resourceGroupObject, SerializeKey::Name, resourceGroup.attributes.name, context);
 
     // Description && Resources
     std::string description;
@@ -675,7 +693,8 @@ sos::Object WrapResourceGroup(const Element& resourceGroup)
          ++it) {
 
         if (it->element == Element::ResourceElement) {
-            resources.push(WrapResource(it->content.resource));
+            CheckDeadline(deadline);
+            PushItem(resources, WrapResource(it->content.resource, context));
         }
         else if (it->element == Element::CopyElement) {
 
@@ -687,48 +706,51 @@ sos::Object WrapResourceGroup(const Element& resourceGroup)
         }
     }
 
-    resourceGroupObject.set(SerializeKey::Description, sos::String(description));
-    resourceGroupObject.set(SerializeKey::Resources, resources);
+    SetString(resourceGroupObject, SerializeKey::Description, description, context);
+    SetValue(resourceGroupObject, SerializeKey::Resources, std::move(resources), context);
 
     return resourceGroupObject;
 }
 
-sos::Object WrapElement(const Element& element)
+sos::Object WrapElement(const Element& element, const Deadline* deadline, const WrapContext& context)
 {
+    CheckDeadline(deadline);
+
     sos::Object elementObject;
 
-    elementObject.set(SerializeKey::Element, ElementClassToString(element.element));
+    SetMember(elementObject, SerializeKey::Element, ElementClassToString(element.element));
 
     if (!element.attributes.name.empty()) {
 
         sos::Object attributes;
 
-        attributes.set(SerializeKey::Name, sos::String(element.attributes.name));
-        elementObject.set(SerializeKey::Attributes, attributes);
+        SetMember(attributes, SerializeKey::Name, sos::String(element.attributes.name));
+        SetMember(elementObject, SerializeKey::Attributes, std::move(attributes));
     }
 
     switch (element.element) {
         case Element::CopyElement:
         {
-            elementObject.set(SerializeKey::Content, sos::String(element.content.copy));
+            SetMember(elementObject, SerializeKey::Content, sos::String(element.content.copy));
             break;
         }
 
         case Element::CategoryElement:
         {
-            elementObject.set(SerializeKey::Content,
-                              WrapCollection<Element>()(element.content.elements(), WrapElement));
+            DeadlineWrapper<Element> wrapper(WrapElement, deadline, context);
+
+            SetCollection<Element>(elementObject, SerializeKey::Content, element.content.elements(), wrapper, context);
             break;
         }
 
         case Element::DataStructureElement:
         {
-            return WrapDataStructure(element.content.dataStructure);
+            return WrapDataStructure(element.content.dataStructure, context);
         }
 
         case Element::ResourceElement:
         {
-            return WrapResource(element.content.resource);
+            return WrapResource(element.content.resource, context);
         }
 
         default:
@@ -743,33 +765,44 @@ bool IsElementResourceGroup(const Element& element)
     return element.element == Element::CategoryElement && element.category == Element::ResourceGroupCategory;
 }
 
-sos::Object drafter::WrapBlueprint(const Blueprint& blueprint)
+sos::Object drafter::WrapBlueprint(const Blueprint& blueprint, const Deadline* deadline, WrapOptions options)
 {
+    if (options & ResolveMSONWrapOption) {
+        Blueprint resolved = blueprint;
+        ResolveBlueprintMSON(resolved);
+
+        return WrapBlueprint(resolved, deadline, options & ~ResolveMSONWrapOption);
+    }
+
+    WrapContext context(options);
     sos::Object blueprintObject;
 
     // Version
-    blueprintObject.set(SerializeKey::Version, sos::String(AST_SERIALIZATION_VERSION));
+    SetMember(blueprintObject, SerializeKey::Version, sos::String(AST_SERIALIZATION_VERSION));
 
     // Metadata
-    blueprintObject.set(SerializeKey::Metadata, 
-                        WrapCollection<Metadata>()(blueprint.metadata, WrapKeyValue));
+    SetCollection<Metadata>(blueprintObject, SerializeKey::Metadata, blueprint.metadata, BindContext(WrapKeyValue, context), context);
 
     // Name
-    blueprintObject.set(SerializeKey::Name, sos::String(blueprint.name));
+    SetString(blueprintObject, SerializeKey::Name, blueprint.name, context);
 
     // Description
-    blueprintObject.set(SerializeKey::Description, sos::String(blueprint.description));
+    SetString(blueprintObject, SerializeKey::Description, blueprint.description, context);
 
     // Element
-    blueprintObject.set(SerializeKey::Element, ElementClassToString(blueprint.element));
+    SetMember(blueprintObject, SerializeKey::Element, ElementClassToString(blueprint.element));
 
     // Resource Groups
-    blueprintObject.set(SerializeKey::ResourceGroups, 
-                        WrapCollection<Element>()(blueprint.content.elements(), WrapResourceGroup, IsElementResourceGroup));
+    DeadlineWrapper<Element> resourceGroupWrapper(WrapResourceGroup, deadline, context);
+
+    SetValue(blueprintObject, SerializeKey::ResourceGroups,
+             WrapCollection<Element>()(blueprint.content.elements(), resourceGroupWrapper, IsElementResourceGroup), context);
 
     // Content
-    blueprintObject.set(SerializeKey::Content,
-                        WrapCollection<Element>()(blueprint.content.elements(), WrapElement));
+    DeadlineWrapper<Element> elementWrapper(WrapElement, deadline, context);
+
+    SetCollection<Element>(blueprintObject, SerializeKey::Content,
+                           blueprint.content.elements(), elementWrapper, context);
 
     return blueprintObject;
 }
@@ -10,10 +10,23 @@
 #define DRAFTER_SERIALIZE_AST_H
 
 #include "Serialize.h"
+#include "Deadline.h"
 
 namespace drafter {
 
-    sos::Object WrapBlueprint(const snowcrash::Blueprint& blueprint);
+    /**
+     *  \brief Wrap blueprint AST for serialization
+     *
+     *  \param blueprint   Blueprint AST
+     *  \param deadline    Optional deadline checked at every element, NULL for no limit
+     *  \param options     SparseWrapOption leaves out empty and default-valued fields,
+     *                     ResolveMSONWrapOption wraps a copy with MSON expanded
+     *
+     *  \throw Cancelled when \param deadline expires
+     */
+    sos::Object WrapBlueprint(const snowcrash::Blueprint& blueprint,
+                              const Deadline* deadline = NULL,
+                              WrapOptions options = 0);
 }
 
 #endif
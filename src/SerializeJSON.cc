@@ -0,0 +1,119 @@
+//
+//  SerializeJSON.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "SerializeJSON.h"
+#include "Format.h"
+
+using namespace drafter;
+
+static void ProcessValue(const sos::Base& value, std::ostream& os, size_t level, DeadlineCounter& counter);
+
+static void ProcessArray(const sos::Base& value, std::ostream& os, size_t level, DeadlineCounter& counter)
+{
+    counter.tick();
+
+    if (value.array.empty()) {
+        os.write("[]", 2);
+        return;
+    }
+
+    os.write("[\n", 2);
+
+    for (sos::Bases::const_iterator it = value.array.begin(); it != value.array.end(); ++it) {
+
+        if (it != value.array.begin()) {
+            os.write(",\n", 2);
+        }
+
+        WriteIndent(level + 1, os);
+        ProcessValue(*it, os, level + 1, counter);
+    }
+
+    os.put('\n');
+    WriteIndent(level, os);
+    os.put(']');
+}
+
+static void ProcessObject(const sos::Base& value, std::ostream& os, size_t level, DeadlineCounter& counter)
+{
+    counter.tick();
+
+    if (value.keys.empty()) {
+        os.write("{}", 2);
+        return;
+    }
+
+    os.write("{\n", 2);
+
+    for (sos::Keys::const_iterator it = value.keys.begin(); it != value.keys.end(); ++it) {
+
+        if (it != value.keys.begin()) {
+            os.write(",\n", 2);
+        }
+
+        WriteIndent(level + 1, os);
+        WriteQuotedString(*it, os);
+        os.write(": ", 2);
+
+        sos::KeyValues::const_iterator member = value.object.find(*it);
+
+        if (member != value.object.end()) {
+            ProcessValue(member->second, os, level + 1, counter);
+        }
+        else {
+            os.write("null", 4);
+        }
+    }
+
+    os.put('\n');
+    WriteIndent(level, os);
+    os.put('}');
+}
+
+static void ProcessValue(const sos::Base& value, std::ostream& os, size_t level, DeadlineCounter& counter)
+{
+    switch (value.type) {
+        case sos::Base::StringType:
+            WriteQuotedString(value.str, os);
+            break;
+
+        case sos::Base::NumberType:
+            WriteNumber(value.number, os);
+            break;
+
+        case sos::Base::BooleanType:
+            if (value.boolean) {
+                os.write("true", 4);
+            }
+            else {
+                os.write("false", 5);
+            }
+            break;
+
+        case sos::Base::ArrayType:
+            ProcessArray(value, os, level, counter);
+            break;
+
+        case sos::Base::ObjectType:
+            ProcessObject(value, os, level, counter);
+            break;
+
+        default:
+            os.write("null", 4);
+            break;
+    }
+}
+
+drafter::SerializeJSON::SerializeJSON(const Deadline* deadline) : deadline_(deadline)
+{
+}
+
+void drafter::SerializeJSON::process(const sos::Base& value, std::ostream& os)
+{
+    DeadlineCounter counter(deadline_);
+    ProcessValue(value, os, 0, counter);
+}
@@ -0,0 +1,36 @@
+//
+//  SerializeJSON.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_SERIALIZE_JSON_H
+#define DRAFTER_SERIALIZE_JSON_H
+
+#include "sos.h"
+#include "Deadline.h"
+
+namespace drafter {
+
+    /**
+     *  \brief JSON serializer producing the same layout as sos::SerializeJSON
+     *
+     *  Two space indentation, one value per line. Integral numbers are
+     *  written by the integer fast path of Format.h, in full digits.
+     *
+     *  process() throws Cancelled when \param deadline given to constructor
+     *  expires, output written so far is left in the stream.
+     */
+    class SerializeJSON : public sos::Serialize {
+    public:
+        explicit SerializeJSON(const Deadline* deadline = NULL);
+
+        virtual void process(const sos::Base& value, std::ostream& os);
+
+    private:
+        const Deadline* deadline_;
+    };
+}
+
+#endif // #ifndef DRAFTER_SERIALIZE_JSON_H
@@ -23,8 +23,8 @@ static sos::Object WrapLocation(const mdp::BytesRange& range)
 {
     sos::Object location;
 
-    location.set(SerializeKey::AnnotationLocationIndex, sos::Number(range.location));
-    location.set(SerializeKey::AnnotationLocationLength, sos::Number(range.length));
+    SetMember(location, SerializeKey::AnnotationLocationIndex, sos::Number(range.location));
+    SetMember(location, SerializeKey::AnnotationLocationLength, sos::Number(range.length));
 
     return location;
 }
@@ -33,14 +33,16 @@ static sos::Object WrapAnnotation(const snowcrash::SourceAnnotation& annotation)
 {
     sos::Object object;
 
-    object.set(SerializeKey::AnnotationCode,     sos::Number(annotation.code));
-    object.set(SerializeKey::AnnotationMessage,  sos::String(annotation.message));
-    object.set(SerializeKey::AnnotationLocation, WrapCollection<mdp::BytesRange>()(annotation.location, WrapLocation));
+    SetMember(object, SerializeKey::AnnotationCode,     sos::Number(annotation.code));
+    SetMember(object, SerializeKey::AnnotationMessage,  sos::String(annotation.message));
+    SetMember(object, SerializeKey::AnnotationLocation, WrapCollection<mdp::BytesRange>()(annotation.location, WrapLocation));
 
     return object;
 }
 
-sos::Object drafter::WrapResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint, const snowcrash::BlueprintParserOptions options)
+sos::Object drafter::WrapResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint,
+                                const snowcrash::BlueprintParserOptions options,
+                                const Deadline* deadline)
 {
     sos::Object object;
 
@@ -48,19 +50,19 @@ sos::Object drafter::WrapResult(const snowcrash::ParseResult<snowcrash::Blueprin
 
     const Report& report = blueprint.report;
 
-    object.set(SerializeKey::Version, sos::String(PARSE_RESULT_SERIALIZATION_VERSION));
+    SetMember(object, SerializeKey::Version, sos::String(PARSE_RESULT_SERIALIZATION_VERSION));
     
-    object.set(SerializeKey::Ast, WrapBlueprint(blueprint.node));
+    SetMember(object, SerializeKey::Ast, WrapBlueprint(blueprint.node, deadline, options & (SparseWrapOption | ResolveMSONWrapOption)));
 
     if (options & ExportSourcemapOption) {
         const SourceMap<Blueprint>& sourceMap = blueprint.sourceMap;
-        object.set(SerializeKey::SourceMap, WrapBlueprintSourcemap(sourceMap));
+        SetMember(object, SerializeKey::SourceMap, WrapBlueprintSourcemap(sourceMap, deadline, options & SparseWrapOption));
     }
 
-    object.set(SerializeKey::Error, WrapAnnotation(report.error));
+    SetMember(object, SerializeKey::Error, WrapAnnotation(report.error));
 
     if (!report.warnings.empty()) {
-        object.set(SerializeKey::Warnings, WrapCollection<snowcrash::SourceAnnotation>()(report.warnings, WrapAnnotation));
+        SetMember(object, SerializeKey::Warnings, WrapCollection<snowcrash::SourceAnnotation>()(report.warnings, WrapAnnotation));
     }
 
     return object;
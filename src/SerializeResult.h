@@ -10,6 +10,7 @@
 #define DRAFTER_SERIALIZE_RESULT_H
 
 #include "Serialize.h"
+#include "Deadline.h"
 
 #include "SectionParserData.h" // required by BlueprintParserOptions
 
@@ -20,7 +21,22 @@ namespace snowcrash {
 
 namespace drafter {
 
-    sos::Object WrapResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint, const snowcrash::BlueprintParserOptions options);
+    /**
+     *  \brief Wrap parse result - AST, source map if requested, error and warnings
+     *
+     *  \param options     Parser options, with SparseWrapOption AST and source map are sparse,
+     *                     with ResolveMSONWrapOption MSON of AST is expanded
+     *  \param deadline    Optional deadline checked at every element, NULL for no limit
+     *
+     *  \throw Cancelled when \param deadline expires
+     *
+     *  Reentrant, the wrapped result may be wrapped by more threads at once.
+     *  Serializers keep buffers of the running process() call, use one
+     *  instance per thread.
+     */
+    sos::Object WrapResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint,
+                           const snowcrash::BlueprintParserOptions options,
+                           const Deadline* deadline = NULL);
 }
 
 #endif // #ifndef DRAFTER_SERIALIZE_RESULT_H
@@ -40,51 +40,59 @@ sos::Array WrapSourcemap(const SourceMapBase& value)
 
         sos::Array sourceMapRow;
 
-        sourceMapRow.push(sos::Number(it->location));
-        sourceMapRow.push(sos::Number(it->length));
+        PushItem(sourceMapRow, sos::Number(it->location));
+        PushItem(sourceMapRow, sos::Number(it->length));
 
-        sourceMap.push(sourceMapRow);
+        PushItem(sourceMap, std::move(sourceMapRow));
     }
 
     return sourceMap;
 }
 
+/** Set \param key to wrapped \param value unless it has no ranges and wrapping is sparse */
+void SetSourcemap(sos::Object& object, const std::string& key, const SourceMapBase& value, const WrapContext& context)
+{
+    if (!context.sparse || !value.sourceMap.empty()) {
+        SetMember(object, key, WrapSourcemap(value));
+    }
+}
+
 // Forward declarations
-sos::Array WrapTypeSectionSourcemap(const SourceMap<mson::TypeSection>& typeSection);
+sos::Array WrapTypeSectionSourcemap(const SourceMap<mson::TypeSection>& typeSection, const WrapContext& context);
 
-sos::Object WrapPropertyMemberSourcemap(const SourceMap<mson::PropertyMember>& propertyMember)
+sos::Object WrapPropertyMemberSourcemap(const SourceMap<mson::PropertyMember>& propertyMember, const WrapContext& context)
 {
     sos::Object propertyMemberObject;
 
     // Name
-    propertyMemberObject.set(SerializeKey::Name, WrapSourcemap(propertyMember.name));
+    SetSourcemap(propertyMemberObject, SerializeKey::Name, propertyMember.name, context);
 
     // Description
-    propertyMemberObject.set(SerializeKey::Description, WrapSourcemap(propertyMember.description));
+    SetSourcemap(propertyMemberObject, SerializeKey::Description, propertyMember.description, context);
 
     // Value Definition
-    propertyMemberObject.set(SerializeKey::ValueDefinition, WrapSourcemap(propertyMember.valueDefinition));
+    SetSourcemap(propertyMemberObject, SerializeKey::ValueDefinition, propertyMember.valueDefinition, context);
 
     // Type Sections
-    propertyMemberObject.set(SerializeKey::Sections, 
-                             WrapCollection<mson::TypeSection>()(propertyMember.sections.collection, WrapTypeSectionSourcemap));
+    SetCollection<mson::TypeSection>(propertyMemberObject, SerializeKey::Sections,
+                                     propertyMember.sections.collection, BindContext(WrapTypeSectionSourcemap, context), context);
 
     return propertyMemberObject;
 }
 
-sos::Object WrapValueMemberSourcemap(const SourceMap<mson::ValueMember>& valueMember)
+sos::Object WrapValueMemberSourcemap(const SourceMap<mson::ValueMember>& valueMember, const WrapContext& context)
 {
     sos::Object valueMemberObject;
 
     // Description
-    valueMemberObject.set(SerializeKey::Description, WrapSourcemap(valueMember.description));
+    SetSourcemap(valueMemberObject, SerializeKey::Description, valueMember.description, context);
 
     // Value Definition
-    valueMemberObject.set(SerializeKey::ValueDefinition, WrapSourcemap(valueMember.valueDefinition));
+    SetSourcemap(valueMemberObject, SerializeKey::ValueDefinition, valueMember.valueDefinition, context);
 
     // Type Sections
-    valueMemberObject.set(SerializeKey::Sections, 
-                          WrapCollection<mson::TypeSection>()(valueMember.sections.collection, WrapTypeSectionSourcemap));
+    SetCollection<mson::TypeSection>(valueMemberObject, SerializeKey::Sections,
+                                     valueMember.sections.collection, BindContext(WrapTypeSectionSourcemap, context), context);
 
     return valueMemberObject;
 }
@@ -94,26 +102,26 @@ sos::Array WrapMixinSourcemap(const SourceMap<mson::Mixin>& mixin)
     return WrapSourcemap(mixin);
 }
 
-sos::Base WrapMSONElementSourcemap(const SourceMap<mson::Element>& element)
+sos::Base WrapMSONElementSourcemap(const SourceMap<mson::Element>& element, const WrapContext& context)
 {
     if (!element.elements().collection.empty()) {
         // Same for oneOf
-        return WrapCollection<mson::Element>()(element.elements().collection, WrapMSONElementSourcemap);
+        return WrapCollection<mson::Element>()(element.elements().collection, BindContext(WrapMSONElementSourcemap, context));
     }
     else if (!element.mixin.sourceMap.empty()) {
         return WrapMixinSourcemap(element.mixin);             // return sos::Array
     }
     else if (!element.value.empty()) {
-        return WrapValueMemberSourcemap(element.value);       // return sos::Object
+        return WrapValueMemberSourcemap(element.value, context);       // return sos::Object
     }
     else if (!element.property.empty()) {
-        return WrapPropertyMemberSourcemap(element.property); // return sos::Object
+        return WrapPropertyMemberSourcemap(element.property, context); // return sos::Object
     }
 
     return sos::Null();                                       // return sos::Null
 }
 
-sos::Array WrapTypeSectionSourcemap(const SourceMap<mson::TypeSection>& section)
+sos::Array WrapTypeSectionSourcemap(const SourceMap<mson::TypeSection>& section, const WrapContext& context)
 {
     if (!section.description.sourceMap.empty()) {
         return WrapSourcemap(section.description);
@@ -122,233 +130,256 @@ sos::Array WrapTypeSectionSourcemap(const SourceMap<mson::TypeSection>& section)
         return WrapSourcemap(section.value);
     }
     else if (!section.elements().collection.empty()) {
-        return WrapCollection<mson::Element>()(section.elements().collection, WrapMSONElementSourcemap);
+        return WrapCollection<mson::Element>()(section.elements().collection, BindContext(WrapMSONElementSourcemap, context));
     }
 
     return sos::Array();
 }
 
-sos::Object WrapDataStructureSourcemap(const SourceMap<DataStructure>& dataStructure)
+sos::Object WrapDataStructureSourcemap(const SourceMap<DataStructure>& dataStructure, const WrapContext& context)
 {
     sos::Object dataStructureObject;
 
     // Name
-    dataStructureObject.set(SerializeKey::Name, WrapSourcemap(dataStructure.name));
+    SetSourcemap(dataStructureObject, SerializeKey::Name, dataStructure.name, context);
 
     // Type Definition
-    dataStructureObject.set(SerializeKey::TypeDefinition, WrapSourcemap(dataStructure.typeDefinition));
+    SetSourcemap(dataStructureObject, SerializeKey::TypeDefinition, dataStructure.typeDefinition, context);
 
     // Type Sections
-    dataStructureObject.set(SerializeKey::Sections, 
-                            WrapCollection<mson::TypeSection>()(dataStructure.sections.collection, WrapTypeSectionSourcemap));
+    SetCollection<mson::TypeSection>(dataStructureObject, SerializeKey::Sections,
+                                     dataStructure.sections.collection, BindContext(WrapTypeSectionSourcemap, context), context);
 
     return dataStructureObject;
 }
 
-sos::Object WrapAssetSourcemap(const SourceMap<Asset>& asset)
+sos::Object WrapAssetSourcemap(const SourceMap<Asset>& asset, const WrapContext& context)
 {
     sos::Object assetObject;
 
     // Content
-    assetObject.set(SerializeKey::Content, WrapSourcemap(asset));
+    SetSourcemap(assetObject, SerializeKey::Content, asset, context);
 
     return assetObject;
 }
 
-sos::Object WrapPayloadSourcemap(const SourceMap<Payload>& payload)
+sos::Object WrapPayloadSourcemap(const SourceMap<Payload>& payload, const WrapContext& context)
 {
     sos::Object payloadObject;
 
     // Reference
     if (!payload.reference.sourceMap.empty()) {
-        payloadObject.set(SerializeKey::Reference, WrapSourcemap(payload.reference));
+        SetSourcemap(payloadObject, SerializeKey::Reference, payload.reference, context);
     }
 
     // Name
-    payloadObject.set(SerializeKey::Name, WrapSourcemap(payload.name));
+    SetSourcemap(payloadObject, SerializeKey::Name, payload.name, context);
 
     // Description
-    payloadObject.set(SerializeKey::Description, WrapSourcemap(payload.description));
+    SetSourcemap(payloadObject, SerializeKey::Description, payload.description, context);
 
     // Headers
-    payloadObject.set(SerializeKey::Headers, 
-                      WrapCollection<Header>()(payload.headers.collection, WrapSourcemap));
+    SetCollection<Header>(payloadObject, SerializeKey::Headers, payload.headers.collection, WrapSourcemap, context);
 
     // Body
-    payloadObject.set(SerializeKey::Body, WrapSourcemap(payload.body));
+    SetSourcemap(payloadObject, SerializeKey::Body, payload.body, context);
 
     // Schema
-    payloadObject.set(SerializeKey::Schema, WrapSourcemap(payload.schema));
+    SetSourcemap(payloadObject, SerializeKey::Schema, payload.schema, context);
 
     // Content
     sos::Array content;
 
     /// Attributes
     if (!payload.attributes.empty()) {
-        content.push(WrapDataStructureSourcemap(payload.attributes));
+        PushItem(content, WrapDataStructureSourcemap(payload.attributes, context));
     }
 
     /// Asset 'bodyExample'
     if (!payload.body.sourceMap.empty()) {
-        content.push(WrapAssetSourcemap(payload.body));
+        PushItem(content, WrapAssetSourcemap(payload.body, context));
     }
 
     /// Asset 'bodySchema'
     if (!payload.schema.sourceMap.empty()) {
-        content.push(WrapAssetSourcemap(payload.schema));
+        PushItem(content, WrapAssetSourcemap(payload.schema, context));
     }
 
-    payloadObject.set(SerializeKey::Content, content);
+    SetValue(payloadObject, SerializeKey::Content, std::move(content), context);
 
     return payloadObject;
 }
 
-sos::Object WrapParameterValueSourceMap(const SourceMap<Value>& value)
+sos::Object WrapParameterValueSourceMap(const SourceMap<Value>& value, const WrapContext& context)
 {
     sos::Object object;
-    object.set(SerializeKey::Value, WrapSourcemap(value));
+    SetSourcemap(object, SerializeKey::Value, value, context);
     return object;
 }
 
-sos::Object WrapParameterSourcemap(const SourceMap<Parameter>& parameter) 
+sos::Object WrapParameterSourcemap(const SourceMap<Parameter>& parameter, const WrapContext& context) 
 {
     sos::Object object;
 
     // Name
-    object.set(SerializeKey::Name, WrapSourcemap(parameter.name));
+    SetSourcemap(object, SerializeKey::Name, parameter.name, context);
 
     // Description
-    object.set(SerializeKey::Description, WrapSourcemap(parameter.description));
+    SetSourcemap(object, SerializeKey::Description, parameter.description, context);
 
     // Type
-    object.set(SerializeKey::Type, WrapSourcemap(parameter.type));
+    SetSourcemap(object, SerializeKey::Type, parameter.type, context);
 
     // Use
-    object.set(SerializeKey::Required, WrapSourcemap(parameter.use));
+    SetSourcemap(object, SerializeKey::Required, parameter.use, context);
 
     // Example Value
-    object.set(SerializeKey::Example, WrapSourcemap(parameter.exampleValue));
+    SetSourcemap(object, SerializeKey::Example, parameter.exampleValue, context);
 
     // Default Value
-    object.set(SerializeKey::Default, WrapSourcemap(parameter.defaultValue));
+    SetSourcemap(object, SerializeKey::Default, parameter.defaultValue, context);
 
     // Values
-    object.set(SerializeKey::Values,
-               WrapCollection<Value>()(parameter.values.collection, WrapParameterValueSourceMap));
+    SetCollection<Value>(object, SerializeKey::Values,
+                         parameter.values.collection, BindContext(WrapParameterValueSourceMap, context), context);
 
     return object;
 }
 
-sos::Object WrapTransactionExampleSourcemap(const SourceMap<TransactionExample>& example)
+sos::Object WrapTransactionExampleSourcemap(const SourceMap<TransactionExample>& example, const WrapContext& context)
 {
     sos::Object exampleObject;
 
     // Name
-    exampleObject.set(SerializeKey::Name, WrapSourcemap(example.name));
+    SetSourcemap(exampleObject, SerializeKey::Name, example.name, context);
 
     // Description
-    exampleObject.set(SerializeKey::Description, WrapSourcemap(example.description));
+    SetSourcemap(exampleObject, SerializeKey::Description, example.description, context);
 
     // Requests
-    exampleObject.set(SerializeKey::Requests, 
-                      WrapCollection<Request>()(example.requests.collection, WrapPayloadSourcemap));
+    SetCollection<Request>(exampleObject, SerializeKey::Requests,
+                           example.requests.collection, BindContext(WrapPayloadSourcemap, context), context);
 
     // Responses
-    exampleObject.set(SerializeKey::Responses, 
-                      WrapCollection<Response>()(example.responses.collection, WrapPayloadSourcemap));
+    SetCollection<Response>(exampleObject, SerializeKey::Responses,
+                            example.responses.collection, BindContext(WrapPayloadSourcemap, context), context);
 
     return exampleObject;
 }
 
-sos::Object WrapActionSourcemap(const SourceMap<Action>& action)
+sos::Object WrapActionSourcemap(const SourceMap<Action>& action, const WrapContext& context)
 {
     sos::Object actionObject;
 
     // Name
-    actionObject.set(SerializeKey::Name, WrapSourcemap(action.name));
+    SetSourcemap(actionObject, SerializeKey::Name, action.name, context);
 
     // Description
-    actionObject.set(SerializeKey::Description, WrapSourcemap(action.description));
+    SetSourcemap(actionObject, SerializeKey::Description, action.description, context);
 
     // HTTP Method
-    actionObject.set(SerializeKey::Method, WrapSourcemap(action.method));
+    SetSourcemap(actionObject, SerializeKey::Method, action.method, context);
 
     // Parameters
-    actionObject.set(SerializeKey::Parameters, 
-                     WrapCollection<Parameter>()(action.parameters.collection, WrapParameterSourcemap));
+    SetCollection<Parameter>(actionObject, SerializeKey::Parameters,
+                             action.parameters.collection, BindContext(WrapParameterSourcemap, context), context);
 
     // Transaction Examples
-    actionObject.set(SerializeKey::Examples, 
-                     WrapCollection<TransactionExample>()(action.examples.collection, WrapTransactionExampleSourcemap));
+    SetCollection<TransactionExample>(actionObject, SerializeKey::Examples,
+                                      action.examples.collection, BindContext(WrapTransactionExampleSourcemap, context), context);
 
     // Attributes
     sos::Object attributes;
 
     /// Relation
-    attributes.set(SerializeKey::Relation, WrapSourcemap(action.relation));
+    SetSourcemap(attributes, SerializeKey::Relation, action.relation, context);
 
     /// URI Template
-    attributes.set(SerializeKey::URITemplate, WrapSourcemap(action.uriTemplate));
+    SetSourcemap(attributes, SerializeKey::URITemplate, action.uriTemplate, context);
 
-    actionObject.set(SerializeKey::Attributes, attributes);
+    SetValue(actionObject, SerializeKey::Attributes, std::move(attributes), context);
 
     // Content
     sos::Array content;
 
     /// Attributes
     if (!action.attributes.empty()) {
-        content.push(WrapDataStructureSourcemap(action.attributes));
+        PushItem(content, WrapDataStructureSourcemap(action.attributes, context));
     }
 
-    actionObject.set(SerializeKey::Content, content);
+    SetValue(actionObject, SerializeKey::Content, std::move(content), context);
 
     return actionObject;
 }
 
-sos::Object WrapResourceSourcemap(const SourceMap<Resource>& resource)
+sos::Object WrapResourceSourcemap(const SourceMap<Resource>& resource, const WrapContext& context)
 {
     sos::Object resourceObject;
 
     // Name
-    resourceObject.set(SerializeKey::Name, WrapSourcemap(resource.name));
+    SetSourcemap(resourceObject, SerializeKey::Name, resource.name, context);
 
     // Description
-    resourceObject.set(SerializeKey::Description, WrapSourcemap(resource.description));
+    SetSourcemap(resourceObject, SerializeKey::Description, resource.description, context);
 
     // URI Template
-    resourceObject.set(SerializeKey::URITemplate, WrapSourcemap(resource.uriTemplate));
+    SetSourcemap(resourceObject, SerializeKey::URITemplate, resource.uriTemplate, context);
 
     // Model
-    sos::Object model = (resource.model.name.sourceMap.empty() ? sos::Object() : WrapPayloadSourcemap(resource.model));
-    resourceObject.set(SerializeKey::Model, model);
+    if (!resource.model.name.sourceMap.empty()) {
+        SetMember(resourceObject, SerializeKey::Model, WrapPayloadSourcemap(resource.model, context));
+    }
+    else if (!context.sparse) {
+        SetMember(resourceObject, SerializeKey::Model, sos::Object());
+    }
 
     // Parameters
-    resourceObject.set(SerializeKey::Parameters, 
-                       WrapCollection<Parameter>()(resource.parameters.collection, WrapParameterSourcemap));
+    SetCollection<Parameter>(resourceObject, SerializeKey::Parameters,
+                             resource.parameters.collection, BindContext(WrapParameterSourcemap, context), context);
 
     // Actions
-    resourceObject.set(SerializeKey::Actions, 
-                       WrapCollection<Action>()(resource.actions.collection, WrapActionSourcemap));
+    SetCollection<Action>(resourceObject, SerializeKey::Actions,
+                          resource.actions.collection, BindContext(WrapActionSourcemap, context), context);
 
     // Content
     sos::Array content;
 
     /// Attributes
     if (!resource.attributes.empty()) {
-        content.push(WrapDataStructureSourcemap(resource.attributes));
+        PushItem(content, WrapDataStructureSourcemap(resource.attributes, context));
     }
 
-    resourceObject.set(SerializeKey::Content, content);
+    SetValue(resourceObject, SerializeKey::Content, std::move(content), context);
 
     return resourceObject;
 }
 
-sos::Object WrapResourceGroupSourcemap(const SourceMap<Element>& resourceGroup)
+/**
+ *  \brief Binds deadline and wrap context to wrapper so it can be used with WrapCollection
+ */
+template<typename T>
+struct DeadlineWrapper {
+
+    typedef sos::Object (*Wrapper)(const SourceMap<T>&, const Deadline*, const WrapContext&);
+
+    Wrapper wrapper;
+    const Deadline* deadline;
+    const WrapContext& context;
+
+    DeadlineWrapper(Wrapper wrapper_, const Deadline* deadline_, const WrapContext& context_)
+    : wrapper(wrapper_), deadline(deadline_), context(context_) {}
+
+    sos::Object operator()(const SourceMap<T>& value) const {
+        return wrapper(value, deadline, context);
+    }
+};
+
+sos::Object WrapResourceGroupSourcemap(const SourceMap<Element>& resourceGroup, const Deadline* deadline, const WrapContext& context)
 {
     sos::Object resourceGroupObject;
 
     // Name
-    resourceGroupObject.set(SerializeKey::Name, WrapSourcemap(resourceGroup.attributes.name));
+    SetSourcemap(resourceGroupObject, SerializeKey::Name, resourceGroup.attributes.name, context);
 
     // Description & Resources
     SourceMap<Description> description;
@@ -359,52 +390,57 @@ sos::Object WrapResourceGroupSourcemap(const SourceMap<Element>& resourceGroup)
          ++it) {
 
         if (it->element == Element::ResourceElement) {
-            resources.push(WrapResourceSourcemap(it->content.resource));
+            CheckDeadline(deadline);
+            PushItem(resources, WrapResourceSourcemap(it->content.resource, context));
         }
         else if (it->element == Element::CopyElement) {
             description.sourceMap.append(it->content.copy.sourceMap);
         }
     }
 
-    resourceGroupObject.set(SerializeKey::Description, WrapSourcemap(description));
-    resourceGroupObject.set(SerializeKey::Resources, resources);
+    SetSourcemap(resourceGroupObject, SerializeKey::Description, description, context);
+    SetValue(resourceGroupObject, SerializeKey::Resources, std::move(resources), context);
 
     return resourceGroupObject;
 }
 
-sos::Object WrapElementSourcemap(const SourceMap<Element>& element)
+sos::Object WrapElementSourcemap(const SourceMap<Element>& element, const Deadline* deadline, const WrapContext& context)
 {
+    CheckDeadline(deadline);
+
     sos::Object elementObject;
 
     if (!element.attributes.name.sourceMap.empty()) {
 
         sos::Object attributes;
 
-        attributes.set(SerializeKey::Name, WrapSourcemap(element.attributes.name));
-        elementObject.set(SerializeKey::Attributes, attributes);
+        SetSourcemap(attributes, SerializeKey::Name, element.attributes.name, context);
+        SetMember(elementObject, SerializeKey::Attributes, std::move(attributes));
     }
 
     switch (element.element) {
         case Element::CopyElement:
         {
-            elementObject.set(SerializeKey::Content, WrapSourcemap(element.content.copy));
+            SetSourcemap(elementObject, SerializeKey::Content, element.content.copy, context);
             break;
         }
 
         case Element::DataStructureElement:
         {
-            return WrapDataStructureSourcemap(element.content.dataStructure);
+            return WrapDataStructureSourcemap(element.content.dataStructure, context);
         }
 
         case Element::ResourceElement:
         {
-            return WrapResourceSourcemap(element.content.resource);
+            return WrapResourceSourcemap(element.content.resource, context);
         }
 
         case Element::CategoryElement:
         {
-            elementObject.set(SerializeKey::Content, 
-                              WrapCollection<Element>()(element.content.elements().collection, WrapElementSourcemap));
+            DeadlineWrapper<Element> wrapper(WrapElementSourcemap, deadline, context);
+
+            SetCollection<Element>(elementObject, SerializeKey::Content,
+                                   element.content.elements().collection, wrapper, context);
             break;
         }
 
@@ -420,27 +456,32 @@ bool IsElementResourceGroup(const SourceMap<Element>& element)
     return element.element == Element::CategoryElement && element.category == Element::ResourceGroupCategory;
 }
 
-sos::Object drafter::WrapBlueprintSourcemap(const SourceMap<Blueprint>& blueprint)
+sos::Object drafter::WrapBlueprintSourcemap(const SourceMap<Blueprint>& blueprint, const Deadline* deadline, WrapOptions options)
 {
+    WrapContext context(options);
     sos::Object blueprintObject;
 
     // Metadata
-    blueprintObject.set(SerializeKey::Metadata, 
-                        WrapCollection<Metadata>()(blueprint.metadata.collection, WrapSourcemap));
+    SetCollection<Metadata>(blueprintObject, SerializeKey::Metadata,
+                            blueprint.metadata.collection, WrapSourcemap, context);
 
     // Name
-    blueprintObject.set(SerializeKey::Name, WrapSourcemap(blueprint.name));
+    SetSourcemap(blueprintObject, SerializeKey::Name, blueprint.name, context);
 
     // Description
-    blueprintObject.set(SerializeKey::Description, WrapSourcemap(blueprint.description));
+    SetSourcemap(blueprintObject, SerializeKey::Description, blueprint.description, context);
 
     // Resource Groups
-    blueprintObject.set(SerializeKey::ResourceGroups, 
-                        WrapCollection<Element>()(blueprint.content.elements().collection, WrapResourceGroupSourcemap, IsElementResourceGroup));
+    DeadlineWrapper<Element> resourceGroupWrapper(WrapResourceGroupSourcemap, deadline, context);
+
+    SetValue(blueprintObject, SerializeKey::ResourceGroups,
+             WrapCollection<Element>()(blueprint.content.elements().collection, resourceGroupWrapper, IsElementResourceGroup), context);
 
     // Content
-    blueprintObject.set(SerializeKey::Content, 
-                        WrapCollection<Element>()(blueprint.content.elements().collection, WrapElementSourcemap));
+    DeadlineWrapper<Element> elementWrapper(WrapElementSourcemap, deadline, context);
+
+    SetCollection<Element>(blueprintObject, SerializeKey::Content,
+                           blueprint.content.elements().collection, elementWrapper, context);
 
     return blueprintObject;
 }
@@ -10,10 +10,23 @@
 #define DRAFTER_SERIALIZE_SOURCEMAP_H
 
 #include "Serialize.h"
+#include "Deadline.h"
 
 namespace drafter {
 
-    sos::Object WrapBlueprintSourcemap(const snowcrash::SourceMap<snowcrash::Blueprint>& blueprint);
+    /**
+     *  \brief Wrap blueprint source map for serialization
+     *
+     *  \param blueprint   Blueprint source map
+     *  \param deadline    Optional deadline checked at every element, NULL for no limit
+     *  \param options     SparseWrapOption leaves out empty source maps of object members,
+     *                     members of arrays are kept to stay aligned with the AST
+     *
+     *  \throw Cancelled when \param deadline expires
+     */
+    sos::Object WrapBlueprintSourcemap(const snowcrash::SourceMap<snowcrash::Blueprint>& blueprint,
+                                       const Deadline* deadline = NULL,
+                                       WrapOptions options = 0);
 }
 
 #endif
@@ -0,0 +1,515 @@
+//
+//  SerializeYAML.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "SerializeYAML.h"
+#include "Format.h"
+#include "Hash.h"
+#include "Serialize.h"
+
+#include <map>
+#include <string.h>
+#include <vector>
+
+using namespace drafter;
+
+static const sos::Base& Member(const sos::Base& value, const std::string& key)
+{
+    static const sos::Base null = sos::Null();
+
+    sos::KeyValues::const_iterator member = value.object.find(key);
+    return member != value.object.end() ? member->second : null;
+}
+
+/** Collections written on lines of their own, empty ones are written as `[]` and `{}` */
+static bool IsBlock(const sos::Base& value)
+{
+    return (value.type == sos::Base::ObjectType && !value.keys.empty()) ||
+           (value.type == sos::Base::ArrayType && !value.array.empty());
+}
+
+namespace {
+
+    /**
+     *  \brief Anchors and aliases of repeated collections of one serialized value
+     *
+     *  Collections are numbered in the order they are written. Content hashes
+     *  are computed bottom-up first, then collections are matched top-down the
+     *  way they will be written - a collection equal to an earlier one becomes
+     *  its alias and nothing inside of it is matched any more. Equal hashes are
+     *  confirmed by comparison, so a hash collision costs only a missed alias.
+     */
+    class Anchors {
+    public:
+
+        enum Mark {
+            NoMark = 0,
+            AnchorMark,
+            AliasMark
+        };
+
+        Anchors();
+
+        /**
+         *  \brief Find repeated collections of \param value
+         */
+        void find(const sos::Base& value, DeadlineCounter& counter);
+
+        /**
+         *  \brief Mark of the next written collection
+         *
+         *  \param name  Output - number of anchor or alias
+         *  \return AliasMark if the collection is to be skipped
+         */
+        Mark next(size_t& name);
+
+    private:
+
+        struct Node {
+            Hash hash;
+            size_t size;                ///< collections in subtree including this one
+            const sos::Base* value;
+            size_t original;            ///< index of the first equal collection
+            bool repeated;              ///< aliased later on
+            size_t name;                ///< anchor number, given when written
+
+            Node(const sos::Base* value_, size_t index)
+            : hash(0), size(1), value(value_), original(index), repeated(false), name(0) {}
+        };
+
+        std::vector<Node> nodes_;
+        size_t next_;
+        size_t names_;
+
+        Hash collect(const sos::Base& value, DeadlineCounter& counter);
+    };
+}
+
+Anchors::Anchors() : next_(0), names_(0)
+{
+}
+
+void Anchors::find(const sos::Base& value, DeadlineCounter& counter)
+{
+    collect(value, counter);
+
+    std::map<Hash, size_t> first;
+
+    for (size_t i = 0; i < nodes_.size();) {
+
+        std::map<Hash, size_t>::iterator it = first.find(nodes_[i].hash);
+
+        if (it == first.end()) {
+            first[nodes_[i].hash] = i;
+        }
+        else if (IsEqual(*nodes_[it->second].value, *nodes_[i].value)) {
+
+            nodes_[it->second].repeated = true;
+            nodes_[i].original = it->second;
+            i += nodes_[i].size;
+            continue;
+        }
+
+        ++i;
+    }
+}
+
+Hash Anchors::collect(const sos::Base& value, DeadlineCounter& counter)
+{
+    Hasher hasher;
+    hasher(static_cast<uint64_t>(value.type));
+
+    switch (value.type) {
+        case sos::Base::StringType:
+            return hasher(value.str).value;
+
+        case sos::Base::NumberType:
+        {
+            uint64_t bits;
+            memcpy(&bits, &value.number, sizeof(bits));
+            return hasher(bits).value;
+        }
+
+        case sos::Base::BooleanType:
+            return hasher(static_cast<uint64_t>(value.boolean)).value;
+
+        default:
+            break;
+    }
+
+    if (!IsBlock(value)) {
+        return hasher.value;
+    }
+
+    counter.tick();
+
+    size_t index = nodes_.size();
+    nodes_.push_back(Node(&value, index));
+
+    if (value.type == sos::Base::ObjectType) {
+        for (sos::Keys::const_iterator it = value.keys.begin(); it != value.keys.end(); ++it) {
+            hasher(*it)(collect(Member(value, *it), counter));
+        }
+    }
+    else {
+        hasher(static_cast<uint64_t>(value.array.size()));
+
+        for (sos::Bases::const_iterator it = value.array.begin(); it != value.array.end(); ++it) {
+            hasher(collect(*it, counter));
+        }
+    }
+
+    nodes_[index].hash = hasher.value;
+    nodes_[index].size = nodes_.size() - index;
+
+    return hasher.value;
+}
+
+Anchors::Mark Anchors::next(size_t& name)
+{
+    Node& node = nodes_[next_];
+
+    if (node.original != next_) {
+        name = nodes_[node.original].name;
+        next_ += node.size;
+        return AliasMark;
+    }
+
+    ++next_;
+
+    if (!node.repeated) {
+        return NoMark;
+    }
+
+    name = node.name = ++names_;
+    return AnchorMark;
+}
+
+static void ProcessMembers(const sos::Base& value, OutputBuffer& os, size_t level, bool last, DeadlineCounter& counter, Anchors* anchors);
+static void ProcessItems(const sos::Base& value, OutputBuffer& os, size_t level, bool last, DeadlineCounter& counter, Anchors* anchors);
+
+/**
+ *  \brief Offset of the first byte breaking literal block in [\param begin, \param end) of \param data or \param end
+ *
+ *  Control characters, DEL and lead bytes of C1 controls, Unicode line
+ *  separators and BOM are found, LF and tab are to be checked by caller.
+ *  Scans 16 bytes at once where SSE2 is available.
+ */
+static size_t FindLiteralBreak(const char* data, size_t begin, size_t end)
+{
+    size_t i = begin;
+
+#if defined(__SSE2__)
+    const __m128i control = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(0x7F);
+    const __m128i c1 = _mm_set1_epi8(static_cast<char>(0xC2));
+    const __m128i separator = _mm_set1_epi8(static_cast<char>(0xE2));
+    const __m128i bom = _mm_set1_epi8(static_cast<char>(0xEF));
+
+    for (; i + 16 <= end; i += 16) {
+
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+
+        __m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(block, control), control),
+                                                  _mm_cmpeq_epi8(block, del)),
+                                     _mm_or_si128(_mm_cmpeq_epi8(block, c1),
+                                                  _mm_or_si128(_mm_cmpeq_epi8(block, separator), _mm_cmpeq_epi8(block, bom))));
+
+        int mask = _mm_movemask_epi8(found);
+
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#endif
+
+    for (; i < end; ++i) {
+
+        unsigned char c = static_cast<unsigned char>(data[i]);
+
+        if (c < 0x20 || c == 0x7F || c == 0xC2 || c == 0xE2 || c == 0xEF) {
+            return i;
+        }
+    }
+
+    return end;
+}
+
+/**
+ *  \brief Multi-line string to be written as literal block scalar
+ *
+ *  Literal block keeps characters as they are, so the string must not
+ *  contain anything YAML reads differently - control characters other
+ *  than tab and LF, DEL, C1 controls, Unicode line separators and BOM.
+ *  Its first line must not start with white space, indentation of the
+ *  block would be detected wrong. Two and more trailing LFs need `|+`
+ *  which at the end of document would take in line breaks following it.
+ *
+ *  \param last  \param str is the last value of document
+ */
+static bool IsLiteral(const std::string& str, bool last)
+{
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(str.data());
+    const size_t size = str.size();
+
+    if (memchr(data, '\n', size) == NULL) {
+        return false;
+    }
+
+    size_t first = str.find_first_not_of('\n');
+
+    if (first == std::string::npos || data[first] == ' ' || data[first] == '\t') {
+        return false;
+    }
+
+    if (last && data[size - 1] == '\n' && data[size - 2] == '\n') {
+        return false;
+    }
+
+    for (size_t i = FindLiteralBreak(str.data(), 0, size); i < size; i = FindLiteralBreak(str.data(), i + 1, size)) {
+
+        unsigned char next = (i + 1 < size) ? data[i + 1] : 0;
+        unsigned char third = (i + 2 < size) ? data[i + 2] : 0;
+
+        switch (data[i]) {
+            case '\n':
+            case '\t':
+                break;
+
+            case 0xC2:  // U+0080 - U+009F
+                if (next < 0xA0) {
+                    return false;
+                }
+                break;
+
+            case 0xE2:  // U+2028, U+2029
+                if (next == 0x80 && (third == 0xA8 || third == 0xA9)) {
+                    return false;
+                }
+                break;
+
+            case 0xEF:  // U+FEFF
+                if (next == 0xBB && third == 0xBF) {
+                    return false;
+                }
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ *  \brief Write \param str checked by IsLiteral() as literal block one level deeper
+ *
+ *  Chomping indicator keeps trailing LFs - `|-` for none, `|` for one
+ *  and `|+` for more, written as empty lines.
+ */
+static void ProcessLiteral(const std::string& str, OutputBuffer& os, size_t level)
+{
+    const char* data = str.data();
+
+    size_t end = str.find_last_not_of('\n') + 1;
+    size_t trailing = str.size() - end;
+
+    if (trailing == 0) {
+        os.write(" |-\n", 4);
+    }
+    else if (trailing == 1) {
+        os.write(" |\n", 3);
+    }
+    else {
+        os.write(" |+\n", 4);
+    }
+
+    for (size_t begin = 0; begin < end;) {
+
+        const char* newline = static_cast<const char*>(memchr(data + begin, '\n', end - begin));
+        size_t lineEnd = newline ? newline - data : end;
+
+        if (lineEnd > begin) {
+            WriteIndent(level + 1, os);
+            os.write(data + begin, lineEnd - begin);
+        }
+
+        os.put('\n');
+        begin = lineEnd + 1;
+    }
+
+    for (size_t i = 1; i < trailing; ++i) {
+        os.put('\n');
+    }
+}
+
+static void ProcessScalar(const sos::Base& value, OutputBuffer& os)
+{
+    switch (value.type) {
+        case sos::Base::StringType:
+            WriteQuotedString(value.str, os);
+            break;
+
+        case sos::Base::NumberType:
+            WriteNumber(value.number, os);
+            break;
+
+        case sos::Base::BooleanType:
+            if (value.boolean) {
+                os.write("true", 4);
+            }
+            else {
+                os.write("false", 5);
+            }
+            break;
+
+        case sos::Base::ArrayType:
+            os.write("[]", 2);
+            break;
+
+        case sos::Base::ObjectType:
+            os.write("{}", 2);
+            break;
+
+        default:
+            os.write("null", 4);
+            break;
+    }
+}
+
+/**
+ *  \brief Write ` &a<n>` or ` *a<n>` before collection \param value
+ *
+ *  \return True if an alias was written instead of the collection
+ */
+static bool ProcessMark(const sos::Base& value, OutputBuffer& os, Anchors* anchors)
+{
+    if (!anchors || !IsBlock(value)) {
+        return false;
+    }
+
+    size_t name;
+    Anchors::Mark mark = anchors->next(name);
+
+    if (mark == Anchors::NoMark) {
+        return false;
+    }
+
+    os.write(mark == Anchors::AliasMark ? " *a" : " &a", 3);
+    WriteNumber(name, os);
+
+    if (mark == Anchors::AliasMark) {
+        os.put('\n');
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ *  \brief Write value following `key:` or `-`
+ *
+ *  Non-empty collections and multi-line strings continue on the next
+ *  lines one level deeper, anything else stays on the same line.
+ *
+ *  \param last  \param value is the last value of document
+ */
+static void ProcessNested(const sos::Base& value, OutputBuffer& os, size_t level, bool last, DeadlineCounter& counter, Anchors* anchors)
+{
+    if (ProcessMark(value, os, anchors)) {
+        return;
+    }
+
+    if (value.type == sos::Base::ObjectType && !value.keys.empty()) {
+        os.put('\n');
+        ProcessMembers(value, os, level + 1, last, counter, anchors);
+    }
+    else if (value.type == sos::Base::ArrayType && !value.array.empty()) {
+        os.put('\n');
+        ProcessItems(value, os, level + 1, last, counter, anchors);
+    }
+    else if (value.type == sos::Base::StringType && IsLiteral(value.str, last)) {
+        ProcessLiteral(value.str, os, level);
+    }
+    else {
+        os.put(' ');
+        ProcessScalar(value, os);
+        os.put('\n');
+    }
+}
+
+static void ProcessMembers(const sos::Base& value, OutputBuffer& os, size_t level, bool last, DeadlineCounter& counter, Anchors* anchors)
+{
+    counter.tick();
+
+    for (sos::Keys::const_iterator it = value.keys.begin(); it != value.keys.end(); ++it) {
+
+        WriteIndent(level, os);
+        os.write(it->data(), it->size());
+        os.put(':');
+
+        ProcessNested(Member(value, *it), os, level, last && it + 1 == value.keys.end(), counter, anchors);
+    }
+}
+
+static void ProcessItems(const sos::Base& value, OutputBuffer& os, size_t level, bool last, DeadlineCounter& counter, Anchors* anchors)
+{
+    counter.tick();
+
+    for (sos::Bases::const_iterator it = value.array.begin(); it != value.array.end(); ++it) {
+
+        WriteIndent(level, os);
+        os.put('-');
+
+        ProcessNested(*it, os, level, last && it + 1 == value.array.end(), counter, anchors);
+    }
+}
+
+drafter::SerializeYAML::SerializeYAML(const Deadline* deadline, bool aliases) : deadline_(deadline), aliases_(aliases)
+{
+}
+
+void drafter::SerializeYAML::process(const sos::Base& value, std::ostream& os)
+{
+    static const size_t BufferSize = 64 * 1024;
+
+    if (buffer_.empty()) {
+        buffer_.resize(BufferSize);
+    }
+
+    OutputBuffer out(buffer_, os);
+    DeadlineCounter counter(deadline_);
+
+    Anchors found;
+    Anchors* anchors = NULL;
+
+    try {
+        if (aliases_ && IsBlock(value)) {
+            found.find(value, counter);
+            anchors = &found;
+
+            size_t name;
+            anchors->next(name);    // the whole document is never repeated
+        }
+
+        if (value.type == sos::Base::ObjectType && !value.keys.empty()) {
+            ProcessMembers(value, out, 0, true, counter, anchors);
+        }
+        else if (value.type == sos::Base::ArrayType && !value.array.empty()) {
+            ProcessItems(value, out, 0, true, counter, anchors);
+        }
+        else {
+            ProcessScalar(value, out);
+        }
+    }
+    catch (const Cancelled&) {
+        out.flush();
+        throw;
+    }
+
+    out.flush();
+}
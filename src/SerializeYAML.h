@@ -0,0 +1,50 @@
+//
+//  SerializeYAML.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_SERIALIZE_YAML_H
+#define DRAFTER_SERIALIZE_YAML_H
+
+#include <vector>
+
+#include "sos.h"
+#include "Deadline.h"
+
+namespace drafter {
+
+    /**
+     *  \brief YAML serializer in the block layout of sos::SerializeYAML
+     *
+     *  Block style with two space indentation, strings double quoted with
+     *  JSON escapes. Multi-line strings are written as literal block scalars
+     *  (`|`) where YAML reads them back unchanged. Integral numbers are
+     *  written by the integer fast path of Format.h, in full digits.
+     *
+     *  Output is collected in a 64 KiB buffer kept for the next process()
+     *  call and written to the stream in blocks.
+     *
+     *  With \param aliases structurally identical collections are written
+     *  once - the first one marked with `&a<n>` anchor, every later one
+     *  replaced by `*a<n>` alias. YAML readers resolve aliases back to the
+     *  same value, the output is only smaller.
+     *
+     *  process() throws Cancelled when \param deadline given to constructor
+     *  expires, output written so far is left in the stream.
+     */
+    class SerializeYAML : public sos::Serialize {
+    public:
+        explicit SerializeYAML(const Deadline* deadline = NULL, bool aliases = false);
+
+        virtual void process(const sos::Base& value, std::ostream& os);
+
+    private:
+        const Deadline* deadline_;
+        bool aliases_;
+        std::vector<char> buffer_;
+    };
+}
+
+#endif // #ifndef DRAFTER_SERIALIZE_YAML_H
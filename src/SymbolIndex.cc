@@ -0,0 +1,334 @@
+//
+//  SymbolIndex.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "SymbolIndex.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+using snowcrash::Collection;
+
+using snowcrash::Action;
+using snowcrash::Resource;
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Blueprint;
+
+typedef Collection<SourceMap<Element> >::type ElementSourceMaps;
+typedef Collection<SourceMap<Action> >::type ActionSourceMaps;
+
+const size_t Symbol::NoParent;
+
+namespace {
+
+    /**
+     *  \brief Return source map of \param index-th member of \param collection or empty source map
+     */
+    template<typename T>
+    const T& SourceMapAt(const std::vector<T>& collection, size_t index)
+    {
+        static const T empty = T();
+        return index < collection.size() ? collection[index] : empty;
+    }
+
+    /** Extend symbol signature to cover \param sourceMap */
+    void Cover(const mdp::BytesRangeSet& sourceMap, Symbol& symbol, bool& found)
+    {
+        for (mdp::BytesRangeSet::const_iterator it = sourceMap.begin(); it != sourceMap.end(); ++it) {
+
+            if (!found || it->location < symbol.begin) {
+                symbol.begin = it->location;
+            }
+
+            if (!found || it->location + it->length > symbol.signatureEnd) {
+                symbol.signatureEnd = it->location + it->length;
+            }
+
+            found = true;
+        }
+    }
+
+    class Collector {
+    public:
+
+        Collector(Symbols& symbols, std::map<std::string, size_t>& definitions)
+        : symbols_(symbols), definitions_(definitions) {}
+
+        /** Add symbol if it has a source map, \return its index or Symbol::NoParent */
+        size_t add(Symbol& symbol, bool found)
+        {
+            if (!found) {
+                return Symbol::NoParent;
+            }
+
+            symbols_.push_back(symbol);
+            return symbols_.size() - 1;
+        }
+
+        void define(const std::string& name, size_t symbol)
+        {
+            if (!name.empty() && symbol != Symbol::NoParent && definitions_.find(name) == definitions_.end()) {
+                definitions_[name] = symbol;
+            }
+        }
+
+        void collectResource(const Resource& resource, const SourceMap<Resource>& sourceMap, size_t parent)
+        {
+            Symbol symbol;
+            bool found = false;
+
+            symbol.kind = Symbol::ResourceSymbol;
+            symbol.name = resource.name.empty() ? resource.uriTemplate : resource.name;
+            symbol.detail = resource.uriTemplate;
+            symbol.description = resource.description;
+            symbol.parent = parent;
+
+            Cover(sourceMap.name.sourceMap, symbol, found);
+            Cover(sourceMap.uriTemplate.sourceMap, symbol, found);
+
+            size_t index = add(symbol, found);
+
+            define(resource.attributes.name.symbol.literal, index);
+            define(resource.model.name, index);
+
+            const ActionSourceMaps& actionSourceMaps = sourceMap.actions.collection;
+
+            for (size_t i = 0; i < resource.actions.size(); ++i) {
+
+                const Action& action = resource.actions[i];
+                const SourceMap<Action>& actionSourceMap = SourceMapAt(actionSourceMaps, i);
+
+                Symbol actionSymbol;
+                bool actionFound = false;
+
+                actionSymbol.kind = Symbol::ActionSymbol;
+                actionSymbol.name = action.method;
+
+                if (!action.uriTemplate.empty()) {
+                    actionSymbol.name += " " + action.uriTemplate;
+                }
+
+                actionSymbol.detail = action.name;
+                actionSymbol.description = action.description;
+                actionSymbol.parent = index;
+
+                Cover(actionSourceMap.name.sourceMap, actionSymbol, actionFound);
+                Cover(actionSourceMap.method.sourceMap, actionSymbol, actionFound);
+                Cover(actionSourceMap.uriTemplate.sourceMap, actionSymbol, actionFound);
+
+                define(action.attributes.name.symbol.literal, add(actionSymbol, actionFound));
+            }
+        }
+
+        void collectElements(const Elements& elements, const ElementSourceMaps& sourceMaps, size_t parent)
+        {
+            for (size_t i = 0; i < elements.size(); ++i) {
+
+                const Element& element = elements[i];
+                const SourceMap<Element>& sourceMap = SourceMapAt(sourceMaps, i);
+
+                if (element.element == Element::ResourceElement) {
+                    collectResource(element.content.resource, sourceMap.content.resource, parent);
+                }
+                else if (element.element == Element::DataStructureElement) {
+
+                    Symbol symbol;
+                    bool found = false;
+
+                    symbol.kind = Symbol::DataStructureSymbol;
+                    symbol.name = element.content.dataStructure.name.symbol.literal;
+                    symbol.parent = parent;
+
+                    Cover(sourceMap.content.dataStructure.name.sourceMap, symbol, found);
+
+                    if (!found) {
+                        Cover(sourceMap.content.dataStructure.sourceMap, symbol, found);
+                    }
+
+                    define(symbol.name, add(symbol, found));
+                }
+                else if (element.element == Element::CategoryElement) {
+
+                    size_t group = parent;
+
+                    if (element.category == Element::ResourceGroupCategory && !element.attributes.name.empty()) {
+
+                        Symbol symbol;
+                        bool found = false;
+
+                        symbol.kind = Symbol::GroupSymbol;
+                        symbol.name = element.attributes.name;
+                        symbol.parent = parent;
+
+                        Cover(sourceMap.attributes.name.sourceMap, symbol, found);
+
+                        group = add(symbol, found);
+
+                        if (group == Symbol::NoParent) {
+                            group = parent;
+                        }
+                    }
+
+                    collectElements(element.content.elements(), sourceMap.content.elements().collection, group);
+                }
+                else if (element.element == Element::CopyElement && parent != Symbol::NoParent &&
+                         symbols_[parent].kind == Symbol::GroupSymbol && symbols_[parent].description.empty()) {
+
+                    symbols_[parent].description = element.content.copy;
+                }
+            }
+        }
+
+    private:
+
+        Symbols& symbols_;
+        std::map<std::string, size_t>& definitions_;
+    };
+
+    size_t Depth(const Symbols& symbols, size_t index)
+    {
+        size_t depth = 0;
+
+        for (; symbols[index].parent != Symbol::NoParent; index = symbols[index].parent) {
+            ++depth;
+        }
+
+        return depth;
+    }
+
+    bool BeginsBefore(size_t byte, const Symbol& symbol)
+    {
+        return byte < symbol.begin;
+    }
+}
+
+SymbolIndex::SymbolIndex(const Blueprint& blueprint,
+                         const SourceMap<Blueprint>& sourceMap,
+                         size_t sourceLength)
+{
+    Collector collector(symbols_, definitions_);
+    collector.collectElements(blueprint.content.elements(), sourceMap.content.elements().collection, Symbol::NoParent);
+
+    // Section ends where next symbol on the same or higher level begins
+    std::vector<std::pair<size_t, size_t> > open;  // (depth, index)
+
+    for (size_t i = 0; i < symbols_.size(); ++i) {
+
+        size_t depth = Depth(symbols_, i);
+
+        while (!open.empty() && open.back().first >= depth) {
+            symbols_[open.back().second].end = symbols_[i].begin;
+            open.pop_back();
+        }
+
+        open.push_back(std::make_pair(depth, i));
+    }
+
+    for (; !open.empty(); open.pop_back()) {
+        symbols_[open.back().second].end = sourceLength;
+    }
+
+    for (Symbols::iterator it = symbols_.begin(); it != symbols_.end(); ++it) {
+        it->end = std::max(it->end, it->signatureEnd);
+    }
+}
+
+const Symbols& SymbolIndex::symbols() const
+{
+    return symbols_;
+}
+
+const Symbol* SymbolIndex::symbolAt(size_t byte) const
+{
+    size_t index = std::upper_bound(symbols_.begin(), symbols_.end(), byte, BeginsBefore) - symbols_.begin();
+
+    if (index == 0) {
+        return NULL;
+    }
+
+    for (--index; index != Symbol::NoParent; index = symbols_[index].parent) {
+        if (byte >= symbols_[index].begin && byte < symbols_[index].end) {
+            return &symbols_[index];
+        }
+    }
+
+    return NULL;
+}
+
+const Symbol* SymbolIndex::definitionOf(const std::string& name) const
+{
+    std::map<std::string, size_t>::const_iterator it = definitions_.find(name);
+    return it != definitions_.end() ? &symbols_[it->second] : NULL;
+}
+
+std::string drafter::TypeReferenceAt(const mdp::ByteBuffer& source, size_t byte)
+{
+    if (byte >= source.size()) {
+        return std::string();
+    }
+
+    size_t lineEnd = source.find('\n', byte);
+
+    if (lineEnd == std::string::npos) {
+        lineEnd = source.size();
+    }
+
+    // Item starts after the nearest separator, inside an opening bracket on the same line
+    size_t begin = std::string::npos;
+    bool opened = false;
+
+    for (size_t i = byte; i > 0 && source[i - 1] != '\n'; --i) {
+
+        char c = source[i - 1];
+
+        if (c == '(' || c == '[') {
+            opened = true;
+
+            if (begin == std::string::npos) {
+                begin = i;
+            }
+
+            break;
+        }
+
+        if (c == ')' || c == ']') {
+            return std::string();
+        }
+
+        if (c == ',' && begin == std::string::npos) {
+            begin = i;
+        }
+    }
+
+    if (!opened) {
+        return std::string();
+    }
+
+    // Item ends at separator or closing bracket
+    size_t end = byte;
+
+    while (end < lineEnd && !strchr(",()[]", source[end])) {
+        ++end;
+    }
+
+    if (end == lineEnd) {
+        return std::string();
+    }
+
+    while (begin < end && (source[begin] == ' ' || source[begin] == '`')) {
+        ++begin;
+    }
+
+    while (end > begin && (source[end - 1] == ' ' || source[end - 1] == '`')) {
+        --end;
+    }
+
+    return source.substr(begin, end - begin);
+}
@@ -0,0 +1,91 @@
+//
+//  SymbolIndex.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_SYMBOL_INDEX_H
+#define DRAFTER_SYMBOL_INDEX_H
+
+#include <map>
+#include <vector>
+
+#include "BlueprintSourcemap.h"
+
+namespace drafter {
+
+    /**
+     *  \brief Resource group, resource, action or data structure with its place in source
+     */
+    struct Symbol {
+
+        enum Kind {
+            GroupSymbol,
+            ResourceSymbol,
+            ActionSymbol,
+            DataStructureSymbol
+        };
+
+        static const size_t NoParent = static_cast<size_t>(-1);
+
+        Kind kind;
+        std::string name;           ///< group name, resource name or URI template, method and URI template, type name
+        std::string detail;         ///< resource URI template, action name
+        std::string description;
+
+        size_t begin;               ///< first byte of symbol signature
+        size_t end;                 ///< byte after the section - start of next symbol on the same or higher level
+        size_t signatureEnd;        ///< byte after symbol signature
+
+        size_t parent;              ///< index of enclosing symbol or NoParent
+
+        Symbol() : kind(GroupSymbol), begin(0), end(0), signatureEnd(0), parent(NoParent) {}
+    };
+
+    typedef std::vector<Symbol> Symbols;
+
+    /**
+     *  \brief Outline of blueprint for editor lookups
+     *
+     *  Built once per parse from source maps. Symbols are in document order
+     *  with parents before children, symbol under a position is found by
+     *  binary search and named types by map lookup.
+     */
+    class SymbolIndex {
+    public:
+
+        /**
+         *  \param blueprint        Parsed blueprint
+         *  \param sourceMap        Its source map, blueprint must be parsed with ExportSourcemapOption
+         *  \param sourceLength     Size of parsed source in bytes
+         */
+        SymbolIndex(const snowcrash::Blueprint& blueprint,
+                    const snowcrash::SourceMap<snowcrash::Blueprint>& sourceMap,
+                    size_t sourceLength);
+
+        const Symbols& symbols() const;
+
+        /** Innermost symbol whose section contains \param byte or NULL */
+        const Symbol* symbolAt(size_t byte) const;
+
+        /** Data structure or resource defining named type \param name or NULL */
+        const Symbol* definitionOf(const std::string& name) const;
+
+    private:
+
+        Symbols symbols_;
+        std::map<std::string, size_t> definitions_;
+    };
+
+    /**
+     *  \brief Named type referenced at \param byte of \param source or empty string
+     *
+     *  Recognizes references in MSON type specifications `(array[Note], required)`
+     *  and Markdown links `[Note][]` - returns the comma separated item under
+     *  \param byte with spaces and backticks trimmed.
+     */
+    std::string TypeReferenceAt(const mdp::ByteBuffer& source, size_t byte);
+}
+
+#endif // #ifndef DRAFTER_SYMBOL_INDEX_H
@@ -0,0 +1,222 @@
+//
+//  ValidatePayloads.cc
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#include "ValidatePayloads.h"
+
+#include <atomic>
+#include <thread>
+
+#include "JSONReader.h"
+#include "SchemaCache.h"
+
+using namespace drafter;
+
+using snowcrash::SourceMap;
+
+using snowcrash::Payload;
+using snowcrash::TransactionExample;
+using snowcrash::Action;
+using snowcrash::Resource;
+using snowcrash::Element;
+using snowcrash::Elements;
+using snowcrash::Blueprint;
+
+namespace {
+
+    /**
+     *  \brief Payload with both body and schema
+     */
+    struct PayloadCheck {
+        const Payload* payload;
+        const SourceMap<Payload>* sourceMap;
+        std::string label;                  ///< e.g. `response 200 of GET /notes`
+        SchemaCache::schema_ptr schema;
+        std::string message;                ///< output - empty if body matches schema
+    };
+
+    typedef std::vector<PayloadCheck> PayloadChecks;
+
+    template<typename T>
+    const T& SourceMapAt(const std::vector<T>& collection, size_t index)
+    {
+        static const T empty = T();
+        return index < collection.size() ? collection[index] : empty;
+    }
+
+    void CollectPayload(const std::string& label,
+                        const Payload& payload,
+                        const SourceMap<Payload>& sourceMap,
+                        PayloadChecks& checks)
+    {
+        if (payload.body.empty() || payload.schema.empty()) {
+            return;
+        }
+
+        PayloadCheck check;
+
+        check.payload = &payload;
+        check.sourceMap = &sourceMap;
+        check.label = label;
+
+        checks.push_back(check);
+    }
+
+    void CollectPayloads(const std::string& kind,
+                         const std::string& suffix,
+                         const std::vector<Payload>& payloads,
+                         const std::vector<SourceMap<Payload> >& sourceMaps,
+                         PayloadChecks& checks)
+    {
+        for (size_t i = 0; i < payloads.size(); ++i) {
+
+            std::string label = payloads[i].name.empty() ? kind : kind + " " + payloads[i].name;
+            CollectPayload(label + suffix, payloads[i], SourceMapAt(sourceMaps, i), checks);
+        }
+    }
+
+    void CollectResourcePayloads(const Resource& resource,
+                                 const SourceMap<Resource>& sourceMap,
+                                 PayloadChecks& checks)
+    {
+        CollectPayload("model of " + resource.uriTemplate, resource.model, sourceMap.model, checks);
+
+        for (size_t i = 0; i < resource.actions.size(); ++i) {
+
+            const Action& action = resource.actions[i];
+            const SourceMap<Action>& actionSourceMap = SourceMapAt(sourceMap.actions.collection, i);
+
+            std::string suffix = " of " + action.method + " " +
+                (action.uriTemplate.empty() ? resource.uriTemplate : action.uriTemplate);
+
+            for (size_t j = 0; j < action.examples.size(); ++j) {
+
+                const TransactionExample& example = action.examples[j];
+                const SourceMap<TransactionExample>& exampleSourceMap = SourceMapAt(actionSourceMap.examples.collection, j);
+
+                CollectPayloads("request", suffix, example.requests, exampleSourceMap.requests.collection, checks);
+                CollectPayloads("response", suffix, example.responses, exampleSourceMap.responses.collection, checks);
+            }
+        }
+    }
+
+    void CollectElementPayloads(const Elements& elements,
+                                const std::vector<SourceMap<Element> >& sourceMaps,
+                                PayloadChecks& checks)
+    {
+        for (size_t i = 0; i < elements.size(); ++i) {
+
+            const Element& element = elements[i];
+            const SourceMap<Element>& sourceMap = SourceMapAt(sourceMaps, i);
+
+            if (element.element == Element::ResourceElement) {
+                CollectResourcePayloads(element.content.resource, sourceMap.content.resource, checks);
+            }
+            else if (element.element == Element::CategoryElement) {
+                CollectElementPayloads(element.content.elements(), sourceMap.content.elements().collection, checks);
+            }
+        }
+    }
+
+    void CheckPayload(PayloadCheck& check)
+    {
+        if (!check.schema->valid) {
+            check.message = check.label + ": " + check.schema->error;
+            return;
+        }
+
+        sos::Base body;
+        std::string error;
+
+        if (!ReadJSON(check.payload->body, body, error)) {
+            check.message = check.label + ": body example is not valid JSON: " + error;
+        }
+        else if (!check.schema->schema.validate(body, error)) {
+            check.message = check.label + ": body example does not match body schema: " + error;
+        }
+    }
+
+    /**
+     *  \brief Run CheckPayload() on all \param checks using up to \param threads workers
+     */
+    void CheckPayloads(PayloadChecks& checks, unsigned int threads)
+    {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+        }
+
+        if (threads > checks.size()) {
+            threads = static_cast<unsigned int>(checks.size());
+        }
+
+        std::atomic<size_t> next(0);
+
+        auto worker = [&checks, &next]() {
+            for (size_t i = next++; i < checks.size(); i = next++) {
+                CheckPayload(checks[i]);
+            }
+        };
+
+        if (threads <= 1) {
+            worker();
+            return;
+        }
+
+        std::vector<std::thread> workers;
+
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.push_back(std::thread(worker));
+        }
+
+        worker();
+
+        for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+            it->join();
+        }
+    }
+}
+
+void drafter::ValidatePayloads(const Blueprint& blueprint,
+                               const SourceMap<Blueprint>& sourceMap,
+                               const mdp::ByteBuffer& source,
+                               snowcrash::Report& report,
+                               SchemaCache* cache,
+                               unsigned int threads)
+{
+    PayloadChecks checks;
+    CollectElementPayloads(blueprint.content.elements(), sourceMap.content.elements().collection, checks);
+
+    if (checks.empty()) {
+        return;
+    }
+
+    SchemaCache localCache;
+
+    if (!cache) {
+        cache = &localCache;
+    }
+
+    // compile every distinct schema once, up front, so workers only read them
+    for (PayloadChecks::iterator it = checks.begin(); it != checks.end(); ++it) {
+        it->schema = cache->get(it->payload->schema);
+    }
+
+    CheckPayloads(checks, threads);
+
+    for (PayloadChecks::const_iterator it = checks.begin(); it != checks.end(); ++it) {
+
+        if (it->message.empty()) {
+            continue;
+        }
+
+        const mdp::BytesRangeSet& location = it->schema->valid ? it->sourceMap->body.sourceMap
+                                                               : it->sourceMap->schema.sourceMap;
+
+        report.warnings.push_back(snowcrash::Warning(it->message,
+                                                     PayloadValidationWarning,
+                                                     mdp::BytesRangeSetToCharactersRangeSet(location, source)));
+    }
+}
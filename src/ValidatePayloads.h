@@ -0,0 +1,51 @@
+//
+//  ValidatePayloads.h
+//  drafter
+//
+//  Copyright (c) 2015 Apiary Inc. All rights reserved.
+//
+
+#ifndef DRAFTER_VALIDATE_PAYLOADS_H
+#define DRAFTER_VALIDATE_PAYLOADS_H
+
+#include "BlueprintSourcemap.h"
+#include "SourceAnnotation.h"
+
+namespace drafter {
+
+    class SchemaCache;
+
+    /**
+     *  Warning codes of drafter's own checks. They start at 100 to stay clear
+     *  of snowcrash::WarningCode.
+     */
+    enum WarningCode {
+        PayloadValidationWarning = 100    ///< body example does not match body schema
+    };
+
+    /**
+     *  \brief Validate body example of every payload against its body schema
+     *
+     *  Checks models, requests and responses having both body and schema.
+     *  Every distinct schema is compiled once, bodies are validated in
+     *  parallel. Each mismatch, invalid body or invalid schema is appended to
+     *  \param report as PayloadValidationWarning located at the payload body
+     *  (or schema) - locations are empty if blueprint was parsed without
+     *  ExportSourcemapOption. Warnings are in order of payloads in blueprint.
+     *
+     *  \param blueprint    Parsed blueprint
+     *  \param sourceMap    Blueprint source map
+     *  \param source       Blueprint source, to translate source map into character ranges
+     *  \param report       Output - report to append warnings to
+     *  \param cache        Compiled schemas to reuse, NULL for cache local to this call
+     *  \param threads      Number of worker threads, 0 for number of CPUs
+     */
+    void ValidatePayloads(const snowcrash::Blueprint& blueprint,
+                          const snowcrash::SourceMap<snowcrash::Blueprint>& sourceMap,
+                          const mdp::ByteBuffer& source,
+                          snowcrash::Report& report,
+                          SchemaCache* cache = NULL,
+                          unsigned int threads = 0);
+}
+
+#endif // #ifndef DRAFTER_VALIDATE_PAYLOADS_H
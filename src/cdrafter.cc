@@ -1,16 +1,99 @@
 #include "cdrafter.h"
 
+#include "drafter.h"
 #include "snowcrash.h"
-#include "sosJSON.h"
+#include "SerializeJSON.h"
 
 #include "SerializeAST.h"
 #include "SerializeSourcemap.h"
 #include "SerializeResult.h"
+#include "Routes.h"
+#include "ResultCache.h"
+#include "PositionIndex.h"
+#include "JSONPatch.h"
 
 #include <string.h>
+#include <vector>
 
 namespace sc = snowcrash;
 
+/** result cache, empty while disabled - accessed only by std::atomic_load()/std::atomic_store() */
+static std::shared_ptr<drafter::ResultCache> resultCache;
+
+struct sc_shared_result {
+    drafter::ResultCache::result_ptr result;
+};
+
+struct sc_deadline {
+    drafter::Deadline deadline;
+
+    sc_deadline() {}
+    explicit sc_deadline(unsigned long milliseconds) : deadline(std::chrono::milliseconds(milliseconds)) {}
+};
+
+struct sc_patch_session {
+    drafter::PatchSession session;
+};
+
+/**
+ *  \brief Stream buffer passing written data to sc_write_callback in chunks
+ *
+ *  Throws WriteFailed when callback asks to stop, the stream must have
+ *  badbit in its exceptions() to pass it to the caller.
+ */
+class CallbackBuffer : public std::streambuf {
+public:
+
+    struct WriteFailed {};
+
+    CallbackBuffer(sc_write_callback write, void* userdata)
+    : write_(write), userdata_(userdata), buffer_(SC_WRITE_CHUNK_SIZE)
+    {
+        setp(&buffer_[0], &buffer_[0] + buffer_.size());
+    }
+
+protected:
+
+    virtual int_type overflow(int_type c)
+    {
+        flush();
+
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    virtual int sync()
+    {
+        flush();
+        return 0;
+    }
+
+private:
+
+    sc_write_callback write_;
+    void* userdata_;
+    std::vector<char> buffer_;
+
+    void flush()
+    {
+        size_t length = pptr() - pbase();
+
+        if (length == 0) {
+            return;
+        }
+
+        setp(&buffer_[0], &buffer_[0] + buffer_.size());
+
+        if (write_(&buffer_[0], length, userdata_) != 0) {
+            throw WriteFailed();
+        }
+    }
+};
+
 static char* ToString(const std::stringstream& stream) 
 {
     size_t length = stream.str().length() + 1;
@@ -19,19 +102,68 @@ static char* ToString(const std::stringstream& stream)
     return str;
 }
 
+/**
+ *  \brief Return result of parsing \param source, from result cache if possible
+ */
+static drafter::ResultCache::result_ptr ParseCached(const char* source,
+                                                   sc_blueprint_parser_options options)
+{
+    std::shared_ptr<drafter::ResultCache> cache = std::atomic_load(&resultCache);
+    std::string input = source;
+
+    if (cache) {
+        drafter::ResultCache::result_ptr cached = cache->get(input, options);
+
+        if (cached) {
+            return cached;
+        }
+    }
+
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(input, options, blueprint);
+
+    drafter::SerializeJSON serializer;
+    std::stringstream resultStream;
+
+    serializer.process(drafter::WrapResult(blueprint, options), resultStream);
+    resultStream << "\n";
+
+    std::string data = resultStream.str();
+
+    if (cache) {
+        return cache->put(input, options, blueprint.report.error.code, data);
+    }
+
+    std::shared_ptr<drafter::ResultCache::Result> parsed(new drafter::ResultCache::Result);
+
+    parsed->options = options;
+    parsed->code = blueprint.report.error.code;
+    parsed->data.swap(data);
+
+    return parsed;
+}
+
 SC_API int drafter_c_parse(const char* source, 
                            sc_blueprint_parser_options options, 
                            char** result) 
 {
+    if (result && std::atomic_load(&resultCache)) {
+        drafter::ResultCache::result_ptr parsed = ParseCached(source, options);
+
+        *result = (char*)malloc(parsed->data.size() + 1);
+        memcpy(*result, parsed->data.c_str(), parsed->data.size() + 1);
+
+        return parsed->code;
+    }
 
     std::stringstream inputStream;
 
     inputStream << source;
 
     sc::ParseResult<sc::Blueprint> blueprint;
-    sc::parse(inputStream.str(), options, blueprint);
+    drafter::ParseBlueprint(inputStream.str(), options, blueprint);
 
-    sos::SerializeJSON serializer;
+    drafter::SerializeJSON serializer;
 
     if (result) {
         std::stringstream resultStream;
@@ -42,3 +174,475 @@ SC_API int drafter_c_parse(const char* source,
 
     return blueprint.report.error.code;
 }
+
+SC_API int drafter_c_parse_positions(const char* source,
+                                     sc_blueprint_parser_options options,
+                                     enum sc_position_unit unit,
+                                     char** result)
+{
+    std::string input = source;
+
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(input, options, blueprint);
+
+    if (result) {
+        sos::Object wrapped = drafter::WrapResult(blueprint, options);
+        drafter::ConvertResultPositions(wrapped, drafter::PositionIndex(input), static_cast<drafter::PositionUnit>(unit));
+
+        std::stringstream resultStream;
+        drafter::SerializeJSON serializer;
+
+        serializer.process(wrapped, resultStream);
+        resultStream << "\n";
+        *result = ToString(resultStream);
+    }
+
+    return blueprint.report.error.code;
+}
+
+SC_API int drafter_c_routes(const char* source,
+                            sc_blueprint_parser_options options,
+                            char** result)
+{
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(source, options | sc::ExportSourcemapOption, blueprint);
+
+    if (result) {
+        drafter::Routes routes;
+        drafter::CollectRoutes(blueprint.node, blueprint.sourceMap, routes);
+
+        std::stringstream resultStream;
+        drafter::WriteRoutes(routes, resultStream);
+        *result = ToString(resultStream);
+    }
+
+    return blueprint.report.error.code;
+}
+
+SC_API void drafter_c_enable_result_cache(size_t capacity)
+{
+    std::shared_ptr<drafter::ResultCache> cache;
+
+    if (capacity > 0) {
+        cache.reset(new drafter::ResultCache(capacity));
+    }
+
+    std::atomic_store(&resultCache, cache);
+}
+
+SC_API void drafter_c_result_cache_stats(sc_result_cache_stats* stats)
+{
+    if (!stats) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    std::shared_ptr<drafter::ResultCache> cache = std::atomic_load(&resultCache);
+
+    if (!cache) {
+        return;
+    }
+
+    drafter::ResultCache::Statistics statistics = cache->statistics();
+
+    stats->hits = statistics.hits;
+    stats->misses = statistics.misses;
+    stats->evictions = statistics.evictions;
+    stats->entries = statistics.entries;
+    stats->bytes = statistics.weight;
+}
+
+SC_API int drafter_c_parse_shared(const char* source,
+                                  sc_blueprint_parser_options options,
+                                  const sc_shared_result** result)
+{
+    sc_shared_result* shared = new sc_shared_result;
+    shared->result = ParseCached(source, options);
+
+    int code = shared->result->code;
+
+    if (result) {
+        *result = shared;
+    }
+    else {
+        delete shared;
+    }
+
+    return code;
+}
+
+SC_API const char* drafter_c_shared_result_data(const sc_shared_result* result)
+{
+    return result ? result->result->data.c_str() : NULL;
+}
+
+SC_API void drafter_c_release_shared_result(const sc_shared_result* result)
+{
+    delete result;
+}
+
+SC_API sc_deadline* drafter_c_create_deadline(unsigned long milliseconds)
+{
+    return milliseconds ? new sc_deadline(milliseconds) : new sc_deadline;
+}
+
+SC_API void drafter_c_cancel(sc_deadline* deadline)
+{
+    if (deadline) {
+        deadline->deadline.cancel();
+    }
+}
+
+SC_API void drafter_c_free_deadline(sc_deadline* deadline)
+{
+    delete deadline;
+}
+
+SC_API int drafter_c_parse_until(const char* source,
+                                 sc_blueprint_parser_options options,
+                                 const sc_deadline* deadline,
+                                 char** result)
+{
+    const drafter::Deadline* limit = deadline ? &deadline->deadline : NULL;
+
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(source, options, blueprint, limit);
+
+    if (!result) {
+        return blueprint.report.error.code;
+    }
+
+    std::stringstream resultStream;
+
+    if (blueprint.report.error.code != drafter::CancelledError) {
+        try {
+            drafter::SerializeJSON serializer(limit);
+            serializer.process(drafter::WrapResult(blueprint, options, limit), resultStream);
+        }
+        catch (const drafter::Cancelled& cancelled) {
+            drafter::ReportCancelled(blueprint.report, cancelled);
+        }
+    }
+
+    if (blueprint.report.error.code == drafter::CancelledError) {
+        // diagnostics only, partial output is dropped
+        sc::ParseResult<sc::Blueprint> cancelled;
+        cancelled.report = blueprint.report;
+
+        resultStream.str(std::string());
+
+        drafter::SerializeJSON serializer;
+        serializer.process(drafter::WrapResult(cancelled, 0), resultStream);
+    }
+
+    resultStream << "\n";
+    *result = ToString(resultStream);
+
+    return blueprint.report.error.code;
+}
+
+SC_API sc_patch_session* drafter_c_create_patch_session(void)
+{
+    return new sc_patch_session;
+}
+
+SC_API void drafter_c_free_patch_session(sc_patch_session* session)
+{
+    delete session;
+}
+
+SC_API int drafter_c_parse_patch(sc_patch_session* session,
+                                 const char* source,
+                                 sc_blueprint_parser_options options,
+                                 char** result)
+{
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(source, options, blueprint);
+
+    if (session && result) {
+        std::stringstream resultStream;
+        drafter::SerializeJSON serializer;
+
+        serializer.process(session->session.update(drafter::WrapResult(blueprint, options)), resultStream);
+        resultStream << "\n";
+        *result = ToString(resultStream);
+    }
+
+    return blueprint.report.error.code;
+}
+
+SC_API int drafter_c_parse_to(const char* source,
+                              size_t length,
+                              sc_blueprint_parser_options options,
+                              sc_write_callback write,
+                              void* userdata)
+{
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(std::string(source, length), options, blueprint);
+
+    if (!write) {
+        return blueprint.report.error.code;
+    }
+
+    CallbackBuffer buffer(write, userdata);
+    std::ostream resultStream(&buffer);
+
+    resultStream.exceptions(std::ios::badbit);
+
+    try {
+        drafter::SerializeJSON serializer;
+
+        // wrapped whole, only the serialized text is streamed
+        serializer.process(drafter::WrapResult(blueprint, options), resultStream);
+        resultStream << "\n";
+        resultStream.flush();
+    }
+    catch (const CallbackBuffer::WriteFailed&) {
+        return SC_WRITE_ERROR;
+    }
+
+    return blueprint.report.error.code;
+}
+
+struct sc_resource_group {
+    const sc::Element* element;                     ///< NULL for resources outside of any group
+    std::vector<const sc::Resource*> resources;
+};
+
+struct sc_result {
+    sc::ParseResult<sc::Blueprint> blueprint;
+    std::vector<sc_resource_group> groups;
+};
+
+namespace {
+
+    /** AST nodes behind handles, handles are never dereferenced as themselves */
+    inline const sc::Resource* Node(const sc_resource* resource) { return reinterpret_cast<const sc::Resource*>(resource); }
+    inline const sc::Action* Node(const sc_action* action) { return reinterpret_cast<const sc::Action*>(action); }
+    inline const sc::TransactionExample* Node(const sc_example* example) { return reinterpret_cast<const sc::TransactionExample*>(example); }
+    inline const sc::Payload* Node(const sc_payload* payload) { return reinterpret_cast<const sc::Payload*>(payload); }
+
+    sc_string_view View(const std::string& str)
+    {
+        sc_string_view view = { str.data(), str.size() };
+        return view;
+    }
+
+    sc_string_view EmptyView()
+    {
+        sc_string_view view = { "", 0 };
+        return view;
+    }
+
+    /** \return Pointer to \param index of \param collection, NULL if out of range */
+    template <typename T>
+    const T* At(const std::vector<T>& collection, size_t index)
+    {
+        return index < collection.size() ? &collection[index] : NULL;
+    }
+
+    /** Collect resources of \param blueprint by their groups */
+    void CollectResourceGroups(const sc::Blueprint& blueprint, std::vector<sc_resource_group>& groups)
+    {
+        const sc::Elements& elements = blueprint.content.elements();
+
+        for (sc::Elements::const_iterator it = elements.begin(); it != elements.end(); ++it) {
+
+            if (it->element == sc::Element::ResourceElement) {
+
+                if (groups.empty() || groups.back().element) {
+                    sc_resource_group ungrouped = { NULL, std::vector<const sc::Resource*>() };
+                    groups.push_back(ungrouped);
+                }
+
+                groups.back().resources.push_back(&it->content.resource);
+                continue;
+            }
+
+            if (it->element != sc::Element::CategoryElement || it->category != sc::Element::ResourceGroupCategory) {
+                continue;
+            }
+
+            sc_resource_group group = { &*it, std::vector<const sc::Resource*>() };
+            const sc::Elements& members = it->content.elements();
+
+            for (sc::Elements::const_iterator member = members.begin(); member != members.end(); ++member) {
+                if (member->element == sc::Element::ResourceElement) {
+                    group.resources.push_back(&member->content.resource);
+                }
+            }
+
+            groups.push_back(group);
+        }
+    }
+}
+
+SC_API int drafter_c_parse_result(const char* source,
+                                  size_t length,
+                                  sc_blueprint_parser_options options,
+                                  sc_result** result)
+{
+    sc_result* parsed = new sc_result;
+    drafter::ParseBlueprint(std::string(source, length), options, parsed->blueprint);
+
+    // pointers into AST, it does not move anymore
+    CollectResourceGroups(parsed->blueprint.node, parsed->groups);
+
+    int code = parsed->blueprint.report.error.code;
+
+    if (result) {
+        *result = parsed;
+    }
+    else {
+        delete parsed;
+    }
+
+    return code;
+}
+
+SC_API void drafter_c_free_result(sc_result* result)
+{
+    delete result;
+}
+
+SC_API sc_string_view drafter_c_result_name(const sc_result* result)
+{
+    return result ? View(result->blueprint.node.name) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_result_error(const sc_result* result)
+{
+    return result ? View(result->blueprint.report.error.message) : EmptyView();
+}
+
+SC_API size_t drafter_c_resource_group_count(const sc_result* result)
+{
+    return result ? result->groups.size() : 0;
+}
+
+SC_API const sc_resource_group* drafter_c_resource_group(const sc_result* result, size_t index)
+{
+    return result ? At(result->groups, index) : NULL;
+}
+
+SC_API sc_string_view drafter_c_resource_group_name(const sc_resource_group* group)
+{
+    return group && group->element ? View(group->element->attributes.name) : EmptyView();
+}
+
+SC_API size_t drafter_c_resource_count(const sc_resource_group* group)
+{
+    return group ? group->resources.size() : 0;
+}
+
+SC_API const sc_resource* drafter_c_resource(const sc_resource_group* group, size_t index)
+{
+    if (!group || index >= group->resources.size()) {
+        return NULL;
+    }
+
+    return reinterpret_cast<const sc_resource*>(group->resources[index]);
+}
+
+SC_API sc_string_view drafter_c_resource_name(const sc_resource* resource)
+{
+    return resource ? View(Node(resource)->name) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_resource_uri_template(const sc_resource* resource)
+{
+    return resource ? View(Node(resource)->uriTemplate) : EmptyView();
+}
+
+SC_API size_t drafter_c_action_count(const sc_resource* resource)
+{
+    return resource ? Node(resource)->actions.size() : 0;
+}
+
+SC_API const sc_action* drafter_c_action(const sc_resource* resource, size_t index)
+{
+    return resource ? reinterpret_cast<const sc_action*>(At(Node(resource)->actions, index)) : NULL;
+}
+
+SC_API sc_string_view drafter_c_action_name(const sc_action* action)
+{
+    return action ? View(Node(action)->name) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_action_method(const sc_action* action)
+{
+    return action ? View(Node(action)->method) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_action_uri_template(const sc_action* action)
+{
+    return action ? View(Node(action)->uriTemplate) : EmptyView();
+}
+
+SC_API size_t drafter_c_example_count(const sc_action* action)
+{
+    return action ? Node(action)->examples.size() : 0;
+}
+
+SC_API const sc_example* drafter_c_example(const sc_action* action, size_t index)
+{
+    return action ? reinterpret_cast<const sc_example*>(At(Node(action)->examples, index)) : NULL;
+}
+
+SC_API sc_string_view drafter_c_example_name(const sc_example* example)
+{
+    return example ? View(Node(example)->name) : EmptyView();
+}
+
+SC_API size_t drafter_c_request_count(const sc_example* example)
+{
+    return example ? Node(example)->requests.size() : 0;
+}
+
+SC_API const sc_payload* drafter_c_request(const sc_example* example, size_t index)
+{
+    return example ? reinterpret_cast<const sc_payload*>(At(Node(example)->requests, index)) : NULL;
+}
+
+SC_API size_t drafter_c_response_count(const sc_example* example)
+{
+    return example ? Node(example)->responses.size() : 0;
+}
+
+SC_API const sc_payload* drafter_c_response(const sc_example* example, size_t index)
+{
+    return example ? reinterpret_cast<const sc_payload*>(At(Node(example)->responses, index)) : NULL;
+}
+
+SC_API sc_string_view drafter_c_payload_name(const sc_payload* payload)
+{
+    return payload ? View(Node(payload)->name) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_payload_body(const sc_payload* payload)
+{
+    return payload ? View(Node(payload)->body) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_payload_schema(const sc_payload* payload)
+{
+    return payload ? View(Node(payload)->schema) : EmptyView();
+}
+
+SC_API size_t drafter_c_header_count(const sc_payload* payload)
+{
+    return payload ? Node(payload)->headers.size() : 0;
+}
+
+SC_API sc_string_view drafter_c_header_name(const sc_payload* payload, size_t index)
+{
+    const sc::Header* header = payload ? At(Node(payload)->headers, index) : NULL;
+    return header ? View(header->first) : EmptyView();
+}
+
+SC_API sc_string_view drafter_c_header_value(const sc_payload* payload, size_t index)
+{
+    const sc::Header* header = payload ? At(Node(payload)->headers, index) : NULL;
+    return header ? View(header->second) : EmptyView();
+}
@@ -14,6 +14,8 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include "Platform.h" // use Platform.h from snowcrash - we should probably move it to drafter
 
 /**
@@ -32,6 +34,10 @@ extern "C" {
  *  You have to release it by calling standard free() function
  *
  *  if `result` input is NULL output is not created for param and parsed `source` is just validated
+ *
+ *  Drafter keeps no shared state for this interface but the locked result
+ *  cache. Calls on their own arguments may run on more threads at once as
+ *  far as snowcrash parser is reentrant, which is not verified yet.
  */
 
 typedef unsigned int sc_blueprint_parser_options;
@@ -40,13 +46,334 @@ typedef unsigned int sc_blueprint_parser_options;
 enum sc_blueprint_parser_option {
     SC_RENDER_DESCRIPTIONS_OPTION = (1 << 0),       /// < Render Markdown in description.
     SC_REQUIRE_BLUEPRINT_NAME_OPTION = (1 << 1),    /// < Treat missing blueprint name as error
-    SC_EXPORT_SORUCEMAP_OPTION = (1 << 2)           /// < Export source maps AST
+    SC_EXPORT_SORUCEMAP_OPTION = (1 << 2),          /// < Export source maps AST
+    SC_SPARSE_OUTPUT_OPTION = (1 << 8),             /// < Leave out empty and default-valued fields of AST and source maps
+    SC_RESOLVE_MSON_OPTION = (1 << 9)               /// < Expand MSON inheritance and mixins of named types in AST
 };
 
 SC_API int drafter_c_parse(const char* source, 
                            sc_blueprint_parser_options option, 
                            char** result);
 
+/**
+ *  \brief Route table of blueprint - one line per action, without serializing the whole AST
+ *
+ *  \param source        A textual source data to be parsed.
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param result        Tab separated route table, columns are:
+ *                       group, resource URI template, action URI template,
+ *                       method, name, relation, URI template source map, method source map
+ *
+ *  \return Error status code. Zero represents success, non-zero a failure.
+ *
+ *  As with drafter_c_parse() `result` must be released by calling free()
+ */
+SC_API int drafter_c_routes(const char* source,
+                            sc_blueprint_parser_options options,
+                            char** result);
+
+/**
+ *  \brief Enable in-process cache of parse results
+ *
+ *  \param capacity     Approximate memory for cached sources and results in bytes,
+ *                       0 disables the cache and drops cached results
+ *
+ *  While the cache is enabled drafter_c_parse() and drafter_c_parse_shared()
+ *  return the stored result for source and options they have already seen
+ *  instead of parsing again. The cache is LRU bounded by \param capacity,
+ *  safe for concurrent callers and disabled by default. Calling it again
+ *  replaces the cache with an empty one.
+ *
+ *  Capacity is split into up to 16 independently locked parts of at least
+ *  4 MB each. A result which does not fit into one part together with its
+ *  source is not cached - a cache below 8 MB keeps results up to its whole
+ *  capacity, a 64 MB one up to 4 MB.
+ */
+SC_API void drafter_c_enable_result_cache(size_t capacity);
+
+/** brief Counters of result cache, see drafter_c_result_cache_stats() */
+typedef struct sc_result_cache_stats {
+    unsigned long long hits;        /// < results returned from the cache
+    unsigned long long misses;      /// < lookups which had to parse
+    unsigned long long evictions;   /// < results dropped to fit capacity
+    size_t entries;                 /// < results in the cache
+    size_t bytes;                   /// < approximate memory held by the cache
+} sc_result_cache_stats;
+
+/**
+ *  \brief Fill \param stats with counters of result cache, all zero if the cache is disabled
+ */
+SC_API void drafter_c_result_cache_stats(sc_result_cache_stats* stats);
+
+/** brief Immutable parse result shared with the result cache */
+typedef struct sc_shared_result sc_shared_result;
+
+/**
+ *  \brief Parse like drafter_c_parse() without copying the result
+ *
+ *  \param source        A textual source data to be parsed.
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param result        Output - handle of JSON parse result, get its content by
+ *                       drafter_c_shared_result_data()
+ *
+ *  \return Error status code. Zero represents success, non-zero a failure.
+ *
+ *  On cache hit the handle refers to the cached buffer itself. The buffer is
+ *  valid until the handle is released by drafter_c_release_shared_result(),
+ *  even if the result is evicted or the cache is disabled meanwhile.
+ */
+SC_API int drafter_c_parse_shared(const char* source,
+                                  sc_blueprint_parser_options options,
+                                  const sc_shared_result** result);
+
+/** \brief Zero terminated JSON parse result of \param result */
+SC_API const char* drafter_c_shared_result_data(const sc_shared_result* result);
+
+/** \brief Release handle returned by drafter_c_parse_shared() */
+SC_API void drafter_c_release_shared_result(const sc_shared_result* result);
+
+/** brief Units of source map and annotation positions, see drafter_c_parse_positions() */
+enum sc_position_unit {
+    SC_BYTE_POSITIONS = 0,                          /// < As drafter_c_parse() - source maps in bytes, annotations in characters
+    SC_CODE_POINT_POSITIONS,                        /// < Unicode code points
+    SC_UTF16_POSITIONS,                             /// < UTF-16 code units, as JavaScript strings count
+    SC_LINE_COLUMN_POSITIONS                        /// < 1-based line and column (code points) of start and end
+};
+
+/**
+ *  \brief Parse like drafter_c_parse() with positions in \param unit
+ *
+ *  Source map rows are `[location, length]` in \param unit, for
+ *  SC_LINE_COLUMN_POSITIONS `[line, column, end line, end column]` with end
+ *  just after the range. Annotation locations are `{index, length}`, for
+ *  SC_LINE_COLUMN_POSITIONS `{line, column, endLine, endColumn}`. Source is
+ *  indexed once, so conversion costs are proportional to number of positions.
+ *
+ *  As with drafter_c_parse() `result` must be released by calling free()
+ */
+SC_API int drafter_c_parse_positions(const char* source,
+                                     sc_blueprint_parser_options options,
+                                     enum sc_position_unit unit,
+                                     char** result);
+
+/** brief Error codes of drafter itself, see drafter_c_parse_until() */
+enum sc_error_code {
+    SC_CANCELLED_ERROR = 100,                       /// < Deadline expired or parsing cancelled
+    SC_WRITE_ERROR = 101                            /// < Write callback of drafter_c_parse_to() failed
+};
+
+/** brief Deadline and cancellation token for drafter_c_parse_until() */
+typedef struct sc_deadline sc_deadline;
+
+/**
+ *  \brief Create deadline expiring \param milliseconds from now
+ *
+ *  0 creates deadline without time limit, expiring only by drafter_c_cancel().
+ *  Release it by drafter_c_free_deadline() when no parse uses it anymore.
+ */
+SC_API sc_deadline* drafter_c_create_deadline(unsigned long milliseconds);
+
+/**
+ *  \brief Expire \param deadline now
+ *
+ *  Safe to call from another thread while drafter_c_parse_until() runs.
+ */
+SC_API void drafter_c_cancel(sc_deadline* deadline);
+
+/** \brief Release deadline created by drafter_c_create_deadline() */
+SC_API void drafter_c_free_deadline(sc_deadline* deadline);
+
+/**
+ *  \brief Parse like drafter_c_parse(), giving up when \param deadline expires
+ *
+ *  \param source        A textual source data to be parsed.
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param deadline      Deadline checked between elements, NULL for no limit
+ *  \param result        Output - as drafter_c_parse()
+ *
+ *  \return Error status code, SC_CANCELLED_ERROR if \param deadline expired.
+ *
+ *  Cancelled result is still complete JSON parse result - with empty AST,
+ *  SC_CANCELLED_ERROR error and the warnings of parsing if it has finished.
+ *  Result cache is not used.
+ *
+ *  Snowcrash parser itself can not be interrupted. It runs on a worker
+ *  thread and when \param deadline expires meanwhile, the call returns
+ *  without waiting for it - the abandoned parse keeps its CPU and memory
+ *  until it finishes in background. While 4 abandoned parses are still
+ *  running, further calls with a deadline fail at once with
+ *  SC_CANCELLED_ERROR. As with drafter_c_parse() `result` must be
+ *  released by calling free().
+ */
+SC_API int drafter_c_parse_until(const char* source,
+                                 sc_blueprint_parser_options options,
+                                 const sc_deadline* deadline,
+                                 char** result);
+
+/** brief Previous result of one document for drafter_c_parse_patch() */
+typedef struct sc_patch_session sc_patch_session;
+
+/**
+ *  \brief Create session for drafter_c_parse_patch()
+ *
+ *  Use one session per edited document. Session must not be used from
+ *  more threads at once. Release it by drafter_c_free_patch_session().
+ */
+SC_API sc_patch_session* drafter_c_create_patch_session(void);
+
+/** \brief Release session created by drafter_c_create_patch_session() */
+SC_API void drafter_c_free_patch_session(sc_patch_session* session);
+
+/**
+ *  \brief Parse like drafter_c_parse(), returning changes since the previous parse of \param session
+ *
+ *  \param session       Session keeping the previous result
+ *  \param source        A textual source data to be parsed.
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param result        Output - RFC 6902 JSON Patch turning the previous
+ *                       parse result of \param session into the new one
+ *
+ *  \return Error status code. Zero represents success, non-zero a failure.
+ *
+ *  The first patch of session replaces the whole document. Unchanged
+ *  subtrees are skipped by comparing their content hashes. As with
+ *  drafter_c_parse() `result` must be released by calling free().
+ */
+SC_API int drafter_c_parse_patch(sc_patch_session* session,
+                                 const char* source,
+                                 sc_blueprint_parser_options options,
+                                 char** result);
+
+/** brief Largest chunk passed to sc_write_callback */
+#define SC_WRITE_CHUNK_SIZE (64 * 1024)
+
+/**
+ *  \brief Receives serialized result of drafter_c_parse_to() chunk by chunk
+ *
+ *  \param data          Next \param length bytes of result, valid only during the call
+ *  \param length        1 to SC_WRITE_CHUNK_SIZE bytes
+ *  \param userdata      As given to drafter_c_parse_to()
+ *
+ *  \return Zero to continue, non-zero to stop
+ */
+typedef int (*sc_write_callback)(const char* data, size_t length, void* userdata);
+
+/**
+ *  \brief Parse like drafter_c_parse(), writing the result through \param write
+ *
+ *  \param source        A textual source data to be parsed, need not be zero terminated
+ *  \param length        Length of \param source in bytes
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param write         Callback receiving the JSON parse result
+ *  \param userdata      Passed to every \param write call
+ *
+ *  \return Error status code. Zero represents success, non-zero a failure.
+ *  SC_WRITE_ERROR if \param write asked to stop - no more chunks are
+ *  written then and the result is incomplete.
+ *
+ *  Result is written as it is serialized, in chunks of at most
+ *  SC_WRITE_CHUNK_SIZE bytes, and the serialized JSON is never held in
+ *  memory as a whole. The parse result is still wrapped whole before
+ *  serialization starts, so peak memory holds the AST and its wrapped
+ *  tree - only the JSON text itself is streamed. Result cache is not used.
+ */
+SC_API int drafter_c_parse_to(const char* source,
+                              size_t length,
+                              sc_blueprint_parser_options options,
+                              sc_write_callback write,
+                              void* userdata);
+
+/**
+ *  \brief String owned by the library - \param length bytes at \param data, not zero terminated
+ *
+ *  Missing strings are empty views, \param data is never NULL.
+ */
+typedef struct sc_string_view {
+    const char* data;
+    size_t length;
+} sc_string_view;
+
+/** brief Parsed AST of blueprint, read by the accessors below without any serialization */
+typedef struct sc_result sc_result;
+
+/** brief Handles of AST nodes, valid as long as the sc_result they come from */
+typedef struct sc_resource_group sc_resource_group;
+typedef struct sc_resource sc_resource;
+typedef struct sc_action sc_action;
+typedef struct sc_example sc_example;
+typedef struct sc_payload sc_payload;
+
+/**
+ *  \brief Parse blueprint into AST accessible from C
+ *
+ *  \param source        A textual source data to be parsed, need not be zero terminated
+ *  \param length        Length of \param source in bytes
+ *  \param options       Parser options. Use 0 for no addtional options.
+ *  \param result        Output - handle of AST, release it by drafter_c_free_result()
+ *
+ *  \return Error status code. Zero represents success, non-zero a failure.
+ *
+ *  Meant for bindings walking resources, actions and payloads - nothing is
+ *  serialized and strings are views into the AST, with no copy. Result is
+ *  immutable, so its accessors may be called from more threads at once.
+ *  Handles and views are valid until the result is released. Out of range
+ *  index gives NULL handle, NULL handle gives empty string and zero count.
+ */
+SC_API int drafter_c_parse_result(const char* source,
+                                  size_t length,
+                                  sc_blueprint_parser_options options,
+                                  sc_result** result);
+
+/** \brief Release result of drafter_c_parse_result() */
+SC_API void drafter_c_free_result(sc_result* result);
+
+/** \brief API name */
+SC_API sc_string_view drafter_c_result_name(const sc_result* result);
+
+/** \brief Error message, empty if parsed without error */
+SC_API sc_string_view drafter_c_result_error(const sc_result* result);
+
+/**
+ *  \brief Number of resource groups
+ *
+ *  Resources outside of any group are in a group of their own, with empty name.
+ */
+SC_API size_t drafter_c_resource_group_count(const sc_result* result);
+SC_API const sc_resource_group* drafter_c_resource_group(const sc_result* result, size_t index);
+SC_API sc_string_view drafter_c_resource_group_name(const sc_resource_group* group);
+
+SC_API size_t drafter_c_resource_count(const sc_resource_group* group);
+SC_API const sc_resource* drafter_c_resource(const sc_resource_group* group, size_t index);
+SC_API sc_string_view drafter_c_resource_name(const sc_resource* resource);
+SC_API sc_string_view drafter_c_resource_uri_template(const sc_resource* resource);
+
+SC_API size_t drafter_c_action_count(const sc_resource* resource);
+SC_API const sc_action* drafter_c_action(const sc_resource* resource, size_t index);
+SC_API sc_string_view drafter_c_action_name(const sc_action* action);
+SC_API sc_string_view drafter_c_action_method(const sc_action* action);
+
+/** \brief URI template of action, empty if it is the one of its resource */
+SC_API sc_string_view drafter_c_action_uri_template(const sc_action* action);
+
+/** \brief Number of transaction examples - requests with their responses */
+SC_API size_t drafter_c_example_count(const sc_action* action);
+SC_API const sc_example* drafter_c_example(const sc_action* action, size_t index);
+SC_API sc_string_view drafter_c_example_name(const sc_example* example);
+
+SC_API size_t drafter_c_request_count(const sc_example* example);
+SC_API const sc_payload* drafter_c_request(const sc_example* example, size_t index);
+SC_API size_t drafter_c_response_count(const sc_example* example);
+SC_API const sc_payload* drafter_c_response(const sc_example* example, size_t index);
+
+/** \brief Name of request, status code of response */
+SC_API sc_string_view drafter_c_payload_name(const sc_payload* payload);
+SC_API sc_string_view drafter_c_payload_body(const sc_payload* payload);
+SC_API sc_string_view drafter_c_payload_schema(const sc_payload* payload);
+
+SC_API size_t drafter_c_header_count(const sc_payload* payload);
+SC_API sc_string_view drafter_c_header_name(const sc_payload* payload, size_t index);
+SC_API sc_string_view drafter_c_header_value(const sc_payload* payload, size_t index);
+
 #ifdef __cplusplus
 }
 #endif
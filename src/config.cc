@@ -20,8 +20,22 @@ namespace config {
     static const std::string Render         = "render";
     static const std::string Sourcemap      = "sourcemap";
     static const std::string Validate       = "validate";
+    static const std::string Routes         = "routes";
+    static const std::string CheckBodies    = "check-bodies";
     static const std::string Version        = "version";
     static const std::string UseLineNumbers = "use-line-num";
+    static const std::string Diagnostics    = "diagnostics-format";
+    static const std::string Port           = "port";
+    static const std::string Threads        = "threads";
+    static const std::string Positions      = "positions";
+    static const std::string Sparse         = "sparse";
+    static const std::string Aliases        = "yaml-aliases";
+    static const std::string ResolveMSON    = "resolve-mson";
+    static const std::string LanguageServer = "lsp";
+    static const std::string Watch          = "watch";
+
+    static const std::string DiffCommand    = "diff";
+    static const std::string MockCommand    = "mock";
 };
 
 void PrepareCommanLineParser(cmdline::parser& parser)
@@ -31,25 +45,85 @@ void PrepareCommanLineParser(cmdline::parser& parser)
     parser.add<std::string>(config::Output,    'o', "save output AST into file", false);
     parser.add<std::string>(config::Format,    'f', "output AST format", false, "yaml", cmdline::oneof<std::string>("yaml", "json"));
     parser.add<std::string>(config::Sourcemap, 's', "export sourcemap AST into file", false);
+    parser.add<std::string>(config::Positions, 'n', "units of exported sourcemap", false, "bytes", cmdline::oneof<std::string>("bytes", "code-points", "utf-16", "line-column"));
+    parser.add(config::Sparse,                 '\0', "leave out empty and default-valued fields of AST and sourcemap");
+    parser.add(config::Aliases,                '\0', "write repeated subtrees of YAML output once, as anchor and aliases");
+    parser.add(config::ResolveMSON,            '\0', "expand MSON inheritance and mixins of named types in AST");
     parser.add("help",                         'h', "display this help message");
     parser.add(config::Version ,               'v', "print Drafter version");
     parser.add(config::Validate,               'l', "validate input only, do not print AST");
+    parser.add(config::Routes,                 'r', "print route table (group, URI template, method, name, relation) instead of AST");
+    parser.add(config::CheckBodies,            'b', "warn about body examples not matching their body schema");
     parser.add(config::UseLineNumbers ,        'u', "use line and row number instead of character index when printing annotation");
+    parser.add<std::string>(config::Diagnostics, 'd', "format of parser warnings and errors", false, "text", cmdline::oneof<std::string>("text", "json", "sarif"));
+    parser.add<int>(config::Port,              'p', "port of mock server", false, 3000, cmdline::range(1, 65535));
+    parser.add<int>(config::Threads,           'j', "parse top-level groups or input files on more threads, 0 for number of cores", false, 1, cmdline::range(0, 256));
+    parser.add(config::LanguageServer,         '\0', "serve Language Server Protocol on stdin and stdout");
+    parser.add(config::Watch,                  'w', "rebuild outputs whenever input files change");
 
     std::stringstream ss;
 
     ss << "<input file>\n\n";
     ss << "API Blueprint Parser\n";
-    ss << "If called without <input file>, 'drafter' will listen on stdin.\n";
+    ss << "If called without <input file>, 'drafter' will listen on stdin.\n\n";
+    ss << "Blueprint split into more files:\n";
+    ss << "  drafter <main file> <more files>...\n";
+    ss << "API name comes from the main file, the others add groups, resources\n";
+    ss << "and data structures. Source map ranges are prefixed by file index.\n\n";
+    ss << "Compare two blueprints:\n";
+    ss << "  drafter diff <old file> <new file>\n";
+    ss << "Lists added, removed and modified resource groups, resources, actions,\n";
+    ss << "payloads and data structures.\n\n";
+    ss << "Serve example responses on 127.0.0.1:<port>:\n";
+    ss << "  drafter mock [--port <port>] [<input file>]\n";
+    ss << "Every action answers with the first response of its first example.\n\n";
+    ss << "Editor integration:\n";
+    ss << "  drafter --lsp\n";
+    ss << "Serves diagnostics, document symbols, hover and definition over stdio.\n";
 
     parser.footer(ss.str());
 }
 
+drafter::PositionUnit ParsePositionUnit(const std::string& name)
+{
+    if (name == "code-points") {
+        return drafter::CodePointPositions;
+    }
+
+    if (name == "utf-16") {
+        return drafter::UTF16Positions;
+    }
+
+    if (name == "line-column") {
+        return drafter::LineColumnPositions;
+    }
+
+    return drafter::BytePositions;
+}
+
+bool IsDiffCommand(const cmdline::parser& parser)
+{
+    return !parser.rest().empty() && parser.rest().front() == config::DiffCommand;
+}
+
+bool IsMockCommand(const cmdline::parser& parser)
+{
+    return !parser.rest().empty() && parser.rest().front() == config::MockCommand;
+}
+
 void ValidateParsedCommandLine(const cmdline::parser& parser)
 {
-    if (parser.rest().size() > 1) {
-        std::cerr << "one input file expected, got " << parser.rest().size() << std::endl;
-        exit(EXIT_FAILURE);
+    if (IsDiffCommand(parser)) {
+        if (parser.rest().size() != 3) {
+            std::cerr << "diff expects two input files, got " << parser.rest().size() - 1 << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if (IsMockCommand(parser)) {
+        if (parser.rest().size() > 2) {
+            std::cerr << "mock expects one input file, got " << parser.rest().size() - 1 << std::endl;
+            exit(EXIT_FAILURE);
+        }
     }
 
     if (parser.exist(config::Version)) {
@@ -68,13 +142,37 @@ void ParseCommadLineOptions(int argc, const char *argv[], /* out */Config& conf)
 
     ValidateParsedCommandLine(parser);
 
-    if (!parser.rest().empty()) {
+    conf.diff = IsDiffCommand(parser);
+    conf.mock = IsMockCommand(parser);
+
+    if (conf.diff) {
+        conf.input     = parser.rest().at(1);
+        conf.diffInput = parser.rest().at(2);
+    }
+    else if (conf.mock) {
+        if (parser.rest().size() > 1) {
+            conf.input = parser.rest().at(1);
+        }
+    }
+    else if (!parser.rest().empty()) {
         conf.input = parser.rest().front();
+        conf.inputs = parser.rest();
     }
 
     conf.lineNumbers = parser.exist(config::UseLineNumbers);
+    conf.diagnosticsFormat = parser.get<std::string>(config::Diagnostics);
     conf.validate    = parser.exist(config::Validate);
+    conf.routes      = parser.exist(config::Routes);
+    conf.checkBodies = parser.exist(config::CheckBodies);
     conf.format      = parser.get<std::string>(config::Format);
     conf.output      = parser.get<std::string>(config::Output);
     conf.sourceMap   = parser.get<std::string>(config::Sourcemap);
+    conf.positions   = ParsePositionUnit(parser.get<std::string>(config::Positions));
+    conf.sparse      = parser.exist(config::Sparse);
+    conf.aliases     = parser.exist(config::Aliases);
+    conf.resolveMSON = parser.exist(config::ResolveMSON);
+    conf.port        = parser.get<int>(config::Port);
+    conf.threads     = parser.get<int>(config::Threads);
+    conf.languageServer = parser.exist(config::LanguageServer);
+    conf.watch       = parser.exist(config::Watch);
 }
@@ -10,14 +10,32 @@
 #define DRAFTER_CONFIG_H
 
 #include <string>
+#include <vector>
+
+#include "PositionIndex.h"
 
 struct Config {
     std::string input;
+    std::vector<std::string> inputs;    ///< all input files, blueprint split into more files if more than one
     bool lineNumbers;
+    std::string diagnosticsFormat;
     bool validate;
+    bool routes;
+    bool checkBodies;
     std::string format;
     std::string sourceMap;
+    drafter::PositionUnit positions;
+    bool sparse;
+    bool aliases;
+    bool resolveMSON;
     std::string output;
+    bool diff;
+    std::string diffInput;
+    bool mock;
+    int port;
+    int threads;
+    bool languageServer;
+    bool watch;
 };
 
 /**
@@ -7,16 +7,174 @@
 //  Copyright (c) 2015 Apiary Inc. All rights reserved.
 //
 #include "drafter.h"
+#include "NormalizeSource.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+    /** How often waiting caller looks whether deadline was cancelled, cancel() does not notify */
+    const std::chrono::milliseconds DeadlinePollInterval(5);
+
+    /** Number of abandoned parses still running, guarded by abandonedMutex */
+    size_t abandonedParses = 0;
+    std::mutex abandonedMutex;
+
+    /**
+     *  \brief Parse on worker thread, shared by the worker and the caller who may abandon it
+     */
+    struct ParseJob {
+        mdp::ByteBuffer source;
+        snowcrash::BlueprintParserOptions options;
+        snowcrash::ParseResult<snowcrash::Blueprint> result;
+
+        bool done;
+        bool abandoned;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        ParseJob() : options(0), done(false), abandoned(false) {}
+    };
+
+    void RunParseJob(const std::shared_ptr<ParseJob>& job)
+    {
+        try {
+            snowcrash::parse(job->source, job->options, job->result);
+        }
+        catch (const std::exception& e) {
+            job->result.report.error = snowcrash::Error(e.what(), snowcrash::ApplicationError);
+        }
+
+        std::lock_guard<std::mutex> lock(job->mutex);
+
+        job->done = true;
+        job->finished.notify_all();
+
+        if (job->abandoned) {
+            std::lock_guard<std::mutex> abandonedLock(abandonedMutex);
+            --abandonedParses;
+        }
+    }
+
+    /**
+     *  \brief snowcrash::parse() \param source into \param out unless \param deadline expires first
+     *
+     *  Snowcrash can not be interrupted, so it parses on a worker thread
+     *  while the caller waits for the result or for the deadline. Worker of
+     *  expired parse is left to finish on its own, its result is dropped.
+     *  At most MaxAbandonedParses workers are left running, further parses
+     *  are refused until some of them finish.
+     *
+     *  \param source  Moved to the worker, given back if parse finished
+     *
+     *  \throw Cancelled when \param deadline expires or too many parses are abandoned
+     */
+    void ParseUntil(mdp::ByteBuffer& source,
+                    snowcrash::BlueprintParserOptions options,
+                    const snowcrash::ParseResultRef<snowcrash::Blueprint>& out,
+                    const drafter::Deadline& deadline)
+    {
+        {
+            std::lock_guard<std::mutex> abandonedLock(abandonedMutex);
+
+            if (abandonedParses >= drafter::MaxAbandonedParses) {
+                throw drafter::Cancelled("too many abandoned parses still running");
+            }
+        }
+
+        std::shared_ptr<ParseJob> job(new ParseJob);
+
+        job->source.swap(source);
+        job->options = options;
+
+        std::thread worker(RunParseJob, job);
+
+        {
+            std::unique_lock<std::mutex> lock(job->mutex);
+
+            while (!job->done) {
+
+                if (deadline.expired()) {
+                    {
+                        std::lock_guard<std::mutex> abandonedLock(abandonedMutex);
+                        ++abandonedParses;
+                    }
+
+                    job->abandoned = true;
+                    lock.unlock();
+                    worker.detach();
+
+                    deadline.check();
+                    throw drafter::Cancelled("parsing deadline exceeded");
+                }
+
+                drafter::Deadline::Clock::time_point poll = drafter::Deadline::Clock::now() + DeadlinePollInterval;
+                job->finished.wait_until(lock, std::min(poll, deadline.until()));
+            }
+        }
+
+        worker.join();
+
+        source.swap(job->source);
+
+        out.report = job->result.report;
+        out.node = job->result.node;
+        out.sourceMap = job->result.sourceMap;
+    }
+}
 
 namespace drafter {
 
     /**
-     * For now just redirect to snowcrash::parse()
+     * Redirect to snowcrash::parse(). With \param deadline the parse runs on
+     * worker thread and is abandoned when the deadline expires. Source is
+     * normalized first, positions in result are translated back.
      */
     int ParseBlueprint(const mdp::ByteBuffer& source,
               snowcrash::BlueprintParserOptions options,
-              const snowcrash::ParseResultRef<snowcrash::Blueprint>& out)
+              const snowcrash::ParseResultRef<snowcrash::Blueprint>& out,
+              const Deadline* deadline)
+    {
+        try {
+            CheckDeadline(deadline);
+
+            mdp::ByteBuffer normalized;
+            SourceRemap remap;
+
+            bool normalize = NormalizeSource(source, normalized, remap);
+
+            if (deadline) {
+                if (!normalize) {
+                    normalized = source;
+                }
+
+                ParseUntil(normalized, options, out, *deadline);
+            }
+            else {
+                snowcrash::parse(normalize ? normalized : source, options, out);
+            }
+
+            if (normalize) {
+                RemapParseResult(source, normalized, remap, out);
+            }
+
+            if (out.report.error.code == snowcrash::Error::OK) {
+                CheckDeadline(deadline);
+            }
+        }
+        catch (const Cancelled& cancelled) {
+            ReportCancelled(out.report, cancelled);
+        }
+
+        return out.report.error.code;
+    }
+
+    void ReportCancelled(snowcrash::Report& report, const Cancelled& cancelled)
     {
-        return snowcrash::parse(source, options, out);
+        report.error = snowcrash::Error(cancelled.what(), CancelledError);
     }
 }
@@ -11,6 +11,7 @@
 #define DRAFTER_H
 
 #include "snowcrash.h"
+#include "Deadline.h"
 
 
 /**
@@ -22,17 +23,49 @@
 
 namespace drafter {
 
+    /**
+     *  Abandoned parses left running in background at most. Deadline
+     *  parses started while this many are still running are refused with
+     *  CancelledError, so a stream of expiring parses can not pile up
+     *  threads. Parses already waiting for their deadline may each add one.
+     */
+    const size_t MaxAbandonedParses = 4;
+
     /**
      *  \brief Parse the source data into a blueprint abstract source tree (AST).
      *
+     *  Line endings, byte order mark and tabs are normalized by
+     *  NormalizeSource() before parsing, source maps and annotation
+     *  locations of \param out point to \param source as given.
+     *
+     *  Drafter adds no shared mutable state to the parse, \param out is the
+     *  only thing written. Concurrent parses are safe as far as snowcrash
+     *  parser is reentrant, which is not verified yet - see `make test-tsan`.
+     *  Deadline parses are concurrent too, the worker may outlive the call.
+     *
      *  \param source       A textual source data to be parsed.
      *  \param options      Parser options. Use 0 for no additional options.
      *  \param out          Output buffer to store parsing result into.
+     *  \param deadline     Optional deadline, NULL for no limit. Snowcrash then
+     *                      parses on a worker thread, which is abandoned to
+     *                      finish in background if the deadline expires. The
+     *                      report error is CancelledError, warnings are kept
+     *                      if parsing has finished. Refused with
+     *                      CancelledError while MaxAbandonedParses are left
+     *                      running.
      *  \return Error status code. Zero represents success, non-zero a failure.
      */
     int ParseBlueprint(const mdp::ByteBuffer& source,
               snowcrash::BlueprintParserOptions options,
-              const snowcrash::ParseResultRef<snowcrash::Blueprint>& out);
+              const snowcrash::ParseResultRef<snowcrash::Blueprint>& out,
+              const Deadline* deadline = NULL);
+
+    /**
+     *  \brief Replace error of \param report by CancelledError described by \param cancelled
+     *
+     *  Warnings are kept as partial diagnostics.
+     */
+    void ReportCancelled(snowcrash::Report& report, const Cancelled& cancelled);
 }
 
 #endif // #ifndef DRAFTER_H
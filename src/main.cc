@@ -11,29 +11,46 @@
 #include "SectionParserData.h"  // snowcrash::BlueprintParserOptions
 
 #include "sos.h"
-#include "sosJSON.h"
-#include "sosYAML.h"
+#include "SerializeJSON.h"
+#include "SerializeYAML.h"
 
 #include "SerializeAST.h"
 #include "SerializeSourcemap.h"
+#include "DiffAST.h"
+#include "Routes.h"
+#include "MockServer.h"
+#include "LanguageServer.h"
+#include "ValidatePayloads.h"
+#include "drafter.h"
+#include "ParallelParse.h"
+#include "AssembleBlueprint.h"
+#include "PositionIndex.h"
+#include "FileWatcher.h"
+#include "Hash.h"
 
 #include "reporting.h"
 #include "config.h"
 #include "stream.h"
 
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <set>
+
 namespace sc = snowcrash;
 
 /**
  *  \brief  return instance sos::Serializer based on \param `format`
  *
  *  \param format - output format for serialization
+ *  \param aliases - write repeated YAML subtrees as aliases
  */
-sos::Serialize* CreateSerializer(const std::string& format)
+sos::Serialize* CreateSerializer(const std::string& format, bool aliases = false)
 {
     if (format == "json") {
-        return new sos::SerializeJSON;
+        return new drafter::SerializeJSON;
     } else if (format == "yaml") {
-        return new sos::SerializeYAML;
+        return new drafter::SerializeYAML(NULL, aliases);
     }
 
     std::cerr << "fatal: unknow serialization format: '" << format << "'\n";
@@ -44,7 +61,7 @@ sos::Serialize* CreateSerializer(const std::string& format)
  * \brief Serialize sos::Object into stream
  */
 void Serialization(std::ostream *stream,
-                   const sos::Object& object,
+                   const sos::Base& object,
                    sos::Serialize* serializer)
 {
     serializer->process(object, *stream);
@@ -52,40 +69,339 @@ void Serialization(std::ostream *stream,
     *stream << std::flush;
 }
 
+/**
+ * \brief Read whole input, from stdin if \param `file` is empty
+ */
+std::string ReadInput(const std::string& file)
+{
+    std::stringstream inputStream;
+    std::unique_ptr<std::istream> in(CreateStreamFromName<std::istream>(file));
+    inputStream << in->rdbuf();
+
+    return inputStream.str();
+}
+
+/**
+ * \brief Serialize structural differences between `config.input` and `config.diffInput`
+ */
+int DiffBlueprints(const Config& config)
+{
+    std::string beforeSource = ReadInput(config.input);
+    std::string afterSource = ReadInput(config.diffInput);
+
+    sc::ParseResult<sc::Blueprint> before;
+    drafter::ParseBlueprint(beforeSource, 0, before);
+
+    if (before.report.error.code != sc::Error::OK) {
+        PrintReport(before.report, beforeSource, config.lineNumbers, config.diagnosticsFormat, config.input);
+        return before.report.error.code;
+    }
+
+    sc::ParseResult<sc::Blueprint> after;
+    drafter::ParseBlueprint(afterSource, 0, after);
+
+    if (after.report.error.code != sc::Error::OK) {
+        PrintReport(after.report, afterSource, config.lineNumbers, config.diagnosticsFormat, config.diffInput);
+        return after.report.error.code;
+    }
+
+    drafter::Changes changes;
+    drafter::DiffBlueprint(drafter::HashBlueprint(before.node), drafter::HashBlueprint(after.node), changes);
+
+    sos::Serialize* serializer = CreateSerializer(config.format, config.aliases);
+
+    std::ostream *out = CreateStreamFromName<std::ostream>(config.output);
+    Serialization(out, drafter::WrapChanges(changes), serializer);
+    delete out;
+
+    delete serializer;
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * \brief Parse `config.input` and serve its example responses until killed
+ */
+int RunMockServer(const Config& config)
+{
+    std::string source = ReadInput(config.input);
+
+    sc::ParseResult<sc::Blueprint> blueprint;
+    drafter::ParseBlueprint(source, 0, blueprint);
+
+    PrintReport(blueprint.report, source, config.lineNumbers, config.diagnosticsFormat, config.input);
+
+    if (blueprint.report.error.code != sc::Error::OK) {
+        return blueprint.report.error.code;
+    }
+
+    MockServer server(blueprint.node);
+    return server.run(static_cast<unsigned short>(config.port));
+}
+
+/**
+ * \brief Parser options needed by outputs of \param `config`
+ */
+sc::BlueprintParserOptions ParserOptions(const Config& config)
+{
+    sc::BlueprintParserOptions options = 0;  // Or snowcrash::RequireBlueprintNameOption
+    if (!config.sourceMap.empty() || config.routes || config.checkBodies) {
+        options |= snowcrash::ExportSourcemapOption;
+    }
+
+    return options;
+}
+
+/**
+ * \brief Parse \param `source`, or \param `files` by \param `assembler` if there is more of them
+ */
+void ParseInput(const Config& config,
+                const drafter::SourceFiles& files,
+                const std::string& source,
+                drafter::BlueprintAssembler& assembler,
+                sc::ParseResult<sc::Blueprint>& blueprint)
+{
+    if (files.size() > 1) {
+        assembler.assemble(files, ParserOptions(config), blueprint, config.threads);
+    }
+    else if (config.threads != 1) {
+        drafter::ParseBlueprintParallel(source, ParserOptions(config), blueprint, config.threads);
+    }
+    else {
+        drafter::ParseBlueprint(source, ParserOptions(config), blueprint);
+    }
+}
+
+/**
+ * \brief Write route table or serialized AST into \param `out` and its source map into \param `sourceMap`
+ *
+ * \param sourceMap - NULL if no source map is requested
+ */
+void WriteResult(const Config& config,
+                 const sc::ParseResult<sc::Blueprint>& blueprint,
+                 const drafter::SourceFiles& files,
+                 const std::string& source,
+                 std::ostream& out,
+                 std::ostream* sourceMap)
+{
+    if (config.routes) {  // route table instead of AST
+        drafter::Routes routes;
+        drafter::CollectRoutes(blueprint.node, blueprint.sourceMap, routes);
+        drafter::WriteRoutes(routes, out);
+
+        out << std::flush;
+        return;
+    }
+
+    sos::Serialize* serializer = CreateSerializer(config.format, config.aliases);
+    drafter::WrapOptions wrapOptions = config.sparse ? drafter::SparseWrapOption : 0;
+
+    if (config.resolveMSON) {
+        wrapOptions |= drafter::ResolveMSONWrapOption;
+    }
+
+    Serialization(&out, drafter::WrapBlueprint(blueprint.node, NULL, wrapOptions), serializer);
+
+    if (sourceMap) {
+        sos::Object wrapped = drafter::WrapBlueprintSourcemap(blueprint.sourceMap, NULL, wrapOptions);
+
+        if (files.size() > 1) {
+            drafter::ConvertSourcemapFiles(wrapped, files, config.positions);
+        }
+        else if (config.positions != drafter::BytePositions) {
+            drafter::ConvertSourcemapPositions(wrapped, drafter::PositionIndex(source), config.positions);
+        }
+
+        Serialization(sourceMap, wrapped, serializer);
+    }
+
+    delete serializer;
+}
+
+/**
+ * \brief Replace output \param `name`, stdout if empty, by \param `content` unless it is \param `previous`
+ */
+void UpdateOutput(const std::string& name, const std::string& content, std::string& previous)
+{
+    if (content == previous) {
+        return;
+    }
+
+    if (name.empty()) {
+        std::cout << content << std::flush;
+    }
+    else if (!WriteFileAtomically(name, content)) {
+        std::cerr << "error: unable to write file '" << name << "': " << strerror(errno) << "\n";
+        return;
+    }
+
+    previous = content;
+}
+
+/**
+ * \brief Reread \param `touched` of \param `files`, \return True if content of some of them changed
+ *
+ * A file which can not be read keeps its previous content - it is likely
+ * being replaced, its next version comes with another event.
+ */
+bool ReloadFiles(drafter::SourceFiles& files, std::vector<drafter::Hash>& hashes, const std::set<size_t>& touched)
+{
+    bool changed = false;
+
+    for (std::set<size_t>::const_iterator it = touched.begin(); it != touched.end(); ++it) {
+
+        std::ifstream in(files[*it].name.c_str(), std::ios::binary);
+
+        if (!in.is_open()) {
+            continue;
+        }
+
+        std::stringstream content;
+        content << in.rdbuf();
+
+        drafter::Hash hash = drafter::HashBytes(content.str());
+
+        if (hash == hashes[*it] && content.str() == files[*it].source) {
+            continue;
+        }
+
+        files[*it].source = content.str();
+        hashes[*it] = hash;
+        changed = true;
+    }
+
+    return changed;
+}
+
+/**
+ * \brief Keep outputs of `config.inputs` up to date until killed
+ *
+ * Sleeps until some of the input files changes, then parses again only
+ * files with different content. Outputs are replaced atomically and only
+ * if their content differs.
+ */
+int WatchBlueprint(const Config& config)
+{
+    if (config.inputs.empty()) {
+        std::cerr << "fatal: input file expected to watch\n";
+        return EXIT_FAILURE;
+    }
+
+    FileWatcher watcher(config.inputs);
+
+    if (!watcher.start()) {
+        std::cerr << "fatal: unable to watch input files: " << strerror(errno) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    drafter::SourceFiles files;
+    std::vector<drafter::Hash> hashes;
+
+    for (std::vector<std::string>::const_iterator it = config.inputs.begin(); it != config.inputs.end(); ++it) {
+        files.push_back(drafter::SourceFile(*it, ReadInput(*it)));
+        hashes.push_back(drafter::HashBytes(files.back().source));
+    }
+
+    drafter::BlueprintAssembler assembler;
+    std::string output, sourceMap;  // as last written
+
+    for (;;) {
+        std::string source = drafter::ConcatenateSourceFiles(files);
+
+        sc::ParseResult<sc::Blueprint> blueprint;
+        ParseInput(config, files, source, assembler, blueprint);
+
+        if (!config.validate) {
+            bool writeSourceMap = !config.sourceMap.empty() && !config.routes;
+
+            std::ostringstream out, map;
+            WriteResult(config, blueprint, files, source, out, writeSourceMap ? &map : NULL);
+
+            UpdateOutput(config.output, out.str(), output);
+
+            if (writeSourceMap) {
+                UpdateOutput(config.sourceMap, map.str(), sourceMap);
+            }
+        }
+
+        if (config.checkBodies && blueprint.report.error.code == sc::Error::OK) {
+            drafter::ValidatePayloads(blueprint.node, blueprint.sourceMap, source, blueprint.report);
+        }
+
+        PrintReport(blueprint.report, files, source, config.lineNumbers, config.diagnosticsFormat);
+
+        std::set<size_t> touched;
+
+        do {
+            if (!watcher.wait(touched)) {
+                std::cerr << "fatal: unable to watch input files: " << strerror(errno) << "\n";
+                return EXIT_FAILURE;
+            }
+        } while (!ReloadFiles(files, hashes, touched));
+    }
+}
+
 int main(int argc, const char *argv[])
 {
     Config config; 
     ParseCommadLineOptions(argc, argv, config);
 
-    sc::BlueprintParserOptions options = 0;  // Or snowcrash::RequireBlueprintNameOption
-    if (!config.sourceMap.empty()) {
-        options |= snowcrash::ExportSourcemapOption;
+    if (config.diff) {
+        return DiffBlueprints(config);
     }
 
-    std::stringstream inputStream;
-    std::auto_ptr<std::istream> in(CreateStreamFromName<std::istream>(config.input));
-    inputStream << in->rdbuf();
+    if (config.mock) {
+        return RunMockServer(config);
+    }
+
+    if (config.languageServer) {
+        LanguageServer server(config.threads);
+        return server.run();
+    }
+
+    if (config.watch) {
+        return WatchBlueprint(config);
+    }
+
+    drafter::SourceFiles files;
+
+    if (config.inputs.size() > 1) {
+        for (std::vector<std::string>::const_iterator it = config.inputs.begin(); it != config.inputs.end(); ++it) {
+            files.push_back(drafter::SourceFile(*it, ReadInput(*it)));
+        }
+    }
+
+    std::string source = files.empty() ? ReadInput(config.input) : drafter::ConcatenateSourceFiles(files);
 
     sc::ParseResult<sc::Blueprint> blueprint;
-    sc::parse(inputStream.str(), options, blueprint);
+    drafter::BlueprintAssembler assembler;
 
-    if (!config.validate) {  // not just validate -> we will serialize
-        sos::Serialize* serializer = CreateSerializer(config.format);
+    ParseInput(config, files, source, assembler, blueprint);
 
+    if (!config.validate) {  // not just validate -> we will serialize
         std::ostream *out = CreateStreamFromName<std::ostream>(config.output);
-        Serialization(out, drafter::WrapBlueprint(blueprint.node), serializer);
-        delete out;
+        std::ostream *sourceMap = NULL;
 
-        if (options & snowcrash::ExportSourcemapOption) {
-            std::ostream *sourcemap = CreateStreamFromName<std::ostream>(config.sourceMap);
-            Serialization(sourcemap, drafter::WrapBlueprintSourcemap(blueprint.sourceMap), serializer);
-            delete sourcemap;
+        if (!config.sourceMap.empty() && !config.routes) {
+            sourceMap = CreateStreamFromName<std::ostream>(config.sourceMap);
         }
 
-        delete serializer;
+        WriteResult(config, blueprint, files, source, *out, sourceMap);
+
+        delete out;
+        delete sourceMap;
     }
 
-    PrintReport(blueprint.report, inputStream.str(), config.lineNumbers);
+    if (config.checkBodies && blueprint.report.error.code == sc::Error::OK) {
+        drafter::ValidatePayloads(blueprint.node, blueprint.sourceMap, source, blueprint.report);
+    }
+
+    if (files.empty()) {
+        PrintReport(blueprint.report, source, config.lineNumbers, config.diagnosticsFormat, config.input);
+    }
+    else {
+        PrintReport(blueprint.report, files, source, config.lineNumbers, config.diagnosticsFormat);
+    }
 
     return blueprint.report.error.code;
 }
@@ -11,9 +11,20 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include "Format.h"
+#include "PositionIndex.h"
+#include "Version.h"
 
 namespace sc = snowcrash;
 
+const std::string DiagnosticsFormat::Text  = "text";
+const std::string DiagnosticsFormat::JSON  = "json";
+const std::string DiagnosticsFormat::SARIF = "sarif";
+
 /** structure contains starting and ending position of a error/warning. */
 struct AnnotationPosition {
     size_t fromLine;
@@ -23,61 +34,115 @@ struct AnnotationPosition {
 };
 
 /**
- *  \brief Convert character index mapping to line and column number
- *  \param linesEndIndex Vector containing indexes of end line characters
- *  \param range Character index mapping as input
- *  \param out Position of the given range as output
+ *  \brief Finds annotations of source, or of files it is concatenated from, in their file
+ *
+ *  Annotation ranges count characters of the whole source. They are
+ *  translated to bytes, for more files LocateSourceFile() tells the file
+ *  and positions are counted by position index of that file.
  */
-void GetLineFromMap(const std::vector<size_t>& linesEndIndex,
-                    const mdp::Range& range,
-                    AnnotationPosition& out)
-{
-
-    std::vector<size_t>::const_iterator annotationPositionIt;
+class AnnotationLocator {
+public:
+
+    /** Range of annotation in bytes of its file */
+    struct Location {
+        size_t file;
+        size_t begin;
+        size_t end;
+    };
+
+    /** Annotations of \param source read from \param file */
+    AnnotationLocator(const std::string& source, const std::string& file)
+    : files_(NULL), file_(file), index_(source) {}
+
+    /** Annotations of \param source concatenated from \param files by ConcatenateSourceFiles() */
+    AnnotationLocator(const std::string& source, const drafter::SourceFiles& files)
+    : files_(&files), index_(source), indexes_(files.size()) {}
+
+    /** True if locations have to name their file */
+    bool multipleFiles() const
+    {
+        return files_ && files_->size() > 1;
+    }
 
-    out.fromLine = 0;
-    out.fromColumn = 0;
-    out.toLine = 0;
-    out.toColumn = 0;
+    const std::string& name(size_t file) const
+    {
+        return files_ ? (*files_)[file].name : file_;
+    }
 
-    // Finds starting line and column position
-    annotationPositionIt = std::upper_bound(linesEndIndex.begin(), linesEndIndex.end(), range.location) - 1;
+    const drafter::PositionIndex& index(size_t file) const
+    {
+        if (!files_) {
+            return index_;
+        }
 
-    if (annotationPositionIt != linesEndIndex.end()) {
+        if (!indexes_[file]) {
+            indexes_[file].reset(new drafter::PositionIndex((*files_)[file].source));
+        }
 
-        out.fromLine = std::distance(linesEndIndex.begin(), annotationPositionIt) + 1;
-        out.fromColumn = range.location - *annotationPositionIt + 1;
+        return *indexes_[file];
     }
 
-    // Finds ending line and column position
-    annotationPositionIt = std::lower_bound(linesEndIndex.begin(), linesEndIndex.end(), range.location + range.length) - 1;
+    void locate(const mdp::Range& range, Location& out) const
+    {
+        size_t begin = index_.byteOfCodePoint(range.location);
+        size_t end = index_.byteOfCodePoint(range.location + range.length);
 
-    if (annotationPositionIt != linesEndIndex.end()) {
+        if (!files_) {
+            out.file = 0;
+            out.begin = begin;
+            out.end = end;
+            return;
+        }
 
-        out.toLine = std::distance(linesEndIndex.begin(), annotationPositionIt) + 1;
-        out.toColumn = (range.location + range.length) - *annotationPositionIt + 1;
+        out.file = drafter::LocateSourceFile(*files_, begin, out.begin);
 
-        if (*(annotationPositionIt + 1) == (range.location + range.length)) {
-            out.toColumn--;
-        }
+        // ranges are cut at the end of file
+        out.end = std::min(out.begin + (end - begin), (*files_)[out.file].source.size());
     }
-}
+
+private:
+    const drafter::SourceFiles* files_;
+    std::string file_;
+    drafter::PositionIndex index_;
+    mutable std::vector<std::unique_ptr<drafter::PositionIndex> > indexes_;
+
+    AnnotationLocator(const AnnotationLocator&);
+    AnnotationLocator& operator=(const AnnotationLocator&);
+};
 
 /**
- *  \brief Given the source returns the length of all the lines in source as a vector
- *  \param source Source data
- *  \param out Vector containing indexes of all end line character in source
+ *  \brief Convert byte range of annotation to line and column numbers
+ *
+ *  End is the position just after the range, or the position of its
+ *  trailing new line.
+ *
+ *  \param index Position index of the file
+ *  \param location Range of annotation in bytes of the file
+ *  \param utf16 True to count columns in UTF-16 code units instead of code points
+ *  \param out Position of the given range as output
  */
-void GetLinesEndIndex(const std::string& source,
-                      std::vector<size_t>& out)
+static void GetLineFromMap(const drafter::PositionIndex& index,
+                           const AnnotationLocator::Location& location,
+                           bool utf16,
+                           AnnotationPosition& out)
 {
+    if (utf16) {
+        index.lineUTF16ColumnAt(location.begin, out.fromLine, out.fromColumn);
+        index.lineUTF16ColumnAt(location.end, out.toLine, out.toColumn);
+    }
+    else {
+        index.lineColumnAt(location.begin, out.fromLine, out.fromColumn);
+        index.lineColumnAt(location.end, out.toLine, out.toColumn);
+    }
 
-    out.push_back(0);
-
-    for (size_t i = 0; i < source.length(); i++) {
+    // range ending by a new line ends on its line, not at start of the next one
+    if (location.end > location.begin && out.toColumn == 1) {
 
-        if (source[i] == '\n') {
-            out.push_back(i + 1);
+        if (utf16) {
+            index.lineUTF16ColumnAt(location.end - 1, out.toLine, out.toColumn);
+        }
+        else {
+            index.lineColumnAt(location.end - 1, out.toLine, out.toColumn);
         }
     }
 }
@@ -86,29 +151,25 @@ void GetLinesEndIndex(const std::string& source,
  *  \brief Print Markdown source annotation.
  *  \param prefix A string prefix for the annotation
  *  \param annotation An annotation to print
- *  \param source Source data
+ *  \param locator Locator of annotations, NULL to print them by character index of single source
  *  \param isUseLineNumbers True if the annotations needs to be printed by line and column number
+ *  \param out Output buffer
  */
 void PrintAnnotation(const std::string& prefix,
                      const snowcrash::SourceAnnotation& annotation,
-                     const std::string& source,
-                     const bool isUseLineNumbers)
+                     const AnnotationLocator* locator,
+                     bool isUseLineNumbers,
+                     std::ostream& out)
 {
 
-    std::cerr << prefix;
+    out << prefix;
 
     if (annotation.code != sc::SourceAnnotation::OK) {
-        std::cerr << " (" << annotation.code << ") ";
+        out << " (" << annotation.code << ") ";
     }
 
     if (!annotation.message.empty()) {
-        std::cerr << " " << annotation.message;
-    }
-
-    std::vector<size_t> linesEndIndex;
-
-    if (isUseLineNumbers) {
-        GetLinesEndIndex(source, linesEndIndex);
+        out << " " << annotation.message;
     }
 
     if (!annotation.location.empty()) {
@@ -117,46 +178,339 @@ void PrintAnnotation(const std::string& prefix,
              it != annotation.location.end();
              ++it) {
 
+            if (!locator) {
+
+                out << ((it == annotation.location.begin()) ? " :" : ";");
+                out << it->location << ":" << it->length;
+                continue;
+            }
+
+            AnnotationLocator::Location location;
+            locator->locate(*it, location);
+
+            const drafter::PositionIndex& index = locator->index(location.file);
+
             if (isUseLineNumbers) {
 
                 AnnotationPosition annotationPosition;
-                GetLineFromMap(linesEndIndex, *it, annotationPosition);
+                GetLineFromMap(index, location, false, annotationPosition);
+
+                out << "; ";
+
+                if (locator->multipleFiles()) {
+                    out << locator->name(location.file) << ": ";
+                }
 
-                std::cerr << "; line " << annotationPosition.fromLine << ", column " << annotationPosition.fromColumn;
-                std::cerr << " - line " << annotationPosition.toLine << ", column " << annotationPosition.toColumn;
+                out << "line " << annotationPosition.fromLine << ", column " << annotationPosition.fromColumn;
+                out << " - line " << annotationPosition.toLine << ", column " << annotationPosition.toColumn;
             }
             else {
 
-                std::cerr << ((it == annotation.location.begin()) ? " :" : ";");
-                std::cerr << it->location << ":" << it->length;
+                // character index in the file
+                size_t begin = index.codePointAt(location.begin);
+
+                out << ((it == annotation.location.begin()) ? " :" : ";");
+
+                if (locator->multipleFiles()) {
+                    out << locator->name(location.file) << ":";
+                }
+
+                out << begin << ":" << index.codePointAt(location.end) - begin;
             }
         }
     }
 
-    std::cerr << std::endl;
+    out << "\n";
 }
 
 /**
- *  \brief Print parser report to stderr.
- *  \param report A parser report to print
- *  \param source Source data
- *  \param isUseLineNumbers True if the annotations needs to be printed by line and column number
+ *  \brief Print report in human readable form
  */
-void PrintReport(const snowcrash::Report& report,
-                 const std::string& source,
-                 const bool isUseLineNumbers)
+void PrintTextReport(const snowcrash::Report& report,
+                     const AnnotationLocator* locator,
+                     bool isUseLineNumbers,
+                     std::ostream& out)
 {
 
-    std::cerr << std::endl;
+    out << "\n";
 
     if (report.error.code == sc::Error::OK) {
-        std::cerr << "OK.\n";
+        out << "OK.\n";
     }
     else {
-        PrintAnnotation("error:", report.error, source, isUseLineNumbers);
+        PrintAnnotation("error:", report.error, locator, isUseLineNumbers, out);
+    }
+
+    for (snowcrash::Warnings::const_iterator it = report.warnings.begin(); it != report.warnings.end(); ++it) {
+        PrintAnnotation("warning:", *it, locator, isUseLineNumbers, out);
+    }
+}
+
+static void WritePosition(size_t line, size_t column, std::ostream& out)
+{
+    out << "{\"line\":";
+    drafter::WriteNumber(line, out);
+    out << ",\"column\":";
+    drafter::WriteNumber(column, out);
+    out << '}';
+}
+
+static void WriteAnnotationLocation(const mdp::CharactersRangeSet& location,
+                                    const AnnotationLocator& locator,
+                                    std::ostream& out)
+{
+    out << '[';
+
+    for (mdp::CharactersRangeSet::const_iterator it = location.begin(); it != location.end(); ++it) {
+
+        AnnotationLocator::Location range;
+        locator.locate(*it, range);
+
+        const drafter::PositionIndex& index = locator.index(range.file);
+
+        AnnotationPosition position;
+        GetLineFromMap(index, range, false, position);
+
+        if (it != location.begin()) {
+            out << ',';
+        }
+
+        out << '{';
+
+        // index and length are characters of the file
+        if (locator.multipleFiles()) {
+            out << "\"file\":";
+            drafter::WriteQuotedString(locator.name(range.file), out);
+            out << ',';
+        }
+
+        size_t begin = index.codePointAt(range.begin);
+
+        out << "\"index\":";
+        drafter::WriteNumber(begin, out);
+        out << ",\"length\":";
+        drafter::WriteNumber(index.codePointAt(range.end) - begin, out);
+        out << ",\"start\":";
+        WritePosition(position.fromLine, position.fromColumn, out);
+        out << ",\"end\":";
+        WritePosition(position.toLine, position.toColumn, out);
+        out << '}';
     }
 
+    out << ']';
+}
+
+static void WriteAnnotation(const snowcrash::SourceAnnotation& annotation,
+                            const AnnotationLocator& locator,
+                            std::ostream& out)
+{
+    out << "{\"code\":";
+    drafter::WriteNumber(annotation.code, out);
+    out << ",\"message\":";
+    drafter::WriteQuotedString(annotation.message, out);
+    out << ",\"location\":";
+    WriteAnnotationLocation(annotation.location, locator, out);
+    out << '}';
+}
+
+/**
+ *  \brief Print report as JSON - error and warnings with character and line/column ranges
+ *
+ *  Uses the same keys as the `error` and `warnings` of serialized result.
+ */
+static void PrintJSONReport(const snowcrash::Report& report,
+                            const AnnotationLocator& locator,
+                            std::ostream& out)
+{
+    out << "{\"error\":";
+    WriteAnnotation(report.error, locator, out);
+    out << ",\"warnings\":[";
+
     for (snowcrash::Warnings::const_iterator it = report.warnings.begin(); it != report.warnings.end(); ++it) {
-        PrintAnnotation("warning:", *it, source, isUseLineNumbers);
+
+        if (it != report.warnings.begin()) {
+            out << ',';
+        }
+
+        WriteAnnotation(*it, locator, out);
     }
+
+    out << "]}\n";
+}
+
+static void WriteSarifResult(const snowcrash::SourceAnnotation& annotation,
+                             const char* level,
+                             const AnnotationLocator& locator,
+                             std::ostream& out)
+{
+    // error and warning codes overlap, level tells them apart
+    out << "{\"ruleId\":\"" << level << '-';
+    drafter::WriteNumber(annotation.code, out);
+    out << "\",\"level\":\"" << level << "\",\"message\":{\"text\":";
+    drafter::WriteQuotedString(annotation.message, out);
+    out << "},\"locations\":[";
+
+    for (mdp::CharactersRangeSet::const_iterator it = annotation.location.begin(); it != annotation.location.end(); ++it) {
+
+        AnnotationLocator::Location range;
+        locator.locate(*it, range);
+
+        const drafter::PositionIndex& index = locator.index(range.file);
+        const std::string& file = locator.name(range.file);
+
+        // SARIF counts columns and offsets in UTF-16 code units by default
+        AnnotationPosition position;
+        GetLineFromMap(index, range, true, position);
+
+        if (it != annotation.location.begin()) {
+            out << ',';
+        }
+
+        out << "{\"physicalLocation\":{";
+
+        if (!file.empty()) {
+            out << "\"artifactLocation\":{\"uri\":";
+            drafter::WriteQuotedString(file, out);
+            out << "},";
+        }
+
+        out << "\"region\":{\"startLine\":";
+        drafter::WriteNumber(position.fromLine, out);
+        out << ",\"startColumn\":";
+        drafter::WriteNumber(position.fromColumn, out);
+        out << ",\"endLine\":";
+        drafter::WriteNumber(position.toLine, out);
+        out << ",\"endColumn\":";
+        drafter::WriteNumber(position.toColumn, out);
+        out << ",\"charOffset\":";
+        drafter::WriteNumber(index.utf16At(range.begin), out);
+        out << ",\"charLength\":";
+        drafter::WriteNumber(index.utf16At(range.end) - index.utf16At(range.begin), out);
+        out << "}}}";
+    }
+
+    out << "]}";
+}
+
+/**
+ *  \brief Print report as SARIF 2.1.0 log with single run
+ */
+static void PrintSarifReport(const snowcrash::Report& report,
+                             const AnnotationLocator& locator,
+                             std::ostream& out)
+{
+    out << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"version\":\"2.1.0\",";
+    out << "\"runs\":[{\"tool\":{\"driver\":{\"name\":\"drafter\",\"version\":";
+    drafter::WriteQuotedString(DRAFTER_VERSION_STRING, out);
+    out << ",\"informationUri\":\"https://github.com/apiaryio/drafter\"}},\"results\":[";
+
+    bool first = true;
+
+    if (report.error.code != sc::Error::OK) {
+        WriteSarifResult(report.error, "error", locator, out);
+        first = false;
+    }
+
+    for (snowcrash::Warnings::const_iterator it = report.warnings.begin(); it != report.warnings.end(); ++it) {
+
+        if (!first) {
+            out << ',';
+        }
+
+        WriteSarifResult(*it, "warning", locator, out);
+        first = false;
+    }
+
+    out << "]}]}\n";
+}
+
+/**
+ *  \brief Write report with annotations located by \param locator
+ */
+static void WriteLocatedReport(const snowcrash::Report& report,
+                               const AnnotationLocator& locator,
+                               const bool isUseLineNumbers,
+                               const std::string& format,
+                               std::ostream& out)
+{
+    if (format == DiagnosticsFormat::JSON) {
+        PrintJSONReport(report, locator, out);
+    }
+    else if (format == DiagnosticsFormat::SARIF) {
+        PrintSarifReport(report, locator, out);
+    }
+    else {
+        PrintTextReport(report, &locator, isUseLineNumbers, out);
+    }
+}
+
+/**
+ *  \brief Write parser report to \param out
+ *  \param report A parser report to print
+ *  \param source Source data
+ *  \param isUseLineNumbers True if the annotations needs to be printed by line and column number
+ *  \param format Diagnostics format - "text", "json" or "sarif"
+ *  \param file Name of source file, empty for stdin
+ */
+void WriteReport(const snowcrash::Report& report,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format,
+                 const std::string& file,
+                 std::ostream& out)
+{
+    if (format == DiagnosticsFormat::Text && !isUseLineNumbers) {
+        PrintTextReport(report, NULL, false, out);
+        return;
+    }
+
+    // machine readable formats always carry line and column
+    AnnotationLocator locator(source, file);
+    WriteLocatedReport(report, locator, isUseLineNumbers, format, out);
+}
+
+void WriteReport(const snowcrash::Report& report,
+                 const drafter::SourceFiles& files,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format,
+                 std::ostream& out)
+{
+    AnnotationLocator locator(source, files);
+    WriteLocatedReport(report, locator, isUseLineNumbers, format, out);
+}
+
+/** Write \param buffer to stderr at once */
+static void WriteToStderr(const std::stringstream& buffer)
+{
+    const std::string& output = buffer.str();
+
+    std::cerr.write(output.data(), output.size());
+    std::cerr.flush();
+}
+
+void PrintReport(const snowcrash::Report& report,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format,
+                 const std::string& file)
+{
+    std::stringstream buffer;
+
+    WriteReport(report, source, isUseLineNumbers, format, file, buffer);
+
+    // whole report in one write
+    WriteToStderr(buffer);
+}
+
+void PrintReport(const snowcrash::Report& report,
+                 const drafter::SourceFiles& files,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format)
+{
+    std::stringstream buffer;
+
+    WriteReport(report, files, source, isUseLineNumbers, format, buffer);
+    WriteToStderr(buffer);
 }
@@ -11,18 +11,68 @@
 #define DRAFTER_REPORTING_H
 
 
+#include <ostream>
+
 #include "SourceAnnotation.h"
+#include "AssembleBlueprint.h"
+
+/** names of supported diagnostics formats */
+struct DiagnosticsFormat {
+    static const std::string Text;      ///< human readable, the default
+    static const std::string JSON;      ///< error and warnings with character and line/column ranges
+    static const std::string SARIF;     ///< SARIF 2.1.0 log
+};
 
 /**
  *  \brief Print parser report to stderr.
  *
+ *  The report is rendered into a buffer first and written at once.
+ *
  *  \param report A parser report to print
  *  \param source Source data
  *  \param isUseLineNumbers True if the annotations needs to be printed by line and column number
+ *  \param format Diagnostics format, \see DiagnosticsFormat
+ *  \param file Name of source file, used as artifact location in SARIF
+ */
+void PrintReport(const snowcrash::Report& report,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format = DiagnosticsFormat::Text,
+                 const std::string& file = std::string());
+
+/**
+ *  \brief Write parser report to \param out, in the same way as PrintReport()
+ */
+void WriteReport(const snowcrash::Report& report,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format,
+                 const std::string& file,
+                 std::ostream& out);
+
+/**
+ *  \brief Print report of blueprint assembled from \param files to stderr
+ *
+ *  Annotations are located in the file they fall into - positions count
+ *  in that file and the file is named in every location.
+ *
+ *  \param source Concatenation of \param files by drafter::ConcatenateSourceFiles()
  */
 void PrintReport(const snowcrash::Report& report,
+                 const drafter::SourceFiles& files,
+                 const std::string& source,
+                 const bool isUseLineNumbers,
+                 const std::string& format = DiagnosticsFormat::Text);
+
+/**
+ *  \brief Write report of blueprint assembled from \param files to \param out, as PrintReport()
+ */
+void WriteReport(const snowcrash::Report& report,
+                 const drafter::SourceFiles& files,
                  const std::string& source,
-                 const bool isUseLineNumbers);
+                 const bool isUseLineNumbers,
+                 const std::string& format,
+                 std::ostream& out);
 
 
 #endif /* end of include guard: DRAFTER_REPORTING_H */
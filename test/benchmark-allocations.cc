@@ -0,0 +1,107 @@
+//
+//  Allocation benchmarks - counting replacement of global operator new is
+//  in effect for the whole program, so they have an executable of their own
+//  and do not run within test-libdrafter.
+//
+//  $ make benchmark-allocations && ./bin/benchmark-allocations
+//
+#define CATCH_CONFIG_MAIN
+#include "test-drafter.h"
+
+#include <atomic>
+#include <ctime>
+#include <new>
+#include <stdlib.h>
+
+#include "snowcrash.h"
+
+#include "SerializeAST.h"
+
+namespace {
+
+    /** Allocations made by the program */
+    std::atomic<size_t> Allocations(0);
+
+    /**
+     *  Object property nested \param depth levels deep, \param breadth
+     *  properties on each level
+     */
+    mson::Element NestedProperty(size_t depth, size_t breadth)
+    {
+        mson::Element element(mson::Element::PropertyClass);
+
+        element.content.property.name.literal = "property";
+        element.content.property.description = "Nested property";
+        element.content.property.valueDefinition.typeDefinition.typeSpecification.name.base = mson::ObjectTypeName;
+
+        if (depth > 0) {
+
+            mson::TypeSection members(mson::TypeSection::MemberTypeClass);
+
+            for (size_t i = 0; i < breadth; ++i) {
+                members.content.elements().push_back(NestedProperty(depth - 1, breadth));
+            }
+
+            element.content.property.sections.push_back(members);
+        }
+
+        return element;
+    }
+}
+
+void* operator new(size_t size)
+{
+    ++Allocations;
+
+    if (void* allocated = malloc(size ? size : 1)) {
+        return allocated;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* allocated)
+{
+    free(allocated);
+}
+
+TEST_CASE("wrap deep data structure","[benchmark][result serialization]")
+{
+    const size_t Depth = 10;
+    const size_t Breadth = 2;
+
+    snowcrash::Element dataStructure(snowcrash::Element::DataStructureElement);
+    dataStructure.content.dataStructure.name.symbol.literal = "Deep";
+
+    mson::TypeSection members(mson::TypeSection::MemberTypeClass);
+    members.content.elements().push_back(NestedProperty(Depth, Breadth));
+    dataStructure.content.dataStructure.sections.push_back(members);
+
+    snowcrash::Element group(snowcrash::Element::CategoryElement);
+    group.category = snowcrash::Element::DataStructureGroupCategory;
+    group.content.elements().push_back(dataStructure);
+
+    snowcrash::Blueprint blueprint;
+    blueprint.content.elements().push_back(group);
+
+    size_t start = Allocations;
+    clock_t started = clock();
+
+    sos::Object wrapped = drafter::WrapBlueprint(blueprint);
+
+    clock_t wrappedAt = clock();
+    size_t wrapping = Allocations - start;
+
+    start = Allocations;
+    sos::Object copy = wrapped;
+    size_t copying = Allocations - start;
+
+    REQUIRE(copy.keys == wrapped.keys);
+
+    // every wrapped level is built once, not copied again by its parents
+    REQUIRE(wrapping < 2 * copying);
+
+    std::cout << "wrapping: " << wrapping << " allocations, "
+              << (1000.0 * (wrappedAt - started) / CLOCKS_PER_SEC) << " ms" << std::endl;
+    std::cout << "one copy of the result: " << copying << " allocations" << std::endl;
+}
@@ -0,0 +1,198 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "drafter.h"
+#include "sosJSON.h"
+#include "SerializeResult.h"
+#include "SerializeSourcemap.h"
+#include "AssembleBlueprint.h"
+
+static std::string SerializedResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint)
+{
+    std::stringstream outStream;
+    sos::SerializeJSON serializer;
+
+    serializer.process(drafter::WrapResult(blueprint, snowcrash::ExportSourcemapOption), outStream);
+
+    return outStream.str();
+}
+
+/** Check every `[file, location, length]` row lies in its file, count rows of files into \param ranges */
+static void RequireFileRanges(const sos::Base& sourceMap, const drafter::SourceFiles& files, std::vector<size_t>& ranges)
+{
+    if (sourceMap.type == sos::Base::ArrayType && sourceMap.array.size() == 3 && sourceMap.array[0].type == sos::Base::NumberType) {
+
+        size_t file = static_cast<size_t>(sourceMap.array[0].number);
+
+        REQUIRE(file < files.size());
+        REQUIRE(sourceMap.array[1].number + sourceMap.array[2].number <= files[file].source.size());
+
+        ++ranges[file];
+        return;
+    }
+
+    for (sos::Bases::const_iterator it = sourceMap.array.begin(); it != sourceMap.array.end(); ++it) {
+        RequireFileRanges(*it, files, ranges);
+    }
+
+    for (sos::KeyValues::const_iterator it = sourceMap.object.begin(); it != sourceMap.object.end(); ++it) {
+        RequireFileRanges(it->second, files, ranges);
+    }
+}
+
+static drafter::SourceFiles NotesFiles()
+{
+    drafter::SourceFiles files;
+
+    files.push_back(drafter::SourceFile("main.apib",
+                                        "FORMAT: 1A\n"
+                                        "# Notes API\n"
+                                        "Notes of the team.\n"));
+
+    files.push_back(drafter::SourceFile("notes.apib",
+                                        "# Group Notes\n"
+                                        "## Note [/notes/{id}]\n"
+                                        "+ Attributes (Note)\n"
+                                        "### Retrieve [GET]\n"
+                                        "+ Response 200 (application/json)\n"
+                                        "    + Attributes (Note)\n"));
+
+    files.push_back(drafter::SourceFile("users.apib",
+                                        "# Group Users\n"
+                                        "## User [/users/{id}]\n"
+                                        "### Retrieve [GET]\n"
+                                        "+ Response 200 (application/json)\n"
+                                        "    + Attributes (User)\n"));
+
+    files.push_back(drafter::SourceFile("types.apib",
+                                        "# Data Structures\n"
+                                        "## Note (object)\n"
+                                        "+ id: 1 (number)\n"
+                                        "+ author (User)\n"
+                                        "## User (object)\n"
+                                        "+ name: Jane\n"));
+
+    return files;
+}
+
+static void RequireSameAsConcatenated(const drafter::SourceFiles& files, unsigned int threads = 1)
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> concatenated;
+    int concatenatedCode = drafter::ParseBlueprint(drafter::ConcatenateSourceFiles(files), snowcrash::ExportSourcemapOption, concatenated);
+
+    drafter::BlueprintAssembler assembler;
+    snowcrash::ParseResult<snowcrash::Blueprint> assembled;
+
+    REQUIRE(assembler.assemble(files, snowcrash::ExportSourcemapOption, assembled, threads) == concatenatedCode);
+    REQUIRE(SerializedResult(assembled) == SerializedResult(concatenated));
+}
+
+TEST_CASE("assembled files give the same result as their concatenation","[assemble blueprint]")
+{
+    RequireSameAsConcatenated(NotesFiles());
+    RequireSameAsConcatenated(NotesFiles(), 4);
+}
+
+TEST_CASE("assembly reparses only changed files","[assemble blueprint]")
+{
+    drafter::SourceFiles files = NotesFiles();
+    drafter::BlueprintAssembler assembler;
+
+    snowcrash::ParseResult<snowcrash::Blueprint> first;
+    assembler.assemble(files, snowcrash::ExportSourcemapOption, first);
+
+    REQUIRE(assembler.statistics().parsed == 4);
+    REQUIRE(assembler.statistics().reused == 0);
+
+    snowcrash::ParseResult<snowcrash::Blueprint> unchanged;
+    assembler.assemble(files, snowcrash::ExportSourcemapOption, unchanged);
+
+    REQUIRE(assembler.statistics().parsed == 0);
+    REQUIRE(assembler.statistics().reused == 4);
+    REQUIRE(SerializedResult(unchanged) == SerializedResult(first));
+
+    // the changed file only, offsets of the files after it move
+    files[1].source.insert(files[1].source.find("### Retrieve"), "Single note.\n\n");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> changed;
+    assembler.assemble(files, snowcrash::ExportSourcemapOption, changed);
+
+    REQUIRE(assembler.statistics().parsed == 1);
+    REQUIRE(assembler.statistics().reused == 3);
+
+    snowcrash::ParseResult<snowcrash::Blueprint> concatenated;
+    drafter::ParseBlueprint(drafter::ConcatenateSourceFiles(files), snowcrash::ExportSourcemapOption, concatenated);
+
+    REQUIRE(SerializedResult(changed) == SerializedResult(concatenated));
+
+    // named types are part of every other file
+    files[3].source += "+ email\n";
+
+    snowcrash::ParseResult<snowcrash::Blueprint> types;
+    assembler.assemble(files, snowcrash::ExportSourcemapOption, types);
+
+    REQUIRE(assembler.statistics().parsed == 4);
+}
+
+TEST_CASE("assembly falls back to the concatenation for resource in more files","[assemble blueprint]")
+{
+    drafter::SourceFiles files = NotesFiles();
+
+    files.push_back(drafter::SourceFile("more-notes.apib",
+                                        "# Group More Notes\n"
+                                        "## Note [/notes/{id}]\n"
+                                        "### Delete [DELETE]\n"
+                                        "+ Response 204\n"));
+
+    RequireSameAsConcatenated(files);
+}
+
+TEST_CASE("source map ranges of assembled files carry file index","[assemble blueprint]")
+{
+    drafter::SourceFiles files = NotesFiles();
+
+    drafter::BlueprintAssembler assembler;
+    snowcrash::ParseResult<snowcrash::Blueprint> assembled;
+    assembler.assemble(files, snowcrash::ExportSourcemapOption, assembled);
+
+    sos::Object sourceMap = drafter::WrapBlueprintSourcemap(assembled.sourceMap);
+    drafter::ConvertSourcemapFiles(sourceMap, files, drafter::BytePositions);
+
+    std::vector<size_t> ranges(files.size(), 0);
+    RequireFileRanges(sourceMap, files, ranges);
+
+    for (size_t i = 1; i < files.size(); ++i) {
+        REQUIRE(ranges[i] > 0);
+    }
+
+    size_t local = 0;
+    REQUIRE(drafter::LocateSourceFile(files, files[0].source.size() + 5, local) == 1);
+    REQUIRE(local == 5);
+}
+
+TEST_CASE("files without trailing line break are separated","[assemble blueprint]")
+{
+    drafter::SourceFiles files = NotesFiles();
+
+    // strip trailing line breaks of all but the last file
+    for (size_t i = 0; i + 1 < files.size(); ++i) {
+        files[i].source.erase(files[i].source.size() - 1);
+    }
+
+    std::string source = drafter::ConcatenateSourceFiles(files);
+
+    REQUIRE(source.compare(files[0].source.size(), 2, "\n#") == 0);
+    REQUIRE(drafter::SourceFileSeparator(files, 0) == 1);
+    REQUIRE(drafter::SourceFileSeparator(files, files.size() - 1) == 0);
+
+    RequireSameAsConcatenated(files);
+
+    // the added line break belongs to the file before it
+    size_t local = 0;
+    REQUIRE(drafter::LocateSourceFile(files, files[0].source.size(), local) == 0);
+    REQUIRE(local == files[0].source.size());
+
+    REQUIRE(drafter::LocateSourceFile(files, files[0].source.size() + 1, local) == 1);
+    REQUIRE(local == 0);
+}
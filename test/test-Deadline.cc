@@ -0,0 +1,125 @@
+#include "test-drafter.h"
+
+#include "drafter.h"
+#include "cdrafter.h"
+#include "SerializeAST.h"
+#include "SerializeJSON.h"
+
+#include <string.h>
+
+TEST_CASE("deadline expires by time or by cancel","[deadline]")
+{
+    drafter::Deadline unlimited;
+
+    REQUIRE_FALSE(unlimited.expired());
+    REQUIRE_NOTHROW(unlimited.check());
+
+    unlimited.cancel();
+
+    REQUIRE(unlimited.expired());
+    REQUIRE_THROWS_AS(unlimited.check(), drafter::Cancelled);
+
+    drafter::Deadline past(drafter::Deadline::Clock::duration::zero());
+
+    REQUIRE(past.expired());
+    REQUIRE_THROWS_AS(past.check(), drafter::Cancelled);
+}
+
+TEST_CASE("expired deadline stops wrapping and serialization","[deadline]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/annotations-with-warning");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(fixture.get(".apib"), 0, blueprint);
+
+    drafter::Deadline deadline;
+    deadline.cancel();
+
+    REQUIRE_THROWS_AS(drafter::WrapBlueprint(blueprint.node, &deadline), drafter::Cancelled);
+
+    sos::Array values;
+
+    for (size_t i = 0; i < drafter::DeadlineCounter::Interval; ++i) {
+        values.push(sos::Array());
+    }
+
+    std::stringstream output;
+    drafter::SerializeJSON serializer(&deadline);
+
+    REQUIRE_THROWS_AS(serializer.process(values, output), drafter::Cancelled);
+}
+
+TEST_CASE("parse with expired deadline reports cancelled error","[deadline]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/annotations-with-warning");
+
+    drafter::Deadline deadline;
+    deadline.cancel();
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+
+    REQUIRE(drafter::ParseBlueprint(fixture.get(".apib"), 0, blueprint, &deadline) == drafter::CancelledError);
+    REQUIRE(blueprint.report.error.code == drafter::CancelledError);
+}
+
+TEST_CASE("parse is abandoned when deadline expires while snowcrash parses","[deadline]")
+{
+    std::string source = "# API\n\n";
+
+    for (size_t i = 0; i < 4000; ++i) {
+        std::stringstream resource;
+        resource << "## Note " << i << " [/notes/" << i << "]\n"
+                 << "\n"
+                 << "### Retrieve [GET]\n"
+                 << "+ Response 200 (application/json)\n"
+                 << "\n"
+                 << "        { \"id\": " << i << " }\n"
+                 << "\n";
+        source += resource.str();
+    }
+
+    typedef drafter::Deadline::Clock Clock;
+
+    Clock::time_point started = Clock::now();
+
+    snowcrash::ParseResult<snowcrash::Blueprint> complete;
+    REQUIRE(drafter::ParseBlueprint(source, 0, complete) == snowcrash::Error::OK);
+
+    drafter::Deadline deadline((Clock::now() - started) / 10);
+
+    snowcrash::ParseResult<snowcrash::Blueprint> abandoned;
+
+    REQUIRE(drafter::ParseBlueprint(source, 0, abandoned, &deadline) == drafter::CancelledError);
+    REQUIRE(abandoned.node.content.elements().empty());
+}
+
+TEST_CASE("c-interface parse until deadline","[deadline][c-interface]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/annotations-with-warning");
+
+    std::string source = fixture.get(".apib");
+
+    char* result = NULL;
+
+    // no deadline - same as drafter_c_parse()
+    REQUIRE(drafter_c_parse_until(source.c_str(), 0, NULL, &result) == 0);
+    REQUIRE(strcmp(result, fixture.get(".result.json").c_str()) == 0);
+
+    free(result);
+
+    sc_deadline* deadline = drafter_c_create_deadline(60 * 1000);
+
+    REQUIRE(drafter_c_parse_until(source.c_str(), 0, deadline, &result) == 0);
+    REQUIRE(strcmp(result, fixture.get(".result.json").c_str()) == 0);
+
+    free(result);
+
+    drafter_c_cancel(deadline);
+
+    REQUIRE(drafter_c_parse_until(source.c_str(), 0, deadline, &result) == SC_CANCELLED_ERROR);
+    REQUIRE(strstr(result, "\"code\": 100") != NULL);
+
+    free(result);
+
+    drafter_c_free_deadline(deadline);
+}
@@ -0,0 +1,132 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "DiffAST.h"
+
+TEST_CASE("identical blueprints have the same hash and no changes","[diff]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/diff-before");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> before;
+    snowcrash::ParseResult<snowcrash::Blueprint> after;
+
+    REQUIRE(snowcrash::parse(fixture.get(".apib"), 0, before) == snowcrash::Error::OK);
+    REQUIRE(snowcrash::parse(fixture.get(".apib"), 0, after) == snowcrash::Error::OK);
+
+    drafter::HashNode beforeHash = drafter::HashBlueprint(before.node);
+    drafter::HashNode afterHash = drafter::HashBlueprint(after.node);
+
+    REQUIRE(beforeHash.hash == afterHash.hash);
+
+    drafter::Changes changes;
+    drafter::DiffBlueprint(beforeHash, afterHash, changes);
+
+    REQUIRE(changes.empty());
+}
+
+TEST_CASE("diff reports added, removed and modified elements","[diff]")
+{
+    ITFixtureFiles beforeFixture = ITFixtureFiles("test/fixtures/diff-before");
+    ITFixtureFiles afterFixture = ITFixtureFiles("test/fixtures/diff-after");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> before;
+    snowcrash::ParseResult<snowcrash::Blueprint> after;
+
+    REQUIRE(snowcrash::parse(beforeFixture.get(".apib"), 0, before) == snowcrash::Error::OK);
+    REQUIRE(snowcrash::parse(afterFixture.get(".apib"), 0, after) == snowcrash::Error::OK);
+
+    drafter::Changes changes;
+    drafter::DiffBlueprint(drafter::HashBlueprint(before.node), drafter::HashBlueprint(after.node), changes);
+
+    REQUIRE(changes.size() == 3);
+
+    REQUIRE(changes[0].type == drafter::Change::RemovedChange);
+    REQUIRE(changes[0].element == "action");
+    REQUIRE(changes[0].path.size() == 3);
+    REQUIRE(changes[0].path[1] == "/notes");
+    REQUIRE(changes[0].path[2] == "POST");
+
+    REQUIRE(changes[1].type == drafter::Change::ModifiedChange);
+    REQUIRE(changes[1].element == "response");
+    REQUIRE(changes[1].path.size() == 4);
+    REQUIRE(changes[1].path[1] == "/notes/{id}");
+    REQUIRE(changes[1].path[3] == "response 200");
+
+    REQUIRE(changes[2].type == drafter::Change::AddedChange);
+    REQUIRE(changes[2].element == "action");
+    REQUIRE(changes[2].path[2] == "DELETE");
+}
+
+namespace {
+
+    /** Blueprint with single GET action answered by responses 200 with \param bodies */
+    snowcrash::Blueprint ResponsesBlueprint(const std::vector<std::string>& bodies)
+    {
+        snowcrash::TransactionExample example;
+
+        for (std::vector<std::string>::const_iterator it = bodies.begin(); it != bodies.end(); ++it) {
+            snowcrash::Response response;
+
+            response.name = "200";
+            response.body = *it;
+
+            example.responses.push_back(response);
+        }
+
+        snowcrash::Action action;
+        action.method = "GET";
+        action.examples.push_back(example);
+
+        snowcrash::Element resource(snowcrash::Element::ResourceElement);
+        resource.content.resource.uriTemplate = "/notes";
+        resource.content.resource.actions.push_back(action);
+
+        snowcrash::Element group(snowcrash::Element::CategoryElement);
+        group.category = snowcrash::Element::ResourceGroupCategory;
+        group.content.elements().push_back(resource);
+
+        snowcrash::Blueprint blueprint;
+        blueprint.content.elements().push_back(group);
+
+        return blueprint;
+    }
+}
+
+TEST_CASE("duplicate siblings are matched by content before position","[diff]")
+{
+    std::vector<std::string> bodies;
+
+    bodies.push_back("first\n");
+    bodies.push_back("second\n");
+    bodies.push_back("third\n");
+
+    drafter::HashNode before = drafter::HashBlueprint(ResponsesBlueprint(bodies));
+
+    // removing the first response renumbers the others, they are still the same
+    bodies.erase(bodies.begin());
+
+    drafter::Changes changes;
+    drafter::DiffBlueprint(before, drafter::HashBlueprint(ResponsesBlueprint(bodies)), changes);
+
+    // action is modified as it has one response less, none of responses is
+    REQUIRE(changes.size() == 2);
+    REQUIRE(changes[0].type == drafter::Change::ModifiedChange);
+    REQUIRE(changes[0].element == "action");
+    REQUIRE(changes[1].type == drafter::Change::RemovedChange);
+    REQUIRE(changes[1].element == "response");
+    REQUIRE(changes[1].path.size() == 4);
+    REQUIRE(changes[1].path[3] == "response 200");
+
+    // duplicates without equal counterpart fall back to position
+    bodies[1] = "changed\n";
+
+    changes.clear();
+    drafter::DiffBlueprint(before, drafter::HashBlueprint(ResponsesBlueprint(bodies)), changes);
+
+    REQUIRE(changes.size() == 3);
+    REQUIRE(changes[1].type == drafter::Change::ModifiedChange);
+    REQUIRE(changes[1].path[3] == "response 200 #2");
+    REQUIRE(changes[2].type == drafter::Change::RemovedChange);
+    REQUIRE(changes[2].path[3] == "response 200 #3");
+}
@@ -0,0 +1,255 @@
+#include "test-drafter.h"
+
+#include <ctime>
+
+#include "sosJSON.h"
+#include "sosYAML.h"
+
+#include "Format.h"
+#include "JSONReader.h"
+#include "SerializeJSON.h"
+#include "SerializeYAML.h"
+
+static std::string FormatNumber(double number)
+{
+    std::stringstream ss;
+    drafter::WriteNumber(number, ss);
+    return ss.str();
+}
+
+static sos::Object MakeSample(const std::string& name = "\"quoted\" \\ and\nnew line")
+{
+    sos::Object object;
+    sos::Array ranges;
+    sos::Array range;
+
+    range.push(sos::Number(104));
+    range.push(sos::Number(43));
+    ranges.push(range);
+    ranges.push(sos::Array());
+
+    object.set("name", sos::String(name));
+    object.set("sourcemap", ranges);
+    object.set("required", sos::Boolean(false));
+    object.set("reference", sos::Null());
+    object.set("ratio", sos::Number(0.25));
+
+    sos::Array items;
+    items.push(object);
+    items.push(sos::Number(-7));
+
+    sos::Object root;
+    root.set("_version", sos::String("3.0"));
+    root.set("items", items);
+
+    return root;
+}
+
+TEST_CASE("integers are written by digit pairs","[format]")
+{
+    REQUIRE(FormatNumber(0) == "0");
+    REQUIRE(FormatNumber(7) == "7");
+    REQUIRE(FormatNumber(10) == "10");
+    REQUIRE(FormatNumber(99) == "99");
+    REQUIRE(FormatNumber(100) == "100");
+    REQUIRE(FormatNumber(-42) == "-42");
+    REQUIRE(FormatNumber(1234567) == "1234567");
+    REQUIRE(FormatNumber(9007199254740991.0) == "9007199254740991");
+
+    REQUIRE(FormatNumber(1.5) == "1.5");
+    REQUIRE(FormatNumber(-0.125) == "-0.125");
+}
+
+TEST_CASE("serializers keep sos layout","[format]")
+{
+    sos::Object sample = MakeSample();
+
+    std::stringstream expected, actual;
+
+    sos::SerializeJSON().process(sample, expected);
+    drafter::SerializeJSON().process(sample, actual);
+
+    REQUIRE(actual.str() == expected.str());
+
+    expected.str("");
+    actual.str("");
+
+    // multi-line strings are literal blocks in drafter YAML
+    sample = MakeSample("\"quoted\" \\ and\ttab");
+
+    sos::SerializeYAML().process(sample, expected);
+    drafter::SerializeYAML().process(sample, actual);
+
+    REQUIRE(actual.str() == expected.str());
+}
+
+TEST_CASE("multi-line strings are written as literal blocks","[format]")
+{
+    sos::Object object;
+    object.set("strip", sos::String("one\ntwo"));
+    object.set("clip", sos::String("one\n\n  indented\n"));
+    object.set("keep", sos::String("one\n\n"));
+    object.set("indented", sos::String("  one\ntwo\n"));
+    object.set("control", sos::String("one\r\ntwo\n"));
+    object.set("separator", sos::String("one\xE2\x80\xA8two\n"));
+
+    sos::Array items;
+    items.push(sos::String("item\n"));
+    object.set("items", items);
+
+    object.set("last", sos::String("one\n\n"));
+
+    std::stringstream yaml;
+    drafter::SerializeYAML().process(object, yaml);
+
+    REQUIRE(yaml.str() ==
+            "strip: |-\n"
+            "  one\n"
+            "  two\n"
+            "clip: |\n"
+            "  one\n"
+            "\n"
+            "    indented\n"
+            "keep: |+\n"
+            "  one\n"
+            "\n"
+            "indented: \"  one\\ntwo\\n\"\n"
+            "control: \"one\\r\\ntwo\\n\"\n"
+            "separator: \"one\xE2\x80\xA8two\\n\"\n"
+            "items:\n"
+            "  - |\n"
+            "    item\n"
+            "last: \"one\\n\\n\"\n");
+}
+
+TEST_CASE("serialized source map fixture is unchanged","[format]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("features/fixtures/sourcemap");
+
+    sos::Base sourceMap;
+    std::string error;
+
+    REQUIRE(drafter::ReadJSON(fixture.get(".json"), sourceMap, error));
+
+    std::stringstream json, yaml;
+
+    drafter::SerializeJSON().process(sourceMap, json);
+    json << "\n";
+
+    drafter::SerializeYAML().process(sourceMap, yaml);
+
+    REQUIRE(json.str() == fixture.get(".json"));
+    REQUIRE(yaml.str() == fixture.get(".yaml"));
+}
+
+TEST_CASE("repeated collections are written as aliases","[format]")
+{
+    sos::Object header;
+    header.set("name", sos::String("Content-Type"));
+    header.set("value", sos::String("application/json"));
+
+    sos::Array headers;
+    headers.push(header);
+
+    sos::Object request;
+    request.set("headers", headers);
+    request.set("body", sos::String("{}"));
+
+    sos::Object response;
+    response.set("headers", headers);
+    response.set("body", sos::String(""));
+
+    sos::Array payloads;
+    payloads.push(request);
+    payloads.push(response);
+    payloads.push(request);
+    payloads.push(sos::Array());
+    payloads.push(sos::Array());
+
+    std::stringstream yaml;
+    drafter::SerializeYAML(NULL, true).process(payloads, yaml);
+
+    REQUIRE(yaml.str() ==
+            "- &a1\n"
+            "  headers: &a2\n"
+            "    -\n"
+            "      name: \"Content-Type\"\n"
+            "      value: \"application/json\"\n"
+            "  body: \"{}\"\n"
+            "-\n"
+            "  headers: *a2\n"
+            "  body: \"\"\n"
+            "- *a1\n"
+            "- []\n"
+            "- []\n");
+
+    std::stringstream plain, expected;
+    drafter::SerializeYAML(NULL, true).process(MakeSample(), plain);
+    drafter::SerializeYAML().process(MakeSample(), expected);
+
+    REQUIRE(plain.str() == expected.str());
+}
+
+/**
+ *  Source map of fixture repeated as if the blueprint was \param copies times longer
+ */
+static void ShiftNumbers(sos::Base& value, double shift)
+{
+    if (value.type == sos::Base::NumberType) {
+        value.number += shift;
+    }
+
+    for (sos::Bases::iterator it = value.array.begin(); it != value.array.end(); ++it) {
+        ShiftNumbers(*it, shift);
+    }
+
+    for (sos::KeyValues::iterator it = value.object.begin(); it != value.object.end(); ++it) {
+        ShiftNumbers(it->second, shift);
+    }
+}
+
+static double MeasureSerializer(sos::Serialize& serializer, const sos::Base& value, size_t& size)
+{
+    std::stringstream out;
+
+    clock_t start = clock();
+    serializer.process(value, out);
+    clock_t end = clock();
+
+    size = out.str().size();
+
+    return 1000.0 * (end - start) / CLOCKS_PER_SEC;
+}
+
+TEST_CASE("serialize scaled source map","[.][benchmark][format]")
+{
+    const size_t Copies = 2000;
+    const double FixtureLength = 4096;
+
+    ITFixtureFiles fixture = ITFixtureFiles("features/fixtures/sourcemap");
+
+    sos::Base sourceMap;
+    std::string error;
+
+    REQUIRE(drafter::ReadJSON(fixture.get(".json"), sourceMap, error));
+
+    sos::Array scaled;
+
+    for (size_t i = 0; i < Copies; ++i) {
+        sos::Base copy = sourceMap;
+        ShiftNumbers(copy, i * FixtureLength);
+        scaled.push(copy);
+    }
+
+    sos::SerializeJSON sosJSON;
+    sos::SerializeYAML sosYAML;
+    drafter::SerializeJSON drafterJSON;
+    drafter::SerializeYAML drafterYAML;
+
+    size_t size;
+
+    std::cout << "sos JSON: " << MeasureSerializer(sosJSON, scaled, size) << " ms, " << size << " bytes" << std::endl;
+    std::cout << "drafter JSON: " << MeasureSerializer(drafterJSON, scaled, size) << " ms, " << size << " bytes" << std::endl;
+    std::cout << "sos YAML: " << MeasureSerializer(sosYAML, scaled, size) << " ms, " << size << " bytes" << std::endl;
+    std::cout << "drafter YAML: " << MeasureSerializer(drafterYAML, scaled, size) << " ms, " << size << " bytes" << std::endl;
+}
@@ -0,0 +1,222 @@
+#include "test-drafter.h"
+
+#include "JSONPatch.h"
+#include "SerializeJSON.h"
+#include "cdrafter.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+namespace {
+
+    std::string ToJSON(const sos::Base& value)
+    {
+        std::stringstream ss;
+        drafter::SerializeJSON serializer;
+
+        serializer.process(value, ss);
+        return ss.str();
+    }
+
+    std::string Field(const sos::Base& operation, const std::string& key)
+    {
+        return operation.object.find(key)->second.str;
+    }
+
+    sos::Object Resource(const std::string& uri, const std::string& description)
+    {
+        sos::Object resource;
+        resource.set("uriTemplate", sos::String(uri));
+        resource.set("description", sos::String(description));
+
+        return resource;
+    }
+
+    /** Apply \param patch as produced by drafter - paths have no escaped tokens */
+    void ApplyPatch(const sos::Base& patch, sos::Base& document)
+    {
+        for (sos::Bases::const_iterator it = patch.array.begin(); it != patch.array.end(); ++it) {
+
+            std::string op = Field(*it, "op");
+            std::string path = Field(*it, "path");
+
+            if (path.empty()) {
+                document = it->object.find("value")->second;
+                continue;
+            }
+
+            sos::Base* parent = &document;
+            size_t begin = 1;
+            size_t end;
+
+            while ((end = path.find('/', begin)) != std::string::npos) {
+                std::string token = path.substr(begin, end - begin);
+
+                parent = parent->type == sos::Base::ArrayType
+                    ? &parent->array[atoi(token.c_str())]
+                    : &parent->object[token];
+
+                begin = end + 1;
+            }
+
+            std::string token = path.substr(begin);
+
+            if (parent->type == sos::Base::ArrayType) {
+                sos::Bases::iterator position = parent->array.begin() + atoi(token.c_str());
+
+                if (op == "add") {
+                    parent->array.insert(position, it->object.find("value")->second);
+                }
+                else if (op == "remove") {
+                    parent->array.erase(position);
+                }
+                else {
+                    *position = it->object.find("value")->second;
+                }
+            }
+            else {
+                if (op == "remove") {
+                    parent->object.erase(token);
+                    parent->keys.erase(std::find(parent->keys.begin(), parent->keys.end(), token));
+                }
+                else {
+                    if (parent->object.find(token) == parent->object.end()) {
+                        parent->keys.push_back(token);
+                    }
+
+                    parent->object[token] = it->object.find("value")->second;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("first update replaces the whole document","[patch]")
+{
+    drafter::PatchSession session;
+
+    sos::Object result;
+    result.set("name", sos::String("API"));
+
+    sos::Array patch = session.update(result);
+
+    REQUIRE(patch.array.size() == 1);
+    REQUIRE(Field(patch.array[0], "op") == "replace");
+    REQUIRE(Field(patch.array[0], "path") == "");
+
+    REQUIRE(session.update(result).array.empty());
+}
+
+TEST_CASE("patch lists only changed leaves","[patch]")
+{
+    sos::Array resources;
+
+    for (int i = 0; i < 100; ++i) {
+        std::stringstream uri;
+        uri << "/r" << i;
+
+        resources.push(Resource(uri.str(), "same"));
+    }
+
+    sos::Object before;
+    before.set("name", sos::String("API"));
+    before.set("resources", resources);
+
+    sos::Object after = before;
+    after.object["resources"].array[42] = Resource("/r42", "changed");
+    after.object["resources"].array.insert(after.object["resources"].array.begin() + 60, Resource("/new/a~b", "added"));
+    after.set("version", sos::String("1"));
+
+    drafter::PatchSession session;
+    session.update(before);
+    sos::Array patch = session.update(after);
+
+    REQUIRE(patch.array.size() == 3);
+
+    REQUIRE(Field(patch.array[0], "op") == "replace");
+    REQUIRE(Field(patch.array[0], "path") == "/resources/42/description");
+
+    REQUIRE(Field(patch.array[1], "op") == "add");
+    REQUIRE(Field(patch.array[1], "path") == "/resources/60");
+
+    REQUIRE(Field(patch.array[2], "op") == "add");
+    REQUIRE(Field(patch.array[2], "path") == "/version");
+
+    sos::Base patched = before;
+    ApplyPatch(patch, patched);
+
+    REQUIRE(ToJSON(patched) == ToJSON(after));
+}
+
+TEST_CASE("patch removes items and keys","[patch]")
+{
+    sos::Array items;
+
+    for (int i = 0; i < 10; ++i) {
+        items.push(sos::Number(i));
+    }
+
+    sos::Object before;
+    before.set("items", items);
+    before.set("gone", sos::Boolean(true));
+
+    sos::Object after;
+    after.set("items", items);
+    after.object["items"].array.erase(after.object["items"].array.begin() + 2, after.object["items"].array.begin() + 5);
+    after.object["items"].array[0] = sos::String("zero");
+
+    drafter::ValueHash beforeHash, afterHash;
+    drafter::HashValue(before, beforeHash);
+    drafter::HashValue(after, afterHash);
+
+    sos::Array patch;
+    drafter::DiffValue(before, beforeHash, after, afterHash, patch);
+
+    sos::Base patched = before;
+    ApplyPatch(patch, patched);
+
+    REQUIRE(ToJSON(patched) == ToJSON(after));
+    REQUIRE(Field(patch.array.back(), "op") == "remove");
+    REQUIRE(Field(patch.array.back(), "path") == "/gone");
+}
+
+TEST_CASE("patch does not trust equal hashes alone","[patch]")
+{
+    sos::Array before;
+    before.push(Resource("/notes", "Notes"));
+    before.push(Resource("/tags", "Tags"));
+
+    sos::Array after;
+    after.push(Resource("/notes", "Notes"));
+    after.push(Resource("/tags", "Labels"));
+
+    // colliding hash trees - the same shape, the same hashes
+    drafter::ValueHash hash;
+    drafter::HashValue(before, hash);
+
+    sos::Array patch;
+    drafter::DiffValue(before, hash, after, hash, patch);
+
+    sos::Base patched = before;
+    ApplyPatch(patch, patched);
+
+    REQUIRE(ToJSON(patched) == ToJSON(after));
+    REQUIRE(patch.array.size() == 1);
+    REQUIRE(Field(patch.array[0], "path") == "/1/description");
+}
+
+TEST_CASE("patch session over C interface","[patch][cdrafter]")
+{
+    sc_patch_session* session = drafter_c_create_patch_session();
+    char* result = NULL;
+
+    drafter_c_parse_patch(session, "# API\n## GET /a\n+ Response 200\n", 0, &result);
+    REQUIRE(std::string(result).find("\"replace\"") != std::string::npos);
+    free(result);
+
+    drafter_c_parse_patch(session, "# API\n## GET /a\n+ Response 200\n", 0, &result);
+    REQUIRE(std::string(result) == "[]\n");
+    free(result);
+
+    drafter_c_free_patch_session(session);
+}
@@ -0,0 +1,69 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "MockServer.h"
+
+static const char ListNotes[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 3\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+TEST_CASE("mock server answers by example response","[mock server]")
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    REQUIRE(snowcrash::parse(ITFixtureFiles("test/fixtures/mock-server.apib").get(""), 0, blueprint) == snowcrash::Error::OK);
+
+    MockServer server(blueprint.node);
+
+    SECTION("matched action") {
+        REQUIRE(server.respond("GET", "/notes") == std::string(ListNotes) + "[]\n");
+        REQUIRE(server.respond("GET", "/notes?page=2") == std::string(ListNotes) + "[]\n");
+    }
+
+    SECTION("unmatched request") {
+        REQUIRE(server.respond("GET", "/users").compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+        REQUIRE(server.respond("DELETE", "/notes").compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+    }
+
+    SECTION("action without example response") {
+        const std::string& response = server.respond("POST", "/notes");
+
+        REQUIRE(response.compare(0, 28, "HTTP/1.1 501 Not Implemented") == 0);
+        REQUIRE(response.find("\r\n\r\nNo example response in blueprint\n") != std::string::npos);
+    }
+
+    SECTION("HEAD answered by headers of GET action") {
+        REQUIRE(server.respond("HEAD", "/notes") == ListNotes);
+
+        const std::string& response = server.respond("HEAD", "/users");
+
+        REQUIRE(response.compare(0, 22, "HTTP/1.1 404 Not Found") == 0);
+        REQUIRE(response.substr(response.size() - 4) == "\r\n\r\n");
+    }
+}
+
+TEST_CASE("mock server reads only sane Content-Length","[mock server]")
+{
+    size_t length = 1;
+
+    REQUIRE(MockServer::ParseContentLength("", length));
+    REQUIRE(length == 0);
+
+    REQUIRE(MockServer::ParseContentLength("42", length));
+    REQUIRE(length == 42);
+
+    REQUIRE(MockServer::ParseContentLength("7 \t", length));
+    REQUIRE(length == 7);
+
+    REQUIRE_FALSE(MockServer::ParseContentLength("-1", length));
+    REQUIRE_FALSE(MockServer::ParseContentLength(" ", length));
+    REQUIRE_FALSE(MockServer::ParseContentLength("12abc", length));
+    REQUIRE_FALSE(MockServer::ParseContentLength("0x10", length));
+
+    // would wrap around when added to request offset
+    REQUIRE_FALSE(MockServer::ParseContentLength("18446744073709551616", length));
+    REQUIRE_FALSE(MockServer::ParseContentLength("99999999999999999999999", length));
+}
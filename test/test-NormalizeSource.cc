@@ -0,0 +1,284 @@
+#include "test-drafter.h"
+
+#include <time.h>
+
+#include "snowcrash.h"
+
+#include "drafter.h"
+#include "cdrafter.h"
+#include "NormalizeSource.h"
+#include "SerializeAST.h"
+#include "SerializeJSON.h"
+
+namespace {
+
+    /** Byte by byte normalization for comparison */
+    std::string NaiveNormalize(const std::string& source)
+    {
+        std::string result;
+        size_t column = 0;
+        size_t i = (source.compare(0, 3, "\xEF\xBB\xBF") == 0) ? 3 : 0;
+
+        for (; i < source.size(); ++i) {
+
+            char c = source[i];
+
+            if (c == '\r') {
+
+                if (i + 1 < source.size() && source[i + 1] == '\n') {
+                    ++i;
+                }
+
+                result += '\n';
+                column = 0;
+            }
+            else if (c == '\n') {
+                result += '\n';
+                column = 0;
+            }
+            else if (c == '\t') {
+                size_t spaces = 4 - column % 4;
+                result.append(spaces, ' ');
+                column += spaces;
+            }
+            else {
+                result += c;
+
+                if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+                    ++column;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    std::string CRLF(const std::string& source)
+    {
+        std::string result;
+
+        for (std::string::const_iterator it = source.begin(); it != source.end(); ++it) {
+
+            if (*it == '\n') {
+                result += '\r';
+            }
+
+            result += *it;
+        }
+
+        return result;
+    }
+}
+
+TEST_CASE("normalized source is left alone","[normalize source]")
+{
+    std::string normalized;
+    drafter::SourceRemap remap;
+
+    REQUIRE_FALSE(drafter::NormalizeSource("# API\n\n## Notes [/notes]\n", normalized, remap));
+    REQUIRE(normalized.empty());
+    REQUIRE(remap.empty());
+}
+
+TEST_CASE("line endings, BOM and tabs are normalized","[normalize source]")
+{
+    const std::string source = "\xEF\xBB\xBF# API\r\n\r\nab\tc\r\n\tx\ry";
+
+    std::string normalized;
+    drafter::SourceRemap remap;
+
+    REQUIRE(drafter::NormalizeSource(source, normalized, remap));
+    REQUIRE(normalized == "# API\n\nab  c\n    x\ny");
+
+    REQUIRE(remap.originalOffset(0) == 3);                      // '#'
+    REQUIRE(remap.originalOffset(5) == 8);                      // LF of first CR LF at its CR
+    REQUIRE(remap.originalOffset(6) == 10);
+    REQUIRE(remap.originalOffset(7) == 12);                     // 'a'
+    REQUIRE(remap.originalOffset(9) == 14);                     // expanded tab
+    REQUIRE(remap.originalOffset(10) == 14);
+    REQUIRE(remap.originalOffset(11) == 15);                    // 'c'
+    REQUIRE(remap.originalOffset(17) == 19);                    // 'x'
+    REQUIRE(remap.originalOffset(18) == 20);                    // lone CR
+    REQUIRE(remap.originalOffset(normalized.size()) == source.size());
+}
+
+TEST_CASE("normalization matches byte by byte normalization","[normalize source]")
+{
+    const char* pieces[] = { "a", "\t", "\r\n", "\n", "\r", "\xC5\xBE", "  ", "0123456789abcdefghij" };
+    const size_t count = sizeof(pieces) / sizeof(pieces[0]);
+
+    unsigned int seed = 7;
+
+    for (size_t round = 0; round < 200; ++round) {
+
+        std::string source;
+
+        for (size_t i = 0; i < 60; ++i) {
+            seed = seed * 1103515245 + 12345;
+            source += pieces[(seed >> 16) % count];
+        }
+
+        std::string normalized;
+        drafter::SourceRemap remap;
+
+        bool changed = drafter::NormalizeSource(source, normalized, remap);
+
+        if (!changed) {
+            normalized = source;
+        }
+
+        REQUIRE(normalized == NaiveNormalize(source));
+
+        // every byte maps to the same byte, a CR or the expanded tab
+        for (size_t i = 0; i < normalized.size(); ++i) {
+
+            char original = source[remap.originalOffset(i)];
+
+            if (normalized[i] == '\n') {
+                REQUIRE((original == '\n' || original == '\r'));
+            }
+            else if (normalized[i] == ' ') {
+                REQUIRE((original == ' ' || original == '\t'));
+            }
+            else {
+                REQUIRE(original == normalized[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("source maps of CR LF blueprint point into original source","[normalize source]")
+{
+    const std::string source = CRLF("# API\n"
+                                    "\n"
+                                    "## Notes [/notes]\n"
+                                    "\n"
+                                    "### List [GET]\n"
+                                    "+ Response 200 (application/json)\n"
+                                    "\n"
+                                    "\t\t{}\n");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    REQUIRE(drafter::ParseBlueprint(source, snowcrash::ExportSourcemapOption, blueprint) == snowcrash::Error::OK);
+
+    const snowcrash::SourceMap<snowcrash::Resource>& resource =
+        blueprint.sourceMap.content.elements().collection[0].content.elements().collection[0].content.resource;
+
+    REQUIRE(resource.uriTemplate.sourceMap.size() == 1);
+
+    const mdp::BytesRange& range = resource.uriTemplate.sourceMap[0];
+    REQUIRE(source.substr(range.location, range.length) == "## Notes [/notes]\r\n");
+
+    REQUIRE(blueprint.node.content.elements()[0].content.elements()[0].content.resource.actions[0]
+            .examples[0].responses[0].body == "{}\n");
+}
+
+namespace {
+
+    std::string SerializeAST(const snowcrash::Blueprint& blueprint)
+    {
+        std::stringstream out;
+        drafter::SerializeJSON serializer;
+
+        serializer.process(drafter::WrapBlueprint(blueprint), out);
+
+        return out.str();
+    }
+}
+
+TEST_CASE("CR LF and tabs parse into the same AST as LF and spaces","[normalize source]")
+{
+    const std::string spaces = "# API\n"
+                               "\n"
+                               "## Notes [/notes]\n"
+                               "\n"
+                               "### List [GET]\n"
+                               "+ Response 200 (application/json)\n"
+                               "\n"
+                               "        {\n"
+                               "            \"id\": 1\n"
+                               "        }\n";
+
+    const std::string tabs = CRLF("# API\n"
+                                  "\n"
+                                  "## Notes [/notes]\n"
+                                  "\n"
+                                  "### List [GET]\n"
+                                  "+ Response 200 (application/json)\n"
+                                  "\n"
+                                  "\t\t{\n"
+                                  "\t\t\t\"id\": 1\n"
+                                  "\t\t}\n");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> raw;
+    REQUIRE(snowcrash::parse(spaces, 0, raw) == snowcrash::Error::OK);
+
+    snowcrash::ParseResult<snowcrash::Blueprint> normalized;
+    REQUIRE(drafter::ParseBlueprint(tabs, 0, normalized) == snowcrash::Error::OK);
+
+    // no carriage returns in bodies, tabs are expanded to 4 columns
+    REQUIRE(SerializeAST(normalized.node) == SerializeAST(raw.node));
+
+    // entry points of C interface normalize as well
+    char* rawResult = NULL;
+    char* normalizedResult = NULL;
+
+    drafter_c_parse(spaces.c_str(), 0, &rawResult);
+    drafter_c_parse(tabs.c_str(), 0, &normalizedResult);
+
+    REQUIRE(std::string(normalizedResult) == rawResult);
+
+    free(rawResult);
+    free(normalizedResult);
+}
+
+TEST_CASE("parse CR LF blueprint","[.][benchmark][normalize source]")
+{
+    const size_t Resources = 2000;
+
+    std::string source = "# API\n\n";
+
+    for (size_t i = 0; i < Resources; ++i) {
+        std::stringstream resource;
+        resource << "## Note " << i << " [/notes/" << i << "]\n"
+                 << "\n"
+                 << "### Retrieve [GET]\n"
+                 << "+ Response 200 (application/json)\n"
+                 << "\n"
+                 << "\t\t{\n"
+                 << "\t\t\t\"id\": " << i << "\n"
+                 << "\t\t}\n"
+                 << "\n";
+        source += resource.str();
+    }
+
+    source = CRLF(source);
+
+    clock_t start = clock();
+
+    snowcrash::ParseResult<snowcrash::Blueprint> plain;
+    snowcrash::parse(source, snowcrash::ExportSourcemapOption, plain);
+
+    clock_t parsed = clock();
+
+    snowcrash::ParseResult<snowcrash::Blueprint> normalized;
+    drafter::ParseBlueprint(source, snowcrash::ExportSourcemapOption, normalized);
+
+    clock_t normalizedParsed = clock();
+
+    std::string buffer;
+
+    for (size_t i = 0; i < 10; ++i) {
+        drafter::SourceRemap remap;
+        drafter::NormalizeSource(source, buffer, remap);
+    }
+
+    clock_t end = clock();
+
+    REQUIRE(normalized.node.content.elements().size() == plain.node.content.elements().size());
+
+    std::cout << source.size() << " bytes" << std::endl;
+    std::cout << "snowcrash::parse: " << (1000.0 * (parsed - start) / CLOCKS_PER_SEC) << " ms" << std::endl;
+    std::cout << "drafter::ParseBlueprint: " << (1000.0 * (normalizedParsed - parsed) / CLOCKS_PER_SEC) << " ms" << std::endl;
+    std::cout << "normalization: " << (100.0 * (end - normalizedParsed) / CLOCKS_PER_SEC) << " ms" << std::endl;
+}
@@ -0,0 +1,64 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "sosJSON.h"
+#include "SerializeResult.h"
+#include "ParallelParse.h"
+
+static std::string SerializedResult(const snowcrash::ParseResult<snowcrash::Blueprint>& blueprint)
+{
+    std::stringstream outStream;
+    sos::SerializeJSON serializer;
+
+    serializer.process(drafter::WrapResult(blueprint, snowcrash::ExportSourcemapOption), outStream);
+
+    return outStream.str();
+}
+
+/** \param merged  Whether parallel parse is expected to merge chunks rather than fall back to serial parse */
+static void RequireSameAsSerial(const std::string& source, bool merged)
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> serial;
+    int serialCode = snowcrash::parse(source, snowcrash::ExportSourcemapOption, serial);
+
+    std::string expected = SerializedResult(serial);
+
+    for (unsigned int threads = 2; threads <= 8; threads *= 2) {
+
+        snowcrash::ParseResult<snowcrash::Blueprint> parallel;
+        drafter::ParallelParseStatistics statistics;
+
+        REQUIRE(drafter::ParseBlueprintParallel(source, snowcrash::ExportSourcemapOption, parallel, threads, &statistics) == serialCode);
+        REQUIRE(SerializedResult(parallel) == expected);
+        REQUIRE((statistics.chunks > 1) == merged);
+    }
+}
+
+TEST_CASE("parallel parse gives the same result as serial parse","[parallel parse]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/parallel-parse");
+
+    RequireSameAsSerial(fixture.get(".apib"), true);
+}
+
+TEST_CASE("parallel parse falls back to serial parse for resource in more groups","[parallel parse]")
+{
+    RequireSameAsSerial("# API\n"
+                        "# Group A\n"
+                        "## Note [/notes]\n"
+                        "### List [GET]\n"
+                        "+ Response 200\n"
+                        "# Group B\n"
+                        "## Note [/notes]\n"
+                        "### Create [POST]\n"
+                        "+ Response 201\n", false);
+}
+
+TEST_CASE("parallel parse of blueprint without groups","[parallel parse]")
+{
+    RequireSameAsSerial("# API\n"
+                        "## Note [/notes]\n"
+                        "### List [GET]\n"
+                        "+ Response 200\n", false);
+}
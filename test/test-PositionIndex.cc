@@ -0,0 +1,100 @@
+#include "test-drafter.h"
+
+#include "PositionIndex.h"
+
+namespace {
+
+    /** Source with ASCII runs, two, three and four byte characters and new lines across strides */
+    std::string MixedSource()
+    {
+        std::string source;
+
+        for (int i = 0; i < 300; ++i) {
+            source += "ascii run of sixteen+ bytes ";
+            source += "\xC3\xA9";               // é
+            source += "\xE2\x82\xAC";           // €
+            source += "\xF0\x9F\x98\x80";       // 😀
+
+            if (i % 7 == 0) {
+                source += "\n";
+            }
+        }
+
+        return source;
+    }
+}
+
+TEST_CASE("position index agrees with counting characters","[position]")
+{
+    std::string source = MixedSource();
+    drafter::PositionIndex index(source);
+
+    size_t codePoints = 0, utf16 = 0, line = 1, column = 1;
+
+    for (size_t byte = 0; byte <= source.size(); ++byte) {
+
+        unsigned char c = byte < source.size() ? static_cast<unsigned char>(source[byte]) : 0;
+        bool isContinuation = (c & 0xC0) == 0x80;
+
+        if (!isContinuation) {
+            REQUIRE(index.codePointAt(byte) == codePoints);
+            REQUIRE(index.utf16At(byte) == utf16);
+            REQUIRE(index.byteOfCodePoint(codePoints) == byte);
+
+            size_t indexLine, indexColumn;
+            index.lineColumnAt(byte, indexLine, indexColumn);
+
+            REQUIRE(indexLine == line);
+            REQUIRE(indexColumn == column);
+        }
+
+        if (byte == source.size()) {
+            break;
+        }
+
+        if (!isContinuation) {
+            ++codePoints;
+            utf16 += c >= 0xF0 ? 2 : 1;
+            ++column;
+        }
+
+        if (c == '\n') {
+            ++line;
+            column = 1;
+        }
+    }
+}
+
+TEST_CASE("sourcemap rows are converted to other units","[position]")
+{
+    std::string source = "# \xC3\xA9\n\n\xF0\x9F\x98\x80 API\n";
+    drafter::PositionIndex index(source);
+
+    sos::Array row;
+    row.push(sos::Number(6));       // "😀 API\n"
+    row.push(sos::Number(9));
+
+    sos::Array sourceMap;
+    sourceMap.push(row);
+
+    sos::Base codePoints = sourceMap;
+    drafter::ConvertSourcemapPositions(codePoints, index, drafter::CodePointPositions);
+
+    REQUIRE(codePoints.array[0].array[0].number == 5);
+    REQUIRE(codePoints.array[0].array[1].number == 6);
+
+    sos::Base utf16 = sourceMap;
+    drafter::ConvertSourcemapPositions(utf16, index, drafter::UTF16Positions);
+
+    REQUIRE(utf16.array[0].array[0].number == 5);
+    REQUIRE(utf16.array[0].array[1].number == 7);
+
+    sos::Base lineColumn = sourceMap;
+    drafter::ConvertSourcemapPositions(lineColumn, index, drafter::LineColumnPositions);
+
+    REQUIRE(lineColumn.array[0].array.size() == 4);
+    REQUIRE(lineColumn.array[0].array[0].number == 3);
+    REQUIRE(lineColumn.array[0].array[1].number == 1);
+    REQUIRE(lineColumn.array[0].array[2].number == 4);
+    REQUIRE(lineColumn.array[0].array[3].number == 1);
+}
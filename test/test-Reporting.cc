@@ -0,0 +1,142 @@
+#include "test-drafter.h"
+
+#include "reporting.h"
+
+namespace {
+
+    const std::string Source = "# API\n\n## Notes\n";
+
+    /** Error and warning with the same code at `## Notes` */
+    snowcrash::Report NotesReport()
+    {
+        mdp::CharactersRangeSet location;
+        location.push_back(mdp::CharactersRange(7, 9));
+
+        snowcrash::Report report;
+
+        report.error = snowcrash::Error("expected resource", snowcrash::BusinessError, location);
+        report.warnings.push_back(snowcrash::Warning("duplicate \"Notes\"", snowcrash::DuplicateWarning, location));
+
+        return report;
+    }
+
+    std::string Write(const snowcrash::Report& report, const std::string& format)
+    {
+        std::stringstream out;
+        WriteReport(report, Source, false, format, "api.apib", out);
+
+        return out.str();
+    }
+}
+
+TEST_CASE("diagnostics as JSON","[reporting]")
+{
+    const std::string location = "[{\"index\":7,\"length\":9,\"start\":{\"line\":3,\"column\":1},\"end\":{\"line\":3,\"column\":9}}]";
+
+    REQUIRE(Write(NotesReport(), DiagnosticsFormat::JSON) ==
+            "{\"error\":{\"code\":2,\"message\":\"expected resource\",\"location\":" + location + "},"
+            "\"warnings\":[{\"code\":2,\"message\":\"duplicate \\\"Notes\\\"\",\"location\":" + location + "}]}\n");
+
+    REQUIRE(Write(snowcrash::Report(), DiagnosticsFormat::JSON) ==
+            "{\"error\":{\"code\":0,\"message\":\"\",\"location\":[]},\"warnings\":[]}\n");
+}
+
+TEST_CASE("diagnostics as SARIF log","[reporting]")
+{
+    std::string log = Write(NotesReport(), DiagnosticsFormat::SARIF);
+
+    REQUIRE(log.compare(0, 76, "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"version\":\"2.1.0\"") == 0);
+
+    const std::string region = "\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":\"api.apib\"},"
+                               "\"region\":{\"startLine\":3,\"startColumn\":1,\"endLine\":3,\"endColumn\":9,\"charOffset\":7,\"charLength\":9}}}]";
+
+    // error and warning of the same code are different rules
+    REQUIRE(log.find("\"results\":[{\"ruleId\":\"error-2\",\"level\":\"error\",\"message\":{\"text\":\"expected resource\"}," + region + "},"
+                     "{\"ruleId\":\"warning-2\",\"level\":\"warning\",\"message\":{\"text\":\"duplicate \\\"Notes\\\"\"}," + region + "}]}]}\n")
+            != std::string::npos);
+
+    // no error, no results
+    REQUIRE(Write(snowcrash::Report(), DiagnosticsFormat::SARIF).find("\"results\":[]}]}\n") != std::string::npos);
+}
+
+TEST_CASE("diagnostics positions count characters","[reporting]")
+{
+    // "č" is two bytes, "😀" is four bytes and two UTF-16 units
+    const std::string source = "# Č 😀\n\n## Notes";
+
+    mdp::CharactersRangeSet location;
+    location.push_back(mdp::CharactersRange(7, 8));
+
+    snowcrash::Report report;
+    report.error = snowcrash::Error("expected resource", snowcrash::BusinessError, location);
+
+    std::stringstream json;
+    WriteReport(report, source, false, DiagnosticsFormat::JSON, "api.apib", json);
+
+    // range ends on the last line, without new line
+    REQUIRE(json.str().find("{\"index\":7,\"length\":8,\"start\":{\"line\":3,\"column\":1},\"end\":{\"line\":3,\"column\":9}}")
+            != std::string::npos);
+
+    std::stringstream sarif;
+    WriteReport(report, source, false, DiagnosticsFormat::SARIF, "api.apib", sarif);
+
+    REQUIRE(sarif.str().find("\"region\":{\"startLine\":3,\"startColumn\":1,\"endLine\":3,\"endColumn\":9,\"charOffset\":8,\"charLength\":8}")
+            != std::string::npos);
+
+    std::stringstream text;
+    WriteReport(report, source, true, DiagnosticsFormat::Text, "api.apib", text);
+
+    REQUIRE(text.str() == "\nerror: (2)  expected resource; line 3, column 1 - line 3, column 9\n");
+}
+
+TEST_CASE("diagnostics positions outside of source","[reporting]")
+{
+    mdp::CharactersRangeSet location;
+    location.push_back(mdp::CharactersRange(0, 100));
+
+    snowcrash::Report report;
+    report.warnings.push_back(snowcrash::Warning("too long", snowcrash::EmptyDefinitionWarning, location));
+
+    std::stringstream text;
+    WriteReport(report, Source, true, DiagnosticsFormat::Text, "api.apib", text);
+
+    REQUIRE(text.str() == "\nOK.\nwarning: (6)  too long; line 1, column 1 - line 3, column 9\n");
+}
+
+TEST_CASE("diagnostics of assembled files name their file","[reporting]")
+{
+    drafter::SourceFiles files;
+    files.push_back(drafter::SourceFile("main.apib", "# API"));
+    files.push_back(drafter::SourceFile("notes.apib", "# Group Č\n## Notes\n"));
+
+    std::string source = drafter::ConcatenateSourceFiles(files);
+
+    mdp::CharactersRangeSet location;
+    location.push_back(mdp::CharactersRange(16, 8));
+
+    snowcrash::Report report;
+    report.warnings.push_back(snowcrash::Warning("duplicate \"Notes\"", snowcrash::DuplicateWarning, location));
+
+    std::stringstream text;
+    WriteReport(report, files, source, true, DiagnosticsFormat::Text, text);
+
+    REQUIRE(text.str() == "\nOK.\nwarning: (2)  duplicate \"Notes\"; notes.apib: line 2, column 1 - line 2, column 9\n");
+
+    std::stringstream indexes;
+    WriteReport(report, files, source, false, DiagnosticsFormat::Text, indexes);
+
+    REQUIRE(indexes.str() == "\nOK.\nwarning: (2)  duplicate \"Notes\" :notes.apib:10:8\n");
+
+    std::stringstream json;
+    WriteReport(report, files, source, false, DiagnosticsFormat::JSON, json);
+
+    REQUIRE(json.str().find("[{\"file\":\"notes.apib\",\"index\":10,\"length\":8,\"start\":{\"line\":2,\"column\":1},\"end\":{\"line\":2,\"column\":9}}]")
+            != std::string::npos);
+
+    std::stringstream sarif;
+    WriteReport(report, files, source, false, DiagnosticsFormat::SARIF, sarif);
+
+    REQUIRE(sarif.str().find("{\"artifactLocation\":{\"uri\":\"notes.apib\"},"
+                             "\"region\":{\"startLine\":2,\"startColumn\":1,\"endLine\":2,\"endColumn\":9,\"charOffset\":10,\"charLength\":8}}")
+            != std::string::npos);
+}
@@ -0,0 +1,224 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "sosJSON.h"
+#include "ResolveMSON.h"
+#include "SerializeAST.h"
+
+namespace {
+
+    mson::Element Property(const std::string& name, const std::string& type = std::string())
+    {
+        mson::Element element(mson::Element::PropertyClass);
+
+        element.content.property.name.literal = name;
+
+        if (type.empty()) {
+            element.content.property.valueDefinition.typeDefinition.typeSpecification.name.base = mson::StringTypeName;
+        }
+        else {
+            element.content.property.valueDefinition.typeDefinition.typeSpecification.name.symbol.literal = type;
+        }
+
+        return element;
+    }
+
+    mson::Element Mixin(const std::string& type)
+    {
+        mson::Element element(mson::Element::MixinClass);
+        element.content.mixin.typeSpecification.name.symbol.literal = type;
+
+        return element;
+    }
+
+    snowcrash::Element DataStructure(const std::string& name,
+                                     const std::string& ancestor,
+                                     const mson::Elements& members)
+    {
+        snowcrash::Element element(snowcrash::Element::DataStructureElement);
+        mson::NamedType& dataStructure = element.content.dataStructure;
+
+        dataStructure.name.symbol.literal = name;
+
+        if (ancestor.empty()) {
+            dataStructure.typeDefinition.typeSpecification.name.base = mson::ObjectTypeName;
+        }
+        else {
+            dataStructure.typeDefinition.typeSpecification.name.symbol.literal = ancestor;
+        }
+
+        if (!members.empty()) {
+            mson::TypeSection section(mson::TypeSection::MemberTypeClass);
+            section.content.elements() = members;
+            dataStructure.sections.push_back(section);
+        }
+
+        return element;
+    }
+
+    snowcrash::Blueprint DataStructures(const snowcrash::Elements& dataStructures)
+    {
+        snowcrash::Element group(snowcrash::Element::CategoryElement);
+        group.category = snowcrash::Element::DataStructureGroupCategory;
+        group.content.elements() = dataStructures;
+
+        snowcrash::Blueprint blueprint;
+        blueprint.content.elements().push_back(group);
+
+        return blueprint;
+    }
+
+    /** Base { id }, Note (Base) { title }, Tagged { Include Note, tag } */
+    snowcrash::Blueprint Notes()
+    {
+        snowcrash::Elements dataStructures;
+
+        dataStructures.push_back(DataStructure("Tagged", "", mson::Elements(1, Mixin("Note"))));
+        dataStructures.back().content.dataStructure.sections[0].content.elements().push_back(Property("tag"));
+
+        dataStructures.push_back(DataStructure("Note", "Base", mson::Elements(1, Property("title"))));
+        dataStructures.push_back(DataStructure("Base", "", mson::Elements(1, Property("id"))));
+
+        return DataStructures(dataStructures);
+    }
+
+    std::vector<std::string> MemberNames(const mson::NamedType& type)
+    {
+        std::vector<std::string> names;
+
+        for (mson::TypeSections::const_iterator it = type.sections.begin(); it != type.sections.end(); ++it) {
+
+            const mson::Elements& elements = it->content.elements();
+
+            for (mson::Elements::const_iterator element = elements.begin(); element != elements.end(); ++element) {
+                names.push_back(element->klass == mson::Element::PropertyClass ? element->content.property.name.literal : "?");
+            }
+        }
+
+        return names;
+    }
+
+    std::string Joined(const std::vector<std::string>& names)
+    {
+        std::string joined;
+
+        for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it) {
+            joined += (it == names.begin() ? "" : " ") + *it;
+        }
+
+        return joined;
+    }
+
+    size_t Occurrences(const std::string& text, const std::string& pattern)
+    {
+        size_t count = 0;
+
+        for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1)) {
+            ++count;
+        }
+
+        return count;
+    }
+}
+
+TEST_CASE("Resolve inheritance and mixins of named types", "[resolve mson]")
+{
+    snowcrash::Blueprint blueprint = Notes();
+    drafter::MSONResolver resolver(blueprint);
+
+    const mson::NamedType* note = resolver.resolved("Note");
+    REQUIRE(note != NULL);
+    REQUIRE(Joined(MemberNames(*note)) == "id title");
+    REQUIRE(note->typeDefinition.typeSpecification.name.base == mson::ObjectTypeName);
+    REQUIRE(note->name.symbol.literal == "Note");
+
+    const mson::NamedType* tagged = resolver.resolved("Tagged");
+    REQUIRE(tagged != NULL);
+    REQUIRE(Joined(MemberNames(*tagged)) == "id title tag");
+
+    REQUIRE(resolver.resolved("Missing") == NULL);
+    REQUIRE(resolver.recursive().empty());
+}
+
+TEST_CASE("Resolve every named type once", "[resolve mson]")
+{
+    snowcrash::Blueprint blueprint = Notes();
+    drafter::MSONResolver resolver(blueprint);
+
+    const mson::NamedType* note = resolver.resolved("Note");
+
+    REQUIRE(resolver.resolved("Tagged") != NULL);
+    REQUIRE(resolver.resolved("Note") == note);
+
+    // Payload attributes referencing named type get its expansion
+    mson::NamedType attributes;
+    attributes.typeDefinition.typeSpecification.name.symbol.literal = "Note";
+    attributes.sections.push_back(mson::TypeSection(mson::TypeSection::MemberTypeClass));
+    attributes.sections[0].content.elements().push_back(Property("body"));
+
+    resolver.resolve(attributes);
+
+    REQUIRE(Joined(MemberNames(attributes)) == "id title body");
+    REQUIRE(attributes.typeDefinition.typeSpecification.name.base == mson::ObjectTypeName);
+}
+
+TEST_CASE("Resolve blueprint MSON in place", "[resolve mson]")
+{
+    snowcrash::Blueprint blueprint = Notes();
+    drafter::ResolveBlueprintMSON(blueprint);
+
+    const snowcrash::Elements& dataStructures = blueprint.content.elements().front().content.elements();
+
+    REQUIRE(Joined(MemberNames(dataStructures[0].content.dataStructure)) == "id title tag");
+    REQUIRE(Joined(MemberNames(dataStructures[1].content.dataStructure)) == "id title");
+    REQUIRE(Joined(MemberNames(dataStructures[2].content.dataStructure)) == "id");
+}
+
+TEST_CASE("Leave references closing a cycle unresolved", "[resolve mson]")
+{
+    snowcrash::Elements dataStructures;
+    dataStructures.push_back(DataStructure("A", "B", mson::Elements(1, Property("a"))));
+    dataStructures.push_back(DataStructure("B", "A", mson::Elements(1, Property("b"))));
+    dataStructures.push_back(DataStructure("Person", "", mson::Elements(1, Property("friend", "Person"))));
+
+    snowcrash::Blueprint blueprint = DataStructures(dataStructures);
+    drafter::MSONResolver resolver(blueprint);
+
+    const mson::NamedType* a = resolver.resolved("A");
+    REQUIRE(a != NULL);
+    REQUIRE(Joined(MemberNames(*a)) == "b a");
+    REQUIRE(a->typeDefinition.typeSpecification.name.symbol.literal == "A");
+
+    const mson::NamedType* person = resolver.resolved("Person");
+    REQUIRE(person != NULL);
+    REQUIRE(Joined(MemberNames(*person)) == "friend");
+
+    const mson::Element& friendMember = person->sections[0].content.elements()[0];
+    REQUIRE(friendMember.content.property.valueDefinition.typeDefinition.typeSpecification.name.symbol.literal == "Person");
+    REQUIRE(friendMember.content.property.sections.empty());
+
+    REQUIRE(resolver.recursive().size() == 2);
+    REQUIRE(resolver.recursive().count("A") == 1);
+    REQUIRE(resolver.recursive().count("Person") == 1);
+}
+
+TEST_CASE("Wrap blueprint with resolved MSON", "[resolve mson]")
+{
+    snowcrash::Blueprint blueprint = Notes();
+
+    sos::Object plain = drafter::WrapBlueprint(blueprint);
+    sos::Object resolved = drafter::WrapBlueprint(blueprint, NULL, drafter::ResolveMSONWrapOption);
+
+    // Blueprint itself is left as it is
+    REQUIRE(Joined(MemberNames(blueprint.content.elements().front().content.elements()[0].content.dataStructure)) == "? tag");
+
+    std::stringstream plainOutput, resolvedOutput;
+    sos::SerializeJSON serializer;
+    serializer.process(plain, plainOutput);
+    serializer.process(resolved, resolvedOutput);
+
+    REQUIRE(Occurrences(plainOutput.str(), "\"title\"") == 1);
+    REQUIRE(Occurrences(resolvedOutput.str(), "\"title\"") == 2);
+    REQUIRE(Occurrences(resolvedOutput.str(), "\"id\"") == 3);
+}
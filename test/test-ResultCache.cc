@@ -0,0 +1,111 @@
+#include "test-drafter.h"
+
+#include "cdrafter.h"
+#include "ResultCache.h"
+
+#include <string.h>
+
+TEST_CASE("result cache counts hits, misses and evictions","[result cache]")
+{
+    drafter::ResultCache cache(1536, 1);
+
+    std::string data(600, 'x');
+
+    REQUIRE_FALSE(cache.get("# A", 0));
+
+    drafter::ResultCache::result_ptr stored = cache.put("# A", 0, 0, data);
+
+    REQUIRE(data.empty());  // moved into the cache
+    REQUIRE(cache.get("# A", 0) == stored);
+
+    // options are part of key
+    REQUIRE_FALSE(cache.get("# A", 1));
+
+    data.assign(600, 'y');
+    cache.put("# B", 0, 0, data);
+    data.assign(600, 'z');
+    cache.put("# C", 0, 0, data);
+
+    // "# A" was evicted but still held by `stored`
+    REQUIRE_FALSE(cache.get("# A", 0));
+    REQUIRE(stored->data == std::string(600, 'x'));
+
+    drafter::ResultCache::Statistics statistics = cache.statistics();
+
+    REQUIRE(statistics.hits == 1);
+    REQUIRE(statistics.misses == 3);
+    REQUIRE(statistics.evictions == 1);
+    REQUIRE(statistics.entries == 2);
+}
+
+TEST_CASE("result cache stores entries up to capacity of one shard","[result cache]")
+{
+    const size_t MB = 1024 * 1024;
+
+    // small cache is not split at all
+    drafter::ResultCache small(MB);
+
+    REQUIRE(small.maxEntryWeight() == MB);
+
+    std::string data(MB / 2, 'x');
+    small.put("# A", 0, 0, data);
+
+    REQUIRE(small.get("# A", 0));
+
+    // heavier than the whole capacity
+    data.assign(MB, 'x');
+    small.put("# B", 0, 0, data);
+
+    REQUIRE_FALSE(small.get("# B", 0));
+    REQUIRE(small.get("# A", 0));
+
+    // shards are no smaller than MinShardCapacity
+    REQUIRE(drafter::ResultCache(8 * MB).maxEntryWeight() == 4 * MB);
+    REQUIRE(drafter::ResultCache(256 * MB).maxEntryWeight() == 16 * MB);
+    REQUIRE(drafter::ResultCache(256 * MB, 1).maxEntryWeight() == 256 * MB);
+}
+
+TEST_CASE("c-interface returns cached result","[result cache][c-interface]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/annotations-with-warning");
+
+    std::string source = fixture.get(".apib");
+
+    drafter_c_enable_result_cache(16 * 1024 * 1024);
+
+    const sc_shared_result* first = NULL;
+    const sc_shared_result* second = NULL;
+
+    REQUIRE(drafter_c_parse_shared(source.c_str(), 0, &first) == 0);
+    REQUIRE(drafter_c_parse_shared(source.c_str(), 0, &second) == 0);
+
+    // the same buffer
+    REQUIRE(drafter_c_shared_result_data(first) == drafter_c_shared_result_data(second));
+    REQUIRE(strcmp(drafter_c_shared_result_data(first), fixture.get(".result.json").c_str()) == 0);
+
+    char* result = NULL;
+
+    REQUIRE(drafter_c_parse(source.c_str(), 0, &result) == 0);
+    REQUIRE(strcmp(result, fixture.get(".result.json").c_str()) == 0);
+
+    free(result);
+
+    sc_result_cache_stats stats;
+    drafter_c_result_cache_stats(&stats);
+
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.entries == 1);
+
+    // disabling the cache does not invalidate handles
+    drafter_c_enable_result_cache(0);
+
+    REQUIRE(strcmp(drafter_c_shared_result_data(second), fixture.get(".result.json").c_str()) == 0);
+
+    drafter_c_release_shared_result(first);
+    drafter_c_release_shared_result(second);
+
+    drafter_c_result_cache_stats(&stats);
+
+    REQUIRE(stats.entries == 0);
+}
@@ -0,0 +1,155 @@
+#include "test-drafter.h"
+
+#include <ctime>
+
+#include "RouteMatcher.h"
+
+static drafter::Route MakeRoute(const std::string& method, const std::string& uriTemplate)
+{
+    drafter::Route route;
+
+    route.method = method;
+    route.uriTemplate = uriTemplate;
+
+    return route;
+}
+
+static std::string Parameter(const drafter::RouteMatch& match, const std::string& name)
+{
+    for (drafter::URIParameters::const_iterator it = match.parameters.begin(); it != match.parameters.end(); ++it) {
+        if (it->first == name) {
+            return it->second;
+        }
+    }
+
+    return "<missing>";
+}
+
+TEST_CASE("match literal and variable path segments","[route matcher]")
+{
+    drafter::Routes routes;
+
+    routes.push_back(MakeRoute("GET", "/notes"));
+    routes.push_back(MakeRoute("GET", "/notes/{id}"));
+    routes.push_back(MakeRoute("DELETE", "/notes/{id}"));
+    routes.push_back(MakeRoute("GET", "/notes/new"));
+    routes.push_back(MakeRoute("GET", "/notes/{noteId}/comments/{id}"));
+
+    drafter::RouteMatcher matcher(routes);
+    drafter::RouteMatch match;
+
+    REQUIRE(matcher.size() == 5);
+
+    REQUIRE(matcher.match("GET", "/notes", match));
+    REQUIRE(match.index == 0);
+    REQUIRE(match.parameters.empty());
+
+    REQUIRE(matcher.match("GET", "/notes/42", match));
+    REQUIRE(match.index == 1);
+    REQUIRE(Parameter(match, "id") == "42");
+
+    REQUIRE(matcher.match("DELETE", "/notes/42", match));
+    REQUIRE(match.index == 2);
+
+    // literal segment wins over variable
+    REQUIRE(matcher.match("GET", "/notes/new", match));
+    REQUIRE(match.index == 3);
+
+    // falls back to variable if method of literal route does not match
+    REQUIRE(matcher.match("DELETE", "/notes/new", match));
+    REQUIRE(match.index == 2);
+    REQUIRE(Parameter(match, "id") == "new");
+
+    REQUIRE(matcher.match("GET", "/notes/1/comments/2", match));
+    REQUIRE(match.index == 4);
+    REQUIRE(Parameter(match, "noteId") == "1");
+    REQUIRE(Parameter(match, "id") == "2");
+
+    REQUIRE_FALSE(matcher.match("POST", "/notes", match));
+    REQUIRE_FALSE(matcher.match("GET", "/notes/1/comments", match));
+    REQUIRE_FALSE(matcher.match("GET", "/users", match));
+}
+
+TEST_CASE("match query, reserved and mixed expressions","[route matcher]")
+{
+    drafter::Routes routes;
+
+    routes.push_back(MakeRoute("GET", "/notes{?page,limit}"));
+    routes.push_back(MakeRoute("GET", "/files/{name}.{ext}"));
+    routes.push_back(MakeRoute("GET", "/static/{+path}"));
+    routes.push_back(MakeRoute("GET", "/users{/id}"));
+
+    drafter::Route action = MakeRoute("POST", "/notes");
+    action.actionUriTemplate = "/notes/{id}/archive";
+    routes.push_back(action);
+
+    drafter::RouteMatcher matcher(routes);
+    drafter::RouteMatch match;
+
+    REQUIRE(matcher.match("GET", "/notes?page=2&other=x", match));
+    REQUIRE(match.index == 0);
+    REQUIRE(match.parameters.size() == 1);
+    REQUIRE(Parameter(match, "page") == "2");
+
+    REQUIRE(matcher.match("GET", "/notes", match));
+    REQUIRE(match.index == 0);
+
+    REQUIRE(matcher.match("GET", "/files/report.pdf", match));
+    REQUIRE(match.index == 1);
+    REQUIRE(Parameter(match, "name") == "report");
+    REQUIRE(Parameter(match, "ext") == "pdf");
+
+    REQUIRE(matcher.match("GET", "/static/css/site%20main.css", match));
+    REQUIRE(match.index == 2);
+    REQUIRE(Parameter(match, "path") == "css/site main.css");
+
+    REQUIRE(matcher.match("GET", "/users/7", match));
+    REQUIRE(match.index == 3);
+    REQUIRE(Parameter(match, "id") == "7");
+
+    REQUIRE(matcher.match("POST", "/notes/7/archive", match));
+    REQUIRE(match.index == 4);
+    REQUIRE_FALSE(matcher.match("POST", "/notes", match));
+}
+
+TEST_CASE("match 10k routes","[.][benchmark][route matcher]")
+{
+    const size_t RoutesCount = 10000;
+    const size_t Lookups = 1000000;
+
+    drafter::Routes routes;
+
+    for (size_t i = 0; i < RoutesCount; ++i) {
+        std::stringstream uri;
+        uri << "/service" << (i / 100) << "/resource" << (i % 100) << "/{id}/items/{itemId}{?page}";
+        routes.push_back(MakeRoute("GET", uri.str()));
+    }
+
+    std::vector<std::string> uris;
+
+    for (size_t i = 0; i < RoutesCount; i += 7) {
+        std::stringstream uri;
+        uri << "/service" << (i / 100) << "/resource" << (i % 100) << "/42/items/abc?page=3";
+        uris.push_back(uri.str());
+    }
+
+    clock_t start = clock();
+    drafter::RouteMatcher matcher(routes);
+    clock_t compiled = clock();
+
+    drafter::RouteMatch match;
+    size_t matched = 0;
+
+    for (size_t i = 0; i < Lookups; ++i) {
+        matched += matcher.match("GET", uris[i % uris.size()], match);
+    }
+
+    clock_t end = clock();
+
+    REQUIRE(matched == Lookups);
+
+    std::cout << "compile " << RoutesCount << " routes: "
+              << (1000.0 * (compiled - start) / CLOCKS_PER_SEC) << " ms" << std::endl;
+    std::cout << "match: "
+              << (1e9 * (end - compiled) / CLOCKS_PER_SEC / Lookups) << " ns per lookup" << std::endl;
+}
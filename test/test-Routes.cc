@@ -0,0 +1,70 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "Routes.h"
+#include "cdrafter.h"
+
+#include <string.h>
+#include <algorithm>
+
+TEST_CASE("collect routes of all actions","[routes]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/diff-after");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    REQUIRE(snowcrash::parse(fixture.get(".apib"), snowcrash::ExportSourcemapOption, blueprint) == snowcrash::Error::OK);
+
+    drafter::Routes routes;
+    drafter::CollectRoutes(blueprint.node, blueprint.sourceMap, routes);
+
+    REQUIRE(routes.size() == 3);
+
+    REQUIRE(routes[0].group == "Notes");
+    REQUIRE(routes[0].uriTemplate == "/notes");
+    REQUIRE(routes[0].method == "GET");
+    REQUIRE(routes[0].name == "List Notes");
+    REQUIRE_FALSE(routes[0].methodSourceMap.empty());
+    REQUIRE_FALSE(routes[0].uriTemplateSourceMap.empty());
+
+    REQUIRE(routes[1].uriTemplate == "/notes/{id}");
+    REQUIRE(routes[1].method == "GET");
+
+    REQUIRE(routes[2].uriTemplate == "/notes/{id}");
+    REQUIRE(routes[2].method == "DELETE");
+    REQUIRE(routes[2].name == "Delete Note");
+}
+
+TEST_CASE("routes are the same without source map","[routes]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/diff-after");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    REQUIRE(snowcrash::parse(fixture.get(".apib"), 0, blueprint) == snowcrash::Error::OK);
+
+    drafter::Routes routes;
+    drafter::CollectRoutes(blueprint.node, blueprint.sourceMap, routes);
+
+    REQUIRE(routes.size() == 3);
+    REQUIRE(routes[2].method == "DELETE");
+    REQUIRE(routes[2].methodSourceMap.empty());
+}
+
+TEST_CASE("c-interface route table","[routes][c-interface]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/diff-after");
+
+    std::string source = fixture.get(".apib");
+
+    char *result = NULL;
+
+    int ret = drafter_c_routes(source.c_str(), 0, &result);
+
+    REQUIRE(ret == 0);
+    REQUIRE(result);
+
+    REQUIRE(strncmp(result, "Notes\t/notes\t\tGET\tList Notes\t\t", 30) == 0);
+    REQUIRE(std::count(result, result + strlen(result), '\n') == 3);
+
+    free(result);
+}
@@ -26,3 +26,89 @@ TEST_CASE("integration test for result parse serialization","[result serializati
 
     REQUIRE(outStream.str() == fixture.get(".result-with-sourcemap.json"));
 }
+
+namespace {
+
+    bool HasEmptyValue(const sos::Base& value)
+    {
+        if (value.type == sos::Base::ObjectType) {
+            for (sos::KeyValues::const_iterator it = value.object.begin(); it != value.object.end(); ++it) {
+                if (drafter::IsEmptyValue(it->second) || HasEmptyValue(it->second)) {
+                    return true;
+                }
+            }
+        }
+        else if (value.type == sos::Base::ArrayType) {
+            for (sos::Bases::const_iterator it = value.array.begin(); it != value.array.end(); ++it) {
+                if (HasEmptyValue(*it)) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+}
+
+TEST_CASE("sparse result leaves out empty fields","[result serialization]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/annotations-with-warning");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(fixture.get(".apib"), snowcrash::ExportSourcemapOption, blueprint);
+
+    sos::Object full = drafter::WrapResult(blueprint, snowcrash::ExportSourcemapOption);
+    sos::Object sparse = drafter::WrapResult(blueprint, snowcrash::ExportSourcemapOption | drafter::SparseWrapOption);
+
+    REQUIRE(HasEmptyValue(full.object.at(drafter::SerializeKey::Ast)));
+    REQUIRE_FALSE(HasEmptyValue(sparse.object.at(drafter::SerializeKey::Ast)));
+    REQUIRE_FALSE(HasEmptyValue(sparse.object.at(drafter::SerializeKey::SourceMap)));
+
+    std::stringstream fullStream, sparseStream;
+    sos::SerializeJSON serializer;
+
+    serializer.process(full, fullStream);
+    serializer.process(sparse, sparseStream);
+
+    REQUIRE(sparseStream.str().size() < fullStream.str().size());
+
+    // Mode does not leak into later full wrapping
+    std::stringstream outStream;
+
+    serializer.process(drafter::WrapResult(blueprint, snowcrash::ExportSourcemapOption), outStream);
+    outStream << "\n";
+
+    REQUIRE(outStream.str() == fixture.get(".result-with-sourcemap.json"));
+}
+
+TEST_CASE("sparse result keeps values differing from default","[result serialization]")
+{
+    const std::string source =
+        "# /notes/{id}\n"
+        "+ Parameters\n"
+        "    + id (optional, number)\n"
+        "    + page\n"
+        "\n"
+        "## GET\n"
+        "+ Response 204\n";
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(source, 0, blueprint);
+
+    sos::Object sparse = drafter::WrapResult(blueprint, drafter::SparseWrapOption);
+
+    const sos::Base& resource = sparse.object.at(drafter::SerializeKey::Ast)
+                                               .object.at(drafter::SerializeKey::ResourceGroups).array[0]
+                                               .object.at(drafter::SerializeKey::Resources).array[0];
+
+    REQUIRE(resource.object.count(drafter::SerializeKey::Name) == 0);
+    REQUIRE(resource.object.count(drafter::SerializeKey::Model) == 0);
+
+    const sos::Bases& parameters = resource.object.at(drafter::SerializeKey::Parameters).array;
+
+    REQUIRE(parameters.size() == 2);
+    REQUIRE(parameters[0].object.at(drafter::SerializeKey::Required).boolean == false);
+    REQUIRE(parameters[0].object.at(drafter::SerializeKey::Type).str == "number");
+    REQUIRE(parameters[1].object.count(drafter::SerializeKey::Required) == 0);
+    REQUIRE(parameters[1].object.count(drafter::SerializeKey::Type) == 0);
+}
@@ -0,0 +1,104 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "SymbolIndex.h"
+
+namespace {
+
+    const std::string Source =
+        "FORMAT: 1A\n"
+        "\n"
+        "# Notes API\n"
+        "\n"
+        "# Group Notes\n"
+        "Notes of a user.\n"
+        "\n"
+        "## Note [/notes/{id}]\n"
+        "A single note.\n"
+        "\n"
+        "+ Attributes (Note Base)\n"
+        "\n"
+        "### Retrieve a Note [GET]\n"
+        "+ Response 200 (application/json)\n"
+        "\n"
+        "        {}\n"
+        "\n"
+        "### Delete a Note [DELETE]\n"
+        "+ Response 204\n"
+        "\n"
+        "# Data Structures\n"
+        "\n"
+        "## Note Base (object)\n"
+        "+ title: Buy milk (string)\n";
+
+    size_t Offset(const std::string& text)
+    {
+        return Source.find(text);
+    }
+}
+
+TEST_CASE("symbols follow groups, resources and actions","[symbols]")
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(Source, snowcrash::ExportSourcemapOption, blueprint);
+
+    drafter::SymbolIndex index(blueprint.node, blueprint.sourceMap, Source.size());
+    const drafter::Symbols& symbols = index.symbols();
+
+    REQUIRE(symbols.size() == 5);
+
+    REQUIRE(symbols[0].kind == drafter::Symbol::GroupSymbol);
+    REQUIRE(symbols[0].name == "Notes");
+
+    REQUIRE(symbols[1].kind == drafter::Symbol::ResourceSymbol);
+    REQUIRE(symbols[1].name == "Note");
+    REQUIRE(symbols[1].detail == "/notes/{id}");
+    REQUIRE(symbols[1].parent == 0);
+
+    REQUIRE(symbols[2].kind == drafter::Symbol::ActionSymbol);
+    REQUIRE(symbols[2].name == "GET");
+    REQUIRE(symbols[2].detail == "Retrieve a Note");
+    REQUIRE(symbols[2].parent == 1);
+
+    REQUIRE(symbols[3].name == "DELETE");
+    REQUIRE(symbols[3].parent == 1);
+
+    REQUIRE(symbols[4].kind == drafter::Symbol::DataStructureSymbol);
+    REQUIRE(symbols[4].name == "Note Base");
+    REQUIRE(symbols[4].parent == drafter::Symbol::NoParent);
+}
+
+TEST_CASE("symbol under position is the innermost section","[symbols]")
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(Source, snowcrash::ExportSourcemapOption, blueprint);
+
+    drafter::SymbolIndex index(blueprint.node, blueprint.sourceMap, Source.size());
+
+    REQUIRE(index.symbolAt(Offset("FORMAT")) == NULL);
+
+    REQUIRE(index.symbolAt(Offset("Notes of a user"))->name == "Notes");
+    REQUIRE(index.symbolAt(Offset("A single note"))->name == "Note");
+    REQUIRE(index.symbolAt(Offset("{}"))->name == "GET");
+    REQUIRE(index.symbolAt(Offset("+ Response 204"))->name == "DELETE");
+    REQUIRE(index.symbolAt(Offset("title"))->name == "Note Base");
+}
+
+TEST_CASE("type references lead to definitions","[symbols]")
+{
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    snowcrash::parse(Source, snowcrash::ExportSourcemapOption, blueprint);
+
+    drafter::SymbolIndex index(blueprint.node, blueprint.sourceMap, Source.size());
+
+    size_t reference = Offset("(Note Base)") + 3;
+
+    REQUIRE(drafter::TypeReferenceAt(Source, reference) == "Note Base");
+    REQUIRE(index.definitionOf("Note Base") == &index.symbols()[4]);
+
+    REQUIRE(drafter::TypeReferenceAt("+ id (required, `array[Note]`)", 8) == "required");
+    REQUIRE(drafter::TypeReferenceAt("+ id (required, `array[Note]`)", 25) == "Note");
+    REQUIRE(drafter::TypeReferenceAt("+ id (required, `array[Note]`)", 3) == "");
+    REQUIRE(drafter::TypeReferenceAt("[Note][] and more", 12) == "");
+}
@@ -0,0 +1,175 @@
+#include "test-drafter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+
+#include "snowcrash.h"
+
+#include "drafter.h"
+#include "cdrafter.h"
+#include "SerializeJSON.h"
+#include "SerializeResult.h"
+#include "ParallelParse.h"
+
+namespace {
+
+    enum EntryPoint {
+        ParseBlueprintEntry = 0,
+        ParseBlueprintParallelEntry,
+        CParseEntry,
+        EntryPointCount
+    };
+
+    const unsigned int Options[] = {
+        0,
+        snowcrash::ExportSourcemapOption,
+        snowcrash::ExportSourcemapOption | drafter::SparseWrapOption,
+        drafter::ResolveMSONWrapOption
+    };
+
+    const size_t OptionCount = sizeof(Options) / sizeof(Options[0]);
+
+    const char* Fixtures[] = {
+        "test/fixtures/annotations-with-warning.apib",
+        "test/fixtures/diff-before.apib",
+        "test/fixtures/diff-after.apib",
+        "test/fixtures/parallel-parse.apib",
+        "test/fixtures/payload-validation.apib"
+    };
+
+    const size_t FixtureCount = sizeof(Fixtures) / sizeof(Fixtures[0]);
+
+    /** Serialized result of \param source parsed by \param entry */
+    std::string Parse(const std::string& source, unsigned int options, EntryPoint entry)
+    {
+        if (entry == CParseEntry) {
+            char* result = NULL;
+            int code = drafter_c_parse(source.c_str(), options, &result);
+
+            std::stringstream out;
+            out << code << "\n" << result;
+            free(result);
+
+            return out.str();
+        }
+
+        snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+
+        if (entry == ParseBlueprintParallelEntry) {
+            drafter::ParseBlueprintParallel(source, options, blueprint, 2);
+        }
+        else {
+            drafter::ParseBlueprint(source, options, blueprint);
+        }
+
+        std::stringstream out;
+        drafter::SerializeJSON serializer;
+
+        out << blueprint.report.error.code << "\n";
+        serializer.process(drafter::WrapResult(blueprint, options), out);
+
+        return out.str();
+    }
+
+    struct Job {
+        size_t fixture;
+        unsigned int options;
+        EntryPoint entry;
+    };
+
+    Job JobOf(size_t i)
+    {
+        Job job;
+
+        job.fixture = i % FixtureCount;
+        job.options = Options[(i / FixtureCount) % OptionCount];
+        job.entry = static_cast<EntryPoint>((i / (FixtureCount * OptionCount)) % EntryPointCount);
+
+        return job;
+    }
+
+    /**
+     *  \brief Run \param parses of the fixtures on all cores, \return number of results differing from serial ones
+     *
+     *  Serial results are parsed without result cache, concurrent parses
+     *  share a cache of \param cacheCapacity if it is not 0. Its counters
+     *  are stored into \param stats before it is disabled again.
+     *
+     *  Catch assertions are not thread-safe, workers only count mismatches.
+     */
+    size_t ParseConcurrently(size_t parses, size_t cacheCapacity = 0, sc_result_cache_stats* stats = NULL)
+    {
+        std::vector<std::string> sources;
+
+        for (size_t i = 0; i < FixtureCount; ++i) {
+            sources.push_back(ITFixtureFiles(Fixtures[i]).get(""));
+        }
+
+        // every combination of fixture, options and entry point, parsed serially
+        const size_t combinations = FixtureCount * OptionCount * EntryPointCount;
+        std::vector<std::string> expected;
+
+        for (size_t i = 0; i < combinations; ++i) {
+            Job job = JobOf(i);
+            expected.push_back(Parse(sources[job.fixture], job.options, job.entry));
+        }
+
+        if (cacheCapacity) {
+            drafter_c_enable_result_cache(cacheCapacity);
+        }
+
+        std::atomic<size_t> next(0);
+        std::atomic<size_t> mismatches(0);
+
+        auto worker = [&]() {
+            for (size_t i = next++; i < parses; i = next++) {
+
+                Job job = JobOf(i);
+
+                if (Parse(sources[job.fixture], job.options, job.entry) != expected[i % combinations]) {
+                    ++mismatches;
+                }
+            }
+        };
+
+        unsigned int threads = std::max(4u, std::thread::hardware_concurrency());
+        std::vector<std::thread> workers;
+
+        for (unsigned int i = 0; i < threads; ++i) {
+            workers.push_back(std::thread(worker));
+        }
+
+        for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it) {
+            it->join();
+        }
+
+        if (cacheCapacity) {
+            drafter_c_result_cache_stats(stats);
+            drafter_c_enable_result_cache(0);
+        }
+
+        return mismatches;
+    }
+}
+
+TEST_CASE("concurrent parses give the same results as serial parses","[thread safety]")
+{
+    REQUIRE(ParseConcurrently(2 * FixtureCount * OptionCount * EntryPointCount) == 0);
+}
+
+TEST_CASE("concurrent parses share result cache","[thread safety]")
+{
+    sc_result_cache_stats stats;
+    size_t mismatches = ParseConcurrently(2 * FixtureCount * OptionCount * EntryPointCount, 1024 * 1024, &stats);
+
+    REQUIRE(mismatches == 0);
+    REQUIRE(stats.hits > 0);
+}
+
+// run under ThreadSanitizer, see README
+TEST_CASE("stress concurrent parses","[.][stress][thread safety]")
+{
+    REQUIRE(ParseConcurrently(10000) == 0);
+}
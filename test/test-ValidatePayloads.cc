@@ -0,0 +1,149 @@
+#include "test-drafter.h"
+
+#include "snowcrash.h"
+
+#include "JSONReader.h"
+#include "JSONSchema.h"
+#include "SchemaCache.h"
+#include "ValidatePayloads.h"
+
+static bool Validate(const std::string& schemaSource, const std::string& instanceSource, std::string& error)
+{
+    sos::Base schemaDocument;
+    sos::Base instance;
+
+    REQUIRE(drafter::ReadJSON(schemaSource, schemaDocument, error));
+    REQUIRE(drafter::ReadJSON(instanceSource, instance, error));
+
+    drafter::JSONSchema schema;
+    REQUIRE(schema.compile(schemaDocument, error));
+
+    return schema.validate(instance, error);
+}
+
+TEST_CASE("read JSON into serialization tree","[payload validation]")
+{
+    sos::Base value;
+    std::string error;
+
+    REQUIRE(drafter::ReadJSON("{\"a\": [1, -2.5e1, true, null, \"x\\u00e9\\n\"]}", value, error));
+    REQUIRE(value.type == sos::Base::ObjectType);
+
+    const sos::Bases& items = value.object["a"].array;
+
+    REQUIRE(items.size() == 5);
+    REQUIRE(items[0].number == 1);
+    REQUIRE(items[1].number == -25);
+    REQUIRE(items[2].boolean);
+    REQUIRE(items[3].type == sos::Base::NullType);
+    REQUIRE(items[4].str == "x\xc3\xa9\n");
+
+    REQUIRE_FALSE(drafter::ReadJSON("{\"a\": 1,}", value, error));
+    REQUIRE_FALSE(drafter::ReadJSON("[01]", value, error));
+    REQUIRE_FALSE(drafter::ReadJSON("\"unterminated", value, error));
+    REQUIRE_FALSE(drafter::ReadJSON("1 2", value, error));
+}
+
+TEST_CASE("validate instances against compiled schema","[payload validation]")
+{
+    std::string error;
+    std::string schema =
+        "{\"type\": \"object\","
+        " \"required\": [\"id\"],"
+        " \"additionalProperties\": false,"
+        " \"properties\": {"
+        "   \"id\": {\"type\": \"integer\", \"minimum\": 1},"
+        "   \"tags\": {\"type\": \"array\", \"items\": {\"$ref\": \"#/definitions/tag\"}, \"uniqueItems\": true},"
+        "   \"state\": {\"enum\": [\"open\", \"done\"]}"
+        " },"
+        " \"definitions\": {\"tag\": {\"type\": \"string\", \"pattern\": \"^[a-z]+$\", \"maxLength\": 8}}"
+        "}";
+
+    REQUIRE(Validate(schema, "{\"id\": 1, \"tags\": [\"a\", \"b\"], \"state\": \"done\"}", error));
+
+    REQUIRE_FALSE(Validate(schema, "{\"tags\": []}", error));
+    REQUIRE(error == "/: missing required property 'id'");
+
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 1.5}", error));
+    REQUIRE(error == "/id: unexpected type 'number'");
+
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 0}", error));
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 1, \"tags\": [\"a\", \"B\"]}", error));
+    REQUIRE(error == "/tags/1: string does not match pattern");
+
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 1, \"tags\": [\"a\", \"a\"]}", error));
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 1, \"state\": \"new\"}", error));
+    REQUIRE_FALSE(Validate(schema, "{\"id\": 1, \"other\": 1}", error));
+
+    REQUIRE(Validate("{\"oneOf\": [{\"type\": \"string\"}, {\"type\": \"integer\"}]}", "3", error));
+    REQUIRE_FALSE(Validate("{\"oneOf\": [{\"type\": \"number\"}, {\"type\": \"integer\"}]}", "3", error));
+    REQUIRE_FALSE(Validate("{\"not\": {\"type\": \"null\"}}", "null", error));
+}
+
+TEST_CASE("unknown type name is schema error","[payload validation]")
+{
+    sos::Base document;
+    drafter::JSONSchema schema;
+    std::string error;
+
+    REQUIRE(drafter::ReadJSON("{\"type\": \"strnig\"}", document, error));
+    REQUIRE_FALSE(schema.compile(document, error));
+    REQUIRE(error == "unknown type 'strnig' at '#'");
+
+    REQUIRE(drafter::ReadJSON("{\"properties\": {\"id\": {\"type\": [\"integer\", 1]}}}", document, error));
+    REQUIRE_FALSE(schema.compile(document, error));
+
+    REQUIRE(drafter::ReadJSON("{\"type\": true}", document, error));
+    REQUIRE_FALSE(schema.compile(document, error));
+}
+
+TEST_CASE("long strings are not matched against pattern","[payload validation]")
+{
+    std::string error;
+    std::string schema = "{\"pattern\": \"^(a|b)*$\", \"patternProperties\": {\"^(a|b)*$\": {\"type\": \"null\"}}}";
+
+    REQUIRE_FALSE(Validate(schema, "\"abc\"", error));
+
+    // would overflow the stack of recursive matcher
+    std::string subject(1024 * 1024, 'a');
+
+    REQUIRE(Validate(schema, "\"" + subject + "c\"", error));
+    REQUIRE(Validate(schema, "{\"" + subject + "\": 1}", error));
+}
+
+TEST_CASE("schema cache compiles shared schema once","[payload validation]")
+{
+    drafter::SchemaCache cache;
+
+    drafter::SchemaCache::schema_ptr first = cache.get("{\"type\": \"string\"}");
+    drafter::SchemaCache::schema_ptr second = cache.get("{\"type\": \"string\"}");
+    drafter::SchemaCache::schema_ptr invalid = cache.get("{\"$ref\": \"other.json\"}");
+
+    REQUIRE(first->valid);
+    REQUIRE(first == second);
+    REQUIRE_FALSE(invalid->valid);
+    REQUIRE(cache.size() == 2);
+}
+
+TEST_CASE("report bodies not matching their schema","[payload validation]")
+{
+    ITFixtureFiles fixture = ITFixtureFiles("test/fixtures/payload-validation");
+    std::string source = fixture.get(".apib");
+
+    snowcrash::ParseResult<snowcrash::Blueprint> blueprint;
+    REQUIRE(snowcrash::parse(source, snowcrash::ExportSourcemapOption, blueprint) == snowcrash::Error::OK);
+
+    size_t warnings = blueprint.report.warnings.size();
+
+    drafter::SchemaCache cache;
+    drafter::ValidatePayloads(blueprint.node, blueprint.sourceMap, source, blueprint.report, &cache, 2);
+
+    REQUIRE(blueprint.report.warnings.size() == warnings + 1);
+    REQUIRE(cache.size() == 1);
+
+    const snowcrash::Warning& warning = blueprint.report.warnings.back();
+
+    REQUIRE(warning.code == drafter::PayloadValidationWarning);
+    REQUIRE(warning.message == "request of PUT /notes/{id}: body example does not match body schema: /id: unexpected type 'string'");
+    REQUIRE_FALSE(warning.location.empty());
+}
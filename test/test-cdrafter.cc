@@ -3,6 +3,8 @@
 #include "cdrafter.h"
 
 #include <string.h>
+#include <algorithm>
+#include <sstream>
 
 TEST_CASE("c-interface parse blueprint ","[c-interface]")
 {
@@ -53,3 +55,131 @@ TEST_CASE("c-interface check result, without memory alloc","[c-interface]")
     REQUIRE(ret == 0);
 }
 
+
+namespace {
+
+    struct Chunks {
+        std::string data;
+        size_t count;
+        size_t largest;
+        size_t limit;           ///< chunks to accept before failing
+
+        Chunks(size_t limit_ = static_cast<size_t>(-1)) : count(0), largest(0), limit(limit_) {}
+    };
+
+    int CollectChunk(const char* data, size_t length, void* userdata)
+    {
+        Chunks* chunks = static_cast<Chunks*>(userdata);
+
+        chunks->data.append(data, length);
+        chunks->largest = std::max(chunks->largest, length);
+
+        return ++chunks->count >= chunks->limit ? 1 : 0;
+    }
+
+    std::string ManyResources(size_t count)
+    {
+        std::stringstream source;
+
+        source << "# API\n\n";
+
+        for (size_t i = 0; i < count; ++i) {
+            source << "## Note " << i << " [/notes/" << i << "]\n"
+                   << "### Retrieve [GET]\n"
+                   << "+ Response 200 (text/plain)\n\n"
+                   << "        Note " << i << "\n\n";
+        }
+
+        return source.str();
+    }
+}
+
+TEST_CASE("c-interface stream result in chunks","[c-interface]")
+{
+    std::string source = ManyResources(500);
+
+    char *result = NULL;
+    int ret = drafter_c_parse(source.c_str(), SC_EXPORT_SORUCEMAP_OPTION, &result);
+
+    Chunks chunks;
+
+    REQUIRE(drafter_c_parse_to(source.data(), source.size(), SC_EXPORT_SORUCEMAP_OPTION, CollectChunk, &chunks) == ret);
+
+    REQUIRE(chunks.count > 1);
+    REQUIRE(chunks.largest <= SC_WRITE_CHUNK_SIZE);
+    REQUIRE(chunks.data == result);
+
+    free(result);
+}
+
+TEST_CASE("c-interface stop streaming when callback fails","[c-interface]")
+{
+    std::string source = ManyResources(500);
+
+    Chunks chunks(1);
+
+    REQUIRE(drafter_c_parse_to(source.data(), source.size(), 0, CollectChunk, &chunks) == SC_WRITE_ERROR);
+    REQUIRE(chunks.count == 1);
+    REQUIRE(chunks.data.size() == SC_WRITE_CHUNK_SIZE);
+}
+
+static std::string ViewString(sc_string_view view)
+{
+    return std::string(view.data, view.length);
+}
+
+TEST_CASE("c-interface walk AST by accessors","[c-interface]")
+{
+    std::string source = "# Notes API\n"
+                         "# Group Notes\n"
+                         "## /notes/{id}\n"
+                         "### Retrieve Note [GET]\n"
+                         "+ Response 200 (application/json)\n"
+                         "\n"
+                         "        { \"id\": 1 }\n"
+                         "\n"
+                         "### Remove Note [DELETE]\n"
+                         "+ Response 204\n";
+
+    sc_result* result = NULL;
+    REQUIRE(drafter_c_parse_result(source.data(), source.size(), 0, &result) == 0);
+
+    REQUIRE(ViewString(drafter_c_result_name(result)) == "Notes API");
+    REQUIRE(drafter_c_result_error(result).length == 0);
+
+    REQUIRE(drafter_c_resource_group_count(result) == 1);
+    const sc_resource_group* group = drafter_c_resource_group(result, 0);
+    REQUIRE(ViewString(drafter_c_resource_group_name(group)) == "Notes");
+
+    REQUIRE(drafter_c_resource_count(group) == 1);
+    const sc_resource* resource = drafter_c_resource(group, 0);
+    REQUIRE(ViewString(drafter_c_resource_uri_template(resource)) == "/notes/{id}");
+
+    REQUIRE(drafter_c_action_count(resource) == 2);
+    const sc_action* action = drafter_c_action(resource, 0);
+    REQUIRE(ViewString(drafter_c_action_name(action)) == "Retrieve Note");
+    REQUIRE(ViewString(drafter_c_action_method(action)) == "GET");
+    REQUIRE(ViewString(drafter_c_action_method(drafter_c_action(resource, 1))) == "DELETE");
+
+    REQUIRE(drafter_c_example_count(action) == 1);
+    const sc_example* example = drafter_c_example(action, 0);
+
+    REQUIRE(drafter_c_request_count(example) == 0);
+    REQUIRE(drafter_c_response_count(example) == 1);
+
+    const sc_payload* response = drafter_c_response(example, 0);
+    REQUIRE(ViewString(drafter_c_payload_name(response)) == "200");
+    REQUIRE(ViewString(drafter_c_payload_body(response)) == "{ \"id\": 1 }\n");
+
+    REQUIRE(drafter_c_header_count(response) == 1);
+    REQUIRE(ViewString(drafter_c_header_name(response, 0)) == "Content-Type");
+    REQUIRE(ViewString(drafter_c_header_value(response, 0)) == "application/json");
+
+    // out of range gives NULL handle, NULL handle empty values
+    REQUIRE(drafter_c_action(resource, 2) == NULL);
+    REQUIRE(drafter_c_example_count(NULL) == 0);
+    REQUIRE(drafter_c_payload_body(drafter_c_request(example, 0)).length == 0);
+    REQUIRE(drafter_c_payload_body(NULL).data != NULL);
+
+    drafter_c_free_result(result);
+}
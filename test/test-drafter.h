@@ -30,7 +30,7 @@ class ITFixtureFiles {
 public:
     ITFixtureFiles(const std::string& base) : base_(base) {} 
 
-    typedef std::auto_ptr<std::istream> stream_type;
+    typedef std::unique_ptr<std::istream> stream_type;
 
     const std::string fetchContent(const std::string& filename) const {
 